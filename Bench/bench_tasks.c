@@ -0,0 +1,463 @@
+#define _POSIX_C_SOURCE 200809L   // clock_gettime
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "list.h"
+#include "stack.h"
+#include "tree.h"
+#include "file.h"
+#include "trash.h"
+#include "desc.h"
+#include "progress.h"
+#include "mem.h"
+
+/**
+ * Benchmark suite for the list, its BSTs, the undo history and the task file.
+ *
+ * For each size N and ID ordering, a synthetic list is built and the operations
+ * below are timed, keeping the best of --repeat runs (K = min(N, 10000)):
+ *
+ *   bulk_add       N tasks appended with BST maintenance deferred, as a load does
+ *   add            K new tasks inserted one at a time, recorded for undo
+ *   update         K priority and status changes of random tasks
+ *   remove         K removals of random tasks, recorded for undo
+ *   undo           K undo steps putting the removed tasks back
+ *   restore        K tasks restored from the trash file
+ *   sorted_id, sorted_priority, sorted_status
+ *                  one in-order walk of each BST (N tasks)
+ *   find_id        K lookups of random IDs
+ *   search_title   one scan of the list for a title substring (N tasks)
+ *   save, load     the list written to a task file and read back (N tasks)
+ *
+ * The ordering gives both the IDs of the list, head first, and those of the K
+ * tasks added: asc (ascending, as an application handing out IDs does), random
+ * (a random permutation) or adversarial (zigzag: lowest, highest, second lowest...,
+ * the deepest insertion paths for the unbalanced BSTs).
+ *
+ * Results go to stdout as tab-separated lines after a header: size, order, op,
+ * ops and nanoseconds per op. With --baseline FILE, a saved earlier output, each
+ * line also gets the baseline's nanoseconds per op for the same size, order and op,
+ * the ratio, and "ok", "slower" (ratio above 1 + tolerance) or "new"; the exit
+ * status is then 1 if any op is slower. Timings depend on the machine, so a
+ * baseline is only meaningful on the machine that recorded it.
+ *
+ * Usage: bench_tasks [--sizes 1000,100000,1000000] [--orders asc,random,adversarial]
+ *                    [--repeat 3] [--baseline FILE] [--tolerance 0.25]
+ */
+
+#define BENCH_MAX_K 10000
+#define BENCH_MAX_SIZES 8
+#define BENCH_MAX_OPS 16
+#define BENCH_MAX_BASELINE 1024
+#define BENCH_TASK_FILE "bench.tasks.dat"
+#define BENCH_TRASH_FILE "bench.trash.dat"
+
+/**
+ * @brief ID orderings.
+ */
+typedef enum {
+    ORDER_ASC,
+    ORDER_RANDOM,
+    ORDER_ADVERSARIAL
+} BenchOrder;
+
+static const char *bench_orderNames[] = { "asc", "random", "adversarial" };
+
+/**
+ * @brief Timing of one operation.
+ */
+typedef struct BenchResult {
+    int size;
+    char order[16];
+    char op[24];
+    long ops;
+    double ns;                // Nanoseconds per op
+} BenchResult;
+
+static BenchResult bench_results[BENCH_MAX_OPS];   // Best timings of the current size and ordering
+static int bench_resultCount;
+static BenchResult bench_baseline[BENCH_MAX_BASELINE];
+static int bench_baselineCount = 0;
+static unsigned long long bench_seed = 88172645463325252ULL;
+static long bench_sink = 0;                         // Keeps the walks and lookups from being optimised away
+
+/**
+ * @brief Returns a monotonic time in seconds.
+ */
+static double bench_now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Returns the next pseudo-random number (xorshift64).
+ */
+static unsigned long long bench_random() {
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 7;
+    bench_seed ^= bench_seed << 17;
+    return bench_seed;
+}
+
+/**
+ * @brief Shuffles the first count IDs of an array into a random prefix (partial Fisher-Yates).
+ *
+ * @param ids The array.
+ * @param length Length of the array.
+ * @param count Number of IDs to draw.
+ */
+static void bench_shuffle(int *ids, int length, int count) {
+    for (int i = 0; i < count && i < length - 1; i++) {
+        int j = i + (int)(bench_random() % (unsigned long long)(length - i));
+        int id = ids[i];
+        ids[i] = ids[j];
+        ids[j] = id;
+    }
+}
+
+/**
+ * @brief Fills an array with the IDs base + 1 to base + count in an ordering.
+ *
+ * @param ids The array.
+ * @param count Number of IDs.
+ * @param base Offset of the IDs.
+ * @param order The ordering.
+ */
+static void bench_ids(int *ids, int count, int base, BenchOrder order) {
+    for (int i = 0; i < count; i++) {
+        if (order == ORDER_ADVERSARIAL) ids[i] = base + (i % 2 == 0 ? i / 2 + 1 : count - i / 2);
+        else ids[i] = base + i + 1;
+    }
+    if (order == ORDER_RANDOM) bench_shuffle(ids, count, count);
+}
+
+/**
+ * @brief Allocates a synthetic task.
+ *
+ * Titles cycle through a few words, every third task has a due date and every
+ * fourth one a description, so all parts of a task record are exercised.
+ *
+ * @param id ID of the task.
+ * @return The task, or NULL on allocation failure.
+ */
+static Task* bench_makeTask(int id) {
+    static const char *words[] = { "report", "review", "deploy", "fix", "plan", "test", "migrate" };
+    char description[64];
+    Task *task = mem_alloc(MEM_TASK, sizeof(Task));
+    if (!task) return NULL;
+    memset(task, 0, sizeof(Task));
+    task->id = id;
+    snprintf(task->title, sizeof(task->title), "Task %d %s", id, words[id % 7]);
+    task->priority = (Priority)(id % 3 + 1);
+    task->status = (Status)((id / 3) % 3 + 1);
+    task->created = 1700000000u + (unsigned int)id;
+    task->due = id % 3 == 0 ? task->created + 86400u * (unsigned int)(id % 30) : 0;
+    task->description = DESC_NONE;
+    snprintf(description, sizeof(description), "Synthetic description of task %d", id);
+    if (id % 4 == 0 && !task_setDescription(task, description)) {
+        mem_free(MEM_TASK, task, sizeof(Task));
+        return NULL;
+    }
+    return task;
+}
+
+/**
+ * @brief Records the timing of an operation, keeping the best of the repeats.
+ *
+ * @param size Size of the list.
+ * @param order The ordering.
+ * @param op Name of the operation.
+ * @param ops Number of operations timed.
+ * @param seconds Time they took.
+ */
+static void bench_record(int size, BenchOrder order, const char *op, long ops, double seconds) {
+    double ns = ops > 0 ? seconds * 1e9 / ops : 0;
+    for (int i = 0; i < bench_resultCount; i++) {
+        if (strcmp(bench_results[i].op, op) == 0) {
+            if (ns < bench_results[i].ns) bench_results[i].ns = ns;
+            return;
+        }
+    }
+    if (bench_resultCount == BENCH_MAX_OPS) return;
+    BenchResult *result = &bench_results[bench_resultCount++];
+    result->size = size;
+    snprintf(result->order, sizeof(result->order), "%s", bench_orderNames[order]);
+    snprintf(result->op, sizeof(result->op), "%s", op);
+    result->ops = ops;
+    result->ns = ns;
+}
+
+/**
+ * @brief Counts the tasks of an in-order walk (a visitor for tree_forEach()).
+ */
+static void bench_visit(Task *task, void *context) {
+    (*(long *)context) += task->id & 1;
+}
+
+/**
+ * @brief Builds a list of a size and ordering, and times every operation on it once.
+ *
+ * @param size Number of tasks.
+ * @param order The ordering.
+ * @return 1 on success, 0 on allocation or file failure.
+ */
+static int bench_run(int size, BenchOrder order) {
+    int k = size < BENCH_MAX_K ? size : BENCH_MAX_K;
+    int *ids = malloc((size_t)size * sizeof(int));
+    int *picks = malloc((size_t)size * sizeof(int));
+    int *added = malloc((size_t)k * sizeof(int));
+    List *head = NULL;
+    Stack *stack = stack_create(k);
+    Tree *id_tree = tree_create(KEY_ID);
+    Tree *priority_tree = tree_create(KEY_PRIORITY);
+    Tree *status_tree = tree_create(KEY_STATUS);
+    int ok = ids && picks && added && stack && id_tree && priority_tree && status_tree;
+    double start;
+
+    if (ok) {
+        bench_ids(ids, size, 0, order);
+        bench_ids(added, k, size, order);
+        memcpy(picks, ids, (size_t)size * sizeof(int));
+        bench_shuffle(picks, size, k);   // K distinct random IDs of the list
+    }
+
+    // bulk_add: appends with deferred BST maintenance, then one rebuild
+    start = bench_now();
+    list_deferIndexes();
+    for (int i = 0; ok && i < size; i++) {
+        Task *task = bench_makeTask(ids[i]);
+        ok = task && list_insertTask(&head, task, POS_END, 0, NULL, id_tree, priority_tree, status_tree) == LIST_OK;
+    }
+    list_resumeIndexes(head, id_tree, priority_tree, status_tree);
+    if (ok) bench_record(size, order, "bulk_add", size, bench_now() - start);
+
+    // add: one insertion at a time, each updating the BSTs and the undo history
+    start = bench_now();
+    for (int i = 0; ok && i < k; i++) {
+        Task *task = bench_makeTask(added[i]);
+        ok = task && list_insertTask(&head, task, POS_END, 0, stack, id_tree, priority_tree, status_tree) == LIST_OK;
+    }
+    if (ok) bench_record(size, order, "add", k, bench_now() - start);
+
+    if (ok) {
+        start = bench_now();
+        for (int i = 0; i < k; i++) {
+            int id = picks[i];
+            list_setTaskFields(head, id, (Priority)(id % 3 + 1), (Status)((id + i) % 3 + 1), stack,
+                               priority_tree, status_tree);
+        }
+        bench_record(size, order, "update", k, bench_now() - start);
+
+        start = bench_now();
+        for (int i = 0; i < k; i++) list_removeTask(&head, picks[i], stack, id_tree, priority_tree, status_tree);
+        bench_record(size, order, "remove", k, bench_now() - start);
+
+        start = bench_now();
+        for (int i = 0; i < k; i++) list_undoStep(&head, stack, id_tree, priority_tree, status_tree);
+        bench_record(size, order, "undo", k, bench_now() - start);
+    }
+
+    // restore: the same tasks deleted to the trash file, then restored from it
+    ok = ok && trash_open(BENCH_TRASH_FILE);
+    if (ok) {
+        for (int i = 0; i < k; i++) {
+            Task *task = list_findTask(head, picks[i]);
+            if (task) trash_append(task);
+            list_removeTask(&head, picks[i], NULL, id_tree, priority_tree, status_tree);
+        }
+        start = bench_now();
+        for (int i = 0; i < k; i++) list_restoreTask(&head, picks[i], 0, stack, id_tree, priority_tree, status_tree);
+        bench_record(size, order, "restore", k, bench_now() - start);
+        trash_close();
+        remove(BENCH_TRASH_FILE);
+    }
+
+    if (ok) {
+        const char *walks[] = { "sorted_id", "sorted_priority", "sorted_status" };
+        Tree *trees[] = { id_tree, priority_tree, status_tree };
+        long count = listCounter_get();
+        for (int t = 0; t < 3; t++) {
+            start = bench_now();
+            tree_forEach(trees[t], bench_visit, &bench_sink);
+            bench_record(size, order, walks[t], count, bench_now() - start);
+        }
+
+        start = bench_now();
+        for (int i = 0; i < k; i++) bench_sink += list_findTask(head, picks[(i * 7) % k]) != NULL;
+        bench_record(size, order, "find_id", k, bench_now() - start);
+
+        start = bench_now();
+        for (List *node = head; node; node = node->next) bench_sink += strstr(node->task->title, "review") != NULL;
+        bench_record(size, order, "search_title", count, bench_now() - start);
+
+        start = bench_now();
+        ok = file_writeTasks(head, BENCH_TASK_FILE) == count;
+        if (ok) bench_record(size, order, "save", count, bench_now() - start);
+    }
+    if (ok) {
+        start = bench_now();
+        ok = file_readTasks(BENCH_TASK_FILE, &head, NULL, id_tree, priority_tree, status_tree, NULL) == listCounter_get();
+        if (ok) bench_record(size, order, "load", listCounter_get(), bench_now() - start);
+    }
+    remove(BENCH_TASK_FILE);
+
+    list_destroy(head);
+    if (stack) stack_free(stack);
+    if (id_tree) tree_free(id_tree);
+    if (priority_tree) tree_free(priority_tree);
+    if (status_tree) tree_free(status_tree);
+    desc_reset();
+    free(ids);
+    free(picks);
+    free(added);
+    return ok;
+}
+
+/**
+ * @brief Reads a baseline, a saved output of this program.
+ *
+ * @param path Path of the file.
+ * @return 1 on success, 0 if the file could not be opened.
+ */
+static int bench_readBaseline(const char *path) {
+    FILE *file = fopen(path, "r");
+    char line[256];
+    if (!file) return 0;
+    while (bench_baselineCount < BENCH_MAX_BASELINE && fgets(line, sizeof(line), file)) {
+        BenchResult *result = &bench_baseline[bench_baselineCount];
+        if (sscanf(line, "%d\t%15s\t%23s\t%ld\t%lf", &result->size, result->order, result->op,
+                   &result->ops, &result->ns) == 5)
+            bench_baselineCount++;
+    }
+    fclose(file);
+    return 1;
+}
+
+/**
+ * @brief Finds the baseline timing of an operation.
+ *
+ * @param result The new timing.
+ * @return The baseline timing, or NULL if the baseline has none.
+ */
+static const BenchResult* bench_findBaseline(const BenchResult *result) {
+    for (int i = 0; i < bench_baselineCount; i++) {
+        const BenchResult *base = &bench_baseline[i];
+        if (base->size == result->size && strcmp(base->order, result->order) == 0 && strcmp(base->op, result->op) == 0)
+            return base;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Parses a comma-separated list of sizes.
+ *
+ * @param text The list.
+ * @param sizes Filled with the sizes.
+ * @return Number of sizes, or 0 if the list is invalid.
+ */
+static int bench_parseSizes(const char *text, int *sizes) {
+    int count = 0;
+    while (*text && count < BENCH_MAX_SIZES) {
+        char *end;
+        long size = strtol(text, &end, 10);
+        if (end == text || size < 1 || size > 100000000L) return 0;
+        sizes[count++] = (int)size;
+        text = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',') return 0;
+    }
+    return *text ? 0 : count;
+}
+
+/**
+ * @brief Parses a comma-separated list of orderings.
+ *
+ * @param text The list.
+ * @param orders Filled with the orderings.
+ * @return Number of orderings, or 0 if the list is invalid.
+ */
+static int bench_parseOrders(const char *text, BenchOrder *orders) {
+    char copy[64];
+    int count = 0;
+    snprintf(copy, sizeof(copy), "%s", text);
+    for (char *name = strtok(copy, ","); name; name = strtok(NULL, ",")) {
+        int found = 0;
+        for (int o = 0; o < 3 && !found; o++) {
+            if (strcmp(name, bench_orderNames[o]) == 0) {
+                if (count == 3) return 0;
+                orders[count++] = (BenchOrder)o;
+                found = 1;
+            }
+        }
+        if (!found) return 0;
+    }
+    return count;
+}
+
+int main(int argc, char *argv[]) {
+    int sizes[BENCH_MAX_SIZES] = { 1000, 100000, 1000000 };
+    int size_count = 3;
+    BenchOrder orders[3] = { ORDER_ASC, ORDER_RANDOM, ORDER_ADVERSARIAL };
+    int order_count = 3;
+    int repeat = 3;
+    double tolerance = 0.25;
+    const char *baseline = NULL;
+    int slower = 0;
+
+    for (int i = 1; i < argc; i++) {
+        int ok = i + 1 < argc;
+        if (ok && strcmp(argv[i], "--sizes") == 0) ok = (size_count = bench_parseSizes(argv[++i], sizes)) > 0;
+        else if (ok && strcmp(argv[i], "--orders") == 0) ok = (order_count = bench_parseOrders(argv[++i], orders)) > 0;
+        else if (ok && strcmp(argv[i], "--repeat") == 0) ok = (repeat = atoi(argv[++i])) > 0;
+        else if (ok && strcmp(argv[i], "--tolerance") == 0) ok = (tolerance = atof(argv[++i])) >= 0;
+        else if (ok && strcmp(argv[i], "--baseline") == 0) baseline = argv[++i];
+        else ok = 0;
+        if (!ok) {
+            printf("Usage: %s [--sizes 1000,100000,1000000] [--orders asc,random,adversarial] "
+                   "[--repeat 3] [--baseline FILE] [--tolerance 0.25]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (baseline && !bench_readBaseline(baseline)) {
+        fprintf(stderr, "Cannot read the baseline %s.\n", baseline);
+        return 2;
+    }
+
+    progress_setEnabled(0);
+    printf("size\torder\top\tops\tns_per_op%s\n", baseline ? "\tbaseline_ns\tratio\tverdict" : "");
+    for (int s = 0; s < size_count; s++) {
+        for (int o = 0; o < order_count; o++) {
+            bench_resultCount = 0;
+            for (int r = 0; r < repeat; r++) {
+                if (!bench_run(sizes[s], orders[o])) {
+                    fprintf(stderr, "Run of %d tasks (%s) failed: out of memory or cannot write files.\n",
+                            sizes[s], bench_orderNames[orders[o]]);
+                    return 2;
+                }
+            }
+
+            for (int i = 0; i < bench_resultCount; i++) {
+                const BenchResult *result = &bench_results[i];
+                printf("%d\t%s\t%s\t%ld\t%.1f", result->size, result->order, result->op, result->ops, result->ns);
+                if (baseline) {
+                    const BenchResult *base = bench_findBaseline(result);
+                    if (!base) {
+                        printf("\t-\t-\tnew");
+                    } else {
+                        double ratio = base->ns > 0 ? result->ns / base->ns : 1;
+                        int regressed = ratio > 1 + tolerance;
+                        printf("\t%.1f\t%.2f\t%s", base->ns, ratio, regressed ? "slower" : "ok");
+                        slower += regressed;
+                    }
+                }
+                printf("\n");
+            }
+            fflush(stdout);
+        }
+    }
+
+    if (baseline) fprintf(stderr, "%d ops slower than the baseline by more than %.0f%%\n", slower, tolerance * 100);
+    return slower > 0;
+}
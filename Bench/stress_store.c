@@ -0,0 +1,201 @@
+#define _POSIX_C_SOURCE 200809L   // clock_gettime, nanosleep
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "store.h"
+#include "desc.h"
+
+/**
+ * Stress benchmark for the thread-safe task store.
+ *
+ * Fills a store, then for 1, 2, 4, ... reader threads measures how many reads per
+ * second the readers complete while one writer keeps updating tasks at a fixed rate.
+ * A read is a lookup by ID (70%), a sorted page of 50 tasks by priority (20%) or a
+ * title search over 1000 tasks in ID order (10%).
+ *
+ * Usage: stress_store [tasks] [max_threads] [seconds] [writes_per_second]
+ */
+
+#define STRESS_PAGE 50
+#define STRESS_SEARCH_SPAN 1000
+#define STRESS_MAX_THREADS 256
+
+/**
+ * @brief Per-thread state, padded so counters of different threads never share a cache line.
+ */
+typedef struct Worker {
+    pthread_t thread;
+    unsigned long long seed;  // xorshift state
+    long long operations;     // Operations completed
+    char padding[64];
+} Worker;
+
+static TaskStore *stress_store;
+static int stress_tasks;
+static int stress_writeRate;
+static int stress_running;                // Read and written atomically
+
+/**
+ * @brief Returns a monotonic time in seconds.
+ */
+static double stress_now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Returns the next pseudo-random number of a worker (xorshift64).
+ */
+static unsigned long long stress_random(Worker *worker) {
+    worker->seed ^= worker->seed << 13;
+    worker->seed ^= worker->seed >> 7;
+    worker->seed ^= worker->seed << 17;
+    return worker->seed;
+}
+
+/**
+ * @brief Scan callback that only counts the tasks it sees.
+ */
+static int stress_visitCount(const Task *task, void *context) {
+    (void)task;
+    (*(long *)context)++;
+    return 1;
+}
+
+/**
+ * @brief Scan callback that counts the tasks whose title contains "99".
+ */
+static int stress_visitSearch(const Task *task, void *context) {
+    if (strstr(task->title, "99")) (*(long *)context)++;
+    return 1;
+}
+
+/**
+ * @brief Reader thread: random reads until the run ends.
+ */
+static void* stress_reader(void *arg) {
+    Worker *worker = arg;
+    Task task;
+    char description[DESC_MAX + 1];
+    long seen = 0;
+
+    while (__atomic_load_n(&stress_running, __ATOMIC_RELAXED)) {
+        for (int i = 0; i < 64; i++) {
+            unsigned long long r = stress_random(worker);
+            int id = (int)(r % (unsigned long long)stress_tasks) + 1;
+            int kind = (int)((r >> 32) % 10);
+            if (kind < 7) store_get(stress_store, id, &task, description, sizeof(description));
+            else if (kind < 9) store_scanSorted(stress_store, KEY_PRIORITY, id, STRESS_PAGE, stress_visitCount, &seen);
+            else store_scanSorted(stress_store, KEY_ID, id, STRESS_SEARCH_SPAN, stress_visitSearch, &seen);
+        }
+        worker->operations += 64;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Writer thread: updates random tasks at stress_writeRate per second.
+ */
+static void* stress_writer(void *arg) {
+    Worker *worker = arg;
+    struct timespec pause = { 0, 1000000 };   // 1 ms between bursts
+    int burst = stress_writeRate / 1000 > 0 ? stress_writeRate / 1000 : 1;
+
+    while (__atomic_load_n(&stress_running, __ATOMIC_RELAXED)) {
+        for (int i = 0; i < burst; i++) {
+            unsigned long long r = stress_random(worker);
+            int id = (int)(r % (unsigned long long)stress_tasks) + 1;
+            store_update(stress_store, id, (Priority)(r % 3 + 1), (Status)((r >> 8) % 3 + 1));
+        }
+        worker->operations += burst;
+        nanosleep(&pause, NULL);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Runs one measurement with a number of reader threads.
+ *
+ * @param readers Number of reader threads.
+ * @param seconds Duration of the run.
+ * @param writes Set to the writer's updates per second.
+ * @return Reads per second across all readers.
+ */
+static double stress_run(int readers, double seconds, double *writes) {
+    static Worker workers[STRESS_MAX_THREADS + 1];
+    Worker *writer = &workers[readers];
+    double start, elapsed;
+    long long total = 0;
+
+    memset(workers, 0, sizeof(workers));
+    __atomic_store_n(&stress_running, 1, __ATOMIC_RELAXED);
+    start = stress_now();
+    for (int i = 0; i <= readers; i++) {
+        workers[i].seed = 0x9E3779B97F4A7C15ULL * (unsigned long long)(i + 1);
+        pthread_create(&workers[i].thread, NULL, i < readers ? stress_reader : stress_writer, &workers[i]);
+    }
+
+    struct timespec duration = { (time_t)seconds, (long)((seconds - (time_t)seconds) * 1e9) };
+    nanosleep(&duration, NULL);
+    __atomic_store_n(&stress_running, 0, __ATOMIC_RELAXED);
+    for (int i = 0; i <= readers; i++) pthread_join(workers[i].thread, NULL);
+    elapsed = stress_now() - start;
+
+    for (int i = 0; i < readers; i++) total += workers[i].operations;
+    *writes = writer->operations / elapsed;
+    return total / elapsed;
+}
+
+int main(int argc, char *argv[]) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = cores > 0 ? (int)cores : 1;
+    double seconds = 2.0;
+    double base = 0;
+    Task task;
+
+    stress_tasks = argc > 1 ? atoi(argv[1]) : 1000000;
+    if (argc > 2) max_threads = atoi(argv[2]);
+    if (argc > 3) seconds = atof(argv[3]);
+    stress_writeRate = argc > 4 ? atoi(argv[4]) : 1000;
+    if (stress_tasks < 1 || max_threads < 1 || max_threads > STRESS_MAX_THREADS || seconds <= 0) {
+        printf("Usage: %s [tasks] [max_threads] [seconds] [writes_per_second]\n", argv[0]);
+        return 1;
+    }
+
+    stress_store = store_create(0);
+    if (!stress_store) {
+        printf("Failed to create the store.\n");
+        return 1;
+    }
+    // Fill with BST maintenance deferred, as a load does, then build the BSTs once
+    memset(&task, 0, sizeof(task));
+    list_deferIndexes();
+    for (int id = 1; id <= stress_tasks; id++) {
+        task.id = id;
+        snprintf(task.title, sizeof(task.title), "Task %d", id);
+        task.priority = (Priority)(id % 3 + 1);
+        task.status = (Status)(id % 3 + 1);
+        store_add(stress_store, &task, POS_END, 0);
+    }
+    list_resumeIndexes(stress_store->head, stress_store->id_tree, stress_store->priority_tree, stress_store->status_tree);
+
+    printf("%d tasks, %ld cores, %.1f s per run, writer at %d updates/s\n\n",
+           store_count(stress_store), cores, seconds, stress_writeRate);
+    printf("threads      reads/s   per thread   speedup    writes/s\n");
+    for (int readers = 1; ; readers *= 2) {
+        double writes;
+        if (readers > max_threads) readers = max_threads;
+        double reads = stress_run(readers, seconds, &writes);
+        if (readers == 1) base = reads;
+        printf("%7d %12.0f %12.0f %8.2fx %11.0f\n", readers, reads, reads / readers, reads / base, writes);
+        if (readers == max_threads) break;
+    }
+
+    store_free(stress_store);
+    return 0;
+}
@@ -0,0 +1,116 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+#include "list.h"
+#include "stack.h"
+#include "tree.h"
+
+/**
+ * @brief Maximum length of one batch command line (including the newline).
+ */
+#define BATCH_LINE_MAX 1024
+
+/**
+ * @brief Maximum length of an error message from batch_executeLine(), including the terminator.
+ */
+#define BATCH_ERROR_MAX 256
+
+/**
+ * @brief State shared by the commands run against one list.
+ */
+typedef struct BatchContext {
+    List **head;              // Head pointer of the list
+    Stack *stack;             // Undo stack
+    Tree *id_tree;            // BST sorted by ID
+    Tree *priority_tree;      // BST sorted by priority
+    Tree *status_tree;        // BST sorted by status
+    FILE *out;                // Stream for query results
+    char error[BATCH_ERROR_MAX]; // Message of the last failed line ("cmd: message")
+    unsigned int clock;       // Time given to new tasks and relative due dates (0: the current time)
+    int read_only;            // Refuse the commands that change the list or its files
+} BatchContext;
+
+/**
+ * @brief What a command does to the list, as told by batch_effect().
+ */
+typedef enum {
+    BATCH_READS,              // Reads the list only (queries, export)
+    BATCH_WRITES,             // Changes the list the same way wherever it is replayed on the same tasks
+    BATCH_REPLACES,           // Changes the list from state outside it: undo history, task files, projects
+    BATCH_CONTROLS            // Changes no task: transactions and save
+} BatchEffect;
+
+/**
+ * @brief Outcome of one command line.
+ */
+typedef enum {
+    BATCH_SKIPPED,            // Blank line or comment
+    BATCH_OK,                 // Command succeeded
+    BATCH_FAILED,             // Command failed; see BatchContext.error
+    BATCH_MALFORMED           // Line could not be split into words; see BatchContext.error
+} BatchResult;
+
+/**
+ * @brief Tells what the command of a line does to the list, without running it.
+ *
+ * Replaying the BATCH_WRITES lines of a run, with the same clock, on a copy of the
+ * list it started from gives the same tasks; the BATCH_REPLACES ones cannot be
+ * replayed that way. Blank lines, comments and unknown commands are BATCH_READS.
+ *
+ * @param line The command line.
+ * @return The effect of its command.
+ */
+BatchEffect batch_effect(const char *line);
+
+/**
+ * @brief Executes one command line.
+ *
+ * Query results are written to ctx->out. The caller is responsible for deferring
+ * BST maintenance around a series of lines if it wants to (see list_deferIndexes()).
+ * Commands are recorded to the trace file while one is open (see trace_open()).
+ *
+ * @param ctx Pointer to the context (head, stack, trees and output stream set).
+ * @param line The command line, with or without its newline (modified).
+ * @return Outcome of the line.
+ */
+BatchResult batch_executeLine(BatchContext *ctx, char *line);
+
+/**
+ * @brief Runs a non-interactive command script against the list.
+ *
+ * Reads one command per line, with no prompts, screen clears or animations:
+ *
+ *   add id=7 title="Fix login" desc="..." prio=high status=todo due=2026-11-30 at=end|head|after:ID
+ *   rm 7 | rm head | rm end | rm where status=done
+ *   update 7 prio=low status=done due=+3d
+ *   update where prio=low title=report set status=done
+ *   undo, redo, begin, commit, rollback, clear
+ *   save [path], load [path] (the active project's file by default)
+ *   get 7, list, sorted id|priority|status, export PATH, count, stats, stats ops [reset], stats mem
+ *   block 3 7, unblock 3 7 (task 3 has to finish before task 7 can start)
+ *   ready, order, blockers 7, critical, overdue
+ *   tag 7 infra urgent, untag 7 urgent, tags [7]
+ *   select tag:infra AND tag:urgent AND NOT status:done
+ *   project [NAME], projects, list all (every project, inactive ones streamed from disk)
+ *
+ * Blank lines and lines starting with '#' are ignored. Listings (get, list, sorted,
+ * export, ready, order, blockers, critical, overdue, select) take an optional format:
+ * plain, compact or tsv (the default); errors go to stderr as "name:line: message"
+ * and do not stop the run. BST maintenance is deferred for the whole run and done once at the end.
+ * The "where" forms select tasks by prio, status and a title substring, run as one
+ * bulk operation (see list_updateWhere()) and print the number of tasks affected.
+ *
+ * @param in Stream to read commands from.
+ * @param name Name of the stream, used in error messages.
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return Number of commands that failed.
+ */
+int batch_run(FILE *in, const char *name, List **head, Stack *stack,
+              Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+#endif
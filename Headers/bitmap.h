@@ -0,0 +1,122 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include <stdint.h>
+
+/**
+ * @brief Compressed set of 32-bit integers (roaring layout).
+ *
+ * Values are grouped by their high 16 bits into containers kept sorted by key.
+ * A container holding up to BITMAP_ARRAY_MAX values is a sorted array of their
+ * low 16 bits; a fuller one is a plain 65536-bit bitset. Set operations pair
+ * up containers by key and work on whole 64-bit words where both sides are
+ * bitsets, in loops the compiler can vectorize.
+ */
+typedef struct BitmapContainer {
+    uint16_t *values;         // Sorted low 16 bits (array container), or NULL
+    uint64_t *words;          // 1024 words (bitset container), or NULL
+    int count;                // Number of values in the container
+    int capacity;             // Allocated entries of values
+    uint16_t key;             // High 16 bits shared by the values
+} BitmapContainer;
+
+typedef struct Bitmap {
+    BitmapContainer *containers;   // Sorted by key, none empty
+    int count;                     // Number of containers
+    int capacity;                  // Allocated containers
+} Bitmap;
+
+/**
+ * @brief Largest number of values kept in an array container (8 KB, the size of a bitset).
+ */
+#define BITMAP_ARRAY_MAX 4096
+
+/**
+ * @brief Initializes an empty bitmap. No memory is allocated until the first insertion.
+ *
+ * @param bitmap Pointer to the bitmap.
+ */
+void bitmap_init(Bitmap *bitmap);
+
+/**
+ * @brief Frees the containers and resets the bitmap to empty.
+ *
+ * @param bitmap Pointer to the bitmap.
+ */
+void bitmap_free(Bitmap *bitmap);
+
+/**
+ * @brief Adds a value.
+ *
+ * @param bitmap Pointer to the bitmap.
+ * @param value The value.
+ * @return 1 on success (including a value already present), 0 on allocation failure.
+ */
+int bitmap_add(Bitmap *bitmap, uint32_t value);
+
+/**
+ * @brief Removes a value, if present.
+ *
+ * @param bitmap Pointer to the bitmap.
+ * @param value The value.
+ */
+void bitmap_remove(Bitmap *bitmap, uint32_t value);
+
+/**
+ * @brief Checks whether a value is in the bitmap.
+ *
+ * @param bitmap Pointer to the bitmap.
+ * @param value The value.
+ * @return 1 if present, 0 otherwise.
+ */
+int bitmap_contains(const Bitmap *bitmap, uint32_t value);
+
+/**
+ * @brief Returns the number of values in the bitmap.
+ *
+ * @param bitmap Pointer to the bitmap.
+ * @return Number of values.
+ */
+long bitmap_cardinality(const Bitmap *bitmap);
+
+/**
+ * @brief Computes a AND b.
+ *
+ * @param out Pointer to an initialized bitmap receiving the result (replaced; not a or b).
+ * @param a Pointer to the first operand.
+ * @param b Pointer to the second operand.
+ * @return 1 on success, 0 on allocation failure (out is left empty).
+ */
+int bitmap_and(Bitmap *out, const Bitmap *a, const Bitmap *b);
+
+/**
+ * @brief Computes a AND NOT b.
+ *
+ * @param out Pointer to an initialized bitmap receiving the result (replaced; not a or b).
+ * @param a Pointer to the first operand.
+ * @param b Pointer to the values to take out.
+ * @return 1 on success, 0 on allocation failure (out is left empty).
+ */
+int bitmap_andNot(Bitmap *out, const Bitmap *a, const Bitmap *b);
+
+/**
+ * @brief Computes a OR b.
+ *
+ * @param out Pointer to an initialized bitmap receiving the result (replaced; not a or b).
+ * @param a Pointer to the first operand.
+ * @param b Pointer to the second operand.
+ * @return 1 on success, 0 on allocation failure (out is left empty).
+ */
+int bitmap_or(Bitmap *out, const Bitmap *a, const Bitmap *b);
+
+/**
+ * @brief Writes the values in increasing order.
+ *
+ * @param bitmap Pointer to the bitmap.
+ * @param values Array receiving up to max values.
+ * @param max Capacity of values.
+ * @return Number of values written.
+ */
+long bitmap_values(const Bitmap *bitmap, uint32_t *values, long max);
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef CLIENT_H
+#define CLIENT_H
+
+/**
+ * @brief Sends the batch commands on standard input to a daemon and prints the responses.
+ *
+ * Requests are pipelined: the client keeps sending while responses come back, so a
+ * long script costs no round trip per line. Output of successful commands goes to
+ * stdout; failures are reported on stderr as "stdin:LINE: message", like batch mode.
+ * Only available on Linux.
+ *
+ * @param path Path of the daemon's socket.
+ * @return Number of failed lines, or -1 if the daemon could not be reached.
+ */
+int client_run(const char *path);
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include "list.h"
+#include "stack.h"
+#include "tree.h"
+
+/**
+ * @brief Maximum number of events handled per wait of the event loop.
+ */
+#define DAEMON_MAX_EVENTS 64
+
+/**
+ * @brief Pending output above which a client's further requests wait.
+ *
+ * A client that pipelines faster than it reads its responses is throttled here,
+ * and its socket buffer then throttles the client itself.
+ */
+#define DAEMON_OUTPUT_HIGH (1 << 20)
+
+/**
+ * @brief Interval of the heartbeats a primary sends to idle replicas, and of a
+ * replica's attempts to reach a primary it lost, in milliseconds.
+ */
+#define DAEMON_HEARTBEAT_MS 1000
+
+/**
+ * @brief Journal backlog above which a primary disconnects a replica.
+ *
+ * The replica gets a fresh snapshot when it reconnects, which costs less than
+ * holding an unbounded backlog for it.
+ */
+#define DAEMON_FOLLOWER_MAX (64L * 1024 * 1024)
+
+/**
+ * @brief Makes daemon_run() ship its journal to replicas connecting on a second socket.
+ *
+ * Each replica is sent a snapshot of the list, then every committed change as it
+ * happens (see journal.h), and a heartbeat every DAEMON_HEARTBEAT_MS while idle.
+ *
+ * @param path Path of the ship socket, or NULL not to ship (the default).
+ */
+void daemon_setShipPath(const char *path);
+
+/**
+ * @brief Makes daemon_run() serve as a read-only replica of another daemon.
+ *
+ * The daemon connects to the primary's ship socket, applies what it receives to
+ * its own list and indexes, and refuses the commands that would change them
+ * ("read-only replica"). If the primary goes away, the last state received is
+ * still served while the replica tries to reconnect. The "replication" command
+ * reports the lag on a replica and the backlog on a primary.
+ *
+ * @param path Path of the primary's ship socket, or NULL to serve the own list (the default).
+ */
+void daemon_setFollowPath(const char *path);
+
+/**
+ * @brief Serves the list to local clients over a Unix domain socket until SIGINT or SIGTERM.
+ *
+ * Requests are batch command lines (see batch_run()), one per line, and may be
+ * pipelined. Every line gets exactly one response, in order:
+ *
+ *   +LENGTH\n followed by LENGTH bytes of output   (success, blank line or comment)
+ *   -LENGTH\n followed by LENGTH bytes of message  (failure, "cmd: message")
+ *
+ * One thread runs a non-blocking epoll loop, so commands execute one at a time and
+ * need no locking. While a client has a transaction open, the other clients' requests
+ * wait until it commits or rolls back; a client that disconnects with a transaction
+ * open has it rolled back. Only available on Linux.
+ *
+ * See daemon_setShipPath() and daemon_setFollowPath() for replication.
+ *
+ * @param path Path of the socket to create (a stale socket file is replaced).
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return 0 after a clean shutdown, 1 if a socket could not be set up (or a replica
+ *         could not reach its primary).
+ */
+int daemon_run(const char *path, List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+#include <stddef.h>
+#include "task.h"
+
+/**
+ * Due dates of unfinished tasks, kept in a hierarchical timing wheel.
+ *
+ * The wheel has four levels of 256 one-list slots: level 0 holds the deadlines of
+ * the next 256 seconds, one slot per second, and each level above covers 256 times
+ * the span of the one below, so the four levels together cover the whole 32-bit
+ * time range. Scheduling and cancelling a deadline link or unlink it from a slot
+ * in O(1); as the clock passes a slot boundary of a higher level, that slot's
+ * deadlines move down a level, each at most three times in its life. A deadline
+ * that expires moves to the overdue list, so overdue tasks are listed without a
+ * scan of the tasks.
+ *
+ * The list calls the deadline_on*() hooks whenever a task enters or leaves the
+ * list or changes status or due date; finished tasks and tasks without a due date
+ * are not in the wheel.
+ */
+
+/**
+ * @brief Called for every deadline that expires while the clock advances.
+ *
+ * @param id ID of the task.
+ * @param due The task's due date.
+ * @param context Opaque pointer given to deadline_advance().
+ */
+typedef void (*DeadlineFn)(int id, unsigned int due, void *context);
+
+/**
+ * @brief Accounts for a task that has just been linked into the list.
+ *
+ * @param task Pointer to the linked Task.
+ */
+void deadline_onAdd(const Task *task);
+
+/**
+ * @brief Accounts for a task that has just been unlinked from the list.
+ *
+ * @param task Pointer to the unlinked Task.
+ */
+void deadline_onRemove(const Task *task);
+
+/**
+ * @brief Accounts for a status or due date change on a task in the list.
+ *
+ * @param task Pointer to the Task holding the new values.
+ */
+void deadline_onUpdate(const Task *task);
+
+/**
+ * @brief Drops every deadline (used when the list is cleared).
+ */
+void deadline_onClear();
+
+/**
+ * @brief Drops every deadline and frees the wheel.
+ */
+void deadline_reset();
+
+/**
+ * @brief Moves the wheel's clock forward, expiring the deadlines it passes.
+ *
+ * The clock starts at the first call (or at the wall-clock time of the first
+ * deadline scheduled before any call) and never goes back: an earlier time is
+ * ignored. Stretches of time with nothing due on the lower levels are skipped
+ * in one step.
+ *
+ * @param now The current time (seconds since the Unix epoch).
+ * @param fired Called for each expired deadline (may be NULL).
+ * @param context Opaque pointer passed to fired.
+ * @return Number of deadlines that expired.
+ */
+long deadline_advance(unsigned int now, DeadlineFn fired, void *context);
+
+/**
+ * @brief Returns the time the wheel's clock has reached.
+ *
+ * @return Seconds since the Unix epoch, or 0 if the clock has not started.
+ */
+unsigned int deadline_now();
+
+/**
+ * @brief Lists the overdue tasks, in the order they became overdue.
+ *
+ * @param ids Array receiving up to max task IDs.
+ * @param max Capacity of ids.
+ * @return Number of overdue tasks (may exceed max).
+ */
+int deadline_overdue(int *ids, int max);
+
+/**
+ * @brief Returns the number of overdue tasks.
+ *
+ * @return Number of unfinished tasks in the list whose due date has passed.
+ */
+int deadline_overdueCount();
+
+/**
+ * @brief Returns the number of deadlines still ahead.
+ *
+ * @return Number of unfinished tasks in the list with a due date not reached yet.
+ */
+int deadline_pendingCount();
+
+/**
+ * @brief Parses a due date.
+ *
+ * Accepts "none" (no due date), seconds since the Unix epoch, "+N" followed by
+ * s, m, h or d for a time relative to now, "YYYY-MM-DD" for the end of that day
+ * and "YYYY-MM-DDTHH:MM", both in local time.
+ *
+ * @param text The text to parse.
+ * @param now The current time, for relative dates.
+ * @param due Set to the due date (0 for none).
+ * @return 1 on success, 0 if the text is not a date in range.
+ */
+int deadline_parse(const char *text, unsigned int now, unsigned int *due);
+
+/**
+ * @brief Formats a time as "YYYY-MM-DD HH:MM" in local time.
+ *
+ * @param when Seconds since the Unix epoch.
+ * @param buffer Buffer receiving the text.
+ * @param size Size of the buffer (17 bytes fit the whole text).
+ */
+void deadline_format(unsigned int when, char *buffer, size_t size);
+
+#endif
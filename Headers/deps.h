@@ -0,0 +1,184 @@
+#ifndef DEPS_H
+#define DEPS_H
+
+#include "task.h"
+
+/**
+ * Dependency edges between tasks, kept outside the Task record.
+ *
+ * An edge "A blocks B" means B cannot start until A is finished. The graph keeps
+ * a topological order of its tasks up to date on every edge insertion (Pearce and
+ * Kelly's algorithm: only the tasks between the two ends of an out-of-order edge
+ * are visited and renumbered), which also rejects edges that would close a cycle.
+ *
+ * The list calls the deps_on*() hooks whenever a task enters or leaves the list
+ * or changes status, so the set of ready tasks (in the list, not finished, every
+ * blocker finished or gone) is maintained as it changes and listed without a
+ * scan. Only tasks that have taken part in an edge are in the graph; the hooks
+ * keep the other tasks of the list in a set of their own, unfinished ones first,
+ * so they are listed without a scan too. Edges are not part of the undo history: they
+ * survive the removal of a task and apply again once it is back in the list.
+ */
+
+/**
+ * @brief Called for each edge by deps_forEachEdge().
+ *
+ * @param blocker_id ID of the blocking task.
+ * @param blocked_id ID of the blocked task.
+ * @param context Opaque pointer given to deps_forEachEdge().
+ */
+typedef void (*DepsEdgeFn)(int blocker_id, int blocked_id, void *context);
+
+/**
+ * @brief Enum for the outcome of a dependency operation.
+ */
+typedef enum {
+    DEPS_OK = 0,        // Success
+    DEPS_SELF,          // A task cannot block itself
+    DEPS_CYCLE,         // The edge would close a cycle
+    DEPS_EXISTS,        // The edge is already in the graph
+    DEPS_NO_EDGE,       // The edge is not in the graph
+    DEPS_NO_MEMORY      // Allocation failure
+} DepsStatus;
+
+/**
+ * @brief Returns a short description of a status code.
+ *
+ * @param status The status code.
+ * @return Static string describing the status.
+ */
+const char* deps_statusName(DepsStatus status);
+
+/**
+ * @brief Records that one task blocks another.
+ *
+ * Runs in O(1) when the edge agrees with the current order, otherwise in time
+ * proportional to the edges of the tasks whose position has to change.
+ *
+ * @param blocker Pointer to the task that has to finish first (in the list).
+ * @param blocked Pointer to the task that waits for it (in the list).
+ * @return DEPS_OK, DEPS_SELF, DEPS_CYCLE, DEPS_EXISTS or DEPS_NO_MEMORY.
+ */
+DepsStatus deps_addEdge(const Task *blocker, const Task *blocked);
+
+/**
+ * @brief Deletes the edge between two tasks.
+ *
+ * @param blocker_id ID of the blocking task.
+ * @param blocked_id ID of the blocked task.
+ * @return DEPS_OK, or DEPS_NO_EDGE if there is no such edge.
+ */
+DepsStatus deps_removeEdge(int blocker_id, int blocked_id);
+
+/**
+ * @brief Deletes every edge of a task.
+ *
+ * @param id The task ID.
+ */
+void deps_dropTask(int id);
+
+/**
+ * @brief Calls a function for each edge between two tasks in the list.
+ *
+ * Blockers are visited in dependency order, so adding the edges back in the same
+ * order seldom has to reorder anything.
+ *
+ * @param fn Function to call.
+ * @param context Opaque pointer passed to fn.
+ */
+void deps_forEachEdge(DepsEdgeFn fn, void *context);
+
+/**
+ * @brief Accounts for a task that has just been linked into the list.
+ *
+ * @param task Pointer to the linked Task.
+ */
+void deps_onAdd(const Task *task);
+
+/**
+ * @brief Accounts for a task that has just been unlinked from the list.
+ *
+ * @param task Pointer to the unlinked Task.
+ */
+void deps_onRemove(const Task *task);
+
+/**
+ * @brief Accounts for a status change on a task in the list.
+ *
+ * @param task Pointer to the Task holding the new status.
+ */
+void deps_onUpdate(const Task *task);
+
+/**
+ * @brief Accounts for every task leaving the list at once (the edges are kept).
+ */
+void deps_onClear();
+
+/**
+ * @brief Drops every edge and frees the graph.
+ */
+void deps_reset();
+
+/**
+ * @brief Returns the number of tasks in the graph, in the list or not.
+ *
+ * An upper bound for the arrays filled by the queries below.
+ *
+ * @return Number of tracked tasks.
+ */
+int deps_taskCount();
+
+/**
+ * @brief Returns the number of edges in the graph.
+ *
+ * @return Number of edges.
+ */
+long deps_edgeCount();
+
+/**
+ * @brief Lists the tasks that are ready to start.
+ *
+ * The ready tasks of the graph come first, then the unfinished tasks with no
+ * dependencies.
+ *
+ * @param ids Array receiving up to max task IDs.
+ * @param max Capacity of ids.
+ * @return Number of ready tasks (may exceed max).
+ */
+int deps_ready(int *ids, int max);
+
+/**
+ * @brief Lists every task in the list in dependency order (blockers first).
+ *
+ * The tasks with no dependencies come first, then the graph's in topological order.
+ *
+ * @param ids Array receiving up to max task IDs.
+ * @param max Capacity of ids.
+ * @return Number of tasks written.
+ */
+int deps_order(int *ids, int max);
+
+/**
+ * @brief Lists the tasks a task is waiting for.
+ *
+ * @param id The task ID.
+ * @param ids Array receiving up to max task IDs of unfinished blockers in the list.
+ * @param max Capacity of ids.
+ * @return Number of tasks written.
+ */
+int deps_blockers(int id, int *ids, int max);
+
+/**
+ * @brief Finds the longest chain of unfinished tasks in the list.
+ *
+ * Every task counts as one unit of work, so the chain is the minimum number of
+ * tasks that still have to be done one after another. Runs in O(tasks + edges)
+ * over the maintained order, with no sort.
+ *
+ * @param ids Array receiving the chain, first task first (up to max IDs).
+ * @param max Capacity of ids.
+ * @return Length of the chain (may exceed max), or -1 on allocation failure.
+ */
+int deps_criticalPath(int *ids, int max);
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef DESC_H
+#define DESC_H
+
+#include <stddef.h>
+
+/**
+ * Task descriptions, kept apart from the Task records (hot/cold split).
+ *
+ * A Task holds the fields every listing, index and filter reads (ID, title,
+ * priority, status, dates) and a DescRef handle to its description, which is only
+ * needed when a task is shown in full or saved. Descriptions are stored at their
+ * own length, and empty ones take no space at all.
+ *
+ * With a memory budget set (see desc_setBudget()), the descriptions in memory form
+ * an LRU cache: once they exceed the budget, the least recently used ones are
+ * written to a temporary cold file and freed, and desc_get() reads them back on
+ * demand. Descriptions never change after creation, so each is written to the
+ * cold file at most once; the file is compacted when most of it is dead.
+ *
+ * The functions are safe to call from several threads.
+ */
+
+/**
+ * @brief Handle of a description (DESC_NONE for an empty one).
+ */
+typedef unsigned int DescRef;
+
+#define DESC_NONE 0
+
+/**
+ * @brief Longest description, in characters.
+ */
+#define DESC_MAX 199
+
+/**
+ * @brief Counters of the description store.
+ */
+typedef struct DescUsage {
+    long resident;            // Descriptions in memory
+    long cold;                // Descriptions only in the cold file
+    size_t resident_bytes;    // Memory held by the descriptions in memory (text only)
+    size_t cold_bytes;        // Size of the cold file
+    long loads;               // Descriptions read back from the cold file
+    long evictions;           // Descriptions dropped from memory to meet the budget
+} DescUsage;
+
+/**
+ * @brief Stores a description.
+ *
+ * @param text The text (truncated to DESC_MAX characters).
+ * @param ref Set to the handle, or DESC_NONE for an empty text.
+ * @return 1 on success, 0 on allocation failure (ref set to DESC_NONE).
+ */
+int desc_create(const char *text, DescRef *ref);
+
+/**
+ * @brief Stores a copy of a description under a new handle.
+ *
+ * @param ref Handle of the description to copy.
+ * @param copy Set to the new handle.
+ * @return 1 on success, 0 on allocation failure (copy set to DESC_NONE).
+ */
+int desc_copy(DescRef ref, DescRef *copy);
+
+/**
+ * @brief Copies a description into a buffer, reading it back from the cold file if needed.
+ *
+ * @param ref Handle of the description (DESC_NONE, or a handle already freed, gives "").
+ * @param buffer Buffer receiving the text (at least 1 byte; DESC_MAX + 1 holds any description).
+ * @param size Size of buffer.
+ * @return Length of the text copied.
+ */
+size_t desc_get(DescRef ref, char *buffer, size_t size);
+
+/**
+ * @brief Frees a description.
+ *
+ * @param ref Handle of the description (DESC_NONE is ignored).
+ */
+void desc_free(DescRef ref);
+
+/**
+ * @brief Sets the memory budget for descriptions, evicting at once if it is exceeded.
+ *
+ * @param bytes Budget in bytes, or 0 to keep every description in memory (the default).
+ */
+void desc_setBudget(size_t bytes);
+
+/**
+ * @brief Returns the memory budget for descriptions.
+ *
+ * @return Budget in bytes (0 if unlimited).
+ */
+size_t desc_getBudget();
+
+/**
+ * @brief Reads the counters of the store.
+ *
+ * @param usage Filled with the counters.
+ */
+void desc_usage(DescUsage *usage);
+
+/**
+ * @brief Frees every description and closes the cold file. Handles given out before become invalid.
+ */
+void desc_reset();
+
+#endif
@@ -1,29 +1,98 @@
 #ifndef FILE_H
 #define FILE_H
 
+#include <stdio.h>
 #include "list.h"
 
 /**
- * @brief Saves all tasks in the list to a binary file.
+ * @brief Default path of the task file.
+ */
+#define TASKS_FILENAME "tasks.dat"
+
+/**
+ * @brief Called for each task read by file_scanTasks().
+ *
+ * @param task Pointer to the task (valid only during the call).
+ * @param context Opaque pointer given to file_scanTasks().
+ * @return Nonzero to continue, 0 to stop the scan.
+ */
+typedef int (*FileTaskFn)(const Task *task, void *context);
+
+/**
+ * @brief Writes all tasks in the list to a binary file, without messages.
  *
- * Writes each task to "tasks.dat" in binary format.
+ * The file holds a format tag and the task count, followed by the task records,
+ * head first, the tags of the tasks and the dependencies between them. Large lists
+ * show a progress bar (see progress_setEnabled()).
  *
  * @param head Pointer to the head of the list.
+ * @param path Path of the file, or NULL for "tasks.dat".
+ * @return Number of tasks written, or -1 if the file could not be written.
  */
-void file_saveTasks(List *head);
+int file_writeTasks(List *head, const char *path);
 
 /**
- * @brief Loads tasks from a binary file into the list.
+ * @brief Writes all tasks in the list to an open stream in the task file format.
  *
- * Reads tasks from "tasks.dat" and reconstructs the list, updating BSTs and counter.
+ * Used to send the list to another process (see journal.h) without a file.
  *
  * @param head Pointer to the head of the list.
- * @param stack Pointer to the undo stack.
+ * @param file Stream to write to (flushed, not closed).
+ * @return Number of tasks written, or -1 if a write failed.
+ */
+int file_writeStream(List *head, FILE *file);
+
+/**
+ * @brief Replaces the list with the tasks of a binary file, without messages.
+ *
+ * The current tasks are freed without going to the trash, and the undo history is
+ * cleared, since a load cannot be undone. The loaded tasks keep their order from
+ * the file and are indexed in one batch. Records with an ID already
+ * loaded are skipped. Large files show a progress bar (see progress_setEnabled()).
+ * Files from before tasks had timestamps, tags or dependencies are still read. The
+ * tags and dependencies in the file replace those of the tasks loaded.
+ *
+ * @param path Path of the file, or NULL for "tasks.dat".
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack, cleared (may be NULL).
  * @param id_tree Pointer to the BST sorted by ID.
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
- * @return New head of the list.
+ * @param skipped Set to the number of unreadable or duplicate records (may be NULL).
+ * @return Number of tasks loaded, or -1 if the file could not be opened or has no header.
+ */
+int file_readTasks(const char *path, List **head, Stack *stack,
+                   Tree *id_tree, Tree *priority_tree, Tree *status_tree, int *skipped);
+
+/**
+ * @brief Replaces the list with the tasks read from an open stream in the task file format.
+ *
+ * Same as file_readTasks(), for a stream written by file_writeStream().
+ *
+ * @param file Stream to read from, positioned at the header (left open).
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack, cleared (may be NULL).
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @param skipped Set to the number of unreadable or duplicate records (may be NULL).
+ * @return Number of tasks loaded, or -1 if the stream has no header (the list is then untouched).
+ */
+int file_readStream(FILE *file, List **head, Stack *stack,
+                    Tree *id_tree, Tree *priority_tree, Tree *status_tree, int *skipped);
+
+/**
+ * @brief Reads the tasks of a binary file one at a time, without loading them.
+ *
+ * Only one record is in memory at a time, whatever the size of the file; the
+ * list is not touched.
+ *
+ * @param path Path of the file, or NULL for "tasks.dat".
+ * @param visit Called for each task (NULL to only read the task count).
+ * @param context Opaque pointer passed to visit.
+ * @return Number of tasks read (the count in the header if visit is NULL), or -1
+ *         if the file could not be opened or has no header.
  */
-List* file_loadTasks(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+int file_scanTasks(const char *path, FileTaskFn visit, void *context);
 
 #endif
@@ -0,0 +1,84 @@
+#ifndef IDMAP_H
+#define IDMAP_H
+
+#include <stddef.h>
+
+/**
+ * @brief Open-addressing hash map from task IDs to 64-bit values.
+ *
+ * Uses linear probing with backward-shift deletion, so lookups never walk
+ * tombstones. Values are file offsets or pointers cast through intptr_t.
+ */
+typedef struct IdMap {
+    int *keys;                // Key per slot
+    long long *values;        // Value per slot
+    unsigned char *used;      // 1 if the slot holds an entry
+    size_t capacity;          // Number of slots (power of two, 0 if unallocated)
+    size_t count;             // Number of entries
+} IdMap;
+
+/**
+ * @brief Initializes an empty map.
+ *
+ * No memory is allocated until the first insertion.
+ *
+ * @param map Pointer to the map.
+ */
+void idmap_init(IdMap *map);
+
+/**
+ * @brief Inserts or overwrites the value stored for a key.
+ *
+ * @param map Pointer to the map.
+ * @param key The task ID.
+ * @param value The value to store.
+ * @return 1 on success, 0 if the table could not grow.
+ */
+int idmap_put(IdMap *map, int key, long long value);
+
+/**
+ * @brief Overwrites the value stored for a key already in the map.
+ *
+ * Never allocates, so it cannot fail once the key is in.
+ *
+ * @param map Pointer to the map.
+ * @param key The task ID.
+ * @param value The value to store.
+ * @return 1 if the key is present, 0 otherwise (nothing is stored).
+ */
+int idmap_set(IdMap *map, int key, long long value);
+
+/**
+ * @brief Looks up the value stored for a key.
+ *
+ * @param map Pointer to the map.
+ * @param key The task ID.
+ * @param value Set to the stored value if found (may be NULL).
+ * @return 1 if the key is present, 0 otherwise.
+ */
+int idmap_get(const IdMap *map, int key, long long *value);
+
+/**
+ * @brief Removes a key from the map.
+ *
+ * @param map Pointer to the map.
+ * @param key The task ID.
+ * @return 1 if the key was present, 0 otherwise.
+ */
+int idmap_remove(IdMap *map, int key);
+
+/**
+ * @brief Removes all entries, keeping the allocated table.
+ *
+ * @param map Pointer to the map.
+ */
+void idmap_clear(IdMap *map);
+
+/**
+ * @brief Frees the table and resets the map to empty.
+ *
+ * @param map Pointer to the map.
+ */
+void idmap_free(IdMap *map);
+
+#endif
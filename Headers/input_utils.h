@@ -43,4 +43,12 @@ void readString(const char *prompt, char *buffer, size_t size);
  */
 void cleanNewline(char *str);
 
+/**
+ * @brief Waits until the user presses Enter.
+ *
+ * Replaces system("pause") and fixed delays: the user reads the result at their
+ * own pace and the program does no work meanwhile. Returns at end of input.
+ */
+void waitForEnter();
+
 #endif
@@ -0,0 +1,158 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stddef.h>
+#include "batch.h"
+#include "list.h"
+
+/**
+ * Journal of the changes made to the list, shipped by a primary daemon to
+ * read-only replicas (log shipping).
+ *
+ * The primary notes every command line it runs (journal_note()). The lines that
+ * change the list the same way wherever they are replayed (BATCH_WRITES) are kept
+ * with the time they ran at and their outcome; the ones that change it from state
+ * a replica does not have (undo history, task files, projects) mark the list as
+ * replaced instead. Work done inside a transaction is held back until it commits
+ * and dropped if it rolls back, so replicas only ever see committed changes. What
+ * is ready leaves as one record (journal_take()):
+ *
+ *   G SEQ TIME LENGTH\n + LENGTH bytes: lines "CLOCK +|- command\n" to replay in order
+ *   S SEQ TIME LENGTH\n + LENGTH bytes: the whole list in the task file format
+ *   H SEQ TIME 0\n                     : heartbeat, sent while idle
+ *
+ * SEQ numbers the G and S records, and TIME is the primary's clock in milliseconds
+ * since the epoch when the record was made; a replica uses it to measure its lag.
+ * CLOCK is the time the command ran at (see BatchContext.clock), and the sign its
+ * outcome on the primary, so that a replica can tell when it has diverged.
+ */
+
+/**
+ * @brief Longest record header, including the newline.
+ */
+#define JOURNAL_HEADER_MAX 64
+
+/**
+ * @brief Enum for the kinds of record.
+ */
+typedef enum {
+    JOURNAL_GROUP = 'G',      // Command lines to replay
+    JOURNAL_SNAPSHOT = 'S',   // The whole list
+    JOURNAL_HEARTBEAT = 'H'   // Nothing changed
+} JournalKind;
+
+/**
+ * @brief Header of a record.
+ */
+typedef struct JournalRecord {
+    JournalKind kind;
+    unsigned long seq;        // Number of the record (heartbeats: of the last one made)
+    long long time;           // Primary's clock when the record was made, in milliseconds
+    size_t length;            // Length of the body
+} JournalRecord;
+
+/**
+ * @brief Returns the current time in milliseconds since the epoch.
+ *
+ * @return The time.
+ */
+long long journal_now();
+
+/**
+ * @brief Formats a record header.
+ *
+ * @param record Pointer to the header.
+ * @param buffer Buffer of at least JOURNAL_HEADER_MAX bytes.
+ * @return Length of the header, newline included.
+ */
+int journal_formatHeader(const JournalRecord *record, char *buffer);
+
+/**
+ * @brief Parses a record header.
+ *
+ * @param line The header line, without its newline.
+ * @param record Filled with the header.
+ * @return 1 on success, 0 if the line is not a header.
+ */
+int journal_parseHeader(const char *line, JournalRecord *record);
+
+/**
+ * @brief Notes a command line run on the primary.
+ *
+ * Called after each line, with the line as it was before being run.
+ *
+ * @param line The command line.
+ * @param clock Time the command ran at (BatchContext.clock).
+ * @param result Outcome of the line.
+ */
+void journal_note(const char *line, unsigned int clock, BatchResult result);
+
+/**
+ * @brief Drops the work of the transaction that was just rolled back.
+ *
+ * journal_note() calls it for the rollback command; call it for rollbacks made
+ * outside a command line.
+ *
+ * @param complete 1 if every change was reverted, 0 if the rollback was refused
+ *                 (the list is then shipped whole).
+ */
+void journal_rollback(int complete);
+
+/**
+ * @brief Makes the next record from the committed work not shipped yet.
+ *
+ * @param head Pointer to the head of the list.
+ * @param record Filled with the header.
+ * @param body Set to the body, valid until the next call to journal_take() or journal_snapshot().
+ * @return 1 if a record was made, 0 if there is nothing to ship (or a snapshot
+ *         has to wait for the open transaction to end), -1 on allocation failure.
+ */
+int journal_take(List *head, JournalRecord *record, const char **body);
+
+/**
+ * @brief Makes a snapshot of the list for a replica that is starting.
+ *
+ * Must be called with no transaction open and after journal_take() has shipped
+ * everything; the snapshot carries the number of the last record made.
+ *
+ * @param head Pointer to the head of the list.
+ * @param record Filled with the header.
+ * @param body Set to the body, valid until the next call to journal_take() or journal_snapshot().
+ * @return 1 on success, -1 on allocation failure.
+ */
+int journal_snapshot(List *head, JournalRecord *record, const char **body);
+
+/**
+ * @brief Makes a heartbeat record.
+ *
+ * @param record Filled with the header.
+ */
+void journal_heartbeat(JournalRecord *record);
+
+/**
+ * @brief Returns the number of the last record made.
+ *
+ * @return The number (0 before the first).
+ */
+unsigned long journal_seq();
+
+/**
+ * @brief Applies a record received from the primary to the list.
+ *
+ * The lines of a group are run with ctx, each at the clock it ran at on the
+ * primary; a snapshot replaces the list, without keeping the old tasks for undo.
+ *
+ * @param record Pointer to the header.
+ * @param body The body (record->length bytes).
+ * @param ctx Pointer to the batch context of the list (must not be read-only).
+ * @return Number of lines whose outcome differed from the primary's, or -1 if a
+ *         snapshot or a line could not be read.
+ */
+long journal_apply(const JournalRecord *record, const char *body, BatchContext *ctx);
+
+/**
+ * @brief Frees the buffers and forgets the work not shipped.
+ */
+void journal_reset();
+
+#endif
@@ -10,147 +10,404 @@
 typedef struct List {
     Task *task;           // Pointer to a dynamically allocated Task
     struct List *next;    // Pointer to the next node
+    struct List *prev;    // Pointer to the previous node
 } List;
 
 /**
- * @brief Adds a new task to the head of the linked list.
+ * @brief Largest bulk change applied to the BSTs task by task; larger ones rebuild them once.
+ */
+#define LIST_BULK_PATCH_MAX 4096
+
+/**
+ * @brief Predicate selecting tasks for a bulk operation.
  *
- * Allocates memory for a new List node and Task, fills the task with user input,
- * and inserts it at the head of the list. Updates the task counter and BSTs.
+ * Called concurrently from several threads: it must not modify the task or any
+ * shared state.
  *
- * @param head Pointer to the current head of the list.
- * @param stack Pointer to the undo stack.
+ * @param task Pointer to the Task.
+ * @param context Opaque pointer passed to the bulk operation.
+ * @return Nonzero if the task matches.
+ */
+typedef int (*TaskPredicate)(const Task *task, void *context);
+
+/**
+ * @brief Result codes of the non-interactive list operations.
+ */
+typedef enum {
+    LIST_OK = 0,          // Operation applied
+    LIST_NOT_FOUND,       // No task with the given ID
+    LIST_DUPLICATE_ID,    // A task with the same ID already exists
+    LIST_NO_MEMORY,       // Allocation failed; the list is unchanged
+    LIST_EMPTY,           // The list (or the undo/redo history) is empty
+    LIST_BAD_STATE        // Not allowed in the current transaction state
+} ListStatus;
+
+/**
+ * @brief Returns a short description of a status code.
+ *
+ * @param status The status code.
+ * @return Static string describing the status.
+ */
+const char* list_statusName(ListStatus status);
+
+/**
+ * @brief Finds a task by its ID in O(1).
+ *
+ * @param head Pointer to the head of the list.
+ * @param id The ID to look for.
+ * @return Pointer to the Task (still owned by the list), or NULL if not found.
+ */
+Task* list_findTask(List *head, int id);
+
+/**
+ * @brief Returns the task after a given one in list order, in O(1).
+ *
+ * @param head Pointer to the head of the list.
+ * @param task Pointer to a Task in the list.
+ * @return The next Task, or NULL at the tail or if the task is not in the list.
+ */
+Task* list_nextTask(List *head, Task *task);
+
+/**
+ * @brief Returns the task before a given one in list order, in O(1).
+ *
+ * @param head Pointer to the head of the list.
+ * @param task Pointer to a Task in the list.
+ * @return The previous Task, or NULL at the head or if the task is not in the list.
+ */
+Task* list_prevTask(List *head, Task *task);
+
+/**
+ * @brief Returns the last task of the list, in O(1).
+ *
+ * @param head Pointer to the head of the list.
+ * @return The Task at the tail, or NULL if the list is empty.
+ */
+Task* list_lastTask(List *head);
+
+/**
+ * @brief Inserts a task at a given position, without prompts or output.
+ *
+ * The list takes ownership of the task only when LIST_OK is returned.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param task Pointer to the Task to insert.
+ * @param position Where to insert the task.
+ * @param target_id ID of the task to insert after (for POS_MIDDLE).
+ * @param stack Pointer to the undo stack (NULL to keep no history).
  * @param id_tree Pointer to the BST sorted by ID.
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
- * @return New head of the list.
+ * @return LIST_OK, LIST_DUPLICATE_ID, LIST_NOT_FOUND (no such target) or LIST_NO_MEMORY.
  */
-List* list_addToHead(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+ListStatus list_insertTask(List **head, Task *task, TaskPosition position, int target_id, Stack *stack,
+                           Tree *id_tree, Tree *priority_tree, Tree *status_tree);
 
 /**
- * @brief Adds a new task to the end of the linked list.
+ * @brief Removes the task with a given ID, without prompts or output.
  *
- * Allocates memory for a new List node and Task, fills the task with user input,
- * and appends it to the end of the list. Updates the task counter and BSTs.
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param id The ID of the task to remove.
+ * @param stack Pointer to the undo stack (NULL frees the task).
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK or LIST_NOT_FOUND.
+ */
+ListStatus list_removeTask(List **head, int id, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Removes the first or the last task, without prompts or output.
  *
- * @param head Pointer to the head of the list.
- * @param stack Pointer to the undo stack.
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param position POS_HEAD or POS_END.
+ * @param stack Pointer to the undo stack (NULL frees the task).
  * @param id_tree Pointer to the BST sorted by ID.
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK or LIST_EMPTY.
  */
-void list_addToEnd(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+ListStatus list_removeEdge(List **head, TaskPosition position, Stack *stack,
+                           Tree *id_tree, Tree *priority_tree, Tree *status_tree);
 
 /**
- * @brief Adds a new task after a node with a given ID.
+ * @brief Sets the priority and status of a task, without prompts or output.
  *
- * Prompts for the ID of the task to insert after, allocates memory for a new List
- * node and Task, and inserts it. Updates the task counter and BSTs.
+ * The change is recorded for undo only if something actually changed.
  *
  * @param head Pointer to the head of the list.
- * @param stack Pointer to the undo stack.
- * @param id_tree Pointer to the BST sorted by ID.
+ * @param id The ID of the task to update.
+ * @param priority The new priority.
+ * @param status The new status.
+ * @param stack Pointer to the undo stack (NULL to keep no history).
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK or LIST_NOT_FOUND.
  */
-void list_addToMiddle(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+ListStatus list_setTaskFields(List *head, int id, Priority priority, Status status, Stack *stack,
+                              Tree *priority_tree, Tree *status_tree);
 
 /**
- * @brief Prints all tasks in the linked list.
+ * @brief Sets the due date of a task, without prompts or output.
  *
- * Traverses the list from head to tail and prints each task using printTask().
+ * The change is recorded for undo only if the date actually changed. Overdue
+ * tracking follows the new date at once (see deadline.h).
  *
  * @param head Pointer to the head of the list.
+ * @param id The ID of the task to update.
+ * @param due The new due date (seconds since the Unix epoch), or 0 for none.
+ * @param stack Pointer to the undo stack (NULL to keep no history).
+ * @return LIST_OK or LIST_NOT_FOUND.
  */
-void list_printAll(List *head);
+ListStatus list_setTaskDue(List *head, int id, unsigned int due, Stack *stack);
 
 /**
- * @brief Removes the first task (head) from the list.
+ * @brief Sets the priority, status and due date of a task as one undo step, without prompts or output.
  *
- * Pushes the task to the undo stack and frees the List node. Updates the task counter.
+ * The due date record is chained to the field record when both change, so no
+ * transaction is needed to undo them together.
  *
  * @param head Pointer to the head of the list.
- * @param stack Pointer to the undo stack.
+ * @param id The ID of the task to update.
+ * @param priority The new priority.
+ * @param status The new status.
+ * @param due The new due date (seconds since the Unix epoch), or 0 for none.
+ * @param stack Pointer to the undo stack (NULL to keep no history).
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK or LIST_NOT_FOUND.
+ */
+ListStatus list_setTaskFieldsDue(List *head, int id, Priority priority, Status status, unsigned int due,
+                                 Stack *stack, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Removes every task as one undo group, without output.
+ *
+ * @param head Pointer to the head pointer of the list (set to NULL).
+ * @param stack Pointer to the undo stack (NULL frees the tasks).
  * @param id_tree Pointer to the BST sorted by ID.
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
- * @return New head of the list (could be NULL).
  */
-List* list_removeFromHead(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+void list_clear(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
 
 /**
- * @brief Removes the last task from the list.
+ * @brief Sets the priority and/or status of every task matching a predicate.
  *
- * Pushes the task to the undo stack and frees the List node. Updates the task counter.
+ * The predicate runs on parallel threads over chunks of the list, so it must be
+ * safe to call concurrently and must not modify tasks. The matching tasks are then
+ * changed in one pass, recorded as a single undo group, and the BSTs are fixed once.
  *
  * @param head Pointer to the head of the list.
+ * @param match The predicate.
+ * @param context Opaque pointer passed to the predicate.
+ * @param priority The new priority, or 0 to keep each task's own.
+ * @param status The new status, or 0 to keep each task's own.
+ * @param stack Pointer to the undo stack (NULL to keep no history).
+ * @param changed Set to the number of tasks actually changed (may be NULL).
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK, or LIST_NO_MEMORY (nothing changed).
+ */
+ListStatus list_updateWhere(List *head, TaskPredicate match, void *context, Priority priority, Status status,
+                            Stack *stack, long *changed, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Removes every task matching a predicate.
+ *
+ * Evaluated like list_updateWhere(). The removals are recorded as a single undo
+ * group; undoing it puts every task back at its place in the list.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param match The predicate.
+ * @param context Opaque pointer passed to the predicate.
+ * @param stack Pointer to the undo stack (NULL frees the tasks).
+ * @param removed Set to the number of tasks removed (may be NULL).
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK, or LIST_NO_MEMORY (nothing removed).
+ */
+ListStatus list_removeWhere(List **head, TaskPredicate match, void *context, Stack *stack, long *removed,
+                            Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Undoes the most recent operation or group, without prompts or output.
+ *
+ * A group (transaction or clear-all) is undone as a unit; a large one rebuilds the
+ * BSTs once at its end instead of patching them per task.
+ * If a removed task cannot come back because its ID is taken, its record stays on
+ * the undo side (stack_peek()) and the records after it in the group stay reverted;
+ * the caller may give the task a new ID and call again to finish the group.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
  * @param stack Pointer to the undo stack.
  * @param id_tree Pointer to the BST sorted by ID.
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK, LIST_EMPTY (nothing to undo), LIST_BAD_STATE (transaction open),
+ *         LIST_DUPLICATE_ID (a restored task's ID is taken) or LIST_NO_MEMORY.
  */
-void list_removeFromEnd(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+ListStatus list_undoStep(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
 
 /**
- * @brief Removes a task by its ID.
+ * @brief Re-applies the most recently undone operation or group, without prompts or output.
  *
- * Prompts for the ID, pushes the task to the undo stack, and frees the List node.
- * Updates the task counter.
+ * Conflicts are handled as in list_undoStep(), with the record kept on the redo
+ * side (stack_peekRedo()).
  *
- * @param head Pointer to the head of the list.
+ * @param head Pointer to the head pointer of the list (updated in place).
  * @param stack Pointer to the undo stack.
  * @param id_tree Pointer to the BST sorted by ID.
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
- * @return New head of the list (in case the head was removed).
+ * @return LIST_OK, LIST_EMPTY (nothing to redo), LIST_BAD_STATE, LIST_DUPLICATE_ID or LIST_NO_MEMORY.
  */
-List* list_removeByID(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+ListStatus list_redoStep(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
 
 /**
- * @brief Frees all tasks and nodes in the list.
+ * @brief Opens a transaction, without output.
  *
- * Pushes all tasks to the undo stack and frees all List nodes. Resets the task counter.
+ * @return LIST_OK, or LIST_BAD_STATE if a transaction is already open.
+ */
+ListStatus list_txnBegin();
+
+/**
+ * @brief Commits the open transaction, without output.
  *
  * @param head Pointer to the head of the list.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK, or LIST_BAD_STATE if no transaction is open.
+ */
+ListStatus list_txnCommit(List *head, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Rolls back the open transaction, without output.
+ *
+ * Either every operation of the transaction is reverted, or none is: when the undo
+ * history could not keep all of them (undo disabled, out of memory, or the history
+ * was cleared meanwhile) the rollback is refused and the transaction is closed with
+ * its changes kept.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
  * @param stack Pointer to the undo stack.
+ * @param reverted Set to the number of operations reverted (may be NULL).
  * @param id_tree Pointer to the BST sorted by ID.
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK, LIST_BAD_STATE if no transaction is open, or LIST_NO_MEMORY if the
+ *         rollback was refused (nothing reverted).
  */
-void list_freeAll(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+ListStatus list_txnRollback(List **head, Stack *stack, int *reverted,
+                            Tree *id_tree, Tree *priority_tree, Tree *status_tree);
 
 /**
- * @brief Restores a task from the undo stack to its original position.
+ * @brief Frees all tasks and nodes in the list without touching the undo stack.
  *
- * Pops a task from the stack, checks for ID conflicts, and inserts it back into the list
- * at its original position (head, middle, or end). Updates the task counter and BSTs.
+ * Used on exit, where pushing every task to the stack would only spill them to the trash.
+ *
+ * @param head Pointer to the head of the list.
+ */
+void list_destroy(List *head);
+
+/**
+ * @brief Rebuilds the three BSTs from the list in one batch.
+ *
+ * Collects the tasks once and builds each tree balanced in O(n log n).
+ *
+ * @param head Pointer to the head of the list.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void list_rebuildIndexes(List *head, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Brings the BSTs up to date if maintenance was deferred.
+ *
+ * Cheap when nothing changed; called before any sorted view is displayed.
  *
  * @param head Pointer to the head of the list.
- * @param stack Pointer to the undo stack.
  * @param id_tree Pointer to the BST sorted by ID.
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
- * @return New head of the list (if restored to head).
  */
-List* list_restoreTask(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+void list_syncIndexes(List *head, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
 
 /**
- * @brief Updates the priority and status of a task by its ID.
+ * @brief Starts deferring BST maintenance until the matching list_resumeIndexes().
  *
- * Prompts for the task ID, updates its priority and status, and rebuilds the BSTs
- * to reflect the changes.
+ * Calls nest; mutations in between only mark the BSTs stale.
+ */
+void list_deferIndexes();
+
+/**
+ * @brief Ends one level of deferral, rebuilding the BSTs once at the outermost level.
  *
  * @param head Pointer to the head of the list.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void list_resumeIndexes(List *head, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Checks whether a transaction is open.
+ *
+ * @return 1 if a transaction is open, 0 otherwise.
+ */
+int list_inTransaction();
+
+/**
+ * @brief Returns the number of operations recorded by the open transaction.
+ *
+ * @return Number of operations, or 0 if no transaction is open.
+ */
+int list_transactionSize();
+
+/**
+ * @brief Checks whether the BSTs lag behind the list (deferred maintenance).
+ *
+ * @return 1 if list_syncIndexes() would rebuild them, 0 otherwise.
+ */
+int list_indexesStale();
+
+/**
+ * @brief Moves a task from the trash file back to the head of the list, without prompts or output.
+ *
+ * The most recently deleted copy is restored, and the insertion is recorded for undo.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param id The ID of the task in the trash.
+ * @param new_id ID to give the restored task, or 0 to keep its own.
  * @param stack Pointer to the undo stack.
  * @param id_tree Pointer to the BST sorted by ID.
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK, LIST_NOT_FOUND (not in the trash), LIST_DUPLICATE_ID (the ID is taken;
+ *         the task stays in the trash) or LIST_NO_MEMORY.
+ */
+ListStatus list_restoreTask(List **head, int id, int new_id, Stack *stack,
+                            Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Forgets a task the undo history discards for good, then hands it to the trash.
+ *
+ * Install it with stack_setEvictHandler() on the active undo stack. Edges and tags
+ * kept for the task's undo go with it, unless a live task has taken its ID since.
+ *
+ * @param task Pointer to the discarded Task (not freed).
  */
-void list_updateTask(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+void list_evictTask(const Task *task);
 
 /**
  * @brief Checks if a task ID exists in the list.
  *
+ * Answers in O(1) from the ID index.
+ *
  * @param head Pointer to the head of the list.
  * @param id The ID to check for.
  * @return 1 if the ID exists, 0 otherwise.
@@ -179,17 +436,4 @@ int listCounter_get();
  */
 void listCounter_reset();
 
-/**
- * @brief Displays a simple terminal-based loading animation.
- *
- * Prints a progress-style loading bar using dots (.) with a short delay
- * between each dot to simulate loading.
- *
- * Example Output:
- *  [..........] Done!
- *
- * @param total The number of dots to print (represents progress steps).
- */
-void loadingBar(int total);
-
 #endif
@@ -0,0 +1,122 @@
+#ifndef MEM_H
+#define MEM_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+/**
+ * Memory accounting: the allocations of the data structures, tagged by subsystem.
+ *
+ * The list, trees, undo stacks, task records, descriptions and indexes allocate
+ * and free through mem_alloc() and mem_free() instead of malloc() and free(),
+ * which keeps per subsystem the bytes and blocks live, the highest amount live
+ * and an estimate of the allocator's own overhead. Callers pass the size of a
+ * block when freeing it, as they always know it, so blocks carry no header and
+ * the accounting costs no memory.
+ *
+ * The overhead is estimated for the common 64-bit allocators (glibc, jemalloc in
+ * its small classes): each block takes its size plus an 8-byte header, rounded
+ * up to 16 bytes, and at least 32 bytes. The counters may be updated from several
+ * threads.
+ */
+
+/**
+ * @brief Subsystems memory is accounted to.
+ */
+typedef enum {
+    MEM_LIST,                 // List nodes, task stores and their locks, the project registry
+    MEM_TREE,                 // BST nodes and headers
+    MEM_STACK,                // Undo stacks: ring buffers and headers
+    MEM_TASK,                 // Task records
+    MEM_DESC,                 // Description texts and table
+    MEM_INDEX,                // ID hash indexes (idmap.h) and the due-date wheel
+    MEM_TAGS,                 // Tag tables and bitmaps
+    MEM_DEPS,                 // Dependency graph
+    MEM_SCRATCH,              // Temporary buffers of sorts, bulk operations and queries
+    MEM_NET,                  // Daemon connections, replication buffers and the journal
+    MEM_COUNT
+} MemTag;
+
+/**
+ * @brief Memory figures of a subsystem, or of all of them.
+ */
+typedef struct MemUsage {
+    long long live;           // Bytes allocated and not freed
+    long long peak;           // Highest value of live
+    long long blocks;         // Blocks allocated and not freed
+    long long allocations;    // Blocks allocated since the start
+    long long overhead;       // Estimated allocator overhead of the live blocks, in bytes
+} MemUsage;
+
+/**
+ * @brief Allocates a block, like malloc().
+ *
+ * @param tag Subsystem to account the block to.
+ * @param size Size in bytes.
+ * @return Pointer to the block, or NULL if memory ran out.
+ */
+void* mem_alloc(MemTag tag, size_t size);
+
+/**
+ * @brief Allocates a zeroed array, like calloc().
+ *
+ * @param tag Subsystem to account the block to.
+ * @param count Number of elements.
+ * @param size Size of an element in bytes.
+ * @return Pointer to the block, or NULL if memory ran out.
+ */
+void* mem_calloc(MemTag tag, size_t count, size_t size);
+
+/**
+ * @brief Resizes a block, like realloc().
+ *
+ * @param tag Subsystem the block is accounted to.
+ * @param ptr Pointer to the block, or NULL to allocate one.
+ * @param old_size Current size of the block in bytes (0 if ptr is NULL).
+ * @param size New size in bytes.
+ * @return Pointer to the resized block, or NULL if memory ran out (the block is then unchanged).
+ */
+void* mem_realloc(MemTag tag, void *ptr, size_t old_size, size_t size);
+
+/**
+ * @brief Frees a block, like free().
+ *
+ * @param tag Subsystem the block is accounted to.
+ * @param ptr Pointer to the block (NULL is ignored).
+ * @param size Size of the block in bytes, as allocated.
+ */
+void mem_free(MemTag tag, void *ptr, size_t size);
+
+/**
+ * @brief Reads the figures of a subsystem.
+ *
+ * @param tag The subsystem, or MEM_COUNT for all of them together (whose peak is
+ *            the highest total live, not the sum of the peaks).
+ * @param usage Filled with the figures.
+ */
+void mem_get(MemTag tag, MemUsage *usage);
+
+/**
+ * @brief Returns the name of a subsystem, such as "list".
+ *
+ * @param tag The subsystem (MEM_COUNT gives "total").
+ * @return Static string.
+ */
+const char* mem_name(MemTag tag);
+
+/**
+ * @brief Prints the memory report: live, peak, blocks, overhead and bytes per task
+ *        for each subsystem and in total, then the fragmentation estimates.
+ *
+ * The internal fragmentation is the share of the live footprint (live bytes plus
+ * overhead) lost to headers and rounding; the external one is the share of the
+ * peak footprint freed since, which the allocator usually keeps rather than
+ * returns to the system.
+ *
+ * @param out Stream to print to.
+ * @param tsv 1 for tab-separated lines, 0 for an aligned table.
+ * @param tasks Number of tasks the bytes per task are computed for (0 to leave them out).
+ */
+void mem_print(FILE *out, int tsv, long tasks);
+
+#endif
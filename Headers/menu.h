@@ -0,0 +1,218 @@
+#ifndef MENU_H
+#define MENU_H
+
+#include "list.h"
+#include "stack.h"
+#include "tree.h"
+
+/**
+ * Interactive commands behind the menus of main.c.
+ *
+ * Each command prompts for what it needs, calls the non-interactive list, file
+ * and trash functions, and reports the outcome on stdout. Nothing else in the
+ * program reads from stdin, so the rest can be used as a library (see taskmgr.h).
+ */
+
+/**
+ * @brief Prompts for a new task and adds it.
+ *
+ * A task ID that is already taken is asked for again.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param position POS_HEAD, POS_END, or POS_MIDDLE to also prompt for the task to insert after.
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_addTask(List **head, TaskPosition position, Stack *stack,
+                  Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Removes a task, recording it for undo.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param position POS_HEAD, POS_END, or POS_MIDDLE to prompt for the ID of the task.
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_removeTask(List **head, TaskPosition position, Stack *stack,
+                     Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Removes every task as one undo group.
+ *
+ * @param head Pointer to the head pointer of the list (set to NULL).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_clearAll(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Drops the undo and redo history.
+ *
+ * @param stack Pointer to the undo stack.
+ */
+void menu_clearHistory(Stack *stack);
+
+/**
+ * @brief Prints all tasks in the current display format (see render_setFormat()).
+ *
+ * @param head Pointer to the head of the list.
+ */
+void menu_printAll(List *head);
+
+/**
+ * @brief Prompts for a task ID and its new priority and status, and applies them.
+ *
+ * @param head Pointer to the head of the list.
+ * @param stack Pointer to the undo stack.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_updateTask(List *head, Stack *stack, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Prompts for a task ID and its new due date, and applies it.
+ *
+ * @param head Pointer to the head of the list.
+ * @param stack Pointer to the undo stack.
+ */
+void menu_setDue(List *head, Stack *stack);
+
+/**
+ * @brief Prints the unfinished tasks whose due date has passed, in the current display format.
+ *
+ * @param head Pointer to the head of the list.
+ */
+void menu_showOverdue(List *head);
+
+/**
+ * @brief Prompts for a task ID and tag names, and puts the tags on the task or takes them off.
+ *
+ * @param head Pointer to the head of the list.
+ * @param add 1 to put the tags on, 0 to take them off.
+ */
+void menu_editTags(List *head, int add);
+
+/**
+ * @brief Prompts for a tag query and prints the matching tasks in the current display format.
+ *
+ * @param head Pointer to the head of the list.
+ */
+void menu_selectTasks(List *head);
+
+/**
+ * @brief Lists the projects with their task counts, then prompts for a project to
+ * switch to (a new name creates it).
+ *
+ * The active project is saved to its file before the switch.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_switchProject(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Prints the tasks of every project in the current display format.
+ *
+ * Only the active project is loaded; the others are read from their files as they are printed.
+ *
+ * @param head Pointer to the head of the list.
+ */
+void menu_showAllProjects(List *head);
+
+/**
+ * @brief Undoes the most recent operation or group.
+ *
+ * A task whose ID was taken in the meantime is given a new ID at a prompt.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_undo(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Re-applies the most recently undone operation or group.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_redo(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Prints the ID and title of every task in the trash file.
+ *
+ * Prints nothing if the trash is empty.
+ */
+void menu_showTrash();
+
+/**
+ * @brief Prompts for an ID and restores that task from the trash file to the head of the list.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_restoreFromTrash(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Opens a transaction grouping the following list operations.
+ */
+void menu_beginTransaction();
+
+/**
+ * @brief Commits the open transaction.
+ *
+ * @param head Pointer to the head of the list.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_commitTransaction(List *head, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Rolls back the open transaction.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_rollbackTransaction(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Saves all tasks to the active project's file ("tasks.dat" for the default project).
+ *
+ * @param head Pointer to the head of the list.
+ */
+void menu_saveTasks(List *head);
+
+/**
+ * @brief Replaces the list with the tasks in the active project's file.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_loadTasks(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdio.h>
+
+/**
+ * Latency histograms and counters of the list, tree, stack and file entry points.
+ *
+ * Each entry point counts its calls, the tasks it scanned (visited, compared, read
+ * or written) and the nodes it allocated, and records its latency in a histogram
+ * of logarithmic buckets split into 32 linear sub-buckets (HDR style), so any
+ * percentile is known to within about 3% from a nanosecond to 18 minutes, in a
+ * fixed amount of memory. Latencies include the entry points called inside.
+ *
+ * Counting costs a few relaxed atomic adds per call and timing two clock reads,
+ * so the metrics are on by default. The entry points that handle a single task
+ * and run in loops (list insertions, removals, updates, lookups and single undo
+ * or redo steps, and the tree
+ * and stack entry points but tree_build(), tree_clear(), tree_forEach() and
+ * stack_clear()) are counted on every call but, past their first 1024 calls,
+ * timed on one in 16: their percentiles stay representative while loading or
+ * bulk-editing a large list pays little for them. Counters may be updated from
+ * several threads.
+ */
+
+/**
+ * @brief Instrumented entry points.
+ */
+typedef enum {
+    METRIC_LIST_INSERT,       // list_insertTask()
+    METRIC_LIST_REMOVE,       // list_removeTask()
+    METRIC_LIST_REMOVE_EDGE,  // list_removeEdge()
+    METRIC_LIST_FIND,         // list_findTask()
+    METRIC_LIST_STEP,         // list_nextTask(), list_prevTask()
+    METRIC_LIST_UPDATE,       // list_setTaskFields()
+    METRIC_LIST_SET_DUE,      // list_setTaskDue()
+    METRIC_LIST_CLEAR,        // list_clear()
+    METRIC_LIST_UPDATE_WHERE, // list_updateWhere()
+    METRIC_LIST_REMOVE_WHERE, // list_removeWhere()
+    METRIC_LIST_UNDO,         // list_undoStep()
+    METRIC_LIST_REDO,         // list_redoStep()
+    METRIC_LIST_COMMIT,       // list_txnCommit()
+    METRIC_LIST_ROLLBACK,     // list_txnRollback()
+    METRIC_LIST_RESTORE,      // list_restoreTask()
+    METRIC_LIST_REBUILD,      // list_rebuildIndexes()
+    METRIC_TREE_INSERT,       // tree_insert()
+    METRIC_TREE_REMOVE,       // tree_remove()
+    METRIC_TREE_BUILD,        // tree_build()
+    METRIC_TREE_CLEAR,        // tree_clear()
+    METRIC_TREE_WALK,         // tree_forEach() (and the sorted views printed through it)
+    METRIC_TREE_STEP,         // tree_first(), tree_last(), tree_next(), tree_prev()
+    METRIC_STACK_PUSH,        // stack_pushRecord(), stack_push()
+    METRIC_STACK_UNDO,        // stack_undo()
+    METRIC_STACK_REDO,        // stack_redo()
+    METRIC_STACK_CLEAR,       // stack_clear()
+    METRIC_FILE_WRITE,        // file_writeStream(), file_writeTasks()
+    METRIC_FILE_READ,         // file_readStream(), file_readTasks()
+    METRIC_FILE_SCAN,         // file_scanTasks()
+    METRIC_COUNT
+} MetricOp;
+
+/**
+ * @brief Stands for the outermost list or file operation running, for counts made by shared helpers.
+ */
+#define METRIC_CURRENT (-1)
+
+/**
+ * @brief Default number of seconds between two writes of the dump file.
+ */
+#define METRICS_DEFAULT_INTERVAL 10
+
+/**
+ * @brief Figures of one entry point. Latencies are in nanoseconds.
+ */
+typedef struct MetricsSnapshot {
+    long long calls;
+    long long timed;          // Calls whose latency was recorded
+    long long scanned;        // Tasks scanned
+    long long allocated;      // Nodes allocated
+    long long mean;
+    long long p50;
+    long long p90;
+    long long p99;
+    long long p999;
+    long long max;
+} MetricsSnapshot;
+
+/**
+ * @brief Counts a call to an entry point and starts timing it.
+ *
+ * @param op The entry point.
+ * @return Value to pass to metrics_end(): the start time, or 0 if the call is not timed.
+ */
+long long metrics_begin(MetricOp op);
+
+/**
+ * @brief Records the latency of a call started with metrics_begin().
+ *
+ * @param op The entry point.
+ * @param start Value returned by metrics_begin().
+ */
+void metrics_end(MetricOp op, long long start);
+
+/**
+ * @brief Adds to the tasks scanned and nodes allocated by an entry point.
+ *
+ * @param op The entry point, or METRIC_CURRENT for the outermost list or file operation running
+ *           (nothing is counted if there is none).
+ * @param scanned Tasks scanned.
+ * @param allocated Nodes allocated.
+ */
+void metrics_count(int op, long long scanned, long long allocated);
+
+/**
+ * @brief Turns recording on or off (on by default).
+ *
+ * @param enabled 1 to record, 0 to stop.
+ */
+void metrics_setEnabled(int enabled);
+
+/**
+ * @brief Reads the figures of an entry point.
+ *
+ * @param op The entry point.
+ * @param snapshot Filled with the figures.
+ */
+void metrics_get(MetricOp op, MetricsSnapshot *snapshot);
+
+/**
+ * @brief Returns the name of an entry point, such as "list.insert".
+ *
+ * @param op The entry point.
+ * @return Static string.
+ */
+const char* metrics_name(MetricOp op);
+
+/**
+ * @brief Prints the figures of every entry point called so far.
+ *
+ * @param out Stream to print to.
+ * @param tsv 1 for tab-separated lines with latencies in nanoseconds, 0 for an
+ *            aligned table in microseconds.
+ */
+void metrics_print(FILE *out, int tsv);
+
+/**
+ * @brief Sets every histogram and counter back to zero.
+ */
+void metrics_reset();
+
+/**
+ * @brief Sets the file the figures are written to periodically (see metrics_tick()).
+ *
+ * @param path Path of the file, or NULL to stop writing it.
+ * @param seconds Seconds between two writes (METRICS_DEFAULT_INTERVAL if 0 or less).
+ */
+void metrics_setDump(const char *path, int seconds);
+
+/**
+ * @brief Returns the number of seconds between two writes of the dump file.
+ *
+ * @return The interval, or 0 if no dump file is set.
+ */
+int metrics_dumpInterval();
+
+/**
+ * @brief Writes the dump file if the interval has passed since the last write.
+ *
+ * Called from the main loops; cheap when nothing is due.
+ */
+void metrics_tick();
+
+/**
+ * @brief Writes the dump file now.
+ *
+ * The figures go to a temporary file that then replaces the dump file, so readers
+ * never see a partial one.
+ *
+ * @return 1 on success, 0 if no dump file is set or it could not be written.
+ */
+int metrics_dump();
+
+#endif
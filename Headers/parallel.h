@@ -0,0 +1,46 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+/**
+ * @brief Fewest items worth handing to a thread of their own.
+ *
+ * Smaller loops run on the calling thread, where starting threads would cost
+ * more than the work.
+ */
+#define PARALLEL_MIN_CHUNK 16384
+
+/**
+ * @brief Upper bound on the threads of one loop, the caller included.
+ */
+#define PARALLEL_MAX_THREADS 64
+
+/**
+ * @brief Work function of a parallel loop, run on one chunk of the items.
+ *
+ * @param begin Index of the first item of the chunk.
+ * @param end Index one past the last item of the chunk.
+ * @param context Opaque pointer passed to parallel_for().
+ */
+typedef void (*ParallelFn)(long begin, long end, void *context);
+
+/**
+ * @brief Returns the number of threads a large loop is split across.
+ *
+ * @return Number of online processors, between 1 and PARALLEL_MAX_THREADS.
+ */
+int parallel_threads();
+
+/**
+ * @brief Runs fn over items [0, count) split into contiguous chunks, one per thread.
+ *
+ * The calling thread takes the last chunk and returns once every chunk is done.
+ * Chunks run concurrently, so fn must only write to state of its own chunk. If a
+ * thread cannot be started, its chunk runs on the calling thread instead.
+ *
+ * @param count Number of items.
+ * @param fn Work function.
+ * @param context Opaque pointer passed to fn.
+ */
+void parallel_for(long count, ParallelFn fn, void *context);
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+/**
+ * @brief Minimum number of items for an operation to show a progress bar.
+ *
+ * Smaller operations finish faster than a bar could be read, so they show nothing.
+ */
+#define PROGRESS_MIN_ITEMS 50000
+
+/**
+ * @brief Width of the progress bar in characters.
+ */
+#define PROGRESS_BAR_WIDTH 30
+
+/**
+ * @brief State of one progress report over a known number of items.
+ */
+typedef struct Progress {
+    const char *label;        // Text shown before the bar
+    long total;               // Number of items the operation will process
+    long next;                // Item count at which the bar is redrawn next
+    int percent;              // Last percentage drawn
+    int visible;              // 1 if the bar is being shown
+} Progress;
+
+/**
+ * @brief Enables or disables progress bars globally (e.g. off in batch mode).
+ *
+ * @param enabled 1 to show bars for large operations, 0 to never show them.
+ */
+void progress_setEnabled(int enabled);
+
+/**
+ * @brief Starts a progress report.
+ *
+ * Nothing is drawn if progress is disabled or total is below PROGRESS_MIN_ITEMS.
+ *
+ * @param progress Pointer to the report to initialize.
+ * @param label Text shown before the bar.
+ * @param total Number of items the operation will process.
+ */
+void progress_begin(Progress *progress, const char *label, long total);
+
+/**
+ * @brief Redraws the bar when another percent of the items is done.
+ *
+ * Costs one comparison per call between redraws, so it can be called for every item.
+ *
+ * @param progress Pointer to the report.
+ * @param done Number of items processed so far.
+ */
+void progress_update(Progress *progress, long done);
+
+/**
+ * @brief Finishes a progress report, completing and ending the bar line if shown.
+ *
+ * @param progress Pointer to the report.
+ */
+void progress_end(Progress *progress);
+
+#endif
@@ -0,0 +1,199 @@
+#ifndef PROJECT_H
+#define PROJECT_H
+
+#include <stddef.h>
+#include "list.h"
+#include "stack.h"
+#include "tree.h"
+
+/**
+ * Named projects, each with its own task file, trash file and undo history.
+ *
+ * The list and its indexes (BSTs, statistics, dependencies, due dates, tags) hold
+ * one project at a time: the active one. Switching saves the active project to its
+ * file, frees it and loads the next one, so only one project is ever in memory.
+ * The undo history of a project left behind is parked rather than dropped, and
+ * comes back when the project is switched to again; parked histories are evicted,
+ * least recently used first, once together they hold more than the parked memory
+ * budget, their deleted tasks going to that project's trash file if a trash is open.
+ *
+ * Project "main" always exists and uses tasks.dat and trash.dat; project NAME uses
+ * NAME.tasks.dat and NAME.trash.dat. The names are kept in projects.txt.
+ */
+
+/**
+ * @brief Longest project name, in characters.
+ */
+#define PROJECT_NAME_MAX 31
+
+/**
+ * @brief Name of the project active at startup.
+ */
+#define PROJECT_DEFAULT "main"
+
+/**
+ * @brief File listing the project names, one per line.
+ */
+#define PROJECT_REGISTRY "projects.txt"
+
+/**
+ * @brief Default memory budget for the parked undo histories, in bytes.
+ */
+#define PROJECT_PARKED_BYTES (64L * 1024 * 1024)
+
+/**
+ * @brief Enum for the outcome of a project operation.
+ */
+typedef enum {
+    PROJECT_OK = 0,           // Success
+    PROJECT_BAD_NAME,         // Not a valid project name
+    PROJECT_IN_TRANSACTION,   // A transaction is open
+    PROJECT_UNSAVED,          // The list was never loaded from or saved to the active project
+    PROJECT_IO_ERROR,         // A project file could not be written or read
+    PROJECT_NO_MEMORY         // Allocation failure
+} ProjectStatus;
+
+/**
+ * @brief Called for each task of a project by project_scan().
+ *
+ * @param task Pointer to the task (valid only during the call).
+ * @param context Opaque pointer given to project_scan().
+ * @return Nonzero to continue, 0 to stop the scan.
+ */
+typedef int (*ProjectTaskFn)(const Task *task, void *context);
+
+/**
+ * @brief Returns a short description of a status code.
+ *
+ * @param status The status code.
+ * @return Static string describing the status.
+ */
+const char* project_statusName(ProjectStatus status);
+
+/**
+ * @brief Returns the number of known projects.
+ *
+ * @return Number of projects (at least 1).
+ */
+int project_count();
+
+/**
+ * @brief Returns the name of a project.
+ *
+ * @param index Position in the registry, from 0 to project_count() - 1.
+ * @return The name, or NULL if index is out of range.
+ */
+const char* project_name(int index);
+
+/**
+ * @brief Returns the position of the active project.
+ *
+ * @return Index of the active project.
+ */
+int project_activeIndex();
+
+/**
+ * @brief Returns the name of the active project.
+ *
+ * @return The name.
+ */
+const char* project_active();
+
+/**
+ * @brief Returns the task file of the active project.
+ *
+ * @return Path of the file ("tasks.dat" for the default project).
+ */
+const char* project_storePath();
+
+/**
+ * @brief Returns the trash file of the active project.
+ *
+ * @return Path of the file ("trash.dat" for the default project).
+ */
+const char* project_trashPath();
+
+/**
+ * @brief Marks the list as holding the active project's tasks.
+ *
+ * Called once the list was loaded from or saved to project_storePath(). Until then
+ * project_switch() will not overwrite that file with the list.
+ */
+void project_bind();
+
+/**
+ * @brief Returns the number of tasks of a project.
+ *
+ * Inactive projects are not loaded: only the header of their file is read.
+ *
+ * @param index Position in the registry.
+ * @return Number of tasks (0 if the project has no file yet), or -1 if index is out of range.
+ */
+int project_taskCount(int index);
+
+/**
+ * @brief Checks whether a project has an undo history parked in memory.
+ *
+ * @param index Position in the registry.
+ * @return 1 if parked, 0 otherwise.
+ */
+int project_isParked(int index);
+
+/**
+ * @brief Makes a project active, creating it if the name is new.
+ *
+ * Saves the active project to its file, parks its undo history and frees the list,
+ * then loads the other project and brings back its parked history (or starts an
+ * empty one with the same capacity). The stack pointer keeps its eviction handler,
+ * and the trash file, if open, is switched to the project's own. If the list was
+ * never bound to the active project (see project_bind()) and holds tasks, nothing
+ * is changed.
+ *
+ * @param name Name of the project: 1 to PROJECT_NAME_MAX letters, digits, '-' or '_'.
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return PROJECT_OK, or the reason nothing was changed.
+ */
+ProjectStatus project_switch(const char *name, List **head, Stack *stack,
+                             Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Calls a function for each task of a project, in list order.
+ *
+ * The active project is read from the list; the others are streamed from their
+ * files one record at a time, without being loaded.
+ *
+ * @param index Position in the registry.
+ * @param head Pointer to the head of the list (the active project).
+ * @param visit Function to call.
+ * @param context Opaque pointer passed to visit.
+ * @return Number of tasks visited, or -1 if index is out of range.
+ */
+int project_scan(int index, List *head, ProjectTaskFn visit, void *context);
+
+/**
+ * @brief Sets the memory budget for parked undo histories, evicting at once if it is exceeded.
+ *
+ * @param bytes Budget in bytes (0 parks nothing).
+ */
+void project_setParkedBudget(size_t bytes);
+
+/**
+ * @brief Returns the memory held by the parked undo histories.
+ *
+ * @return Size in bytes.
+ */
+size_t project_parkedMemory();
+
+/**
+ * @brief Frees the parked undo histories and forgets the registry.
+ *
+ * Deleted tasks held by the parked histories are dropped, not spilled. The default
+ * project becomes active again.
+ */
+void project_reset();
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdio.h>
+#include "task.h"
+#include "list.h"
+#include "tree.h"
+
+/**
+ * @brief Size of the output buffer; listings are written in chunks of this size.
+ */
+#define RENDER_BUFFER_SIZE (1 << 16)
+
+/**
+ * @brief Layouts for task listings.
+ */
+typedef enum {
+    RENDER_PLAIN,     // Multi-line block per task, as in the interactive menus
+    RENDER_COMPACT,   // One aligned line per task: ID, priority, status, title
+    RENDER_TSV        // One tab-separated line per task with escaped text (machine-readable)
+} RenderFormat;
+
+/**
+ * @brief Sets the format used by the interactive listings.
+ *
+ * @param format The new format.
+ */
+void render_setFormat(RenderFormat format);
+
+/**
+ * @brief Returns the format used by the interactive listings.
+ *
+ * @return The current format.
+ */
+RenderFormat render_getFormat();
+
+/**
+ * @brief Returns the name of a format ("plain", "compact" or "tsv").
+ *
+ * @param format The format.
+ * @return Static string.
+ */
+const char* render_formatName(RenderFormat format);
+
+/**
+ * @brief Parses a format name.
+ *
+ * @param name "plain", "compact" or "tsv".
+ * @param format Set to the parsed format.
+ * @return 1 on success, 0 if the name is unknown.
+ */
+int render_parseFormat(const char *name, RenderFormat *format);
+
+/**
+ * @brief Starts rendering into the output buffer.
+ *
+ * Text is appended to a static buffer and written to the stream only when the
+ * buffer fills up or at render_end(), so a listing costs a few large writes and
+ * no allocation.
+ *
+ * @param out Stream the buffer is flushed to.
+ */
+void render_begin(FILE *out);
+
+/**
+ * @brief Appends a string to the output buffer.
+ *
+ * @param text The string.
+ */
+void render_text(const char *text);
+
+/**
+ * @brief Appends an integer in decimal to the output buffer.
+ *
+ * @param value The integer.
+ */
+void render_int(long long value);
+
+/**
+ * @brief Appends one task in a given format.
+ *
+ * @param task Pointer to the Task.
+ * @param format The layout to use.
+ * @param index Position shown as "Task #index" in the plain format (0 to omit).
+ */
+void render_task(const Task *task, RenderFormat format, long index);
+
+/**
+ * @brief Appends one task that is not in the list, such as a task read from another project's file.
+ *
+ * Same as render_task(), except that the tags, which belong to the tasks of the
+ * list, are left out.
+ *
+ * @param task Pointer to the Task.
+ * @param format The layout to use.
+ * @param index Position shown as "Task #index" in the plain format (0 to omit).
+ */
+void render_storedTask(const Task *task, RenderFormat format, long index);
+
+/**
+ * @brief Writes out the buffered text.
+ *
+ * @return 1 on success, 0 if the stream reported a write error.
+ */
+int render_end();
+
+/**
+ * @brief Renders every task of the list, head to tail.
+ *
+ * The plain format numbers the tasks and ends with the total, as the menu listing always has.
+ *
+ * @param head Pointer to the head of the list.
+ * @param out Stream to write to.
+ * @param format The layout to use.
+ * @return Number of tasks rendered.
+ */
+long render_list(List *head, FILE *out, RenderFormat format);
+
+/**
+ * @brief Renders every task of a BST in sorted order.
+ *
+ * @param tree Pointer to the tree.
+ * @param out Stream to write to.
+ * @param format The layout to use.
+ * @return Number of tasks rendered.
+ */
+long render_tree(Tree *tree, FILE *out, RenderFormat format);
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef RWLOCK_H
+#define RWLOCK_H
+
+/**
+ * @brief Reader-writer lock: any number of readers, or one writer.
+ *
+ * Wraps an SRWLOCK on Windows and a pthread rwlock elsewhere. On glibc, waiting
+ * writers are served before new readers so a stream of readers cannot starve them.
+ * The type is opaque so that callers need no thread headers.
+ */
+typedef struct RwLock RwLock;
+
+/**
+ * @brief Creates a lock.
+ *
+ * @return Pointer to the new lock, or NULL on failure.
+ */
+RwLock* rwlock_create();
+
+/**
+ * @brief Frees a lock that is no longer held.
+ *
+ * @param lock Pointer to the lock (may be NULL).
+ */
+void rwlock_free(RwLock *lock);
+
+/**
+ * @brief Acquires the lock for reading, waiting while a writer holds it.
+ *
+ * @param lock Pointer to the lock.
+ */
+void rwlock_readLock(RwLock *lock);
+
+/**
+ * @brief Releases a read acquisition.
+ *
+ * @param lock Pointer to the lock.
+ */
+void rwlock_readUnlock(RwLock *lock);
+
+/**
+ * @brief Acquires the lock for writing, waiting until no reader or writer holds it.
+ *
+ * @param lock Pointer to the lock.
+ */
+void rwlock_writeLock(RwLock *lock);
+
+/**
+ * @brief Releases a write acquisition.
+ *
+ * @param lock Pointer to the lock.
+ */
+void rwlock_writeUnlock(RwLock *lock);
+
+#endif
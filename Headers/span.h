@@ -0,0 +1,53 @@
+#ifndef SPAN_H
+#define SPAN_H
+
+/**
+ * Span tracing: the long operations written as Chrome trace events, which
+ * Perfetto (ui.perfetto.dev) and chrome://tracing show as a timeline.
+ *
+ * Loads and saves, index rebuilds, bulk changes, clearing and freeing the list,
+ * project switches and queries each record a span: a complete event ("ph":"X")
+ * with its start and duration in microseconds since span_open(), the thread it
+ * ran on and, for most, the number of tasks it handled. Spans nest by time, so a
+ * load shows the old list being cleared, the records being decoded, the index
+ * rebuild with the sort and build of each tree, then the tag and dependency
+ * sections, one inside the other.
+ *
+ * Threads are numbered in the order they record their first span, from 1 for the
+ * thread that opened the file; the worker threads of a parallel loop (see
+ * parallel_for()) each record their chunk. The events are written whole by a
+ * single stdio call, so threads may record spans concurrently. With no file open
+ * a span costs a test.
+ */
+
+/**
+ * @brief Starts writing spans to a trace-event file, replacing it.
+ *
+ * @param path Path of the file.
+ * @return 1 on success, 0 if the file could not be created.
+ */
+int span_open(const char *path);
+
+/**
+ * @brief Stops writing spans and closes the file.
+ */
+void span_close();
+
+/**
+ * @brief Starts a span.
+ *
+ * @return Value to pass to span_end(): the start time, or 0 if no file is open.
+ */
+long long span_begin();
+
+/**
+ * @brief Ends a span started with span_begin() and writes it.
+ *
+ * @param start Value returned by span_begin() (0 writes nothing).
+ * @param name Name of the span, such as "file.read"; the part before the first
+ *             dot is its category.
+ * @param tasks Number of tasks the operation handled, or -1 to leave it out.
+ */
+void span_end(long long start, const char *name, long tasks);
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef STACK_H
 #define STACK_H
 
+#include <stddef.h>
 #include "task.h"
 
 /**
@@ -13,37 +14,160 @@ typedef enum {
 } TaskPosition;
 
 /**
- * @brief Structure for a stack node to store a task and its metadata.
+ * @brief Enum for the kind of mutation an undo record describes.
+ */
+typedef enum {
+    OP_ADD,      // A task was inserted into the list
+    OP_REMOVE,   // A task was unlinked from the list
+    OP_UPDATE,   // A task's priority and/or status changed
+    OP_RESCHEDULE // A task's due date changed
+} OpType;
+
+/**
+ * @brief Record flag: the record belongs to the same group as the record below it.
+ *
+ * Undo keeps going while the record it just reverted is chained, and redo keeps going
+ * while the next record is chained, so a group (transaction, clear-all) is one step.
+ */
+#define REC_CHAINED 0x01
+
+/**
+ * @brief Default number of undo entries kept when no capacity is configured.
+ */
+#define STACK_DEFAULT_CAPACITY 10
+
+/**
+ * @brief Structure for an operation record (one undo/redo step).
+ *
+ * Records only hold what changed: the task ID and position for adds/removes and the
+ * old/new priority and status for updates, one due date for reschedules. A full Task is only attached while the
+ * task is out of the list (a removal that has not been undone, or an add that has),
+ * in which case the record owns it.
  */
 typedef struct StackNode {
-    Task *task;              // Pointer to a Task
-    TaskPosition position;   // Position in the original list (HEAD, MIDDLE, END)
-    int target_id;           // ID of the task to insert after (for MIDDLE)
-    struct StackNode *next;  // Pointer to next node in stack
+    Task *task;                  // Owned Task while it is out of the list, NULL otherwise
+    int task_id;                 // ID of the task the operation applies to
+    int target_id;               // ID of the task to insert after (for MIDDLE); for OP_RESCHEDULE,
+                                 // the due date the task does not have now (swapped on undo/redo)
+    unsigned char type;          // OpType
+    unsigned char position;      // TaskPosition in the list (HEAD, MIDDLE, END)
+    unsigned char old_priority;  // Priority before an OP_UPDATE
+    unsigned char old_status;    // Status before an OP_UPDATE
+    unsigned char new_priority;  // Priority after an OP_UPDATE
+    unsigned char new_status;    // Status after an OP_UPDATE
+    unsigned char flags;         // REC_* bits
 } StackNode;
 
 /**
- * @brief Structure for the stack to store deleted tasks for undo.
+ * @brief Callback invoked for every owned task the stack discards.
+ *
+ * Called before the task is freed, e.g. to spill it to the trash file.
+ */
+typedef void (*StackEvictFn)(const Task *task);
+
+/**
+ * @brief Structure for the undo/redo history.
+ *
+ * Records live in a ring buffer preallocated at creation time. The `size` records
+ * below `top` can be undone; the `redo` records from `top` upwards have been undone
+ * and can be redone. Pushing a new record discards the redo records, and when the
+ * stack is full the oldest group is evicted as a whole, in O(1) per record without
+ * allocating. A group is never cut: while a single group (a transaction, a bulk
+ * operation) outgrows the capacity, the ring grows to hold it, and the extra
+ * records are evicted with the group once newer ones push it out.
  */
 typedef struct Stack {
-    StackNode *top;          // Pointer to top of stack
-    int size;                // Number of tasks in stack
+    StackNode *slots;        // Ring buffer of `allocated` slots
+    int allocated;           // Slots in the ring (above capacity while a group outgrows it)
+    int capacity;            // Maximum number of records kept once the newest group is closed
+    int top;                 // Index of the slot the next push writes to
+    int size;                // Number of records that can be undone
+    int redo;                // Number of records that can be redone
+    int open;                // Records of the newest group, if it may still grow (0 if unknown)
+    int dropping;            // The newest group lost records: its further records are discarded
+    int reserved;            // Slots kept for the next group by stack_reserve() (0 if none)
+    StackEvictFn on_evict;   // Called for discarded tasks (may be NULL)
 } Stack;
 
 /**
- * @brief Creates a new empty stack.
+ * @brief Creates a new empty stack with the given capacity.
  *
- * Allocates memory for the stack and initializes it with no tasks.
+ * Allocates the stack and its ring buffer up front. A capacity of 0 disables undo:
+ * pushed records are discarded (and their tasks freed) immediately.
  *
+ * @param capacity Maximum number of records to keep (negative values are treated as 0).
  * @return Pointer to the new Stack, or NULL if allocation fails.
  */
-Stack* stack_create();
+Stack* stack_create(int capacity);
+
+/**
+ * @brief Changes the capacity of the stack at runtime.
+ *
+ * Discards the redo records and keeps the most recent undo records; if the new
+ * capacity is smaller than the current size, the oldest groups are freed, whole.
+ *
+ * @param stack Pointer to the stack.
+ * @param capacity New maximum number of records.
+ * @return 1 on success, 0 if the new buffer could not be allocated (stack unchanged).
+ */
+int stack_setCapacity(Stack *stack, int capacity);
 
 /**
- * @brief Pushes a task onto the stack with its position metadata.
+ * @brief Sets the callback invoked for tasks the stack discards.
  *
- * Stores the task along with its original position and target ID (for middle insertions).
- * Enforces a maximum stack size of 10, freeing the oldest task if necessary.
+ * Applies to eviction of the oldest record, discarded redo records, capacity
+ * reductions and stack_clear(), but not to stack_free().
+ *
+ * @param stack Pointer to the stack.
+ * @param on_evict Callback, or NULL to simply free discarded tasks.
+ */
+void stack_setEvictHandler(Stack *stack, StackEvictFn on_evict);
+
+/**
+ * @brief Returns the maximum number of records the stack can hold.
+ *
+ * @param stack Pointer to the stack.
+ * @return Capacity of the stack.
+ */
+int stack_getCapacity(Stack *stack);
+
+/**
+ * @brief Makes room for a group of records before the operation that pushes them starts.
+ *
+ * Grows the ring so a group of the given number of records is kept whole, even past
+ * the capacity, without allocating while it is pushed. A bulk operation calls it
+ * before changing anything, so running out of memory leaves the list untouched.
+ *
+ * @param stack Pointer to the stack.
+ * @param records Number of records the operation will push.
+ * @param chained 1 if the records extend the newest group (an open transaction).
+ * @return 1 on success (or if undo is disabled), 0 if the ring could not grow.
+ */
+int stack_reserve(Stack *stack, int records, int chained);
+
+/**
+ * @brief Pushes an operation record onto the stack.
+ *
+ * Discards any redo records, then stores a copy of the record. When the stack is
+ * full, the oldest group (and the tasks its records own) is freed to make room; a
+ * record chained to a group that fills the whole stack grows the ring instead.
+ * Ownership of record->task passes to the stack.
+ *
+ * If the ring cannot grow, the group the record belongs to is discarded as a whole,
+ * along with the rest of its records as they are pushed, so no part of it can be
+ * undone.
+ *
+ * @param stack Pointer to the stack.
+ * @param record Pointer to the record to copy.
+ * @return 1 if the record was kept, 0 if undo is disabled or memory ran out (its
+ *         group is then discarded).
+ */
+int stack_pushRecord(Stack *stack, const StackNode *record);
+
+/**
+ * @brief Pushes a removed task onto the stack with its position metadata.
+ *
+ * Shorthand for stack_pushRecord() with an OP_REMOVE record owning the task.
  *
  * @param stack Pointer to the stack.
  * @param task Pointer to the Task to push.
@@ -53,45 +177,110 @@ Stack* stack_create();
 void stack_push(Stack *stack, Task *task, TaskPosition position, int target_id);
 
 /**
- * @brief Pops a task from the stack along with its position metadata.
+ * @brief Moves the newest undo record to the redo side and returns it.
  *
- * Removes and returns the top task, along with its position and target ID.
+ * The record stays in the buffer; the caller applies its inverse and updates
+ * record->task to reflect ownership after the change.
  *
  * @param stack Pointer to the stack.
- * @param position Pointer to store the task's original position.
- * @param target_id Pointer to store the target ID (for POS_MIDDLE).
- * @return Pointer to the popped Task, or NULL if the stack is empty.
+ * @return Pointer to the record to undo, or NULL if there is nothing to undo.
  */
-Task* stack_pop(Stack *stack, TaskPosition *position, int *target_id);
+StackNode* stack_undo(Stack *stack);
 
 /**
- * @brief Peeks at the top task on the stack without removing it.
+ * @brief Moves the oldest redo record back to the undo side and returns it.
+ *
+ * The caller re-applies the record and updates record->task accordingly.
  *
  * @param stack Pointer to the stack.
- * @return Pointer to the top Task, or NULL if the stack is empty.
+ * @return Pointer to the record to redo, or NULL if there is nothing to redo.
  */
-Task* stack_peek(Stack *stack);
+StackNode* stack_redo(Stack *stack);
+
+/**
+ * @brief Drops the redo records undone last without calling the eviction handler.
+ *
+ * Used by transaction rollback: tasks owned by the dropped records were created
+ * inside the transaction and never became visible, so they are simply freed.
+ * Older redo records stay and can still be redone.
+ *
+ * @param stack Pointer to the stack.
+ * @param count Number of redo records to drop, nearest to the undo side first.
+ */
+void stack_dropRedo(Stack *stack, int count);
+
+/**
+ * @brief Peeks at the record the next undo would apply.
+ *
+ * @param stack Pointer to the stack.
+ * @return Pointer to the record, or NULL if there is nothing to undo.
+ */
+StackNode* stack_peek(Stack *stack);
+
+/**
+ * @brief Peeks at the record the next redo would apply.
+ *
+ * @param stack Pointer to the stack.
+ * @return Pointer to the record, or NULL if there is nothing to redo.
+ */
+StackNode* stack_peekRedo(Stack *stack);
 
 /**
  * @brief Checks if the stack is empty.
  *
  * @param stack Pointer to the stack.
- * @return 1 if the stack is empty, 0 otherwise.
+ * @return 1 if there is nothing to undo, 0 otherwise.
  */
 int stack_isEmpty(Stack *stack);
 
 /**
- * @brief Returns the number of tasks in the stack.
+ * @brief Returns the number of records that can be undone.
  *
  * @param stack Pointer to the stack.
- * @return Number of tasks in the stack.
+ * @return Number of undo records in the stack.
  */
 int stack_getSize(Stack *stack);
 
 /**
- * @brief Clears all tasks from the stack.
+ * @brief Returns the number of records that can be redone.
+ *
+ * @param stack Pointer to the stack.
+ * @return Number of redo records in the stack.
+ */
+int stack_getRedoSize(Stack *stack);
+
+/**
+ * @brief Returns a short name for an operation type ("add", "remove", "update").
+ *
+ * @param type The OpType value.
+ * @return Static string describing the operation.
+ */
+const char* stack_opName(int type);
+
+/**
+ * @brief Swaps the records of two stacks, keeping each one's eviction handler.
+ *
+ * Lets a caller park the history behind its stack pointer and bring another one
+ * in (e.g. when switching projects) without copying records.
+ *
+ * @param a Pointer to the first stack.
+ * @param b Pointer to the second stack.
+ */
+void stack_exchange(Stack *a, Stack *b);
+
+/**
+ * @brief Returns the memory held by the stack: its ring buffer and the tasks its records own.
+ *
+ * @param stack Pointer to the stack.
+ * @return Size in bytes.
+ */
+size_t stack_memoryUsage(Stack *stack);
+
+/**
+ * @brief Clears all records from the stack.
  *
- * Frees all tasks and nodes in the stack, resetting it to empty.
+ * Frees all owned tasks (passing them to the eviction handler first), resetting both
+ * the undo and redo sides. The ring buffer is kept.
  *
  * @param stack Pointer to the stack.
  */
@@ -100,7 +289,8 @@ void stack_clear(Stack *stack);
 /**
  * @brief Frees the stack and all its tasks.
  *
- * Clears all tasks and frees the stack structure itself.
+ * Clears all records and frees the ring buffer and the stack structure itself.
+ * The eviction handler is not called.
  *
  * @param stack Pointer to the stack.
  */
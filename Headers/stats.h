@@ -0,0 +1,90 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "task.h"
+
+/**
+ * @brief Snapshot of the aggregate statistics maintained over the task list.
+ *
+ * Arrays are indexed by (priority - PRIORITY_HIGH) and (status - STATUS_NOT_STARTED).
+ */
+typedef struct TaskStats {
+    int total;               // Number of tasks in the list
+    int by_priority[3];      // Tasks per priority (HIGH, MEDIUM, LOW)
+    int by_status[3];        // Tasks per status (NOT_STARTED, IN_PROGRESS, FINISHED)
+    int by_pair[3][3];       // Tasks per (priority, status) pair
+} TaskStats;
+
+/**
+ * @brief Accounts for a task that has just been inserted into the list.
+ *
+ * @param task Pointer to the inserted Task.
+ */
+void stats_onAdd(const Task *task);
+
+/**
+ * @brief Accounts for a task that has just been unlinked from the list.
+ *
+ * @param task Pointer to the removed Task.
+ */
+void stats_onRemove(const Task *task);
+
+/**
+ * @brief Accounts for a priority and/or status change on a task in the list.
+ *
+ * @param old_priority Priority before the change.
+ * @param old_status Status before the change.
+ * @param task Pointer to the Task holding the new values.
+ */
+void stats_onUpdate(Priority old_priority, Status old_status, const Task *task);
+
+/**
+ * @brief Resets all aggregates to zero (used when the list is cleared).
+ */
+void stats_reset();
+
+/**
+ * @brief Returns the number of tasks with the given priority.
+ *
+ * @param priority The priority to query.
+ * @return Number of tasks, or 0 for an invalid priority.
+ */
+int stats_countByPriority(Priority priority);
+
+/**
+ * @brief Returns the number of tasks with the given status.
+ *
+ * @param status The status to query.
+ * @return Number of tasks, or 0 for an invalid status.
+ */
+int stats_countByStatus(Status status);
+
+/**
+ * @brief Returns the number of tasks with the given priority and status.
+ *
+ * @param priority The priority to query.
+ * @param status The status to query.
+ * @return Number of tasks, or 0 for invalid values.
+ */
+int stats_countByPair(Priority priority, Status status);
+
+/**
+ * @brief Returns the fraction of tasks that are finished.
+ *
+ * @return Value in [0, 1], or 0 if the list is empty.
+ */
+double stats_finishedRatio();
+
+/**
+ * @brief Copies the current aggregates into a caller-provided snapshot.
+ *
+ * @param out Pointer to the TaskStats to fill.
+ */
+void stats_get(TaskStats *out);
+
+/**
+ * @brief Prints the aggregates as a priority/status table.
+ */
+void stats_print();
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef STORE_H
+#define STORE_H
+
+#include "task.h"
+#include "list.h"
+#include "stack.h"
+#include "tree.h"
+#include "stats.h"
+#include "rwlock.h"
+
+/**
+ * @brief Thread-safe task store: the list, its undo history and its BSTs behind one lock.
+ *
+ * Any number of threads may read at the same time (lookups, scans, sorted pages,
+ * statistics); a write waits for the readers in progress and holds the store alone.
+ * Tasks never leave the store: readers get copies or see them inside a callback
+ * that runs under the read lock. Since the list keeps its ID index in module state,
+ * only one store may exist at a time.
+ */
+typedef struct TaskStore {
+    List *head;               // Head of the task list
+    Stack *stack;             // Undo history
+    Tree *id_tree;            // BST sorted by ID
+    Tree *priority_tree;      // BST sorted by priority
+    Tree *status_tree;        // BST sorted by status
+    RwLock *lock;             // Readers share it, writers hold it alone
+} TaskStore;
+
+/**
+ * @brief Callback for store scans; runs with the read lock held.
+ *
+ * The task must not be modified or kept after the callback returns, and the callback
+ * must not call back into the store.
+ *
+ * @param task Pointer to the Task.
+ * @param context Opaque pointer passed to the scan.
+ * @return Nonzero to continue, 0 to stop the scan.
+ */
+typedef int (*StoreVisitFn)(const Task *task, void *context);
+
+/**
+ * @brief Creates an empty store.
+ *
+ * @param undo_depth Number of operations kept for undo.
+ * @return Pointer to the new store, or NULL if allocation fails.
+ */
+TaskStore* store_create(int undo_depth);
+
+/**
+ * @brief Frees the store and every task in it.
+ *
+ * No other thread may be using the store.
+ *
+ * @param store Pointer to the store (may be NULL).
+ */
+void store_free(TaskStore *store);
+
+/**
+ * @brief Adds a copy of a task.
+ *
+ * The description is copied too: the caller keeps ownership of the one of task.
+ *
+ * @param store Pointer to the store.
+ * @param task The task to copy.
+ * @param position Where to insert it.
+ * @param target_id ID of the task to insert after (for POS_MIDDLE).
+ * @return LIST_OK, LIST_DUPLICATE_ID, LIST_NOT_FOUND (no such target) or LIST_NO_MEMORY.
+ */
+ListStatus store_add(TaskStore *store, const Task *task, TaskPosition position, int target_id);
+
+/**
+ * @brief Removes the task with a given ID.
+ *
+ * @param store Pointer to the store.
+ * @param id The ID of the task to remove.
+ * @return LIST_OK or LIST_NOT_FOUND.
+ */
+ListStatus store_remove(TaskStore *store, int id);
+
+/**
+ * @brief Sets the priority and status of a task.
+ *
+ * @param store Pointer to the store.
+ * @param id The ID of the task to update.
+ * @param priority The new priority.
+ * @param status The new status.
+ * @return LIST_OK or LIST_NOT_FOUND.
+ */
+ListStatus store_update(TaskStore *store, int id, Priority priority, Status status);
+
+/**
+ * @brief Undoes the last operation.
+ *
+ * @param store Pointer to the store.
+ * @return LIST_OK, LIST_EMPTY (nothing to undo) or another ListStatus on failure.
+ */
+ListStatus store_undo(TaskStore *store);
+
+/**
+ * @brief Redoes the last undone operation.
+ *
+ * @param store Pointer to the store.
+ * @return LIST_OK, LIST_EMPTY (nothing to redo) or another ListStatus on failure.
+ */
+ListStatus store_redo(TaskStore *store);
+
+/**
+ * @brief Removes every task as one undo step.
+ *
+ * @param store Pointer to the store.
+ */
+void store_clear(TaskStore *store);
+
+/**
+ * @brief Copies the task with a given ID, description included.
+ *
+ * The description is copied under the lock, since a concurrent update or removal
+ * frees the stored one; the copy's description handle is DESC_NONE.
+ *
+ * @param store Pointer to the store.
+ * @param id The ID to look for.
+ * @param out Filled with a copy of the task.
+ * @param description Buffer receiving the description (may be NULL to skip it;
+ *                    DESC_MAX + 1 bytes hold any description).
+ * @param size Size of the buffer.
+ * @return LIST_OK or LIST_NOT_FOUND.
+ */
+ListStatus store_get(TaskStore *store, int id, Task *out, char *description, size_t size);
+
+/**
+ * @brief Returns the number of tasks.
+ *
+ * @param store Pointer to the store.
+ * @return The task count.
+ */
+int store_count(TaskStore *store);
+
+/**
+ * @brief Copies the aggregate statistics.
+ *
+ * @param store Pointer to the store.
+ * @param out Filled with the statistics.
+ */
+void store_stats(TaskStore *store, TaskStats *out);
+
+/**
+ * @brief Visits the tasks in list order under one read lock.
+ *
+ * @param store Pointer to the store.
+ * @param visit Callback invoked for each task until it returns 0.
+ * @param context Opaque pointer passed to the callback.
+ * @return Number of tasks visited.
+ */
+long store_scan(TaskStore *store, StoreVisitFn visit, void *context);
+
+/**
+ * @brief Visits up to limit tasks in the order of a BST, under one read lock.
+ *
+ * If the BSTs are stale (e.g. after a deferred load), they are rebuilt first under
+ * the write lock.
+ *
+ * @param store Pointer to the store.
+ * @param key Order to visit the tasks in.
+ * @param from_id ID of the first task to visit; if no task has it, the scan starts at the first task.
+ * @param limit Maximum number of tasks to visit.
+ * @param visit Callback invoked for each task until it returns 0.
+ * @param context Opaque pointer passed to the callback.
+ * @return Number of tasks visited.
+ */
+long store_scanSorted(TaskStore *store, SortKey key, int from_id, long limit, StoreVisitFn visit, void *context);
+
+#endif
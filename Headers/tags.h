@@ -0,0 +1,171 @@
+#ifndef TAGS_H
+#define TAGS_H
+
+#include "task.h"
+
+/**
+ * Free-form tags on tasks (team, component, customer...), kept outside the Task record.
+ *
+ * Every task in the list is given a dense slot number, reused once the task is
+ * gone, and each tag name in the dictionary has a compressed bitmap of the slots
+ * carrying it (see bitmap.h). The slots of the tasks in the list and of each
+ * priority and status are kept in bitmaps as well, so a query such as
+ * "tag:infra AND tag:urgent AND NOT status:done" is answered by intersecting
+ * bitmaps, smallest first, without walking the list.
+ *
+ * The list calls the tags_on*() hooks whenever a task enters or leaves the list
+ * or changes priority or status. Like dependencies, tags are not part of the undo
+ * history: they stay with a task ID while the task is out of the list and apply
+ * again once it is back.
+ */
+
+/**
+ * @brief Longest tag name, in characters.
+ */
+#define TAG_NAME_MAX 31
+
+/**
+ * @brief Enum for the outcome of a tag operation.
+ */
+typedef enum {
+    TAGS_OK = 0,        // Success
+    TAGS_BAD_NAME,      // Not a valid tag name
+    TAGS_NO_TAG,        // The task does not carry the tag
+    TAGS_SYNTAX,        // The query could not be parsed
+    TAGS_NO_MEMORY      // Allocation failure
+} TagsStatus;
+
+/**
+ * @brief Called for each tag of each task in the list by tags_forEach().
+ *
+ * @param id ID of the task.
+ * @param name Name of the tag.
+ * @param context Opaque pointer given to tags_forEach().
+ */
+typedef void (*TagsFn)(int id, const char *name, void *context);
+
+/**
+ * @brief Returns a short description of a status code.
+ *
+ * @param status The status code.
+ * @return Static string describing the status.
+ */
+const char* tags_statusName(TagsStatus status);
+
+/**
+ * @brief Puts a tag on a task, adding the name to the dictionary if it is new.
+ *
+ * Names are 1 to TAG_NAME_MAX letters, digits and the characters - _ . / and
+ * are case-sensitive.
+ *
+ * @param task Pointer to the task (in the list).
+ * @param name The tag name.
+ * @return TAGS_OK (also if the task already had the tag), TAGS_BAD_NAME or TAGS_NO_MEMORY.
+ */
+TagsStatus tags_add(const Task *task, const char *name);
+
+/**
+ * @brief Takes a tag off a task.
+ *
+ * @param id ID of the task.
+ * @param name The tag name.
+ * @return TAGS_OK, or TAGS_NO_TAG if the task does not carry the tag.
+ */
+TagsStatus tags_remove(int id, const char *name);
+
+/**
+ * @brief Takes every tag off a task.
+ *
+ * @param id ID of the task.
+ */
+void tags_removeAll(int id);
+
+/**
+ * @brief Lists the tags of a task, in dictionary order.
+ *
+ * @param id ID of the task.
+ * @param names Array receiving up to max names (static strings owned by the dictionary).
+ * @param max Capacity of names.
+ * @return Number of tags of the task (may exceed max).
+ */
+int tags_ofTask(int id, const char **names, int max);
+
+/**
+ * @brief Returns the number of names in the dictionary.
+ *
+ * @return Number of tag names ever used.
+ */
+int tags_nameCount();
+
+/**
+ * @brief Returns a name of the dictionary and the number of tasks in the list carrying it.
+ *
+ * @param index Position in the dictionary, from 0 to tags_nameCount() - 1.
+ * @param tasks Set to the number of tasks in the list with the tag (may be NULL).
+ * @return The name, or NULL if index is out of range.
+ */
+const char* tags_name(int index, long *tasks);
+
+/**
+ * @brief Calls a function for each tag of each task in the list.
+ *
+ * Tags are visited one after another; the tasks of a tag in slot order.
+ *
+ * @param fn Function to call.
+ * @param context Opaque pointer passed to fn.
+ * @return 1 on success, 0 on allocation failure (some tags may not have been visited).
+ */
+int tags_forEach(TagsFn fn, void *context);
+
+/**
+ * @brief Finds the tasks in the list matching a query.
+ *
+ * A query combines terms with AND, OR, NOT and parentheses (AND binds tighter
+ * than OR and may be left out between terms; keywords in any case). Terms are
+ * tag:NAME, status:VALUE, prio:VALUE and all. Status values are todo, doing and
+ * done (or not_started, in_progress and finished), priority values high, medium
+ * and low; both also as 1-3. A tag that is not in the dictionary matches nothing.
+ *
+ * @param query The query text.
+ * @param ids Array receiving up to max task IDs, in increasing order.
+ * @param max Capacity of ids.
+ * @param count Set to the number of matching tasks (may exceed max).
+ * @param error_at Set to the position in query where parsing failed (may be NULL).
+ * @return TAGS_OK, TAGS_SYNTAX or TAGS_NO_MEMORY.
+ */
+TagsStatus tags_select(const char *query, int *ids, int max, int *count, int *error_at);
+
+/**
+ * @brief Accounts for a task that has just been linked into the list.
+ *
+ * @param task Pointer to the linked Task.
+ */
+void tags_onAdd(const Task *task);
+
+/**
+ * @brief Accounts for a task that has just been unlinked from the list.
+ *
+ * @param task Pointer to the unlinked Task.
+ */
+void tags_onRemove(const Task *task);
+
+/**
+ * @brief Accounts for a priority and/or status change on a task in the list.
+ *
+ * @param old_priority Priority before the change.
+ * @param old_status Status before the change.
+ * @param task Pointer to the Task holding the new values.
+ */
+void tags_onUpdate(Priority old_priority, Status old_status, const Task *task);
+
+/**
+ * @brief Accounts for every task leaving the list at once (the tags are kept).
+ */
+void tags_onClear();
+
+/**
+ * @brief Drops every tag and the dictionary, and frees the bitmaps.
+ */
+void tags_reset();
+
+#endif
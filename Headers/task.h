@@ -1,6 +1,8 @@
 #ifndef TASK_H
 #define TASK_H
 
+#include "desc.h"
+
 /**
  * @brief Enum for task priority levels.
  */
@@ -21,34 +23,113 @@ typedef enum {
 
 /**
  * @brief Structure to represent a task with its attributes.
+ *
+ * Only the fields read by listings, indexes and filters are held here; the
+ * description lives in the description store (see desc.h), which may keep it on
+ * disk, and is looked up through its handle when a task is shown in full or saved.
+ * A Task owns its description: free it with task_free().
  */
 typedef struct Task {
     int id;                    // Unique identifier for the task
     char title[50];            // Task title (max 50 characters)
-    char description[200];     // Task description (max 200 characters)
     Priority priority;         // Task priority (HIGH, MEDIUM, LOW)
     Status status;             // Task status (NOT_STARTED, IN_PROGRESS, FINISHED)
+    unsigned int created;      // Creation time, seconds since the Unix epoch (0 if unknown)
+    unsigned int due;          // Due date, seconds since the Unix epoch (0 for none)
+    DescRef description;       // Handle of the task description (DESC_NONE if empty)
 } Task;
 
 /**
- * @brief Fills a Task structure with validated user input.
+ * @brief Layout of a task in task and trash files, description included.
+ */
+typedef struct TaskRecord {
+    int id;
+    char title[50];
+    char description[200];
+    Priority priority;
+    Status status;
+    unsigned int created;
+    unsigned int due;
+} TaskRecord;
+
+/**
+ * @brief Layout of Task records written before tasks had timestamps.
+ *
+ * Still read from old task and trash files. Times are kept in 32 unsigned bits,
+ * which last until 2106 and let an undo record hold a due date in place of an ID.
+ */
+typedef struct TaskV1 {
+    int id;
+    char title[50];
+    char description[200];
+    Priority priority;
+    Status status;
+} TaskV1;
+
+/**
+ * @brief Converts an old record to a record with no timestamps.
+ *
+ * @param record Pointer to the record to fill.
+ * @param old Pointer to the old record.
+ */
+void task_fromV1(TaskRecord *record, const TaskV1 *old);
+
+/**
+ * @brief Fills a Task from a file record, storing its description.
+ *
+ * @param task Pointer to the Task to fill.
+ * @param record Pointer to the record.
+ * @return 1 on success, 0 if the description could not be stored.
+ */
+int task_fromRecord(Task *task, const TaskRecord *record);
+
+/**
+ * @brief Fills a file record from a Task, looking up its description.
+ *
+ * @param record Pointer to the record to fill.
+ * @param task Pointer to the Task.
+ */
+void task_toRecord(TaskRecord *record, const Task *task);
+
+/**
+ * @brief Replaces the description of a task.
  *
- * Uses safe input functions to avoid buffer overflow and invalid entries:
- * - readInt() for numeric inputs like ID
- * - readIntInRange() for validated enum selection (priority, status)
- * - readString() for title and description (supports spaces)
+ * @param task Pointer to the Task.
+ * @param text The new description (truncated to DESC_MAX characters).
+ * @return 1 on success, 0 on allocation failure (the old description is kept).
+ */
+int task_setDescription(Task *task, const char *text);
+
+/**
+ * @brief Frees a task and its description.
  *
- * @param task Pointer to the Task structure to populate.
+ * @param task Pointer to the Task (may be NULL), allocated with mem_alloc(MEM_TASK, sizeof(Task)).
  */
-void fillTask(Task *task);
+void task_free(Task *task);
 
 /**
  * @brief Prints the contents of a single Task in a formatted way.
  *
- * Uses switch statements for enum-based fields to increase readability.
+ * Formats the whole block in the output buffer and writes it at once.
  *
  * @param task Pointer to the Task structure to print.
  */
 void printTask(Task *task);
 
+/**
+ * @brief Returns the display name of a priority level.
+ *
+ * @param priority The priority.
+ * @return Static string ("HIGH", "MEDIUM", "LOW" or "UNKNOWN").
+ */
+const char* priorityName(Priority priority);
+
+/**
+ * @brief Returns the display name of a status level.
+ *
+ * @param status The status.
+ * @return Static string ("Not Started", "In Progress", "Finished" or "Unknown").
+ */
+const char* statusName(Status status);
+
 #endif
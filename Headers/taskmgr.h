@@ -0,0 +1,55 @@
+#ifndef TASKMGR_H
+#define TASKMGR_H
+
+/**
+ * libtaskmgr: the task manager without its frontend.
+ *
+ * Every function reachable from here takes its input as values and reports the
+ * outcome as a ListStatus (or a count), never prompting on stdin and never
+ * printing, except for the progress bars of large loads and saves, which
+ * progress_setEnabled(0) turns off. The library is every source file except
+ * main.c, menu.c, input_utils.c, term.c, tui.c, journal.c, daemon.c and client.c.
+ *
+ * Single-threaded use goes through the list_* calls on a list with its undo
+ * stack and three BSTs:
+ *
+ *   list_insertTask()     add(task, position)
+ *   list_removeTask()     remove(id); list_removeEdge() for head or end
+ *   list_setTaskFields()  update(id, priority, status)
+ *   list_restoreTask()    restore(id) from the trash file
+ *   list_undoStep(), list_redoStep(), list_txnBegin(), list_txnCommit(), list_txnRollback()
+ *   file_readTasks(), file_writeTasks(), batch_executeLine()
+ *   trace_open(), trace_replay()  operation traces recorded and replayed with timing
+ *   metrics_get(), metrics_print()  latency histograms and counters of every entry point
+ *   mem_get(), mem_print()  memory used by each subsystem, bytes per task, fragmentation
+ *   span_open()  long operations written as Chrome trace events, for Perfetto
+ *   deps_addEdge(), deps_ready(), deps_criticalPath()  dependencies between tasks
+ *   project_switch(), project_scan()  named projects, one loaded at a time
+ *
+ * Multi-threaded use goes through TaskStore (store.h), which puts the same
+ * operations behind a reader-writer lock.
+ */
+
+#include "task.h"
+#include "desc.h"
+#include "list.h"
+#include "stack.h"
+#include "tree.h"
+#include "file.h"
+#include "stats.h"
+#include "deps.h"
+#include "deadline.h"
+#include "bitmap.h"
+#include "tags.h"
+#include "project.h"
+#include "trash.h"
+#include "render.h"
+#include "progress.h"
+#include "batch.h"
+#include "store.h"
+#include "trace.h"
+#include "metrics.h"
+#include "mem.h"
+#include "span.h"
+
+#endif
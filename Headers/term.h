@@ -0,0 +1,105 @@
+#ifndef TERM_H
+#define TERM_H
+
+/**
+ * @brief Maximum number of lines in a frame.
+ */
+#define TERM_MAX_LINES 128
+
+/**
+ * @brief Maximum length of a frame line, including the terminator.
+ */
+#define TERM_LINE_MAX 512
+
+/**
+ * @brief Special keys returned by term_readKey(), above the range of characters.
+ */
+typedef enum {
+    TERM_KEY_NONE = -1,       // No key before the timeout
+    TERM_KEY_ESCAPE = 27,     // Escape pressed on its own
+    TERM_KEY_UP = 256,
+    TERM_KEY_DOWN,
+    TERM_KEY_PAGE_UP,
+    TERM_KEY_PAGE_DOWN,
+    TERM_KEY_HOME,
+    TERM_KEY_END
+} TermKey;
+
+/**
+ * @brief Detects whether stdout is an ANSI-capable terminal.
+ *
+ * On Windows this also enables escape sequence processing on the console.
+ * Without a terminal (pipes, files, TERM=dumb) no escape sequence is ever written.
+ */
+void term_init();
+
+/**
+ * @brief Returns 1 if escape sequences are written to stdout.
+ *
+ * @return 1 for a terminal, 0 otherwise.
+ */
+int term_isInteractive();
+
+/**
+ * @brief Clears the screen and moves the cursor to the top-left corner.
+ *
+ * Forgets the last frame, so the next one is painted in full.
+ */
+void term_clear();
+
+/**
+ * @brief Starts a new frame.
+ *
+ * Lines added with term_line() are kept until term_endFrame() paints them.
+ */
+void term_beginFrame();
+
+/**
+ * @brief Adds one line to the frame being built.
+ *
+ * Lines beyond TERM_MAX_LINES are ignored and long lines are truncated.
+ *
+ * @param format printf-style format of the line, without the newline.
+ */
+void term_line(const char *format, ...);
+
+/**
+ * @brief Paints the frame.
+ *
+ * If the previous frame is still on screen, only the lines that changed are
+ * rewritten and anything printed below it is erased; otherwise the screen is
+ * cleared and every line is written. The cursor is left on the line after the frame.
+ */
+void term_endFrame();
+
+/**
+ * @brief Reads the size of the terminal window.
+ *
+ * @param rows Set to the number of rows (24 if unknown).
+ * @param cols Set to the number of columns (80 if unknown).
+ */
+void term_size(int *rows, int *cols);
+
+/**
+ * @brief Switches to the alternate screen with the cursor hidden and unbuffered, unechoed keys.
+ *
+ * Must be paired with term_leaveFullScreen().
+ */
+void term_enterFullScreen();
+
+/**
+ * @brief Restores the normal screen, the cursor and line-buffered input.
+ */
+void term_leaveFullScreen();
+
+/**
+ * @brief Waits for one key press in full-screen mode.
+ *
+ * Arrow, page and Home/End keys are decoded from their escape sequences.
+ *
+ * @param timeout_ms Maximum wait in milliseconds (0 to poll, negative to wait forever).
+ * @return The character, a TermKey value, or TERM_KEY_NONE on timeout.
+ */
+int term_readKey(int timeout_ms);
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include "list.h"
+#include "stack.h"
+#include "tree.h"
+
+/**
+ * Operation traces: a recorder of the operations run against the list, and a
+ * replayer that runs a recorded trace again to measure it offline.
+ *
+ * Every operation is written as the batch command line doing the same (see
+ * batch_run()), whether it came from a script, a daemon client or the menu, with
+ * when it started and how long it took. The file is plain text, one line each:
+ *
+ *   # taskmgr trace 1 MODE       header; MODE is interactive, batch or daemon
+ *   DELTA DURATION +|- command   microseconds since the previous operation started,
+ *                                nanoseconds it took, and whether it succeeded
+ *
+ * Operations with no batch command (restoring from the trash, clearing the undo
+ * history, display settings) are not recorded. Double quotes in titles and
+ * descriptions typed at the menu are recorded as single quotes.
+ */
+
+/**
+ * @brief Most commands told apart in a replay report; the rest are counted under "other".
+ */
+#define TRACE_MAX_COMMANDS 24
+
+/**
+ * @brief Latency figures of a set of operations, in nanoseconds.
+ */
+typedef struct TraceLatency {
+    long count;               // Operations
+    long long mean;
+    long long p50;
+    long long p90;
+    long long p99;
+    long long max;
+    long long recorded_p50;   // Median when the trace was recorded
+    long long recorded_p99;
+} TraceLatency;
+
+/**
+ * @brief Outcome of a replay.
+ */
+typedef struct TraceReport {
+    char mode[16];            // Mode the trace was recorded in
+    int paced;                // Replayed at the original pacing
+    long ops;                 // Operations replayed
+    long failed;              // Operations that failed
+    long diverged;            // Operations whose outcome differed from the recording
+    long unreadable;          // Lines that could not be read
+    double seconds;           // Wall time of the replay
+    double recorded_seconds;  // Time between the first and last operation when recorded
+    long long max_lag;        // Paced: longest an operation started behind schedule, in nanoseconds
+    TraceLatency all;         // Every operation
+    int command_count;
+    char commands[TRACE_MAX_COMMANDS][16];
+    TraceLatency by_command[TRACE_MAX_COMMANDS];
+} TraceReport;
+
+/**
+ * @brief Starts recording operations to a trace file, replacing it.
+ *
+ * @param path Path of the file.
+ * @param mode Where the operations come from: "interactive", "batch" or "daemon".
+ * @return 1 on success, 0 if the file could not be created.
+ */
+int trace_open(const char *path, const char *mode);
+
+/**
+ * @brief Stops recording and closes the trace file.
+ */
+void trace_close();
+
+/**
+ * @brief Tells whether operations are being recorded.
+ *
+ * @return 1 if a trace file is open, 0 otherwise.
+ */
+int trace_isRecording();
+
+/**
+ * @brief Returns a monotonic clock for timing operations.
+ *
+ * @return The time in nanoseconds since an arbitrary point.
+ */
+long long trace_clock();
+
+/**
+ * @brief Records an operation, if recording.
+ *
+ * @param start trace_clock() when the operation started.
+ * @param ok 1 if the operation succeeded, 0 otherwise.
+ * @param format printf-style format of the batch command line doing the same, followed by its arguments.
+ */
+void trace_record(long long start, int ok, const char *format, ...);
+
+/**
+ * @brief Runs the operations of a trace file against the list.
+ *
+ * Commands run as in batch mode with their output discarded; BST maintenance is
+ * deferred for the whole replay unless the trace was recorded interactively. Run
+ * a replay where the trace was recorded, since commands such as load read the
+ * files there.
+ *
+ * @param path Path of the trace file.
+ * @param paced 1 to start each operation as long after the previous one as when
+ *              recorded, 0 to run them back to back.
+ * @param report Filled with the outcome.
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return Number of operations replayed, or -1 if the file could not be opened, is
+ *         not a trace or memory ran out.
+ */
+long trace_replay(const char *path, int paced, TraceReport *report, List **head, Stack *stack,
+                  Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+/**
+ * @brief Prints a replay report: throughput, then latency percentiles overall and per command.
+ *
+ * @param report Pointer to the report.
+ * @param out Stream to print to.
+ */
+void trace_printReport(const TraceReport *report, FILE *out);
+
+#endif
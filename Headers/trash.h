@@ -0,0 +1,97 @@
+#ifndef TRASH_H
+#define TRASH_H
+
+#include "task.h"
+
+/**
+ * @brief Default path of the append-only trash file.
+ */
+#define TRASH_FILENAME "trash.dat"
+
+/**
+ * @brief Called for each restorable task by trash_forEach().
+ *
+ * @param id ID of the deleted task.
+ * @param title Its title.
+ * @param context Opaque pointer given to trash_forEach().
+ */
+typedef void (*TrashVisitFn)(int id, const char *title, void *context);
+
+/**
+ * @brief Opens (or creates) the trash file and rebuilds its in-memory index.
+ *
+ * The index maps each task ID to the offset of its most recently deleted copy.
+ * Only record headers are read, so startup cost is one seek per record.
+ *
+ * @param path Path of the trash file.
+ * @return 1 on success, 0 if the file could not be opened.
+ */
+int trash_open(const char *path);
+
+/**
+ * @brief Flushes and closes the trash file and frees the index.
+ */
+void trash_close();
+
+/**
+ * @brief Checks whether a trash file is open.
+ *
+ * @return 1 if deleted tasks are being kept, 0 otherwise.
+ */
+int trash_isOpen();
+
+/**
+ * @brief Appends a deleted task to the trash file.
+ *
+ * Used as the undo stack's eviction handler, so tasks that fall out of the undo
+ * window are kept on disk instead of being lost. A task that cannot be written is
+ * counted in trash_lostCount().
+ *
+ * @param task Pointer to the deleted Task (not freed).
+ */
+void trash_append(const Task *task);
+
+/**
+ * @brief Checks whether a deleted copy of a task ID is in the trash.
+ *
+ * @param id The task ID.
+ * @return 1 if the trash holds the ID, 0 otherwise.
+ */
+int trash_contains(int id);
+
+/**
+ * @brief Reads back the most recently deleted copy of a task.
+ *
+ * The ID is removed from the index and a tombstone is appended, so the task is
+ * not offered again after a restart.
+ *
+ * @param id The task ID.
+ * @return Newly allocated Task (owned by the caller; free with task_free()), or NULL if
+ *         not found, unreadable or out of memory.
+ */
+Task* trash_take(int id);
+
+/**
+ * @brief Returns the number of distinct task IDs in the trash.
+ *
+ * @return Number of restorable tasks.
+ */
+int trash_count();
+
+/**
+ * @brief Returns the number of deleted tasks that could not be written to the trash file.
+ *
+ * @return Number of tasks lost so far, over every trash file opened.
+ */
+int trash_lostCount();
+
+/**
+ * @brief Calls a function with the ID and title of every restorable task.
+ *
+ * @param fn Function to call.
+ * @param context Opaque pointer passed to fn.
+ * @return Number of tasks visited; records that cannot be read are skipped.
+ */
+int trash_forEach(TrashVisitFn fn, void *context);
+
+#endif
@@ -47,15 +47,94 @@ Tree* tree_create(SortKey key);
  */
 void tree_insert(Tree *tree, Task *task);
 
+/**
+ * @brief Replaces the contents of the tree with a balanced tree over the given tasks.
+ *
+ * Sorts the array in place by the tree's key, then builds the tree in O(n), so a batch
+ * of changes costs one O(n log n) rebuild instead of one insertion per change.
+ *
+ * @param tree Pointer to the tree.
+ * @param tasks Array of task pointers (reordered by this call).
+ * @param count Number of tasks in the array.
+ * @return 1 on success, 0 on allocation failure (the tree is left empty).
+ */
+int tree_build(Tree *tree, Task **tasks, int count);
+
+/**
+ * @brief Removes a task from the binary search tree.
+ *
+ * Must be called before the task's key fields change, since the task is located
+ * by its current key. The task itself is not freed.
+ *
+ * @param tree Pointer to the tree.
+ * @param task Pointer to the Task to remove.
+ * @return 1 if the task was found and removed, 0 otherwise.
+ */
+int tree_remove(Tree *tree, Task *task);
+
 /**
  * @brief Prints all tasks in the tree in sorted order (inorder traversal).
  *
- * Displays tasks sorted by the tree's sort key.
+ * Displays tasks sorted by the tree's sort key, in the current display format
+ * (see render_setFormat()) through the buffered renderer.
  *
  * @param tree Pointer to the tree.
  */
 void tree_printInorder(Tree *tree);
 
+/**
+ * @brief Calls a function for every task in the tree, in sorted order.
+ *
+ * @param tree Pointer to the tree.
+ * @param visit Callback invoked for each task.
+ * @param context Opaque pointer passed to the callback.
+ */
+void tree_forEach(Tree *tree, void (*visit)(Task *task, void *context), void *context);
+
+/**
+ * @brief Returns the first task in sorted order.
+ *
+ * @param tree Pointer to the tree.
+ * @return The smallest Task, or NULL if the tree is empty.
+ */
+Task* tree_first(Tree *tree);
+
+/**
+ * @brief Returns the last task in sorted order.
+ *
+ * @param tree Pointer to the tree.
+ * @return The largest Task, or NULL if the tree is empty.
+ */
+Task* tree_last(Tree *tree);
+
+/**
+ * @brief Returns the task following a given one in sorted order.
+ *
+ * Walks down from the root by key, so it costs O(height) and needs no parent
+ * links. The task must not have changed its key fields since it was indexed.
+ *
+ * @param tree Pointer to the tree.
+ * @param task Pointer to a Task in the tree.
+ * @return The next Task, or NULL if task is the last one.
+ */
+Task* tree_next(Tree *tree, Task *task);
+
+/**
+ * @brief Returns the task preceding a given one in sorted order.
+ *
+ * @param tree Pointer to the tree.
+ * @param task Pointer to a Task in the tree.
+ * @return The previous Task, or NULL if task is the first one.
+ */
+Task* tree_prev(Tree *tree, Task *task);
+
+/**
+ * @brief Removes all nodes from the tree (but not the tasks), keeping the tree usable.
+ *
+ * @param tree Pointer to the tree.
+ */
+void tree_clear(Tree *tree);
+
 /**
  * @brief Frees all nodes in the tree (but not the tasks).
  *
@@ -0,0 +1,41 @@
+#ifndef TUI_H
+#define TUI_H
+
+#include "list.h"
+#include "tree.h"
+
+/**
+ * @brief Maximum number of tasks examined per frame while a filter skips rows.
+ *
+ * Bounds the frame time when few tasks match; a page that is not complete yet
+ * keeps filling on the following frames while keys stay responsive.
+ */
+#define TUI_SCAN_BUDGET 200000
+
+/**
+ * @brief Maximum length of the filter text and of a typed ID, including the terminator.
+ */
+#define TUI_INPUT_MAX 64
+
+/**
+ * @brief Time between checks for a resized window while no key is pressed, in milliseconds.
+ */
+#define TUI_IDLE_MS 250
+
+/**
+ * @brief Runs the full-screen task browser until the user quits.
+ *
+ * Only the rows that fit on screen are visited, walking the list or a BST from the
+ * first visible task, so a frame costs the same for 100 tasks or 10 million.
+ * Keys: Up/Down, PgUp/PgDn, Home/End to scroll, Tab to switch between list order
+ * and the sorted indexes, '/' to filter by title as you type, '#' to jump to an ID,
+ * q or Esc to quit. The BSTs must be up to date (see list_syncIndexes()).
+ *
+ * @param head Pointer to the head of the list.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void tui_run(List *head, Tree *id_tree, Tree *priority_tree, Tree *status_tree);
+
+#endif
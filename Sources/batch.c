@@ -0,0 +1,890 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "batch.h"
+#include "task.h"
+#include "list.h"
+#include "stack.h"
+#include "tree.h"
+#include "file.h"
+#include "stats.h"
+#include "metrics.h"
+#include "mem.h"
+#include "render.h"
+#include "deps.h"
+#include "deadline.h"
+#include "tags.h"
+#include "project.h"
+#include "trace.h"
+
+#define BATCH_MAX_ARGS 16
+#define BATCH_DUE_USAGE "due must be none, epoch seconds, +N[s|m|h|d], YYYY-MM-DD or YYYY-MM-DDTHH:MM"
+
+/**
+ * @brief Splits a command line into words in place.
+ *
+ * Words are separated by blanks. A word or the value of a key=value word may be
+ * enclosed in double quotes to contain blanks; the quotes are removed.
+ *
+ * @param line The line to split (modified).
+ * @param argv Set to the words.
+ * @param max Capacity of argv.
+ * @return Number of words, or -1 on an unterminated quote or too many words.
+ */
+static int batch_split(char *line, char **argv, int max) {
+    int argc = 0;
+    char *read = line;
+    while (1) {
+        while (*read == ' ' || *read == '\t' || *read == '\r' || *read == '\n') read++;
+        if (*read == '\0') return argc;
+        if (argc == max) return -1;
+
+        char *write = read;
+        argv[argc++] = write;
+        int quoted = 0;
+        while (*read && (quoted || (*read != ' ' && *read != '\t' && *read != '\r' && *read != '\n'))) {
+            if (*read == '"') quoted = !quoted;
+            else *write++ = *read;
+            read++;
+        }
+        if (quoted) return -1;
+        if (*read) read++;
+        *write = '\0';
+    }
+}
+
+/**
+ * @brief Returns the time the commands of a context run at.
+ *
+ * @param ctx Pointer to the batch context.
+ * @return ctx->clock if set, the current time otherwise.
+ */
+static unsigned int batch_now(const BatchContext *ctx) {
+    return ctx->clock ? ctx->clock : (unsigned int)time(NULL);
+}
+
+/**
+ * @brief Parses a whole word as a decimal integer.
+ *
+ * @param text The word.
+ * @param value Set to the parsed value.
+ * @return 1 on success, 0 if the word is not an integer.
+ */
+static int batch_parseInt(const char *text, int *value) {
+    char *end;
+    long parsed = strtol(text, &end, 10);
+    if (end == text || *end != '\0') return 0;
+    *value = (int)parsed;
+    return 1;
+}
+
+/**
+ * @brief Parses a priority given as 1-3 or by name (high, medium, low).
+ *
+ * @param text The word.
+ * @param priority Set to the parsed priority.
+ * @return 1 on success, 0 if the word is not a priority.
+ */
+static int batch_parsePriority(const char *text, Priority *priority) {
+    if (strcmp(text, "1") == 0 || strcmp(text, "high") == 0) *priority = PRIORITY_HIGH;
+    else if (strcmp(text, "2") == 0 || strcmp(text, "medium") == 0) *priority = PRIORITY_MEDIUM;
+    else if (strcmp(text, "3") == 0 || strcmp(text, "low") == 0) *priority = PRIORITY_LOW;
+    else return 0;
+    return 1;
+}
+
+/**
+ * @brief Parses a status given as 1-3 or by name (todo, doing, done).
+ *
+ * @param text The word.
+ * @param status Set to the parsed status.
+ * @return 1 on success, 0 if the word is not a status.
+ */
+static int batch_parseStatus(const char *text, Status *status) {
+    if (strcmp(text, "1") == 0 || strcmp(text, "todo") == 0) *status = STATUS_NOT_STARTED;
+    else if (strcmp(text, "2") == 0 || strcmp(text, "doing") == 0) *status = STATUS_IN_PROGRESS;
+    else if (strcmp(text, "3") == 0 || strcmp(text, "done") == 0) *status = STATUS_FINISHED;
+    else return 0;
+    return 1;
+}
+
+/**
+ * @brief Splits a key=value word.
+ *
+ * @param word The word (modified: the '=' is replaced by a terminator).
+ * @param value Set to the value part.
+ * @return 1 if the word has a '=', 0 otherwise.
+ */
+static int batch_splitPair(char *word, char **value) {
+    char *eq = strchr(word, '=');
+    if (!eq) return 0;
+    *eq = '\0';
+    *value = eq + 1;
+    return 1;
+}
+
+/**
+ * @brief Parses an optional trailing format word.
+ *
+ * @param argc Number of words.
+ * @param argv The words.
+ * @param index Position of the optional format word.
+ * @param format Set to the format (RENDER_TSV if the word is absent).
+ * @return 1 on success, 0 if the word is present but not a format.
+ */
+static int batch_parseFormat(int argc, char **argv, int index, RenderFormat *format) {
+    *format = RENDER_TSV;
+    return index >= argc || render_parseFormat(argv[index], format);
+}
+
+/**
+ * @brief Conditions of "update where" and "rm where"; a zero or NULL field matches any task.
+ */
+typedef struct BatchFilter {
+    Priority priority;
+    Status status;
+    const char *title;        // Substring of the title
+} BatchFilter;
+
+/**
+ * @brief Predicate for the bulk commands: checks a task against a BatchFilter.
+ *
+ * @param task Pointer to the Task.
+ * @param context Pointer to the BatchFilter.
+ * @return 1 if the task meets every condition.
+ */
+static int batch_matchFilter(const Task *task, void *context) {
+    const BatchFilter *filter = context;
+    return (!filter->priority || task->priority == filter->priority) &&
+           (!filter->status || task->status == filter->status) &&
+           (!filter->title || strstr(task->title, filter->title) != NULL);
+}
+
+/**
+ * @brief Parses the key=value conditions after "where", up to "set" or the end of the line.
+ *
+ * @param argc Number of words.
+ * @param argv The words.
+ * @param index Position of the first condition; set to the position of "set" or argc.
+ * @param filter Filled with the conditions.
+ * @return NULL on success, or an error message.
+ */
+static const char* batch_parseFilter(int argc, char **argv, int *index, BatchFilter *filter) {
+    memset(filter, 0, sizeof(*filter));
+    int first = *index;
+    for (; *index < argc && strcmp(argv[*index], "set") != 0; (*index)++) {
+        char *value;
+        if (!batch_splitPair(argv[*index], &value)) return "expected key=value";
+        if (strcmp(argv[*index], "prio") == 0) {
+            if (!batch_parsePriority(value, &filter->priority)) return "prio must be 1-3, high, medium or low";
+        } else if (strcmp(argv[*index], "status") == 0) {
+            if (!batch_parseStatus(value, &filter->status)) return "status must be 1-3, todo, doing or done";
+        } else if (strcmp(argv[*index], "title") == 0) {
+            filter->title = value;
+        } else {
+            return "unknown key";
+        }
+    }
+    return *index > first ? NULL : "missing condition after where";
+}
+
+/**
+ * @brief Handles "add key=value...".
+ *
+ * @param ctx Pointer to the batch context.
+ * @param argc Number of words (including the command).
+ * @param argv The words.
+ * @return NULL on success, or an error message.
+ */
+static const char* batch_add(BatchContext *ctx, int argc, char **argv) {
+    Task task = {0};
+    const char *description = "";
+    TaskPosition position = POS_END;
+    int target_id = 0, has_id = 0;
+    task.priority = PRIORITY_MEDIUM;
+    task.status = STATUS_NOT_STARTED;
+    task.created = batch_now(ctx);
+
+    for (int i = 1; i < argc; i++) {
+        char *value;
+        if (!batch_splitPair(argv[i], &value)) return "expected key=value";
+        if (strcmp(argv[i], "id") == 0) {
+            if (!batch_parseInt(value, &task.id)) return "id must be an integer";
+            has_id = 1;
+        } else if (strcmp(argv[i], "title") == 0) {
+            if (strlen(value) >= sizeof(task.title)) return "title too long";
+            strcpy(task.title, value);
+        } else if (strcmp(argv[i], "desc") == 0) {
+            if (strlen(value) > DESC_MAX) return "desc too long";
+            description = value;
+        } else if (strcmp(argv[i], "prio") == 0) {
+            if (!batch_parsePriority(value, &task.priority)) return "prio must be 1-3, high, medium or low";
+        } else if (strcmp(argv[i], "status") == 0) {
+            if (!batch_parseStatus(value, &task.status)) return "status must be 1-3, todo, doing or done";
+        } else if (strcmp(argv[i], "due") == 0) {
+            if (!deadline_parse(value, task.created, &task.due)) return BATCH_DUE_USAGE;
+        } else if (strcmp(argv[i], "at") == 0) {
+            if (strcmp(value, "head") == 0) position = POS_HEAD;
+            else if (strcmp(value, "end") == 0) position = POS_END;
+            else if (strncmp(value, "after:", 6) == 0 && batch_parseInt(value + 6, &target_id)) position = POS_MIDDLE;
+            else return "at must be head, end or after:ID";
+        } else {
+            return "unknown key";
+        }
+    }
+    if (!has_id) return "missing id";
+
+    Task *new_task = mem_alloc(MEM_TASK, sizeof(Task));
+    if (!new_task) return list_statusName(LIST_NO_MEMORY);
+    *new_task = task;
+    if (!task_setDescription(new_task, description)) {
+        mem_free(MEM_TASK, new_task, sizeof(Task));
+        return list_statusName(LIST_NO_MEMORY);
+    }
+    ListStatus status = list_insertTask(ctx->head, new_task, position, target_id, ctx->stack,
+                                        ctx->id_tree, ctx->priority_tree, ctx->status_tree);
+    if (status != LIST_OK) {
+        task_free(new_task);
+        return status == LIST_NOT_FOUND ? "no task to insert after" : list_statusName(status);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Handles "rm ID", "rm head", "rm end" and "rm where key=value...".
+ *
+ * "rm where" prints the number of tasks removed.
+ *
+ * @param ctx Pointer to the batch context.
+ * @param argc Number of words (including the command).
+ * @param argv The words.
+ * @return NULL on success, or an error message.
+ */
+static const char* batch_remove(BatchContext *ctx, int argc, char **argv) {
+    int id;
+    ListStatus status;
+    if (argc >= 2 && strcmp(argv[1], "where") == 0) {
+        BatchFilter filter;
+        int index = 2;
+        long removed;
+        const char *error = batch_parseFilter(argc, argv, &index, &filter);
+        if (error) return error;
+        if (index < argc) return "usage: rm where key=value...";
+        status = list_removeWhere(ctx->head, batch_matchFilter, &filter, ctx->stack, &removed,
+                                  ctx->id_tree, ctx->priority_tree, ctx->status_tree);
+        if (status != LIST_OK) return list_statusName(status);
+        fprintf(ctx->out, "%ld\n", removed);
+        return NULL;
+    }
+    if (argc != 2) return "usage: rm ID|head|end";
+    if (strcmp(argv[1], "head") == 0 || strcmp(argv[1], "end") == 0) {
+        status = list_removeEdge(ctx->head, argv[1][0] == 'h' ? POS_HEAD : POS_END, ctx->stack,
+                                 ctx->id_tree, ctx->priority_tree, ctx->status_tree);
+    } else if (batch_parseInt(argv[1], &id)) {
+        status = list_removeTask(ctx->head, id, ctx->stack, ctx->id_tree, ctx->priority_tree, ctx->status_tree);
+    } else {
+        return "usage: rm ID|head|end";
+    }
+    return status == LIST_OK ? NULL : list_statusName(status);
+}
+
+/**
+ * @brief Handles "update where key=value... set prio=... status=...".
+ *
+ * @param ctx Pointer to the batch context.
+ * @param argc Number of words (including the command).
+ * @param argv The words.
+ * @return NULL on success, or an error message.
+ */
+static const char* batch_updateWhere(BatchContext *ctx, int argc, char **argv) {
+    BatchFilter filter;
+    Priority priority = 0;
+    Status status = 0;
+    int index = 2;
+    long changed;
+    const char *error = batch_parseFilter(argc, argv, &index, &filter);
+    if (error) return error;
+    if (index + 1 >= argc) return "usage: update where key=value... set prio=P status=S";
+
+    for (index++; index < argc; index++) {
+        char *value;
+        if (!batch_splitPair(argv[index], &value)) return "expected key=value";
+        if (strcmp(argv[index], "prio") == 0) {
+            if (!batch_parsePriority(value, &priority)) return "prio must be 1-3, high, medium or low";
+        } else if (strcmp(argv[index], "status") == 0) {
+            if (!batch_parseStatus(value, &status)) return "status must be 1-3, todo, doing or done";
+        } else {
+            return "unknown key";
+        }
+    }
+    ListStatus result = list_updateWhere(*ctx->head, batch_matchFilter, &filter, priority, status, ctx->stack,
+                                         &changed, ctx->id_tree, ctx->priority_tree, ctx->status_tree);
+    if (result != LIST_OK) return list_statusName(result);
+    fprintf(ctx->out, "%ld\n", changed);
+    return NULL;
+}
+
+/**
+ * @brief Handles "update ID prio=... status=..." and "update where key=value... set key=value...".
+ *
+ * "update where" prints the number of tasks changed.
+ *
+ * @param ctx Pointer to the batch context.
+ * @param argc Number of words (including the command).
+ * @param argv The words.
+ * @return NULL on success, or an error message.
+ */
+static const char* batch_update(BatchContext *ctx, int argc, char **argv) {
+    int id;
+    if (argc >= 2 && strcmp(argv[1], "where") == 0) return batch_updateWhere(ctx, argc, argv);
+    if (argc < 3 || !batch_parseInt(argv[1], &id)) return "usage: update ID prio=P status=S due=D";
+    Task *task = list_findTask(*ctx->head, id);
+    if (!task) return list_statusName(LIST_NOT_FOUND);
+
+    Priority priority = task->priority;
+    Status status = task->status;
+    unsigned int due = task->due;
+    for (int i = 2; i < argc; i++) {
+        char *value;
+        if (!batch_splitPair(argv[i], &value)) return "expected key=value";
+        if (strcmp(argv[i], "prio") == 0) {
+            if (!batch_parsePriority(value, &priority)) return "prio must be 1-3, high, medium or low";
+        } else if (strcmp(argv[i], "status") == 0) {
+            if (!batch_parseStatus(value, &status)) return "status must be 1-3, todo, doing or done";
+        } else if (strcmp(argv[i], "due") == 0) {
+            if (!deadline_parse(value, batch_now(ctx), &due)) return BATCH_DUE_USAGE;
+        } else {
+            return "unknown key";
+        }
+    }
+    // Both changes undo as one step
+    list_setTaskFieldsDue(*ctx->head, id, priority, status, due, ctx->stack, ctx->priority_tree, ctx->status_tree);
+    return NULL;
+}
+
+/**
+ * @brief State of a "list all" walk through one project.
+ */
+typedef struct BatchProjectWalk {
+    const char *name;         // Name of the project
+    RenderFormat format;
+    int active;               // The tasks come from the list, not from a file
+    long count;               // Tasks rendered so far
+} BatchProjectWalk;
+
+/**
+ * @brief Renders one task of a project (a ProjectTaskFn for project_scan()).
+ *
+ * @param task Pointer to the Task.
+ * @param context Pointer to the BatchProjectWalk.
+ * @return 1 to continue.
+ */
+static int batch_renderProjectTask(const Task *task, void *context) {
+    BatchProjectWalk *walk = context;
+    if (walk->format == RENDER_TSV) {
+        render_text(walk->name);
+        render_text("\t");
+    }
+    if (walk->active) render_task(task, walk->format, ++walk->count);
+    else render_storedTask(task, walk->format, ++walk->count);
+    return 1;
+}
+
+/**
+ * @brief Runs "list all [format]": the tasks of every project, project by project.
+ *
+ * Inactive projects are streamed from their files, not loaded. In tsv each line
+ * starts with the project name; the other formats put a header above each project.
+ *
+ * @param ctx Pointer to the batch context.
+ * @param argc Number of words (including the command).
+ * @param argv The words.
+ * @return NULL on success, or an error message.
+ */
+static const char* batch_listAll(BatchContext *ctx, int argc, char **argv) {
+    RenderFormat format;
+    if (argc > 3 || !batch_parseFormat(argc, argv, 2, &format)) return "usage: list all [plain|compact|tsv]";
+    render_begin(ctx->out);
+    for (int i = 0; i < project_count(); i++) {
+        BatchProjectWalk walk = { project_name(i), format, i == project_activeIndex(), 0 };
+        if (format != RENDER_TSV) {
+            render_text(format == RENDER_PLAIN ? "\n> Project " : "> Project ");
+            render_text(walk.name);
+            render_text(walk.active ? " (active)\n" : "\n");
+        }
+        project_scan(i, *ctx->head, batch_renderProjectTask, &walk);
+    }
+    render_end();
+    return NULL;
+}
+
+/**
+ * @brief Runs a project command: "project" prints the active project, "project NAME"
+ * switches to it (creating it if new) and "projects" lists the projects.
+ *
+ * The listing has one line per project: name, number of tasks, and "active",
+ * "parked" (undo history kept in memory) or "-".
+ *
+ * @param ctx Pointer to the batch context.
+ * @param argc Number of words (including the command).
+ * @param argv The words.
+ * @return NULL on success, or an error message.
+ */
+static const char* batch_project(BatchContext *ctx, int argc, char **argv) {
+    if (strcmp(argv[0], "projects") == 0) {
+        if (argc > 1) return "usage: projects";
+        for (int i = 0; i < project_count(); i++) {
+            const char *state = i == project_activeIndex() ? "active" : (project_isParked(i) ? "parked" : "-");
+            fprintf(ctx->out, "%s\t%d\t%s\n", project_name(i), project_taskCount(i), state);
+        }
+        return NULL;
+    }
+    if (argc > 2) return "usage: project [NAME]";
+    if (argc == 1) {
+        fprintf(ctx->out, "%s\n", project_active());
+        return NULL;
+    }
+    ProjectStatus status = project_switch(argv[1], ctx->head, ctx->stack,
+                                          ctx->id_tree, ctx->priority_tree, ctx->status_tree);
+    return status == PROJECT_OK ? NULL : project_statusName(status);
+}
+
+/**
+ * @brief Handles the query commands: get, list, sorted, export, count and stats.
+ *
+ * Listings take an optional format (plain, compact or tsv; tsv by default).
+ * "stats ops" prints the per-operation metrics (see metrics_print()), and
+ * "stats ops reset" then sets them back to zero. "stats mem" prints the memory
+ * used by each subsystem, with the bytes per task (see mem_print()).
+ *
+ * @param ctx Pointer to the batch context.
+ * @param argc Number of words (including the command).
+ * @param argv The words.
+ * @return NULL on success, or an error message.
+ */
+static const char* batch_query(BatchContext *ctx, int argc, char **argv) {
+    RenderFormat format;
+    int id;
+    if (strcmp(argv[0], "get") == 0) {
+        if (argc < 2 || argc > 3 || !batch_parseInt(argv[1], &id) || !batch_parseFormat(argc, argv, 2, &format))
+            return "usage: get ID [plain|compact|tsv]";
+        Task *task = list_findTask(*ctx->head, id);
+        if (!task) return list_statusName(LIST_NOT_FOUND);
+        render_begin(ctx->out);
+        render_task(task, format, 0);
+        render_end();
+    } else if (strcmp(argv[0], "list") == 0) {
+        if (argc > 1 && strcmp(argv[1], "all") == 0) return batch_listAll(ctx, argc, argv);
+        if (argc > 2 || !batch_parseFormat(argc, argv, 1, &format)) return "usage: list [plain|compact|tsv]";
+        render_list(*ctx->head, ctx->out, format);
+    } else if (strcmp(argv[0], "export") == 0) {
+        if (argc < 2 || argc > 3 || !batch_parseFormat(argc, argv, 2, &format))
+            return "usage: export PATH [plain|compact|tsv]";
+        FILE *file = fopen(argv[1], "w");
+        if (!file) return "failed to open file";
+        render_list(*ctx->head, file, format);
+        if (fclose(file) != 0) return "failed to write file";
+    } else if (strcmp(argv[0], "sorted") == 0) {
+        Tree *tree;
+        if (argc < 2 || argc > 3 || !batch_parseFormat(argc, argv, 2, &format))
+            return "usage: sorted id|priority|status [plain|compact|tsv]";
+        if (strcmp(argv[1], "id") == 0) tree = ctx->id_tree;
+        else if (strcmp(argv[1], "priority") == 0) tree = ctx->priority_tree;
+        else if (strcmp(argv[1], "status") == 0) tree = ctx->status_tree;
+        else return "usage: sorted id|priority|status [plain|compact|tsv]";
+        list_syncIndexes(*ctx->head, ctx->id_tree, ctx->priority_tree, ctx->status_tree);
+        render_tree(tree, ctx->out, format);
+    } else if (strcmp(argv[0], "count") == 0) {
+        fprintf(ctx->out, "%d\n", listCounter_get());
+    } else if (argc == 2 && strcmp(argv[1], "mem") == 0) {
+        mem_print(ctx->out, 1, listCounter_get());
+    } else if (argc > 1) {
+        if (strcmp(argv[1], "ops") != 0 || argc > 3 || (argc == 3 && strcmp(argv[2], "reset") != 0))
+            return "usage: stats [ops [reset] | mem]";
+        metrics_print(ctx->out, 1);
+        if (argc == 3) metrics_reset();
+    } else {
+        TaskStats stats;
+        stats_get(&stats);
+        fprintf(ctx->out, "total\t%d\thigh\t%d\tmedium\t%d\tlow\t%d\ttodo\t%d\tdoing\t%d\tdone\t%d\n",
+                stats.total, stats.by_priority[0], stats.by_priority[1], stats.by_priority[2],
+                stats.by_status[0], stats.by_status[1], stats.by_status[2]);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Renders the tasks with the given IDs, in that order.
+ *
+ * @param ctx Pointer to the batch context.
+ * @param ids The task IDs (all in the list).
+ * @param count Number of IDs.
+ * @param format The output format.
+ */
+static void batch_renderIds(BatchContext *ctx, const int *ids, int count, RenderFormat format) {
+    render_begin(ctx->out);
+    for (int i = 0; i < count; i++) {
+        Task *task = list_findTask(*ctx->head, ids[i]);
+        if (task) render_task(task, format, i + 1);
+    }
+    render_end();
+}
+
+/**
+ * @brief Runs a dependency command (block, unblock, ready, order, blockers, critical).
+ *
+ * @param ctx Pointer to the batch context.
+ * @param argc Number of words (including the command).
+ * @param argv The words.
+ * @return NULL on success, or an error message.
+ */
+static const char* batch_deps(BatchContext *ctx, int argc, char **argv) {
+    RenderFormat format;
+    int blocker, blocked;
+
+    if (strcmp(argv[0], "block") == 0 || strcmp(argv[0], "unblock") == 0) {
+        if (argc != 3 || !batch_parseInt(argv[1], &blocker) || !batch_parseInt(argv[2], &blocked))
+            return argv[0][0] == 'b' ? "usage: block BLOCKER BLOCKED" : "usage: unblock BLOCKER BLOCKED";
+        DepsStatus status;
+        if (argv[0][0] == 'u') {
+            status = deps_removeEdge(blocker, blocked);
+        } else {
+            Task *from = list_findTask(*ctx->head, blocker);
+            Task *to = list_findTask(*ctx->head, blocked);
+            if (!from || !to) return list_statusName(LIST_NOT_FOUND);
+            status = deps_addEdge(from, to);
+        }
+        return status == DEPS_OK ? NULL : deps_statusName(status);
+    }
+
+    int index = strcmp(argv[0], "blockers") == 0 ? 2 : 1;
+    if (argc > index + 1 || (index == 2 && (argc < 2 || !batch_parseInt(argv[1], &blocked))) ||
+        !batch_parseFormat(argc, argv, index, &format))
+        return index == 2 ? "usage: blockers ID [plain|compact|tsv]" : "usage: ready|order|critical [plain|compact|tsv]";
+
+    // Every task in the list or in the graph fits
+    int capacity = listCounter_get() + deps_taskCount();
+    size_t size = (size_t)(capacity + 1) * sizeof(int);
+    int *ids = mem_alloc(MEM_SCRATCH, size);
+    if (!ids) return list_statusName(LIST_NO_MEMORY);
+    int count;
+    if (strcmp(argv[0], "ready") == 0) count = deps_ready(ids, capacity);
+    else if (strcmp(argv[0], "order") == 0) count = deps_order(ids, capacity);
+    else if (index == 2) count = deps_blockers(blocked, ids, capacity);
+    else count = deps_criticalPath(ids, capacity);
+    if (count >= 0) batch_renderIds(ctx, ids, count, format);
+    mem_free(MEM_SCRATCH, ids, size);
+    return count < 0 ? list_statusName(LIST_NO_MEMORY) : NULL;
+}
+
+/**
+ * @brief Handles "overdue [format]": brings the deadlines up to the current time and
+ * lists the unfinished tasks whose due date has passed.
+ *
+ * @param ctx Pointer to the batch context.
+ * @param argc Number of words (including the command).
+ * @param argv The words.
+ * @return NULL on success, or an error message.
+ */
+static const char* batch_overdue(BatchContext *ctx, int argc, char **argv) {
+    RenderFormat format;
+    if (argc > 2 || !batch_parseFormat(argc, argv, 1, &format)) return "usage: overdue [plain|compact|tsv]";
+    deadline_advance((unsigned int)time(NULL), NULL, NULL);
+
+    int count = deadline_overdueCount();
+    size_t size = (size_t)(count + 1) * sizeof(int);
+    int *ids = mem_alloc(MEM_SCRATCH, size);
+    if (!ids) return list_statusName(LIST_NO_MEMORY);
+    deadline_overdue(ids, count);
+    batch_renderIds(ctx, ids, count, format);
+    mem_free(MEM_SCRATCH, ids, size);
+    return NULL;
+}
+
+/**
+ * @brief Runs a tag command: "tag ID NAME...", "untag ID NAME...", "tags [ID]" and
+ * "select QUERY... [format]".
+ *
+ * "tags" prints each name of the dictionary with the number of tasks carrying it,
+ * "tags ID" the tags of one task, one per line. The words of a select query are
+ * joined with blanks, so it needs no quotes.
+ *
+ * @param ctx Pointer to the batch context.
+ * @param argc Number of words (including the command).
+ * @param argv The words.
+ * @return NULL on success, or an error message.
+ */
+static const char* batch_tags(BatchContext *ctx, int argc, char **argv) {
+    int id;
+    if (strcmp(argv[0], "tag") == 0 || strcmp(argv[0], "untag") == 0) {
+        if (argc < 3 || !batch_parseInt(argv[1], &id))
+            return argv[0][0] == 't' ? "usage: tag ID NAME..." : "usage: untag ID NAME...";
+        Task *task = list_findTask(*ctx->head, id);
+        if (!task) return list_statusName(LIST_NOT_FOUND);
+        for (int i = 2; i < argc; i++) {
+            TagsStatus status = argv[0][0] == 't' ? tags_add(task, argv[i]) : tags_remove(id, argv[i]);
+            if (status != TAGS_OK) return tags_statusName(status);
+        }
+        return NULL;
+    }
+
+    if (strcmp(argv[0], "tags") == 0) {
+        if (argc > 2 || (argc == 2 && !batch_parseInt(argv[1], &id))) return "usage: tags [ID]";
+        if (argc == 2) {
+            const char *names[64];
+            int count = tags_ofTask(id, names, 64);
+            for (int i = 0; i < count && i < 64; i++) fprintf(ctx->out, "%s\n", names[i]);
+            return NULL;
+        }
+        for (int i = 0; i < tags_nameCount(); i++) {
+            long tasks;
+            const char *name = tags_name(i, &tasks);
+            if (tasks > 0) fprintf(ctx->out, "%s\t%ld\n", name, tasks);
+        }
+        return NULL;
+    }
+
+    RenderFormat format = RENDER_TSV;
+    int words = argc;
+    if (argc > 2 && render_parseFormat(argv[argc - 1], &format)) words--;
+    if (words < 2) return "usage: select QUERY [plain|compact|tsv]";
+    char query[BATCH_LINE_MAX];
+    size_t length = 0;
+    for (int i = 1; i < words; i++) {
+        length += (size_t)snprintf(query + length, sizeof(query) - length, i > 1 ? " %s" : "%s", argv[i]);
+        if (length >= sizeof(query)) return "query too long";
+    }
+
+    size_t size = (size_t)(listCounter_get() + 1) * sizeof(int);
+    int *ids = mem_alloc(MEM_SCRATCH, size);
+    if (!ids) return list_statusName(LIST_NO_MEMORY);
+    int count, error_at;
+    TagsStatus status = tags_select(query, ids, listCounter_get(), &count, &error_at);
+    if (status == TAGS_OK) batch_renderIds(ctx, ids, count, format);
+    mem_free(MEM_SCRATCH, ids, size);
+    if (status == TAGS_SYNTAX) {
+        static char message[BATCH_ERROR_MAX];
+        if (query[error_at] == '\0') return "syntax error at end of query";
+        snprintf(message, sizeof(message), "syntax error at \"%.40s\"", query + error_at);
+        return message;
+    }
+    return status == TAGS_OK ? NULL : tags_statusName(status);
+}
+
+/**
+ * @brief Tells what a command does to the list.
+ *
+ * @param cmd The command word.
+ * @param has_args Whether the command has arguments.
+ * @return The effect of the command.
+ */
+static BatchEffect batch_commandEffect(const char *cmd, int has_args) {
+    if (strcmp(cmd, "add") == 0 || strcmp(cmd, "rm") == 0 || strcmp(cmd, "update") == 0 ||
+        strcmp(cmd, "block") == 0 || strcmp(cmd, "unblock") == 0 || strcmp(cmd, "tag") == 0 ||
+        strcmp(cmd, "untag") == 0 || strcmp(cmd, "clear") == 0)
+        return BATCH_WRITES;
+    if (strcmp(cmd, "undo") == 0 || strcmp(cmd, "redo") == 0 || strcmp(cmd, "load") == 0 ||
+        (strcmp(cmd, "project") == 0 && has_args))
+        return BATCH_REPLACES;
+    if (strcmp(cmd, "begin") == 0 || strcmp(cmd, "commit") == 0 || strcmp(cmd, "rollback") == 0 ||
+        strcmp(cmd, "save") == 0)
+        return BATCH_CONTROLS;
+    return BATCH_READS;
+}
+
+/**
+ * @brief Tells what the command of a line does to the list, without running it.
+ *
+ * @param line The command line.
+ * @return The effect of its command.
+ */
+BatchEffect batch_effect(const char *line) {
+    char cmd[16];
+    size_t length = 0;
+    while (*line == ' ' || *line == '\t') line++;
+    while (*line && *line != ' ' && *line != '\t' && *line != '\r' && *line != '\n') {
+        if (length == sizeof(cmd) - 1) return BATCH_READS;   // Longer than any command
+        cmd[length++] = *line++;
+    }
+    cmd[length] = '\0';
+    while (*line == ' ' || *line == '\t' || *line == '\r' || *line == '\n') line++;
+    return batch_commandEffect(cmd, *line != '\0');
+}
+
+/**
+ * @brief Executes one split command line.
+ *
+ * @param ctx Pointer to the batch context.
+ * @param argc Number of words.
+ * @param argv The words.
+ * @return NULL on success, or an error message.
+ */
+static const char* batch_execute(BatchContext *ctx, int argc, char **argv) {
+    const char *cmd = argv[0];
+    ListStatus status;
+    int count;
+
+    if (ctx->read_only && batch_commandEffect(cmd, argc > 1) != BATCH_READS) return "read-only replica";
+
+    if (strcmp(cmd, "add") == 0) return batch_add(ctx, argc, argv);
+    if (strcmp(cmd, "rm") == 0) return batch_remove(ctx, argc, argv);
+    if (strcmp(cmd, "update") == 0) return batch_update(ctx, argc, argv);
+    if (strcmp(cmd, "get") == 0 || strcmp(cmd, "list") == 0 || strcmp(cmd, "sorted") == 0 ||
+        strcmp(cmd, "export") == 0 || strcmp(cmd, "count") == 0 || strcmp(cmd, "stats") == 0)
+        return batch_query(ctx, argc, argv);
+    if (strcmp(cmd, "block") == 0 || strcmp(cmd, "unblock") == 0 || strcmp(cmd, "ready") == 0 ||
+        strcmp(cmd, "order") == 0 || strcmp(cmd, "blockers") == 0 || strcmp(cmd, "critical") == 0)
+        return batch_deps(ctx, argc, argv);
+    if (strcmp(cmd, "overdue") == 0) return batch_overdue(ctx, argc, argv);
+    if (strcmp(cmd, "tag") == 0 || strcmp(cmd, "untag") == 0 || strcmp(cmd, "tags") == 0 ||
+        strcmp(cmd, "select") == 0)
+        return batch_tags(ctx, argc, argv);
+    if (strcmp(cmd, "project") == 0 || strcmp(cmd, "projects") == 0) return batch_project(ctx, argc, argv);
+
+    if (strcmp(cmd, "undo") == 0) {
+        status = list_undoStep(ctx->head, ctx->stack, ctx->id_tree, ctx->priority_tree, ctx->status_tree);
+        return status == LIST_EMPTY ? "nothing to undo" : (status == LIST_OK ? NULL : list_statusName(status));
+    }
+    if (strcmp(cmd, "redo") == 0) {
+        status = list_redoStep(ctx->head, ctx->stack, ctx->id_tree, ctx->priority_tree, ctx->status_tree);
+        return status == LIST_EMPTY ? "nothing to redo" : (status == LIST_OK ? NULL : list_statusName(status));
+    }
+    if (strcmp(cmd, "begin") == 0) {
+        return list_txnBegin() == LIST_OK ? NULL : "a transaction is already open";
+    }
+    if (strcmp(cmd, "commit") == 0) {
+        status = list_txnCommit(*ctx->head, ctx->id_tree, ctx->priority_tree, ctx->status_tree);
+        return status == LIST_OK ? NULL : "no transaction is open";
+    }
+    if (strcmp(cmd, "rollback") == 0) {
+        status = list_txnRollback(ctx->head, ctx->stack, NULL, ctx->id_tree, ctx->priority_tree, ctx->status_tree);
+        if (status == LIST_BAD_STATE) return "no transaction is open";
+        return status == LIST_OK ? NULL : "cannot roll back (undo history incomplete), changes kept";
+    }
+    if (strcmp(cmd, "clear") == 0) {
+        list_clear(ctx->head, ctx->stack, ctx->id_tree, ctx->priority_tree, ctx->status_tree);
+        return NULL;
+    }
+    if (strcmp(cmd, "save") == 0) {
+        if (argc > 2) return "usage: save [path]";
+        if (file_writeTasks(*ctx->head, argc == 2 ? argv[1] : project_storePath()) < 0) return "failed to write file";
+        if (argc == 1) project_bind();
+        return NULL;
+    }
+    if (strcmp(cmd, "load") == 0) {
+        if (argc > 2) return "usage: load [path]";
+        count = file_readTasks(argc == 2 ? argv[1] : project_storePath(), ctx->head, ctx->stack,
+                               ctx->id_tree, ctx->priority_tree, ctx->status_tree, NULL);
+        if (count < 0) return "failed to read file";
+        if (argc == 1) project_bind();
+        return NULL;
+    }
+    return "unknown command";
+}
+
+/**
+ * @brief Splits and executes one command line.
+ *
+ * @param ctx Pointer to the batch context.
+ * @param line The command line (modified).
+ * @return Outcome of the line.
+ */
+static BatchResult batch_runLine(BatchContext *ctx, char *line) {
+    char *argv[BATCH_MAX_ARGS];
+    int argc = batch_split(line, argv, BATCH_MAX_ARGS);
+    if (argc < 0) {
+        snprintf(ctx->error, sizeof(ctx->error), "unterminated quote or too many words");
+        return BATCH_MALFORMED;
+    }
+    if (argc == 0 || argv[0][0] == '#') return BATCH_SKIPPED;
+
+    const char *error = batch_execute(ctx, argc, argv);
+    if (!error) return BATCH_OK;
+    snprintf(ctx->error, sizeof(ctx->error), "%s: %s", argv[0], error);
+    return BATCH_FAILED;
+}
+
+/**
+ * @brief Executes one command line.
+ *
+ * Query results are written to ctx->out. The caller is responsible for deferring
+ * BST maintenance around a series of lines if it wants to (see list_deferIndexes()).
+ * Commands are recorded to the trace file while one is open (see trace_open()).
+ *
+ * @param ctx Pointer to the context (head, stack, trees and output stream set).
+ * @param line The command line, with or without its newline (modified).
+ * @return Outcome of the line.
+ */
+BatchResult batch_executeLine(BatchContext *ctx, char *line) {
+    char original[BATCH_LINE_MAX];
+    if (!trace_isRecording()) return batch_runLine(ctx, line);
+
+    snprintf(original, sizeof(original), "%.*s", (int)strcspn(line, "\r\n"), line);
+    long long start = trace_clock();
+    BatchResult result = batch_runLine(ctx, line);
+    if (result == BATCH_OK || result == BATCH_FAILED) trace_record(start, result == BATCH_OK, "%s", original);
+    return result;
+}
+
+/**
+ * @brief Runs a non-interactive command script against the list.
+ *
+ * Reads one command per line, with no prompts, screen clears or animations.
+ * Query results go to stdout (tab-separated by default); errors go to stderr as
+ * "name:line: message" and do not stop the run. BST maintenance is deferred for
+ * the whole run and done once at the end.
+ *
+ * @param in Stream to read commands from.
+ * @param name Name of the stream, used in error messages.
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return Number of commands that failed.
+ */
+int batch_run(FILE *in, const char *name, List **head, Stack *stack,
+              Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    BatchContext ctx = { head, stack, id_tree, priority_tree, status_tree, stdout, "", 0, 0 };
+    char line[BATCH_LINE_MAX];
+    long line_no = 0, commands = 0;
+    int errors = 0;
+    clock_t start = clock();
+
+    list_deferIndexes();
+    while (fgets(line, sizeof(line), in)) {
+        line_no++;
+        size_t len = strlen(line);
+        if (len == sizeof(line) - 1 && line[len - 1] != '\n' && !feof(in)) {
+            // Skip the rest of an overlong line
+            int c;
+            while ((c = fgetc(in)) != EOF && c != '\n') {}
+            fprintf(stderr, "%s:%ld: line too long\n", name, line_no);
+            errors++;
+            continue;
+        }
+
+        BatchResult result = batch_executeLine(&ctx, line);
+        if (result == BATCH_OK || result == BATCH_FAILED) commands++;
+        if (result == BATCH_FAILED || result == BATCH_MALFORMED) {
+            fprintf(stderr, "%s:%ld: %s\n", name, line_no, ctx.error);
+            errors++;
+        }
+        metrics_tick();
+    }
+
+    if (list_inTransaction()) {
+        fprintf(stderr, "%s: transaction left open at end of input, rolled back\n", name);
+        list_txnRollback(head, stack, NULL, id_tree, priority_tree, status_tree);
+        errors++;
+    }
+    list_resumeIndexes(*head, id_tree, priority_tree, status_tree);
+    fflush(stdout);
+
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    fprintf(stderr, "%s: %ld commands, %d failed, %.3f s", name, commands, errors, seconds);
+    if (seconds > 0) fprintf(stderr, " (%.0f commands/s)", commands / seconds);
+    fprintf(stderr, "\n");
+    return errors;
+}
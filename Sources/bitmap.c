@@ -0,0 +1,651 @@
+#include <stdlib.h>
+#include <string.h>
+#include "bitmap.h"
+#include "mem.h"
+
+#define BITMAP_WORDS 1024   // 64-bit words in a bitset container
+
+/**
+ * @brief Counts the set bits of a word.
+ *
+ * @param word The word.
+ * @return Number of bits set.
+ */
+static int bitmap_popcount(uint64_t word) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ull);
+    word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+    word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return (int)((word * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/**
+ * @brief Returns the position of the lowest set bit of a nonzero word.
+ *
+ * @param word The word.
+ * @return Bit index in [0, 63].
+ */
+static int bitmap_lowestBit(uint64_t word) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+/**
+ * @brief Counts the set bits of a bitset container's words.
+ *
+ * @param words The 1024 words.
+ * @return Number of bits set.
+ */
+static int bitmap_countWords(const uint64_t *words) {
+    int count = 0;
+    for (int i = 0; i < BITMAP_WORDS; i++) count += bitmap_popcount(words[i]);
+    return count;
+}
+
+/**
+ * @brief Frees the storage of a container.
+ *
+ * @param c Pointer to the container.
+ */
+static void bitmap_freeContainer(BitmapContainer *c) {
+    mem_free(MEM_TAGS, c->values, (size_t)c->capacity * sizeof(uint16_t));
+    mem_free(MEM_TAGS, c->words, BITMAP_WORDS * sizeof(uint64_t));
+    c->values = NULL;
+    c->words = NULL;
+    c->count = 0;
+    c->capacity = 0;
+}
+
+/**
+ * @brief Finds the first entry of a sorted array not below a value.
+ *
+ * @param values The sorted array.
+ * @param from First position to consider.
+ * @param count Length of the array.
+ * @param value The value to look for.
+ * @return Position of value, or where it would be inserted.
+ */
+static int bitmap_search(const uint16_t *values, int from, int count, uint16_t value) {
+    int low = from, high = count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (values[mid] < value) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+/**
+ * @brief Finds the container for a key.
+ *
+ * @param bitmap Pointer to the bitmap.
+ * @param key High 16 bits of a value.
+ * @return Position of the container, or where it would be inserted.
+ */
+static int bitmap_findContainer(const Bitmap *bitmap, uint16_t key) {
+    int low = 0, high = bitmap->count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (bitmap->containers[mid].key < key) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+/**
+ * @brief Turns an array container into a bitset container.
+ *
+ * @param c Pointer to the container.
+ * @return 1 on success, 0 on allocation failure (container unchanged).
+ */
+static int bitmap_toBitset(BitmapContainer *c) {
+    uint64_t *words = mem_calloc(MEM_TAGS, BITMAP_WORDS, sizeof(uint64_t));
+    if (!words) return 0;
+    for (int i = 0; i < c->count; i++) words[c->values[i] >> 6] |= 1ull << (c->values[i] & 63);
+    mem_free(MEM_TAGS, c->values, (size_t)c->capacity * sizeof(uint16_t));
+    c->values = NULL;
+    c->capacity = 0;
+    c->words = words;
+    return 1;
+}
+
+/**
+ * @brief Turns a bitset container small enough for an array into one.
+ *
+ * Keeps the bitset if the array cannot be allocated; both forms are valid.
+ *
+ * @param c Pointer to the container.
+ */
+static void bitmap_shrink(BitmapContainer *c) {
+    if (!c->words || c->count > BITMAP_ARRAY_MAX) return;
+    int capacity = c->count ? c->count : 1;
+    uint16_t *values = mem_alloc(MEM_TAGS, capacity * sizeof(uint16_t));
+    if (!values) return;
+    int n = 0;
+    for (int i = 0; i < BITMAP_WORDS; i++) {
+        for (uint64_t word = c->words[i]; word; word &= word - 1)
+            values[n++] = (uint16_t)(i * 64 + bitmap_lowestBit(word));
+    }
+    mem_free(MEM_TAGS, c->words, BITMAP_WORDS * sizeof(uint64_t));
+    c->words = NULL;
+    c->values = values;
+    c->capacity = capacity;
+}
+
+/**
+ * @brief Appends a container to a result bitmap, taking ownership of its storage.
+ *
+ * Empty containers are freed instead.
+ *
+ * @param out Pointer to the result bitmap (containers appended in key order).
+ * @param c Pointer to the container.
+ * @return 1 on success, 0 on allocation failure (the container is freed).
+ */
+static int bitmap_append(Bitmap *out, BitmapContainer *c) {
+    if (c->count == 0) {
+        bitmap_freeContainer(c);
+        return 1;
+    }
+    if (out->count == out->capacity) {
+        int capacity = out->capacity ? out->capacity * 2 : 4;
+        BitmapContainer *containers = mem_realloc(MEM_TAGS, out->containers,
+                                                  (size_t)out->capacity * sizeof(BitmapContainer),
+                                                  capacity * sizeof(BitmapContainer));
+        if (!containers) {
+            bitmap_freeContainer(c);
+            return 0;
+        }
+        out->containers = containers;
+        out->capacity = capacity;
+    }
+    out->containers[out->count++] = *c;
+    return 1;
+}
+
+/**
+ * @brief Initializes an empty bitmap. No memory is allocated until the first insertion.
+ *
+ * @param bitmap Pointer to the bitmap.
+ */
+void bitmap_init(Bitmap *bitmap) {
+    bitmap->containers = NULL;
+    bitmap->count = 0;
+    bitmap->capacity = 0;
+}
+
+/**
+ * @brief Frees the containers and resets the bitmap to empty.
+ *
+ * @param bitmap Pointer to the bitmap.
+ */
+void bitmap_free(Bitmap *bitmap) {
+    for (int i = 0; i < bitmap->count; i++) bitmap_freeContainer(&bitmap->containers[i]);
+    mem_free(MEM_TAGS, bitmap->containers, (size_t)bitmap->capacity * sizeof(BitmapContainer));
+    bitmap_init(bitmap);
+}
+
+/**
+ * @brief Adds a value.
+ *
+ * @param bitmap Pointer to the bitmap.
+ * @param value The value.
+ * @return 1 on success (including a value already present), 0 on allocation failure.
+ */
+int bitmap_add(Bitmap *bitmap, uint32_t value) {
+    uint16_t key = (uint16_t)(value >> 16), low = (uint16_t)value;
+    int pos = bitmap_findContainer(bitmap, key);
+
+    if (pos == bitmap->count || bitmap->containers[pos].key != key) {
+        if (bitmap->count == bitmap->capacity) {
+            int capacity = bitmap->capacity ? bitmap->capacity * 2 : 4;
+            BitmapContainer *containers = mem_realloc(MEM_TAGS, bitmap->containers,
+                                                      (size_t)bitmap->capacity * sizeof(BitmapContainer),
+                                                      capacity * sizeof(BitmapContainer));
+            if (!containers) return 0;
+            bitmap->containers = containers;
+            bitmap->capacity = capacity;
+        }
+        uint16_t *values = mem_alloc(MEM_TAGS, 4 * sizeof(uint16_t));
+        if (!values) return 0;
+        memmove(&bitmap->containers[pos + 1], &bitmap->containers[pos],
+                (bitmap->count - pos) * sizeof(BitmapContainer));
+        bitmap->count++;
+        BitmapContainer *c = &bitmap->containers[pos];
+        c->values = values;
+        c->words = NULL;
+        c->values[0] = low;
+        c->count = 1;
+        c->capacity = 4;
+        c->key = key;
+        return 1;
+    }
+
+    BitmapContainer *c = &bitmap->containers[pos];
+    if (!c->words) {
+        int at = bitmap_search(c->values, 0, c->count, low);
+        if (at < c->count && c->values[at] == low) return 1;
+        if (c->count == BITMAP_ARRAY_MAX) {
+            if (!bitmap_toBitset(c)) return 0;
+        } else {
+            if (c->count == c->capacity) {
+                int capacity = c->capacity * 2 > BITMAP_ARRAY_MAX ? BITMAP_ARRAY_MAX : c->capacity * 2;
+                uint16_t *values = mem_realloc(MEM_TAGS, c->values, (size_t)c->capacity * sizeof(uint16_t),
+                                               capacity * sizeof(uint16_t));
+                if (!values) return 0;
+                c->values = values;
+                c->capacity = capacity;
+            }
+            memmove(&c->values[at + 1], &c->values[at], (c->count - at) * sizeof(uint16_t));
+            c->values[at] = low;
+            c->count++;
+            return 1;
+        }
+    }
+    uint64_t bit = 1ull << (low & 63);
+    if (!(c->words[low >> 6] & bit)) {
+        c->words[low >> 6] |= bit;
+        c->count++;
+    }
+    return 1;
+}
+
+/**
+ * @brief Removes a value, if present.
+ *
+ * A bitset container that falls to half the array limit becomes an array again;
+ * the gap keeps a container near the limit from switching back and forth.
+ *
+ * @param bitmap Pointer to the bitmap.
+ * @param value The value.
+ */
+void bitmap_remove(Bitmap *bitmap, uint32_t value) {
+    uint16_t key = (uint16_t)(value >> 16), low = (uint16_t)value;
+    int pos = bitmap_findContainer(bitmap, key);
+    if (pos == bitmap->count || bitmap->containers[pos].key != key) return;
+
+    BitmapContainer *c = &bitmap->containers[pos];
+    if (c->words) {
+        uint64_t bit = 1ull << (low & 63);
+        if (!(c->words[low >> 6] & bit)) return;
+        c->words[low >> 6] &= ~bit;
+        c->count--;
+        if (c->count <= BITMAP_ARRAY_MAX / 2) bitmap_shrink(c);
+    } else {
+        int at = bitmap_search(c->values, 0, c->count, low);
+        if (at == c->count || c->values[at] != low) return;
+        memmove(&c->values[at], &c->values[at + 1], (c->count - at - 1) * sizeof(uint16_t));
+        c->count--;
+    }
+
+    if (c->count == 0) {
+        bitmap_freeContainer(c);
+        memmove(&bitmap->containers[pos], &bitmap->containers[pos + 1],
+                (bitmap->count - pos - 1) * sizeof(BitmapContainer));
+        bitmap->count--;
+    }
+}
+
+/**
+ * @brief Checks whether a value is in the bitmap.
+ *
+ * @param bitmap Pointer to the bitmap.
+ * @param value The value.
+ * @return 1 if present, 0 otherwise.
+ */
+int bitmap_contains(const Bitmap *bitmap, uint32_t value) {
+    uint16_t key = (uint16_t)(value >> 16), low = (uint16_t)value;
+    int pos = bitmap_findContainer(bitmap, key);
+    if (pos == bitmap->count || bitmap->containers[pos].key != key) return 0;
+
+    const BitmapContainer *c = &bitmap->containers[pos];
+    if (c->words) return (c->words[low >> 6] >> (low & 63)) & 1;
+    int at = bitmap_search(c->values, 0, c->count, low);
+    return at < c->count && c->values[at] == low;
+}
+
+/**
+ * @brief Returns the number of values in the bitmap.
+ *
+ * @param bitmap Pointer to the bitmap.
+ * @return Number of values.
+ */
+long bitmap_cardinality(const Bitmap *bitmap) {
+    long total = 0;
+    for (int i = 0; i < bitmap->count; i++) total += bitmap->containers[i].count;
+    return total;
+}
+
+/**
+ * @brief Copies a container.
+ *
+ * @param r Pointer to the container receiving the copy.
+ * @param a Pointer to the container to copy.
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int bitmap_copyContainer(BitmapContainer *r, const BitmapContainer *a) {
+    *r = *a;
+    if (a->words) {
+        r->words = mem_alloc(MEM_TAGS, BITMAP_WORDS * sizeof(uint64_t));
+        if (!r->words) return 0;
+        memcpy(r->words, a->words, BITMAP_WORDS * sizeof(uint64_t));
+    } else {
+        r->values = mem_alloc(MEM_TAGS, a->count * sizeof(uint16_t));
+        if (!r->values) return 0;
+        memcpy(r->values, a->values, a->count * sizeof(uint16_t));
+        r->capacity = a->count;
+    }
+    return 1;
+}
+
+/**
+ * @brief Intersects two sorted arrays.
+ *
+ * When one side is much shorter, each of its values is looked up in the other by
+ * binary search from the previous match, instead of merging the two.
+ *
+ * @param a The first array.
+ * @param na Its length.
+ * @param b The second array.
+ * @param nb Its length.
+ * @param out Array receiving the common values (room for the shorter side).
+ * @return Number of values written.
+ */
+static int bitmap_intersectArrays(const uint16_t *a, int na, const uint16_t *b, int nb, uint16_t *out) {
+    int n = 0;
+    if (na > nb) {
+        const uint16_t *t = a; a = b; b = t;
+        int tn = na; na = nb; nb = tn;
+    }
+    if (na * 32 < nb) {
+        int from = 0;
+        for (int i = 0; i < na && from < nb; i++) {
+            from = bitmap_search(b, from, nb, a[i]);
+            if (from < nb && b[from] == a[i]) out[n++] = a[i];
+        }
+        return n;
+    }
+    int i = 0, j = 0;
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) i++;
+        else if (a[i] > b[j]) j++;
+        else {
+            out[n++] = a[i];
+            i++;
+            j++;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Combines the words of two bitset containers into a new one.
+ *
+ * The word loop has a fixed trip count and no branches, so the compiler turns it
+ * into vector instructions; the bits are counted in a second pass.
+ *
+ * @param r Pointer to the container receiving the result.
+ * @param a Words of the first container.
+ * @param b Words of the second container.
+ * @param op 0 for AND, 1 for AND NOT, 2 for OR.
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int bitmap_combineWords(BitmapContainer *r, const uint64_t *restrict a, const uint64_t *restrict b, int op) {
+    uint64_t *restrict words = mem_alloc(MEM_TAGS, BITMAP_WORDS * sizeof(uint64_t));
+    if (!words) return 0;
+    if (op == 0) {
+        for (int i = 0; i < BITMAP_WORDS; i++) words[i] = a[i] & b[i];
+    } else if (op == 1) {
+        for (int i = 0; i < BITMAP_WORDS; i++) words[i] = a[i] & ~b[i];
+    } else {
+        for (int i = 0; i < BITMAP_WORDS; i++) words[i] = a[i] | b[i];
+    }
+    r->words = words;
+    r->values = NULL;
+    r->capacity = 0;
+    r->count = bitmap_countWords(words);
+    bitmap_shrink(r);
+    return 1;
+}
+
+/**
+ * @brief Intersects two containers with the same key.
+ *
+ * @param r Pointer to the container receiving the result.
+ * @param a Pointer to the first container.
+ * @param b Pointer to the second container.
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int bitmap_andContainers(BitmapContainer *r, const BitmapContainer *a, const BitmapContainer *b) {
+    r->key = a->key;
+    if (a->words && b->words) return bitmap_combineWords(r, a->words, b->words, 0);
+
+    if (a->words) {
+        const BitmapContainer *t = a; a = b; b = t;
+    }
+    r->words = NULL;
+    r->values = mem_alloc(MEM_TAGS, a->count * sizeof(uint16_t));
+    if (!r->values) return 0;
+    r->capacity = a->count;
+    if (b->words) {
+        int n = 0;
+        for (int i = 0; i < a->count; i++) {
+            uint16_t v = a->values[i];
+            r->values[n] = v;
+            n += (int)((b->words[v >> 6] >> (v & 63)) & 1);
+        }
+        r->count = n;
+    } else {
+        r->count = bitmap_intersectArrays(a->values, a->count, b->values, b->count, r->values);
+    }
+    return 1;
+}
+
+/**
+ * @brief Subtracts a container from another with the same key.
+ *
+ * @param r Pointer to the container receiving the result.
+ * @param a Pointer to the container to subtract from.
+ * @param b Pointer to the values to take out.
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int bitmap_andNotContainers(BitmapContainer *r, const BitmapContainer *a, const BitmapContainer *b) {
+    r->key = a->key;
+    if (a->words && b->words) return bitmap_combineWords(r, a->words, b->words, 1);
+
+    if (a->words) {
+        if (!bitmap_copyContainer(r, a)) return 0;
+        for (int i = 0; i < b->count; i++) {
+            uint16_t v = b->values[i];
+            uint64_t bit = 1ull << (v & 63);
+            r->count -= (r->words[v >> 6] & bit) != 0;
+            r->words[v >> 6] &= ~bit;
+        }
+        bitmap_shrink(r);
+        return 1;
+    }
+
+    r->words = NULL;
+    r->values = mem_alloc(MEM_TAGS, a->count * sizeof(uint16_t));
+    if (!r->values) return 0;
+    r->capacity = a->count;
+    int n = 0;
+    if (b->words) {
+        for (int i = 0; i < a->count; i++) {
+            uint16_t v = a->values[i];
+            r->values[n] = v;
+            n += (int)(((b->words[v >> 6] >> (v & 63)) & 1) ^ 1);
+        }
+    } else {
+        int j = 0;
+        for (int i = 0; i < a->count; i++) {
+            while (j < b->count && b->values[j] < a->values[i]) j++;
+            if (j == b->count || b->values[j] != a->values[i]) r->values[n++] = a->values[i];
+        }
+    }
+    r->count = n;
+    return 1;
+}
+
+/**
+ * @brief Merges two containers with the same key.
+ *
+ * @param r Pointer to the container receiving the result.
+ * @param a Pointer to the first container.
+ * @param b Pointer to the second container.
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int bitmap_orContainers(BitmapContainer *r, const BitmapContainer *a, const BitmapContainer *b) {
+    r->key = a->key;
+    if (a->words && b->words) return bitmap_combineWords(r, a->words, b->words, 2);
+
+    if (a->words || b->words || a->count + b->count > BITMAP_ARRAY_MAX) {
+        if (b->words) {
+            const BitmapContainer *t = a; a = b; b = t;
+        }
+        if (a->words) {
+            if (!bitmap_copyContainer(r, a)) return 0;
+        } else {
+            if (!bitmap_copyContainer(r, a) || !bitmap_toBitset(r)) {
+                bitmap_freeContainer(r);
+                return 0;
+            }
+        }
+        for (int i = 0; i < b->count; i++) {
+            uint16_t v = b->values[i];
+            uint64_t bit = 1ull << (v & 63);
+            r->count += (r->words[v >> 6] & bit) == 0;
+            r->words[v >> 6] |= bit;
+        }
+        bitmap_shrink(r);
+        return 1;
+    }
+
+    r->words = NULL;
+    r->values = mem_alloc(MEM_TAGS, (a->count + b->count) * sizeof(uint16_t));
+    if (!r->values) return 0;
+    r->capacity = a->count + b->count;
+    int i = 0, j = 0, n = 0;
+    while (i < a->count && j < b->count) {
+        if (a->values[i] < b->values[j]) r->values[n++] = a->values[i++];
+        else if (a->values[i] > b->values[j]) r->values[n++] = b->values[j++];
+        else {
+            r->values[n++] = a->values[i++];
+            j++;
+        }
+    }
+    while (i < a->count) r->values[n++] = a->values[i++];
+    while (j < b->count) r->values[n++] = b->values[j++];
+    r->count = n;
+    return 1;
+}
+
+/**
+ * @brief Runs a set operation container by container.
+ *
+ * @param out Pointer to the result bitmap (replaced).
+ * @param a Pointer to the first operand.
+ * @param b Pointer to the second operand.
+ * @param op 0 for AND, 1 for AND NOT, 2 for OR.
+ * @return 1 on success, 0 on allocation failure (out is left empty).
+ */
+static int bitmap_combine(Bitmap *out, const Bitmap *a, const Bitmap *b, int op) {
+    bitmap_free(out);
+    int i = 0, j = 0, ok = 1;
+    while (ok && (i < a->count || j < b->count)) {
+        BitmapContainer r = {0};
+        if (j == b->count || (i < a->count && a->containers[i].key < b->containers[j].key)) {
+            // Only in a
+            if (op != 0) ok = bitmap_copyContainer(&r, &a->containers[i]);
+            i++;
+        } else if (i == a->count || b->containers[j].key < a->containers[i].key) {
+            // Only in b
+            if (op == 2) ok = bitmap_copyContainer(&r, &b->containers[j]);
+            j++;
+        } else {
+            if (op == 0) ok = bitmap_andContainers(&r, &a->containers[i], &b->containers[j]);
+            else if (op == 1) ok = bitmap_andNotContainers(&r, &a->containers[i], &b->containers[j]);
+            else ok = bitmap_orContainers(&r, &a->containers[i], &b->containers[j]);
+            i++;
+            j++;
+        }
+        if (!ok) bitmap_freeContainer(&r);
+        else ok = bitmap_append(out, &r);
+        // AND stops when either side runs out
+        if (op == 0 && (i == a->count || j == b->count)) break;
+        if (op == 1 && i == a->count) break;
+    }
+    if (!ok) bitmap_free(out);
+    return ok;
+}
+
+/**
+ * @brief Computes a AND b.
+ *
+ * @param out Pointer to an initialized bitmap receiving the result (replaced; not a or b).
+ * @param a Pointer to the first operand.
+ * @param b Pointer to the second operand.
+ * @return 1 on success, 0 on allocation failure (out is left empty).
+ */
+int bitmap_and(Bitmap *out, const Bitmap *a, const Bitmap *b) {
+    return bitmap_combine(out, a, b, 0);
+}
+
+/**
+ * @brief Computes a AND NOT b.
+ *
+ * @param out Pointer to an initialized bitmap receiving the result (replaced; not a or b).
+ * @param a Pointer to the first operand.
+ * @param b Pointer to the values to take out.
+ * @return 1 on success, 0 on allocation failure (out is left empty).
+ */
+int bitmap_andNot(Bitmap *out, const Bitmap *a, const Bitmap *b) {
+    return bitmap_combine(out, a, b, 1);
+}
+
+/**
+ * @brief Computes a OR b.
+ *
+ * @param out Pointer to an initialized bitmap receiving the result (replaced; not a or b).
+ * @param a Pointer to the first operand.
+ * @param b Pointer to the second operand.
+ * @return 1 on success, 0 on allocation failure (out is left empty).
+ */
+int bitmap_or(Bitmap *out, const Bitmap *a, const Bitmap *b) {
+    return bitmap_combine(out, a, b, 2);
+}
+
+/**
+ * @brief Writes the values in increasing order.
+ *
+ * @param bitmap Pointer to the bitmap.
+ * @param values Array receiving up to max values.
+ * @param max Capacity of values.
+ * @return Number of values written.
+ */
+long bitmap_values(const Bitmap *bitmap, uint32_t *values, long max) {
+    long n = 0;
+    for (int i = 0; i < bitmap->count && n < max; i++) {
+        const BitmapContainer *c = &bitmap->containers[i];
+        uint32_t high = (uint32_t)c->key << 16;
+        if (!c->words) {
+            for (int k = 0; k < c->count && n < max; k++) values[n++] = high | c->values[k];
+            continue;
+        }
+        for (int w = 0; w < BITMAP_WORDS && n < max; w++) {
+            for (uint64_t word = c->words[w]; word && n < max; word &= word - 1)
+                values[n++] = high | (uint32_t)(w * 64 + bitmap_lowestBit(word));
+        }
+    }
+    return n;
+}
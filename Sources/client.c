@@ -0,0 +1,203 @@
+#ifdef __linux__
+    #define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "client.h"
+#include "batch.h"
+
+#ifndef __linux__
+
+/**
+ * @brief Daemon mode needs Unix domain sockets; other platforms report it as unavailable.
+ */
+int client_run(const char *path) {
+    (void)path;
+    fprintf(stderr, "Daemon mode is only available on Linux.\n");
+    return -1;
+}
+
+#else
+
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define CLIENT_BUFFER (1 << 16)
+
+/**
+ * @brief Parser state for the response stream.
+ */
+typedef struct Response {
+    char header[32];                  // "+LENGTH" or "-LENGTH" being received
+    size_t header_length;
+    int in_body;                      // Receiving a body
+    int ok;                           // The body is output, not an error message
+    size_t remaining;                 // Body bytes still to come
+    char error[BATCH_ERROR_MAX];      // Error message being received
+    size_t error_length;
+    long answered;                    // Responses received so far
+    int failures;
+} Response;
+
+static char client_request[CLIENT_BUFFER];
+static char client_received[CLIENT_BUFFER];
+
+/**
+ * @brief Connects to the daemon's socket.
+ *
+ * @param path Path of the socket.
+ * @return The connected socket, or -1 on failure (reported on stderr).
+ */
+static int client_connect(const char *path) {
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "Cannot connect to the daemon at %s: %s\n", path, strerror(errno));
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Consumes received bytes: writes output to stdout and reports errors.
+ *
+ * @param response Pointer to the parser state.
+ * @param data The received bytes.
+ * @param size Number of bytes.
+ * @return 1 on success, 0 if the daemon sent something that is not a response.
+ */
+static int client_parse(Response *response, const char *data, size_t size) {
+    size_t i = 0;
+    while (i < size) {
+        if (!response->in_body) {
+            char c = data[i++];
+            if (c != '\n') {
+                if (response->header_length == sizeof(response->header) - 1) return 0;
+                response->header[response->header_length++] = c;
+                continue;
+            }
+            response->header[response->header_length] = '\0';
+            response->header_length = 0;
+            if (response->header[0] != '+' && response->header[0] != '-') return 0;
+            response->ok = response->header[0] == '+';
+            response->remaining = strtoul(response->header + 1, NULL, 10);
+            response->error_length = 0;
+            response->in_body = 1;
+        }
+
+        size_t chunk = size - i < response->remaining ? size - i : response->remaining;
+        if (response->ok) {
+            fwrite(data + i, 1, chunk, stdout);
+        } else {
+            size_t room = sizeof(response->error) - 1 - response->error_length;
+            size_t copy = chunk < room ? chunk : room;
+            memcpy(response->error + response->error_length, data + i, copy);
+            response->error_length += copy;
+        }
+        i += chunk;
+        response->remaining -= chunk;
+
+        if (response->remaining == 0) {
+            response->in_body = 0;
+            response->answered++;
+            if (!response->ok) {
+                response->failures++;
+                fprintf(stderr, "stdin:%ld: %.*s\n", response->answered, (int)response->error_length, response->error);
+            }
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Sends the batch commands on standard input to a daemon and prints the responses.
+ *
+ * @param path Path of the daemon's socket.
+ * @return Number of failed lines, or -1 if the daemon could not be reached.
+ */
+int client_run(const char *path) {
+    Response response;
+    size_t pending = 0;     // Request bytes read from stdin but not sent yet
+    long sent_lines = 0;    // Complete lines read from stdin
+    int input_done = 0;
+    int at_line_start = 1;
+
+    int fd = client_connect(path);
+    if (fd < 0) return -1;
+    memset(&response, 0, sizeof(response));
+
+    while (!input_done || pending > 0 || response.answered < sent_lines) {
+        struct pollfd fds[2];
+        int count = 1;
+        fds[0].fd = fd;
+        fds[0].events = POLLIN | (pending > 0 ? POLLOUT : 0);
+        // Keep one byte free for a newline after an unterminated last line
+        if (!input_done && pending < CLIENT_BUFFER - 1) {
+            fds[1].fd = STDIN_FILENO;
+            fds[1].events = POLLIN;
+            count = 2;
+        }
+        if (poll(fds, count, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            break;
+        }
+
+        if (count == 2 && fds[1].revents) {
+            ssize_t got = read(STDIN_FILENO, client_request + pending, CLIENT_BUFFER - 1 - pending);
+            if (got > 0) {
+                for (ssize_t i = 0; i < got; i++)
+                    if (client_request[pending + i] == '\n') sent_lines++;
+                at_line_start = client_request[pending + got - 1] == '\n';
+                pending += (size_t)got;
+            } else if (got == 0 || errno != EINTR) {
+                input_done = 1;
+                if (!at_line_start) {
+                    client_request[pending++] = '\n';
+                    sent_lines++;
+                }
+            }
+        }
+
+        if (fds[0].revents & POLLOUT) {
+            ssize_t sent = send(fd, client_request, pending, MSG_NOSIGNAL);
+            if (sent < 0 && errno != EAGAIN && errno != EINTR) break;
+            if (sent > 0) {
+                memmove(client_request, client_request + sent, pending - (size_t)sent);
+                pending -= (size_t)sent;
+            }
+        }
+
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t got = read(fd, client_received, sizeof(client_received));
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) break;
+            if (!client_parse(&response, client_received, (size_t)got)) {
+                fprintf(stderr, "Unexpected data from the daemon.\n");
+                break;
+            }
+        }
+    }
+    close(fd);
+    fflush(stdout);
+
+    if (input_done && pending == 0 && response.answered == sent_lines) return response.failures;
+    fprintf(stderr, "Lost the connection to the daemon after %ld of %ld lines.\n", response.answered, sent_lines);
+    return -1;
+}
+
+#endif
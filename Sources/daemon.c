@@ -0,0 +1,893 @@
+#ifdef __linux__
+    #define _POSIX_C_SOURCE 200809L   // open_memstream, sigaction
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "daemon.h"
+#include "batch.h"
+#include "list.h"
+#include "journal.h"
+#include "metrics.h"
+#include "mem.h"
+
+#ifndef __linux__
+
+/**
+ * @brief Replication needs the daemon; other platforms ignore the setting.
+ */
+void daemon_setShipPath(const char *path) {
+    (void)path;
+}
+
+/**
+ * @brief Replication needs the daemon; other platforms ignore the setting.
+ */
+void daemon_setFollowPath(const char *path) {
+    (void)path;
+}
+
+/**
+ * @brief Daemon mode needs epoll; other platforms report it as unavailable.
+ */
+int daemon_run(const char *path, List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    (void)path; (void)head; (void)stack; (void)id_tree; (void)priority_tree; (void)status_tree;
+    fprintf(stderr, "Daemon mode is only available on Linux.\n");
+    return 1;
+}
+
+#else
+
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+
+#define DAEMON_INPUT_SIZE (2 * BATCH_LINE_MAX)   // Room for a full line plus the start of the next
+#define DAEMON_OUTPUT_KEEP (1 << 20)             // Larger output buffers are freed once drained
+#define DAEMON_RECEIVE_CHUNK (1 << 16)           // Bytes read from the primary at a time
+
+/**
+ * @brief One client connection.
+ */
+typedef struct Connection {
+    int fd;
+    char input[DAEMON_INPUT_SIZE];    // Received bytes not executed yet
+    size_t input_length;
+    int discarding;                   // Skipping the rest of an overlong line
+    int closing;                      // Client finished sending; close once answered
+    char *output;                     // Responses not sent yet
+    size_t output_length;
+    size_t output_sent;
+    size_t output_capacity;
+    unsigned int events;              // Events registered with epoll
+    int follower;                     // Replica receiving the journal; sends nothing
+    int starting;                     // Follower waiting for its first snapshot
+    struct Connection *prev;
+    struct Connection *next;
+} Connection;
+
+static volatile sig_atomic_t daemon_stopping = 0;
+static int daemon_epoll = -1;
+static Connection *daemon_connections = NULL;
+static Connection *daemon_txnOwner = NULL;   // Client with a transaction open
+static int daemon_released = 0;              // A transaction ended; waiting clients may run
+static int daemon_deferring = 0;             // Writes since the last read left the BSTs to rebuild
+static BatchContext daemon_ctx;
+static char *daemon_scratch = NULL;          // Buffer of the memory stream behind daemon_ctx.out
+static size_t daemon_scratchSize = 0;
+static long daemon_clients = 0;
+static long daemon_commands = 0;
+static long daemon_failed = 0;
+
+// Primary: replicas connect to the ship socket and are sent the journal
+static const char *daemon_shipPath = NULL;
+static int daemon_shipListener = -1;
+static long daemon_followers = 0;            // Followers connected
+static long daemon_shipped = 0;              // Records sent, over all followers
+static long long daemon_heartbeatAt = 0;     // Time of the last record or heartbeat sent
+
+/**
+ * @brief Replica: the connection to the primary's ship socket.
+ */
+typedef struct Upstream {
+    int fd;                           // -1 while disconnected
+    char *input;                      // Received bytes not applied yet
+    size_t input_length;
+    size_t input_capacity;
+    JournalRecord record;             // Header of the record being received
+    int has_header;
+    unsigned long applied_seq;        // Last record applied
+    unsigned long primary_seq;        // Last record the primary made, as far as is known
+    long long contact;                // Time of the last record or heartbeat received
+    long long lag;                    // Delay of the last record, from the primary making it to applying it (ms)
+    long long max_lag;
+    long records;                     // Records applied
+    long snapshots;                   // Snapshots among them
+    long diverged;                    // Replayed lines whose outcome differed from the primary's
+} Upstream;
+
+static const char *daemon_followPath = NULL;
+static Upstream daemon_upstream = { -1, NULL, 0, 0, { JOURNAL_HEARTBEAT, 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+static long long daemon_reconnectAt = 0;    // Time of the last attempt to reach the primary
+
+/**
+ * @brief Sets the socket on which replicas connect to receive the journal (NULL: none).
+ *
+ * @param path Path of the socket.
+ */
+void daemon_setShipPath(const char *path) {
+    daemon_shipPath = path;
+}
+
+/**
+ * @brief Makes the daemon a read-only replica of the primary shipping on a socket (NULL: none).
+ *
+ * @param path Path of the primary's ship socket.
+ */
+void daemon_setFollowPath(const char *path) {
+    daemon_followPath = path;
+}
+
+/**
+ * @brief Signal handler for SIGINT and SIGTERM: ends the event loop.
+ */
+static void daemon_onSignal(int signal_number) {
+    (void)signal_number;
+    daemon_stopping = 1;
+}
+
+/**
+ * @brief Switches a descriptor to non-blocking mode.
+ *
+ * @param fd The descriptor.
+ * @return 1 on success, 0 on failure.
+ */
+static int daemon_setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+/**
+ * @brief Returns the number of response bytes not sent yet.
+ */
+static size_t daemon_pending(Connection *conn) {
+    return conn->output_length - conn->output_sent;
+}
+
+/**
+ * @brief Appends bytes to a connection's output buffer, growing it as needed.
+ *
+ * @param conn Pointer to the connection.
+ * @param data The bytes.
+ * @param size Number of bytes.
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int daemon_append(Connection *conn, const char *data, size_t size) {
+    if (conn->output_length + size > conn->output_capacity) {
+        size_t capacity = conn->output_capacity ? conn->output_capacity : 4096;
+        while (capacity < conn->output_length + size) capacity *= 2;
+        char *output = mem_realloc(MEM_NET, conn->output, conn->output_capacity, capacity);
+        if (!output) return 0;
+        conn->output = output;
+        conn->output_capacity = capacity;
+    }
+    memcpy(conn->output + conn->output_length, data, size);
+    conn->output_length += size;
+    return 1;
+}
+
+/**
+ * @brief Queues one response: "+LENGTH\n" or "-LENGTH\n", then the body.
+ *
+ * @param conn Pointer to the connection.
+ * @param ok 1 for success, 0 for failure.
+ * @param body The body.
+ * @param size Length of the body.
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int daemon_respond(Connection *conn, int ok, const char *body, size_t size) {
+    char header[32];
+    int length = snprintf(header, sizeof(header), "%c%zu\n", ok ? '+' : '-', size);
+    return daemon_append(conn, header, (size_t)length) && daemon_append(conn, body, size);
+}
+
+/**
+ * @brief Writes the replication status for the "replication" command.
+ *
+ * One "key\tvalue" line per counter: the role (standalone, primary or replica),
+ * then for a primary the last record number, the followers connected, the largest
+ * backlog of a follower in bytes and the records sent; for a replica whether it is
+ * connected, the last record applied and the last one the primary made, the lag of
+ * the last record and the largest lag (ms), the time since the primary was last
+ * heard from (ms), and the records, snapshots and diverging lines applied.
+ *
+ * @param out Stream to write to.
+ */
+static void daemon_report(FILE *out) {
+    if (daemon_followPath) {
+        Upstream *up = &daemon_upstream;
+        fprintf(out, "role\treplica\nconnected\t%d\n", up->fd >= 0);
+        fprintf(out, "applied_seq\t%lu\nprimary_seq\t%lu\n", up->applied_seq, up->primary_seq);
+        fprintf(out, "lag_ms\t%lld\nmax_lag_ms\t%lld\n", up->lag, up->max_lag);
+        fprintf(out, "contact_ms\t%lld\n", up->contact ? journal_now() - up->contact : -1);
+        fprintf(out, "records\t%ld\nsnapshots\t%ld\ndiverged\t%ld\n", up->records, up->snapshots, up->diverged);
+    } else if (daemon_shipPath) {
+        size_t backlog = 0;
+        for (Connection *conn = daemon_connections; conn; conn = conn->next)
+            if (conn->follower && daemon_pending(conn) > backlog) backlog = daemon_pending(conn);
+        fprintf(out, "role\tprimary\nseq\t%lu\nfollowers\t%ld\n", journal_seq(), daemon_followers);
+        fprintf(out, "backlog_bytes\t%zu\nshipped\t%ld\n", backlog, daemon_shipped);
+    } else {
+        fprintf(out, "role\tstandalone\n");
+    }
+}
+
+/**
+ * @brief Keeps BST maintenance deferred while write lines run back to back.
+ *
+ * A run of writes, from clients or from the primary, marks the BSTs stale once
+ * instead of patching them per task; the first read line after it rebuilds them
+ * once. Blank lines and comments leave the run going.
+ *
+ * @param line The request line about to run.
+ */
+static void daemon_trackIndexes(const char *line) {
+    char cmd[16] = "";
+    if (sscanf(line, "%15s", cmd) != 1 || cmd[0] == '#') return;
+
+    if (batch_effect(line) != BATCH_READS) {
+        if (!daemon_deferring) list_deferIndexes();
+        daemon_deferring = 1;
+    } else if (daemon_deferring) {
+        daemon_deferring = 0;
+        list_resumeIndexes(*daemon_ctx.head, daemon_ctx.id_tree, daemon_ctx.priority_tree, daemon_ctx.status_tree);
+    }
+}
+
+/**
+ * @brief Executes one request line and queues its response.
+ *
+ * Output of the command is captured in the memory stream and copied into the
+ * connection's buffer. Tracks which client owns the open transaction.
+ *
+ * @param conn Pointer to the connection.
+ * @param line The request line (modified).
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int daemon_execute(Connection *conn, char *line) {
+    int was_open = list_inTransaction();
+    BatchResult result;
+    char cmd[16] = "";
+    sscanf(line, "%15s", cmd);
+    daemon_trackIndexes(line);
+
+    rewind(daemon_ctx.out);
+    if (strcmp(cmd, "replication") == 0) {
+        daemon_report(daemon_ctx.out);
+        result = BATCH_OK;
+    } else if (daemon_shipListener >= 0) {
+        // The journal keeps the line as received, and the clock so that replicas date tasks alike
+        char original[DAEMON_INPUT_SIZE + 1];
+        strcpy(original, line);
+        daemon_ctx.clock = (unsigned int)time(NULL);
+        result = batch_executeLine(&daemon_ctx, line);
+        journal_note(original, daemon_ctx.clock, result);
+    } else {
+        result = batch_executeLine(&daemon_ctx, line);
+    }
+    fflush(daemon_ctx.out);
+    long length = ftell(daemon_ctx.out);
+
+    if (result == BATCH_OK || result == BATCH_FAILED) daemon_commands++;
+    if (!was_open && list_inTransaction()) daemon_txnOwner = conn;
+    if (was_open && !list_inTransaction()) {
+        daemon_txnOwner = NULL;
+        daemon_released = 1;
+    }
+
+    if (result == BATCH_FAILED || result == BATCH_MALFORMED) {
+        daemon_failed++;
+        return daemon_respond(conn, 0, daemon_ctx.error, strlen(daemon_ctx.error));
+    }
+    return daemon_respond(conn, 1, daemon_scratch, length > 0 ? (size_t)length : 0);
+}
+
+/**
+ * @brief Checks whether a connection must wait before running more requests.
+ *
+ * @param conn Pointer to the connection.
+ * @return 1 if another client holds a transaction or too much output is pending.
+ */
+static int daemon_blocked(Connection *conn) {
+    return (daemon_txnOwner && daemon_txnOwner != conn) || daemon_pending(conn) >= DAEMON_OUTPUT_HIGH;
+}
+
+/**
+ * @brief Runs the complete request lines received on a connection.
+ *
+ * @param conn Pointer to the connection.
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int daemon_process(Connection *conn) {
+    size_t start = 0;
+    int ok = 1;
+
+    while (ok && !daemon_blocked(conn)) {
+        char *newline = memchr(conn->input + start, '\n', conn->input_length - start);
+        if (!newline) break;
+        *newline = '\0';
+        if (conn->discarding) conn->discarding = 0;   // Tail of a line already rejected
+        else ok = daemon_execute(conn, conn->input + start);
+        start = (size_t)(newline - conn->input) + 1;
+    }
+    memmove(conn->input, conn->input + start, conn->input_length - start);
+    conn->input_length -= start;
+    if (!ok || daemon_blocked(conn)) return ok;
+
+    if (conn->discarding) {
+        conn->input_length = 0;
+    } else if (conn->input_length == DAEMON_INPUT_SIZE) {
+        // No newline in a full buffer: reject the line and skip to its end
+        conn->discarding = 1;
+        conn->input_length = 0;
+        ok = daemon_respond(conn, 0, "line too long", 13);
+        daemon_failed++;
+    } else if (conn->closing && conn->input_length > 0) {
+        // Last line without a newline
+        conn->input[conn->input_length] = '\0';
+        conn->input_length = 0;
+        ok = daemon_execute(conn, conn->input);
+    }
+    return ok;
+}
+
+/**
+ * @brief Sends as much pending output as the socket accepts.
+ *
+ * @param conn Pointer to the connection.
+ * @return 1 on success, 0 if the connection failed.
+ */
+static int daemon_flush(Connection *conn) {
+    while (daemon_pending(conn) > 0) {
+        ssize_t sent = send(conn->fd, conn->output + conn->output_sent, daemon_pending(conn), MSG_NOSIGNAL);
+        if (sent < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        conn->output_sent += (size_t)sent;
+    }
+    conn->output_length = conn->output_sent = 0;
+    if (conn->output_capacity > DAEMON_OUTPUT_KEEP) {
+        mem_free(MEM_NET, conn->output, conn->output_capacity);
+        conn->output = NULL;
+        conn->output_capacity = 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Registers the events a connection currently needs with epoll.
+ *
+ * Input is read only while it can be buffered and run; output is watched only
+ * while some is pending.
+ *
+ * @param conn Pointer to the connection.
+ * @return 1 on success, 0 on failure.
+ */
+static int daemon_watch(Connection *conn) {
+    unsigned int events = 0;
+    if (!conn->closing && (conn->follower ||
+                           (conn->input_length < DAEMON_INPUT_SIZE && daemon_pending(conn) < DAEMON_OUTPUT_HIGH)))
+        events |= EPOLLIN;
+    if (daemon_pending(conn) > 0) events |= EPOLLOUT;
+    if (events == conn->events) return 1;
+
+    struct epoll_event event;
+    event.events = events;
+    event.data.ptr = conn;
+    conn->events = events;
+    return epoll_ctl(daemon_epoll, EPOLL_CTL_MOD, conn->fd, &event) == 0;
+}
+
+/**
+ * @brief Runs what a connection can run, sends what it can send, and updates its events.
+ *
+ * @param conn Pointer to the connection.
+ * @return 1 to keep the connection, 0 to close it.
+ */
+static int daemon_service(Connection *conn) {
+    if (conn->follower) {
+        if (!daemon_flush(conn) || conn->closing) return 0;
+        return daemon_watch(conn);
+    }
+
+    // Output that drains at once frees the client to run the lines it was held at
+    for (;;) {
+        size_t buffered = conn->input_length;
+        if (!daemon_process(conn) || !daemon_flush(conn)) return 0;
+        if (daemon_pending(conn) > 0 || conn->input_length == buffered) break;
+    }
+    if (conn->closing && conn->input_length == 0 && daemon_pending(conn) == 0) return 0;
+    return daemon_watch(conn);
+}
+
+/**
+ * @brief Reads available request bytes from a connection.
+ *
+ * @param conn Pointer to the connection.
+ * @return 1 on success (or nothing to read), 0 if the connection failed.
+ */
+static int daemon_read(Connection *conn) {
+    size_t room = DAEMON_INPUT_SIZE - conn->input_length;
+    if (room == 0 || conn->closing) return 1;
+
+    ssize_t received = read(conn->fd, conn->input + conn->input_length, room);
+    if (received > 0) {
+        if (!conn->follower) conn->input_length += (size_t)received;   // Followers have nothing to say
+    } else if (received == 0) {
+        conn->closing = 1;
+    } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return 0;
+    return 1;
+}
+
+/**
+ * @brief Closes a connection, rolling back its transaction if it left one open.
+ *
+ * @param conn Pointer to the connection.
+ */
+static void daemon_close(Connection *conn) {
+    if (daemon_txnOwner == conn) {
+        ListStatus status = list_txnRollback(daemon_ctx.head, daemon_ctx.stack, NULL,
+                                             daemon_ctx.id_tree, daemon_ctx.priority_tree, daemon_ctx.status_tree);
+        if (daemon_shipListener >= 0) journal_rollback(status == LIST_OK);
+        daemon_txnOwner = NULL;
+        daemon_released = 1;
+    }
+    if (conn->follower) daemon_followers--;
+    epoll_ctl(daemon_epoll, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+
+    if (conn->prev) conn->prev->next = conn->next;
+    else daemon_connections = conn->next;
+    if (conn->next) conn->next->prev = conn->prev;
+    mem_free(MEM_NET, conn->output, conn->output_capacity);
+    mem_free(MEM_NET, conn, sizeof(Connection));
+}
+
+/**
+ * @brief Accepts every pending client on a listening socket.
+ *
+ * @param listener The listening socket.
+ * @param follower 1 for the ship socket: the clients are replicas, sent a snapshot first.
+ */
+static void daemon_accept(int listener, int follower) {
+    for (;;) {
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0) return;
+
+        Connection *conn = mem_calloc(MEM_NET, 1, sizeof(Connection));
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = conn;
+        if (!conn || !daemon_setNonBlocking(fd) || epoll_ctl(daemon_epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+            mem_free(MEM_NET, conn, sizeof(Connection));
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        conn->events = EPOLLIN;
+        conn->follower = conn->starting = follower;
+        conn->next = daemon_connections;
+        if (daemon_connections) daemon_connections->prev = conn;
+        daemon_connections = conn;
+        if (follower) daemon_followers++;
+        else daemon_clients++;
+    }
+}
+
+/**
+ * @brief Fills the address of a Unix domain socket.
+ *
+ * @param path Path of the socket.
+ * @param addr Filled with the address.
+ * @return 1 on success, 0 if the path is too long (reported on stderr).
+ */
+static int daemon_address(const char *path, struct sockaddr_un *addr) {
+    if (strlen(path) >= sizeof(addr->sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return 0;
+    }
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    strcpy(addr->sun_path, path);
+    return 1;
+}
+
+/**
+ * @brief Creates the listening socket, refusing to replace the socket of a running daemon.
+ *
+ * @param path Path of the socket.
+ * @return The socket, or -1 on failure (reported on stderr).
+ */
+static int daemon_listen(const char *path) {
+    struct sockaddr_un addr;
+    if (!daemon_address(path, &addr)) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+        fprintf(stderr, "A daemon is already listening on %s.\n", path);
+        close(fd);
+        return -1;
+    }
+    close(fd);
+
+    unlink(path);
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(fd, SOMAXCONN) != 0 || !daemon_setNonBlocking(fd)) {
+        perror(path);
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Queues a journal record on a follower, cutting the follower off if it falls too far behind.
+ *
+ * A follower cut off is shut down, so that epoll reports the hangup and the event
+ * loop closes it; it gets a fresh snapshot when it reconnects.
+ *
+ * @param conn Pointer to the follower.
+ * @param record Pointer to the header.
+ * @param body The body.
+ */
+static void daemon_send(Connection *conn, const JournalRecord *record, const char *body) {
+    char header[JOURNAL_HEADER_MAX];
+    int length = journal_formatHeader(record, header);
+    if (daemon_pending(conn) + record->length > DAEMON_FOLLOWER_MAX ||
+        !daemon_append(conn, header, (size_t)length) || !daemon_append(conn, body, record->length)) {
+        fprintf(stderr, "daemon: replica too far behind, disconnected\n");
+        conn->output_length = conn->output_sent = 0;
+        shutdown(conn->fd, SHUT_RDWR);
+        return;
+    }
+    daemon_shipped++;
+}
+
+/**
+ * @brief Sends the committed work not shipped yet to the followers.
+ *
+ * Followers that just connected get a snapshot of the list first, once no
+ * transaction is open; followers idle for DAEMON_HEARTBEAT_MS get a heartbeat.
+ *
+ * @param head Pointer to the head of the list.
+ */
+static void daemon_ship(List *head) {
+    JournalRecord record;
+    const char *body;
+    int made, sent = 0;
+    while ((made = journal_take(head, &record, &body)) > 0) {
+        for (Connection *conn = daemon_connections; conn; conn = conn->next)
+            if (conn->follower && !conn->starting) daemon_send(conn, &record, body);
+        sent = 1;
+    }
+    if (made < 0) fprintf(stderr, "daemon: journal: %s\n", list_statusName(LIST_NO_MEMORY));
+
+    int snapshot = 0;
+    for (Connection *conn = daemon_connections; conn && !list_inTransaction(); conn = conn->next) {
+        if (!conn->starting) continue;
+        if (!snapshot && journal_snapshot(head, &record, &body) < 0) break;
+        snapshot = 1;
+        conn->starting = 0;
+        daemon_send(conn, &record, body);
+    }
+
+    long long now = journal_now();
+    if (!sent && now - daemon_heartbeatAt >= DAEMON_HEARTBEAT_MS) {
+        journal_heartbeat(&record);
+        for (Connection *conn = daemon_connections; conn; conn = conn->next)
+            if (conn->follower && !conn->starting) daemon_send(conn, &record, "");
+        sent = 1;
+    }
+    if (sent) daemon_heartbeatAt = now;
+
+    for (Connection *conn = daemon_connections; conn; conn = conn->next) {
+        if (!conn->follower || daemon_pending(conn) == 0) continue;
+        if (!daemon_flush(conn) || !daemon_watch(conn)) shutdown(conn->fd, SHUT_RDWR);
+    }
+}
+
+/**
+ * @brief Connects a replica to its primary's ship socket.
+ *
+ * @return 1 on success, 0 if the primary cannot be reached.
+ */
+static int daemon_connectUpstream() {
+    Upstream *up = &daemon_upstream;
+    struct sockaddr_un addr;
+    daemon_reconnectAt = journal_now();
+    if (!daemon_address(daemon_followPath, &addr)) return 0;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return 0;
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = up;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || !daemon_setNonBlocking(fd) ||
+        epoll_ctl(daemon_epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+        close(fd);
+        return 0;
+    }
+    up->fd = fd;
+    up->input_length = 0;
+    up->has_header = 0;
+    fprintf(stderr, "daemon: following %s\n", daemon_followPath);
+    return 1;
+}
+
+/**
+ * @brief Disconnects a replica from its primary; the list keeps the last state received.
+ *
+ * @param reason Reported on stderr.
+ */
+static void daemon_dropUpstream(const char *reason) {
+    Upstream *up = &daemon_upstream;
+    if (up->fd < 0) return;
+    epoll_ctl(daemon_epoll, EPOLL_CTL_DEL, up->fd, NULL);
+    close(up->fd);
+    up->fd = -1;
+    up->input_length = 0;
+    up->has_header = 0;
+    if (up->input_capacity > DAEMON_OUTPUT_KEEP) {
+        mem_free(MEM_NET, up->input, up->input_capacity);
+        up->input = NULL;
+        up->input_capacity = 0;
+    }
+    fprintf(stderr, "daemon: lost the primary (%s), serving record %lu\n", reason, up->applied_seq);
+}
+
+/**
+ * @brief Applies one record received from the primary and updates the lag counters.
+ *
+ * @param body The body of daemon_upstream.record.
+ */
+static void daemon_applyRecord(const char *body) {
+    Upstream *up = &daemon_upstream;
+    const JournalRecord *record = &up->record;
+    up->contact = journal_now();
+    if (record->kind == JOURNAL_SNAPSHOT || record->seq > up->primary_seq) up->primary_seq = record->seq;
+    if (record->kind == JOURNAL_HEARTBEAT) return;
+
+    if (!daemon_deferring) list_deferIndexes();   // Records carry writes only
+    daemon_deferring = 1;
+
+    BatchContext apply = daemon_ctx;
+    apply.read_only = 0;
+    long diverged = journal_apply(record, body, &apply);
+    if (diverged < 0) fprintf(stderr, "daemon: record %lu could not be applied\n", record->seq);
+    else up->diverged += diverged;
+
+    up->applied_seq = record->seq;
+    up->records++;
+    if (record->kind == JOURNAL_SNAPSHOT) up->snapshots++;
+    up->lag = journal_now() - record->time;
+    if (up->lag < 0) up->lag = 0;
+    if (up->lag > up->max_lag) up->max_lag = up->lag;
+}
+
+/**
+ * @brief Reads what the primary sent and applies every complete record.
+ */
+static void daemon_receive() {
+    Upstream *up = &daemon_upstream;
+    if (up->input_capacity - up->input_length < DAEMON_RECEIVE_CHUNK) {
+        size_t capacity = up->input_capacity ? 2 * up->input_capacity : 2 * DAEMON_RECEIVE_CHUNK;
+        char *input = mem_realloc(MEM_NET, up->input, up->input_capacity, capacity);
+        if (!input) {
+            daemon_dropUpstream(list_statusName(LIST_NO_MEMORY));
+            return;
+        }
+        up->input = input;
+        up->input_capacity = capacity;
+    }
+
+    ssize_t received = read(up->fd, up->input + up->input_length, up->input_capacity - up->input_length);
+    if (received == 0) {
+        daemon_dropUpstream("connection closed");
+        return;
+    }
+    if (received < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) daemon_dropUpstream(strerror(errno));
+        return;
+    }
+    up->input_length += (size_t)received;
+
+    size_t start = 0;
+    for (;;) {
+        if (!up->has_header) {
+            char *newline = memchr(up->input + start, '\n', up->input_length - start);
+            if (!newline && up->input_length - start < JOURNAL_HEADER_MAX) break;
+            if (newline) *newline = '\0';
+            if (!newline || !journal_parseHeader(up->input + start, &up->record)) {
+                daemon_dropUpstream("malformed record");
+                return;
+            }
+            up->has_header = 1;
+            start = (size_t)(newline - up->input) + 1;
+        }
+        if (up->input_length - start < up->record.length) break;
+        daemon_applyRecord(up->input + start);
+        start += up->record.length;
+        up->has_header = 0;
+    }
+    memmove(up->input, up->input + start, up->input_length - start);
+    up->input_length -= start;
+}
+
+/**
+ * @brief Serves the list to local clients over a Unix domain socket until SIGINT or SIGTERM.
+ *
+ * @param path Path of the socket to create (a stale socket file is replaced).
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return 0 after a clean shutdown, 1 if a socket could not be set up (or a replica
+ *         could not reach its primary).
+ */
+int daemon_run(const char *path, List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    struct epoll_event events[DAEMON_MAX_EVENTS];
+    struct sigaction action;
+
+    if (daemon_shipPath && daemon_followPath) {
+        fprintf(stderr, "A replica cannot ship a journal of its own.\n");
+        return 1;
+    }
+    int listener = daemon_listen(path);
+    if (listener < 0) return 1;
+
+    daemon_epoll = epoll_create1(0);
+    FILE *scratch = open_memstream(&daemon_scratch, &daemon_scratchSize);
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;                   // NULL marks the listener
+    if (daemon_epoll < 0 || !scratch || epoll_ctl(daemon_epoll, EPOLL_CTL_ADD, listener, &event) != 0) {
+        perror("daemon");
+        if (scratch) fclose(scratch);
+        free(daemon_scratch);
+        if (daemon_epoll >= 0) close(daemon_epoll);
+        close(listener);
+        unlink(path);
+        return 1;
+    }
+
+    memset(&daemon_ctx, 0, sizeof(daemon_ctx));
+    daemon_ctx.head = head;
+    daemon_ctx.stack = stack;
+    daemon_ctx.id_tree = id_tree;
+    daemon_ctx.priority_tree = priority_tree;
+    daemon_ctx.status_tree = status_tree;
+    daemon_ctx.out = scratch;
+    daemon_ctx.read_only = daemon_followPath != NULL;
+
+    // Replication: a primary listens for replicas, a replica reaches its primary before serving
+    int setup = 1;
+    if (daemon_shipPath) {
+        daemon_shipListener = daemon_listen(daemon_shipPath);
+        event.data.ptr = &daemon_shipListener;
+        setup = daemon_shipListener >= 0 && epoll_ctl(daemon_epoll, EPOLL_CTL_ADD, daemon_shipListener, &event) == 0;
+    } else if (daemon_followPath && !daemon_connectUpstream()) {
+        fprintf(stderr, "Cannot reach the primary on %s.\n", daemon_followPath);
+        setup = 0;
+    }
+    if (!setup) {
+        if (daemon_shipListener >= 0) {
+            close(daemon_shipListener);
+            daemon_shipListener = -1;
+            unlink(daemon_shipPath);
+        }
+        fclose(scratch);
+        free(daemon_scratch);
+        daemon_scratch = NULL;
+        close(daemon_epoll);
+        close(listener);
+        unlink(path);
+        return 1;
+    }
+    int timeout = daemon_shipPath || daemon_followPath ? DAEMON_HEARTBEAT_MS : -1;
+    if (timeout < 0 && metrics_dumpInterval() > 0) timeout = 1000; // wake up to write the metrics dump
+
+    // No SA_RESTART, so the signal interrupts epoll_wait
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = daemon_onSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    fprintf(stderr, "daemon: %d tasks, listening on %s\n", listCounter_get(), path);
+    while (!daemon_stopping) {
+        int count = epoll_wait(daemon_epoll, events, DAEMON_MAX_EVENTS, timeout);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
+
+        for (int i = 0; i < count; i++) {
+            void *source = events[i].data.ptr;
+            if (!source || source == &daemon_shipListener) {
+                daemon_accept(source ? daemon_shipListener : listener, source != NULL);
+                continue;
+            }
+            if (source == &daemon_upstream) {
+                if (events[i].events & (EPOLLERR | EPOLLHUP) && !(events[i].events & EPOLLIN))
+                    daemon_dropUpstream("connection closed");
+                else
+                    daemon_receive();
+                continue;
+            }
+            Connection *conn = source;
+            int alive = !(events[i].events & (EPOLLERR | EPOLLHUP));
+            if (alive && (events[i].events & EPOLLIN)) alive = daemon_read(conn);
+            if (alive) alive = daemon_service(conn);
+            if (!alive) daemon_close(conn);
+        }
+
+        // Clients that waited for a transaction to end can run now
+        while (daemon_released) {
+            daemon_released = 0;
+            for (Connection *conn = daemon_connections, *next; conn; conn = next) {
+                next = conn->next;
+                if (!daemon_service(conn)) daemon_close(conn);
+            }
+        }
+
+        if (daemon_shipListener >= 0) daemon_ship(*head);
+        if (daemon_followPath && daemon_upstream.fd < 0 && journal_now() - daemon_reconnectAt >= DAEMON_HEARTBEAT_MS)
+            daemon_connectUpstream();
+        metrics_tick();
+    }
+
+    if (daemon_deferring) {
+        daemon_deferring = 0;
+        list_resumeIndexes(*head, daemon_ctx.id_tree, daemon_ctx.priority_tree, daemon_ctx.status_tree);
+    }
+    while (daemon_connections) daemon_close(daemon_connections);
+    fclose(scratch);
+    free(daemon_scratch);
+    daemon_scratch = NULL;
+    close(daemon_epoll);
+    close(listener);
+    unlink(path);
+
+    fprintf(stderr, "daemon: %ld clients, %ld commands, %ld failed\n", daemon_clients, daemon_commands, daemon_failed);
+    if (daemon_shipListener >= 0) {
+        close(daemon_shipListener);
+        daemon_shipListener = -1;
+        unlink(daemon_shipPath);
+        fprintf(stderr, "daemon: %lu records made, %ld sent to replicas\n", journal_seq(), daemon_shipped);
+        journal_reset();
+    }
+    if (daemon_followPath) {
+        if (daemon_upstream.fd >= 0) close(daemon_upstream.fd);
+        daemon_upstream.fd = -1;
+        mem_free(MEM_NET, daemon_upstream.input, daemon_upstream.input_capacity);
+        daemon_upstream.input = NULL;
+        daemon_upstream.input_length = daemon_upstream.input_capacity = 0;
+        fprintf(stderr, "daemon: %ld records applied (%ld snapshots), largest lag %lld ms, %ld lines diverged\n",
+                daemon_upstream.records, daemon_upstream.snapshots, daemon_upstream.max_lag, daemon_upstream.diverged);
+    }
+    return 0;
+}
+
+#endif
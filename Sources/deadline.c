@@ -0,0 +1,438 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "deadline.h"
+#include "idmap.h"
+#include "mem.h"
+
+#define WHEEL_BITS 8
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_LEVELS 4
+#define WHEEL_OVERDUE (WHEEL_LEVELS * WHEEL_SLOTS)   // List number of the overdue list
+
+/**
+ * @brief A scheduled deadline, linked into one slot list or the overdue list.
+ */
+typedef struct Deadline {
+    int id;                  // Task ID
+    unsigned int due;        // Due date
+    int prev;                // Neighbours in the list (-1 at the ends)
+    int next;                // Also links the free entries
+    int list;                // level * WHEEL_SLOTS + slot, or WHEEL_OVERDUE
+} Deadline;
+
+static Deadline *wheel_entries = NULL;
+static int wheel_capacity = 0;
+static int wheel_used = 0;                    // Entries handed out at least once
+static int wheel_free = -1;                   // First free entry
+static int wheel_head[WHEEL_OVERDUE + 1];
+static int wheel_tail[WHEEL_OVERDUE + 1];
+static int wheel_levelCount[WHEEL_LEVELS];    // Deadlines per level
+static int wheel_overdueCount = 0;
+static int wheel_ready = 0;                   // The lists are initialized
+static int wheel_started = 0;                 // The clock is set
+static unsigned long long wheel_now = 0;      // Time the clock has reached
+static IdMap wheel_index;                     // Task ID -> entry
+
+/**
+ * @brief Empties every list.
+ */
+static void wheel_setup() {
+    for (int i = 0; i <= WHEEL_OVERDUE; i++) wheel_head[i] = wheel_tail[i] = -1;
+    for (int i = 0; i < WHEEL_LEVELS; i++) wheel_levelCount[i] = 0;
+    wheel_overdueCount = 0;
+    wheel_used = 0;
+    wheel_free = -1;
+    wheel_ready = 1;
+}
+
+/**
+ * @brief Appends an entry to a list.
+ *
+ * @param e The entry.
+ * @param list The list number.
+ */
+static void wheel_link(int e, int list) {
+    Deadline *entry = &wheel_entries[e];
+    entry->list = list;
+    entry->next = -1;
+    entry->prev = wheel_tail[list];
+    if (entry->prev >= 0) wheel_entries[entry->prev].next = e;
+    else wheel_head[list] = e;
+    wheel_tail[list] = e;
+    if (list == WHEEL_OVERDUE) wheel_overdueCount++;
+    else wheel_levelCount[list / WHEEL_SLOTS]++;
+}
+
+/**
+ * @brief Removes an entry from its list.
+ *
+ * @param e The entry.
+ */
+static void wheel_unlink(int e) {
+    Deadline *entry = &wheel_entries[e];
+    if (entry->prev >= 0) wheel_entries[entry->prev].next = entry->next;
+    else wheel_head[entry->list] = entry->next;
+    if (entry->next >= 0) wheel_entries[entry->next].prev = entry->prev;
+    else wheel_tail[entry->list] = entry->prev;
+    if (entry->list == WHEEL_OVERDUE) wheel_overdueCount--;
+    else wheel_levelCount[entry->list / WHEEL_SLOTS]--;
+}
+
+/**
+ * @brief Links an entry into the slot its due date falls in, relative to the clock.
+ *
+ * The level is the first whose span covers the time left; the slot is taken from
+ * the due date's own bits for that level, so it comes up when the clock reaches
+ * the start of that span.
+ *
+ * @param e The entry.
+ * @param due_now 1 to put a deadline due right now in the slot about to fire
+ *                (cascading), 0 to make it overdue at once (scheduling).
+ */
+static void wheel_place(int e, int due_now) {
+    unsigned long long due = wheel_entries[e].due;
+    if (due < wheel_now || (due == wheel_now && !due_now)) {
+        wheel_link(e, WHEEL_OVERDUE);
+        return;
+    }
+    unsigned long long left = due - wheel_now;
+    int level = 0;
+    while (level < WHEEL_LEVELS - 1 && left >= (1ULL << (WHEEL_BITS * (level + 1)))) level++;
+    int slot = (int)((due >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1));
+    wheel_link(e, level * WHEEL_SLOTS + slot);
+}
+
+/**
+ * @brief Looks up the entry of a task ID.
+ *
+ * @param id The task ID.
+ * @return Entry index, or -1 if the task has no deadline in the wheel.
+ */
+static int wheel_find(int id) {
+    long long value;
+    return idmap_get(&wheel_index, id, &value) ? (int)value : -1;
+}
+
+/**
+ * @brief Schedules (or moves) the deadline of a task.
+ *
+ * @param id The task ID.
+ * @param due The due date.
+ */
+static void wheel_schedule(int id, unsigned int due) {
+    if (!wheel_ready) wheel_setup();
+    if (!wheel_started) {
+        wheel_now = (unsigned long long)time(NULL);
+        wheel_started = 1;
+    }
+
+    int e = wheel_find(id);
+    if (e >= 0) {
+        wheel_unlink(e);
+    } else {
+        if (wheel_free >= 0) {
+            e = wheel_free;
+            wheel_free = wheel_entries[e].next;
+        } else {
+            if (wheel_used == wheel_capacity) {
+                int capacity = wheel_capacity ? wheel_capacity * 2 : 1024;
+                Deadline *entries = mem_realloc(MEM_INDEX, wheel_entries, (size_t)wheel_capacity * sizeof(Deadline),
+                                                capacity * sizeof(Deadline));
+                if (!entries) return;
+                wheel_entries = entries;
+                wheel_capacity = capacity;
+            }
+            e = wheel_used++;
+        }
+        if (!idmap_put(&wheel_index, id, e)) {
+            wheel_entries[e].next = wheel_free;
+            wheel_free = e;
+            return;
+        }
+        wheel_entries[e].id = id;
+    }
+    wheel_entries[e].due = due;
+    wheel_place(e, 0);
+}
+
+/**
+ * @brief Cancels the deadline of a task, if it has one in the wheel.
+ *
+ * @param id The task ID.
+ */
+static void wheel_cancel(int id) {
+    int e = wheel_find(id);
+    if (e < 0) return;
+    wheel_unlink(e);
+    idmap_remove(&wheel_index, id);
+    wheel_entries[e].next = wheel_free;
+    wheel_free = e;
+}
+
+/**
+ * @brief Accounts for a task that has just been linked into the list.
+ *
+ * @param task Pointer to the linked Task.
+ */
+void deadline_onAdd(const Task *task) {
+    if (task->due && task->status != STATUS_FINISHED) wheel_schedule(task->id, task->due);
+}
+
+/**
+ * @brief Accounts for a task that has just been unlinked from the list.
+ *
+ * @param task Pointer to the unlinked Task.
+ */
+void deadline_onRemove(const Task *task) {
+    if (task->due && wheel_ready) wheel_cancel(task->id);
+}
+
+/**
+ * @brief Accounts for a status or due date change on a task in the list.
+ *
+ * @param task Pointer to the Task holding the new values.
+ */
+void deadline_onUpdate(const Task *task) {
+    if (task->due && task->status != STATUS_FINISHED) wheel_schedule(task->id, task->due);
+    else if (wheel_ready) wheel_cancel(task->id);
+}
+
+/**
+ * @brief Drops every deadline (used when the list is cleared).
+ */
+void deadline_onClear() {
+    if (!wheel_ready) return;
+    wheel_setup();
+    idmap_clear(&wheel_index);
+}
+
+/**
+ * @brief Drops every deadline and frees the wheel.
+ */
+void deadline_reset() {
+    mem_free(MEM_INDEX, wheel_entries, (size_t)wheel_capacity * sizeof(Deadline));
+    wheel_entries = NULL;
+    wheel_capacity = 0;
+    idmap_free(&wheel_index);
+    wheel_ready = 0;
+    wheel_started = 0;
+    wheel_now = 0;
+}
+
+/**
+ * @brief Advances the clock by one second.
+ *
+ * On a level-0 wrap, the slot of the level above that the clock has entered is
+ * spread over the levels below (and so on up while those wrap too); then the
+ * deadlines in the level-0 slot of the new second expire.
+ *
+ * @param fired Called for each expired deadline (may be NULL).
+ * @param context Opaque pointer passed to fired.
+ * @return Number of deadlines that expired.
+ */
+static long wheel_tick(DeadlineFn fired, void *context) {
+    long count = 0;
+    wheel_now++;
+    if ((wheel_now & (WHEEL_SLOTS - 1)) == 0) {
+        for (int level = 1; level < WHEEL_LEVELS; level++) {
+            int slot = (int)((wheel_now >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1));
+            int list = level * WHEEL_SLOTS + slot;
+            while (wheel_head[list] >= 0) {
+                int e = wheel_head[list];
+                wheel_unlink(e);
+                wheel_place(e, 1);
+            }
+            if (slot != 0) break;
+        }
+    }
+
+    int list = (int)(wheel_now & (WHEEL_SLOTS - 1));
+    while (wheel_head[list] >= 0) {
+        int e = wheel_head[list];
+        wheel_unlink(e);
+        wheel_link(e, WHEEL_OVERDUE);
+        count++;
+        if (fired) fired(wheel_entries[e].id, wheel_entries[e].due, context);
+    }
+    return count;
+}
+
+/**
+ * @brief Moves the wheel's clock forward, expiring the deadlines it passes.
+ *
+ * @param now The current time (seconds since the Unix epoch).
+ * @param fired Called for each expired deadline (may be NULL).
+ * @param context Opaque pointer passed to fired.
+ * @return Number of deadlines that expired.
+ */
+long deadline_advance(unsigned int now, DeadlineFn fired, void *context) {
+    unsigned long long target = now;
+    long count = 0;
+    if (!wheel_ready) wheel_setup();
+    if (!wheel_started) {
+        wheel_now = target;
+        wheel_started = 1;
+        return 0;
+    }
+
+    while (wheel_now < target) {
+        // With levels 0..level-1 empty, nothing happens before the next wrap of that level
+        int level = 0;
+        while (level < WHEEL_LEVELS && wheel_levelCount[level] == 0) level++;
+        if (level == WHEEL_LEVELS) {
+            wheel_now = target;
+            break;
+        }
+        if (level > 0) {
+            unsigned long long next = ((wheel_now >> (WHEEL_BITS * level)) + 1) << (WHEEL_BITS * level);
+            if (next > target) {
+                wheel_now = target;
+                break;
+            }
+            wheel_now = next - 1;
+        }
+        count += wheel_tick(fired, context);
+    }
+    return count;
+}
+
+/**
+ * @brief Returns the time the wheel's clock has reached.
+ *
+ * @return Seconds since the Unix epoch, or 0 if the clock has not started.
+ */
+unsigned int deadline_now() {
+    return (unsigned int)wheel_now;
+}
+
+/**
+ * @brief Lists the overdue tasks, in the order they became overdue.
+ *
+ * @param ids Array receiving up to max task IDs.
+ * @param max Capacity of ids.
+ * @return Number of overdue tasks (may exceed max).
+ */
+int deadline_overdue(int *ids, int max) {
+    int k = 0;
+    if (!wheel_ready) return 0;
+    for (int e = wheel_head[WHEEL_OVERDUE]; e >= 0 && k < max; e = wheel_entries[e].next)
+        ids[k++] = wheel_entries[e].id;
+    return wheel_overdueCount;
+}
+
+/**
+ * @brief Returns the number of overdue tasks.
+ *
+ * @return Number of unfinished tasks in the list whose due date has passed.
+ */
+int deadline_overdueCount() {
+    return wheel_ready ? wheel_overdueCount : 0;
+}
+
+/**
+ * @brief Returns the number of deadlines still ahead.
+ *
+ * @return Number of unfinished tasks in the list with a due date not reached yet.
+ */
+int deadline_pendingCount() {
+    int count = 0;
+    if (!wheel_ready) return 0;
+    for (int level = 0; level < WHEEL_LEVELS; level++) count += wheel_levelCount[level];
+    return count;
+}
+
+/**
+ * @brief Converts a local date and time to seconds since the Unix epoch.
+ *
+ * @param year The year.
+ * @param month The month (1-12).
+ * @param day The day of the month.
+ * @param hour The hour (0-23).
+ * @param minute The minute (0-59).
+ * @param next_day 1 to return the start of the following day instead.
+ * @return The time, or 0 if the date does not exist or is out of range.
+ */
+static unsigned int deadline_localTime(int year, int month, int day, int hour, int minute, int next_day) {
+    struct tm fields;
+    memset(&fields, 0, sizeof(fields));
+    fields.tm_year = year - 1900;
+    fields.tm_mon = month - 1;
+    fields.tm_mday = day;
+    fields.tm_hour = hour;
+    fields.tm_min = minute;
+    fields.tm_isdst = -1;
+    time_t value = mktime(&fields);
+    // mktime() normalizes: a date that comes back changed did not exist
+    if (value == (time_t)-1 || fields.tm_mon != month - 1 || fields.tm_mday != day) return 0;
+    if (next_day) {
+        fields.tm_mday++;
+        fields.tm_isdst = -1;
+        value = mktime(&fields);
+    }
+    if (value <= 0 || (unsigned long long)value > UINT_MAX) return 0;
+    return (unsigned int)value;
+}
+
+/**
+ * @brief Parses a due date.
+ *
+ * @param text The text to parse.
+ * @param now The current time, for relative dates.
+ * @param due Set to the due date (0 for none).
+ * @return 1 on success, 0 if the text is not a date in range.
+ */
+int deadline_parse(const char *text, unsigned int now, unsigned int *due) {
+    char *end;
+    int year, month, day, hour = 0, minute = 0, length = 0;
+
+    if (strcmp(text, "none") == 0) {
+        *due = 0;
+        return 1;
+    }
+    if (text[0] == '+' && text[1] >= '0' && text[1] <= '9') {
+        unsigned long long value = strtoull(text + 1, &end, 10);
+        unsigned long long unit;
+        if (strcmp(end, "s") == 0) unit = 1;
+        else if (strcmp(end, "m") == 0) unit = 60;
+        else if (strcmp(end, "h") == 0) unit = 3600;
+        else if (strcmp(end, "d") == 0) unit = 86400;
+        else return 0;
+        if (value > UINT_MAX / unit || now + value * unit > UINT_MAX) return 0;
+        *due = (unsigned int)(now + value * unit);
+        return 1;
+    }
+    if (text[0] >= '0' && text[0] <= '9' && strchr(text, '-') == NULL) {
+        unsigned long long value = strtoull(text, &end, 10);
+        if (*end != '\0' || value == 0 || value > UINT_MAX) return 0;
+        *due = (unsigned int)value;
+        return 1;
+    }
+
+    if (sscanf(text, "%4d-%2d-%2d%n", &year, &month, &day, &length) != 3) return 0;
+    int next_day = text[length] == '\0';
+    if (!next_day) {
+        int more = 0;
+        if (sscanf(text + length, "T%2d:%2d%n", &hour, &minute, &more) != 2 || text[length + more] != '\0' ||
+            hour < 0 || hour > 23 || minute < 0 || minute > 59)
+            return 0;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31) return 0;
+    *due = deadline_localTime(year, month, day, hour, minute, next_day);
+    return *due != 0;
+}
+
+/**
+ * @brief Formats a time as "YYYY-MM-DD HH:MM" in local time.
+ *
+ * @param when Seconds since the Unix epoch.
+ * @param buffer Buffer receiving the text.
+ * @param size Size of the buffer (17 bytes fit the whole text).
+ */
+void deadline_format(unsigned int when, char *buffer, size_t size) {
+    time_t value = (time_t)when;
+    struct tm *fields = localtime(&value);
+    if (!fields || strftime(buffer, size, "%Y-%m-%d %H:%M", fields) == 0) snprintf(buffer, size, "%u", when);
+}
@@ -0,0 +1,686 @@
+#include <stdlib.h>
+#include "deps.h"
+#include "idmap.h"
+#include "mem.h"
+#include "span.h"
+
+/**
+ * @brief A task in the dependency graph.
+ */
+typedef struct DepNode {
+    int id;                  // Task ID
+    int ord;                 // Position in the topological order
+    int pending;             // Blockers that are in the list and not finished
+    int *out;                // Nodes this task blocks
+    int *in;                 // Nodes blocking this task
+    int out_count;
+    int out_capacity;
+    int in_count;
+    int in_capacity;
+    int ready_prev;          // Neighbours in the ready list (-1 at the ends)
+    int ready_next;
+    unsigned char present;   // The task is in the list
+    unsigned char done;      // The task is finished
+    unsigned char ready;     // Linked into the ready list
+    unsigned char mark;      // Visited by the current search
+} DepNode;
+
+static DepNode *deps_nodes = NULL;
+static int *deps_position = NULL;    // Topological position -> node
+static int *deps_stack = NULL;       // Search stack of deps_reorder()
+static int *deps_forward = NULL;     // Nodes reached forwards from the blocked task
+static int *deps_backward = NULL;    // Nodes reached backwards from the blocker
+static int *deps_slots = NULL;       // Positions freed up by deps_reorder()
+static int deps_count = 0;
+static int deps_capacity = 0;
+static long deps_edges = 0;
+static IdMap deps_index;             // Task ID -> node
+static int deps_readyHead = -1;
+static int deps_readyTail = -1;
+static int deps_readyTotal = 0;
+static int *deps_loose = NULL;       // Tasks in the list outside the graph, unfinished ones first
+static int deps_looseCount = 0;
+static int deps_looseReady = 0;      // Unfinished tasks at the front of deps_loose
+static int deps_looseCapacity = 0;
+static IdMap deps_looseIndex;        // Task ID -> position in deps_loose
+
+/**
+ * @brief Returns a short description of a status code.
+ *
+ * @param status The status code.
+ * @return Static string describing the status.
+ */
+const char* deps_statusName(DepsStatus status) {
+    switch (status) {
+        case DEPS_OK: return "ok";
+        case DEPS_SELF: return "a task cannot block itself";
+        case DEPS_CYCLE: return "would create a cycle";
+        case DEPS_EXISTS: return "dependency already exists";
+        case DEPS_NO_EDGE: return "no such dependency";
+        case DEPS_NO_MEMORY: return "out of memory";
+        default: return "unknown error";
+    }
+}
+
+/**
+ * @brief Grows the node table and the search arrays, which all hold one entry per node.
+ *
+ * @return 1 on success, 0 on allocation failure (nothing is lost).
+ */
+static int deps_grow() {
+    int capacity = deps_capacity ? deps_capacity * 2 : 64;
+    DepNode *nodes = mem_realloc(MEM_DEPS, deps_nodes, (size_t)deps_capacity * sizeof(DepNode),
+                                 capacity * sizeof(DepNode));
+    if (!nodes) return 0;
+    deps_nodes = nodes;
+
+    int **arrays[] = { &deps_position, &deps_stack, &deps_forward, &deps_backward, &deps_slots };
+    for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); i++) {
+        int *array = mem_realloc(MEM_DEPS, *arrays[i], (size_t)deps_capacity * sizeof(int), capacity * sizeof(int));
+        if (!array) return 0;
+        *arrays[i] = array;
+    }
+    deps_capacity = capacity;
+    return 1;
+}
+
+/**
+ * @brief Appends a node to an edge array.
+ *
+ * @param array Pointer to the array.
+ * @param count Pointer to its length.
+ * @param capacity Pointer to its capacity.
+ * @param value The node to append.
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int deps_append(int **array, int *count, int *capacity, int value) {
+    if (*count == *capacity) {
+        int grown = *capacity ? *capacity * 2 : 4;
+        int *resized = mem_realloc(MEM_DEPS, *array, (size_t)*capacity * sizeof(int), grown * sizeof(int));
+        if (!resized) return 0;
+        *array = resized;
+        *capacity = grown;
+    }
+    (*array)[(*count)++] = value;
+    return 1;
+}
+
+/**
+ * @brief Deletes a node from an edge array (order is not kept).
+ *
+ * @param array The array.
+ * @param count Pointer to its length.
+ * @param value The node to delete.
+ * @return 1 if it was there, 0 otherwise.
+ */
+static int deps_erase(int *array, int *count, int value) {
+    for (int i = 0; i < *count; i++) {
+        if (array[i] == value) {
+            array[i] = array[--(*count)];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Checks whether a node holds back the tasks it blocks.
+ *
+ * @param node The node.
+ * @return 1 if the task is in the list and not finished.
+ */
+static int deps_blocking(const DepNode *node) {
+    return node->present && !node->done;
+}
+
+/**
+ * @brief Links a node into the ready list or unlinks it, according to its state.
+ *
+ * @param n The node.
+ */
+static void deps_refresh(int n) {
+    DepNode *node = &deps_nodes[n];
+    int ready = deps_blocking(node) && node->pending == 0;
+    if (ready == node->ready) return;
+
+    if (ready) {
+        node->ready_prev = deps_readyTail;
+        node->ready_next = -1;
+        if (deps_readyTail >= 0) deps_nodes[deps_readyTail].ready_next = n;
+        else deps_readyHead = n;
+        deps_readyTail = n;
+        deps_readyTotal++;
+    } else {
+        if (node->ready_prev >= 0) deps_nodes[node->ready_prev].ready_next = node->ready_next;
+        else deps_readyHead = node->ready_next;
+        if (node->ready_next >= 0) deps_nodes[node->ready_next].ready_prev = node->ready_prev;
+        else deps_readyTail = node->ready_prev;
+        deps_readyTotal--;
+    }
+    node->ready = (unsigned char)ready;
+}
+
+/**
+ * @brief Changes whether a node's task is in the list and finished.
+ *
+ * When that changes whether it blocks, the tasks it blocks are updated.
+ *
+ * @param n The node.
+ * @param present 1 if the task is in the list.
+ * @param done 1 if the task is finished.
+ */
+static void deps_setState(int n, int present, int done) {
+    DepNode *node = &deps_nodes[n];
+    int was_blocking = deps_blocking(node);
+    node->present = (unsigned char)present;
+    node->done = (unsigned char)done;
+    int blocking = deps_blocking(node);
+
+    if (blocking != was_blocking) {
+        for (int i = 0; i < node->out_count; i++) {
+            int w = node->out[i];
+            deps_nodes[w].pending += blocking ? 1 : -1;
+            deps_refresh(w);
+        }
+    }
+    deps_refresh(n);
+}
+
+/**
+ * @brief Swaps two tasks of deps_loose, keeping their positions indexed.
+ *
+ * @param a A position in deps_loose.
+ * @param b Another position in deps_loose.
+ */
+static void deps_looseSwap(int a, int b) {
+    if (a == b) return;
+    int id = deps_loose[a];
+    deps_loose[a] = deps_loose[b];
+    deps_loose[b] = id;
+    idmap_set(&deps_looseIndex, deps_loose[a], a);
+    idmap_set(&deps_looseIndex, deps_loose[b], b);
+}
+
+/**
+ * @brief Looks up the position of a task outside the graph.
+ *
+ * @param id The task ID.
+ * @return Position in deps_loose, or -1 if the task is not there.
+ */
+static int deps_looseFind(int id) {
+    long long value;
+    return idmap_get(&deps_looseIndex, id, &value) ? (int)value : -1;
+}
+
+/**
+ * @brief Adds a task of the list that is outside the graph.
+ *
+ * @param id The task ID.
+ * @param done 1 if the task is finished.
+ */
+static void deps_looseAdd(int id, int done) {
+    if (deps_looseFind(id) >= 0) return;
+    if (deps_looseCount == deps_looseCapacity) {
+        int capacity = deps_looseCapacity ? deps_looseCapacity * 2 : 64;
+        int *loose = mem_realloc(MEM_DEPS, deps_loose, (size_t)deps_looseCapacity * sizeof(int),
+                                 capacity * sizeof(int));
+        if (!loose) return;
+        deps_loose = loose;
+        deps_looseCapacity = capacity;
+    }
+    if (!idmap_put(&deps_looseIndex, id, deps_looseCount)) return;
+    deps_loose[deps_looseCount++] = id;
+    if (!done) deps_looseSwap(deps_looseCount - 1, deps_looseReady++);
+}
+
+/**
+ * @brief Moves a task outside the graph between the unfinished and finished ones.
+ *
+ * @param id The task ID.
+ * @param done 1 if the task is finished now.
+ */
+static void deps_looseUpdate(int id, int done) {
+    int p = deps_looseFind(id);
+    if (p < 0) return;
+    if (!done && p >= deps_looseReady) deps_looseSwap(p, deps_looseReady++);
+    else if (done && p < deps_looseReady) deps_looseSwap(p, --deps_looseReady);
+}
+
+/**
+ * @brief Removes a task from the ones outside the graph.
+ *
+ * @param id The task ID.
+ */
+static void deps_looseRemove(int id) {
+    int p = deps_looseFind(id);
+    if (p < 0) return;
+    if (p < deps_looseReady) {
+        deps_looseSwap(p, --deps_looseReady);
+        p = deps_looseReady;
+    }
+    deps_looseSwap(p, --deps_looseCount);
+    idmap_remove(&deps_looseIndex, id);
+}
+
+/**
+ * @brief Looks up the node of a task ID.
+ *
+ * @param id The task ID.
+ * @return Node index, or -1 if the task is not in the graph.
+ */
+static int deps_find(int id) {
+    long long value;
+    return idmap_get(&deps_index, id, &value) ? (int)value : -1;
+}
+
+/**
+ * @brief Returns the node of a task, adding it at the end of the order if needed.
+ *
+ * @param task Pointer to the task (in the list).
+ * @return Node index, or -1 on allocation failure.
+ */
+static int deps_node(const Task *task) {
+    int n = deps_find(task->id);
+    if (n >= 0) return n;
+    if (deps_count == deps_capacity && !deps_grow()) return -1;
+    n = deps_count;
+    if (!idmap_put(&deps_index, task->id, n)) return -1;
+    deps_looseRemove(task->id);
+
+    DepNode *node = &deps_nodes[n];
+    node->id = task->id;
+    node->ord = n;
+    node->pending = 0;
+    node->out = node->in = NULL;
+    node->out_count = node->out_capacity = 0;
+    node->in_count = node->in_capacity = 0;
+    node->ready_prev = node->ready_next = -1;
+    node->present = 1;
+    node->done = task->status == STATUS_FINISHED;
+    node->ready = 0;
+    node->mark = 0;
+    deps_position[n] = n;
+    deps_count++;
+    deps_refresh(n);
+    return n;
+}
+
+/**
+ * @brief qsort comparator ordering node indices by topological position.
+ */
+static int deps_compareOrd(const void *a, const void *b) {
+    int x = deps_nodes[*(const int *)a].ord;
+    int y = deps_nodes[*(const int *)b].ord;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Restores the topological order before adding the edge x -> y, with ord(y) < ord(x).
+ *
+ * Only nodes positioned between y and x can be out of order: those reachable from y
+ * are collected by a forward search, those reaching x by a backward search, and the
+ * two sets are reassigned the positions they occupy, x's side first. Reaching x from
+ * y means the edge would close a cycle.
+ *
+ * @param x The blocker.
+ * @param y The blocked task.
+ * @return DEPS_OK or DEPS_CYCLE (the order is unchanged).
+ */
+static DepsStatus deps_reorder(int x, int y) {
+    int lower = deps_nodes[y].ord;
+    int upper = deps_nodes[x].ord;
+    int forward = 0, backward = 0, top = 0;
+
+    deps_nodes[y].mark = 1;
+    deps_stack[top++] = y;
+    while (top > 0) {
+        int n = deps_stack[--top];
+        deps_forward[forward++] = n;
+        for (int i = 0; i < deps_nodes[n].out_count; i++) {
+            int w = deps_nodes[n].out[i];
+            if (w == x) {
+                for (int j = 0; j < forward; j++) deps_nodes[deps_forward[j]].mark = 0;
+                for (int j = 0; j < top; j++) deps_nodes[deps_stack[j]].mark = 0;
+                return DEPS_CYCLE;
+            }
+            if (!deps_nodes[w].mark && deps_nodes[w].ord < upper) {
+                deps_nodes[w].mark = 1;
+                deps_stack[top++] = w;
+            }
+        }
+    }
+
+    deps_nodes[x].mark = 1;
+    deps_stack[top++] = x;
+    while (top > 0) {
+        int n = deps_stack[--top];
+        deps_backward[backward++] = n;
+        for (int i = 0; i < deps_nodes[n].in_count; i++) {
+            int w = deps_nodes[n].in[i];
+            if (!deps_nodes[w].mark && deps_nodes[w].ord > lower) {
+                deps_nodes[w].mark = 1;
+                deps_stack[top++] = w;
+            }
+        }
+    }
+
+    qsort(deps_forward, forward, sizeof(int), deps_compareOrd);
+    qsort(deps_backward, backward, sizeof(int), deps_compareOrd);
+
+    // Merge the positions both sets occupy, then hand them out backward set first
+    int i = 0, j = 0, k = 0;
+    while (i < backward || j < forward) {
+        if (j == forward || (i < backward && deps_nodes[deps_backward[i]].ord < deps_nodes[deps_forward[j]].ord))
+            deps_slots[k++] = deps_nodes[deps_backward[i++]].ord;
+        else
+            deps_slots[k++] = deps_nodes[deps_forward[j++]].ord;
+    }
+    k = 0;
+    for (i = 0; i < backward; i++, k++) {
+        int n = deps_backward[i];
+        deps_nodes[n].ord = deps_slots[k];
+        deps_nodes[n].mark = 0;
+        deps_position[deps_slots[k]] = n;
+    }
+    for (j = 0; j < forward; j++, k++) {
+        int n = deps_forward[j];
+        deps_nodes[n].ord = deps_slots[k];
+        deps_nodes[n].mark = 0;
+        deps_position[deps_slots[k]] = n;
+    }
+    return DEPS_OK;
+}
+
+/**
+ * @brief Records that one task blocks another.
+ *
+ * @param blocker Pointer to the task that has to finish first (in the list).
+ * @param blocked Pointer to the task that waits for it (in the list).
+ * @return DEPS_OK, DEPS_SELF, DEPS_CYCLE, DEPS_EXISTS or DEPS_NO_MEMORY.
+ */
+DepsStatus deps_addEdge(const Task *blocker, const Task *blocked) {
+    if (blocker->id == blocked->id) return DEPS_SELF;
+    int x = deps_node(blocker);
+    int y = x >= 0 ? deps_node(blocked) : -1;
+    if (y < 0) return DEPS_NO_MEMORY;
+
+    // Scan the shorter side, so a task blocking (or blocked by) thousands stays cheap
+    DepNode *from = &deps_nodes[x], *to = &deps_nodes[y];
+    if (from->out_count <= to->in_count) {
+        for (int i = 0; i < from->out_count; i++)
+            if (from->out[i] == y) return DEPS_EXISTS;
+    } else {
+        for (int i = 0; i < to->in_count; i++)
+            if (to->in[i] == x) return DEPS_EXISTS;
+    }
+
+    if (from->ord > to->ord && deps_reorder(x, y) == DEPS_CYCLE) return DEPS_CYCLE;
+
+    if (!deps_append(&from->out, &from->out_count, &from->out_capacity, y)) return DEPS_NO_MEMORY;
+    if (!deps_append(&to->in, &to->in_count, &to->in_capacity, x)) {
+        from->out_count--;
+        return DEPS_NO_MEMORY;
+    }
+    deps_edges++;
+    if (deps_blocking(from)) {
+        to->pending++;
+        deps_refresh(y);
+    }
+    return DEPS_OK;
+}
+
+/**
+ * @brief Deletes the edge between two tasks.
+ *
+ * @param blocker_id ID of the blocking task.
+ * @param blocked_id ID of the blocked task.
+ * @return DEPS_OK, or DEPS_NO_EDGE if there is no such edge.
+ */
+DepsStatus deps_removeEdge(int blocker_id, int blocked_id) {
+    int x = deps_find(blocker_id);
+    int y = deps_find(blocked_id);
+    if (x < 0 || y < 0) return DEPS_NO_EDGE;
+    DepNode *from = &deps_nodes[x], *to = &deps_nodes[y];
+    if (!deps_erase(from->out, &from->out_count, y)) return DEPS_NO_EDGE;
+    deps_erase(to->in, &to->in_count, x);
+    deps_edges--;
+    if (deps_blocking(from)) {
+        to->pending--;
+        deps_refresh(y);
+    }
+    return DEPS_OK;
+}
+
+/**
+ * @brief Deletes every edge of a task.
+ *
+ * @param id The task ID.
+ */
+void deps_dropTask(int id) {
+    int n = deps_find(id);
+    if (n < 0) return;
+    while (deps_nodes[n].out_count > 0) deps_removeEdge(id, deps_nodes[deps_nodes[n].out[0]].id);
+    while (deps_nodes[n].in_count > 0) deps_removeEdge(deps_nodes[deps_nodes[n].in[0]].id, id);
+}
+
+/**
+ * @brief Calls a function for each edge between two tasks in the list.
+ *
+ * Blockers are visited in dependency order, so adding the edges back in the same
+ * order seldom has to reorder anything.
+ *
+ * @param fn Function to call.
+ * @param context Opaque pointer passed to fn.
+ */
+void deps_forEachEdge(DepsEdgeFn fn, void *context) {
+    for (int p = 0; p < deps_count; p++) {
+        const DepNode *node = &deps_nodes[deps_position[p]];
+        if (!node->present) continue;
+        for (int i = 0; i < node->out_count; i++) {
+            const DepNode *blocked = &deps_nodes[node->out[i]];
+            if (blocked->present) fn(node->id, blocked->id, context);
+        }
+    }
+}
+
+/**
+ * @brief Accounts for a task that has just been linked into the list.
+ *
+ * @param task Pointer to the linked Task.
+ */
+void deps_onAdd(const Task *task) {
+    int n = deps_find(task->id);
+    if (n >= 0) deps_setState(n, 1, task->status == STATUS_FINISHED);
+    else deps_looseAdd(task->id, task->status == STATUS_FINISHED);
+}
+
+/**
+ * @brief Accounts for a task that has just been unlinked from the list.
+ *
+ * @param task Pointer to the unlinked Task.
+ */
+void deps_onRemove(const Task *task) {
+    int n = deps_find(task->id);
+    if (n >= 0) deps_setState(n, 0, deps_nodes[n].done);
+    else deps_looseRemove(task->id);
+}
+
+/**
+ * @brief Accounts for a status change on a task in the list.
+ *
+ * @param task Pointer to the Task holding the new status.
+ */
+void deps_onUpdate(const Task *task) {
+    int n = deps_find(task->id);
+    if (n >= 0) deps_setState(n, deps_nodes[n].present, task->status == STATUS_FINISHED);
+    else deps_looseUpdate(task->id, task->status == STATUS_FINISHED);
+}
+
+/**
+ * @brief Accounts for every task leaving the list at once (the edges are kept).
+ */
+void deps_onClear() {
+    for (int n = 0; n < deps_count; n++) {
+        deps_nodes[n].present = 0;
+        deps_nodes[n].pending = 0;
+        deps_nodes[n].ready = 0;
+    }
+    deps_readyHead = deps_readyTail = -1;
+    deps_readyTotal = 0;
+    deps_looseCount = deps_looseReady = 0;
+    idmap_clear(&deps_looseIndex);
+}
+
+/**
+ * @brief Drops every edge and frees the graph.
+ */
+void deps_reset() {
+    for (int n = 0; n < deps_count; n++) {
+        mem_free(MEM_DEPS, deps_nodes[n].out, (size_t)deps_nodes[n].out_capacity * sizeof(int));
+        mem_free(MEM_DEPS, deps_nodes[n].in, (size_t)deps_nodes[n].in_capacity * sizeof(int));
+    }
+    size_t size = (size_t)deps_capacity * sizeof(int);
+    mem_free(MEM_DEPS, deps_nodes, (size_t)deps_capacity * sizeof(DepNode));
+    mem_free(MEM_DEPS, deps_position, size);
+    mem_free(MEM_DEPS, deps_stack, size);
+    mem_free(MEM_DEPS, deps_forward, size);
+    mem_free(MEM_DEPS, deps_backward, size);
+    mem_free(MEM_DEPS, deps_slots, size);
+    deps_nodes = NULL;
+    deps_position = deps_stack = deps_forward = deps_backward = deps_slots = NULL;
+    deps_count = deps_capacity = 0;
+    deps_edges = 0;
+    idmap_free(&deps_index);
+    deps_readyHead = deps_readyTail = -1;
+    deps_readyTotal = 0;
+    mem_free(MEM_DEPS, deps_loose, (size_t)deps_looseCapacity * sizeof(int));
+    deps_loose = NULL;
+    deps_looseCount = deps_looseReady = deps_looseCapacity = 0;
+    idmap_free(&deps_looseIndex);
+}
+
+/**
+ * @brief Returns the number of tasks in the graph, in the list or not.
+ *
+ * @return Number of tracked tasks.
+ */
+int deps_taskCount() {
+    return deps_count;
+}
+
+/**
+ * @brief Returns the number of edges in the graph.
+ *
+ * @return Number of edges.
+ */
+long deps_edgeCount() {
+    return deps_edges;
+}
+
+/**
+ * @brief Lists the tasks that are ready to start.
+ *
+ * The ready tasks of the graph come first, then the unfinished tasks with no
+ * dependencies.
+ *
+ * @param ids Array receiving up to max task IDs.
+ * @param max Capacity of ids.
+ * @return Number of ready tasks (may exceed max).
+ */
+int deps_ready(int *ids, int max) {
+    int k = 0;
+    for (int n = deps_readyHead; n >= 0 && k < max; n = deps_nodes[n].ready_next)
+        ids[k++] = deps_nodes[n].id;
+    for (int i = 0; i < deps_looseReady && k < max; i++) ids[k++] = deps_loose[i];
+    return deps_readyTotal + deps_looseReady;
+}
+
+/**
+ * @brief Lists every task in the list in dependency order (blockers first).
+ *
+ * The tasks with no dependencies come first, then the graph's in topological order.
+ *
+ * @param ids Array receiving up to max task IDs.
+ * @param max Capacity of ids.
+ * @return Number of tasks written.
+ */
+int deps_order(int *ids, int max) {
+    int k = 0;
+    for (int i = 0; i < deps_looseCount && k < max; i++) ids[k++] = deps_loose[i];
+    for (int p = 0; p < deps_count && k < max; p++) {
+        const DepNode *node = &deps_nodes[deps_position[p]];
+        if (node->present) ids[k++] = node->id;
+    }
+    return k;
+}
+
+/**
+ * @brief Lists the tasks a task is waiting for.
+ *
+ * @param id The task ID.
+ * @param ids Array receiving up to max task IDs of unfinished blockers in the list.
+ * @param max Capacity of ids.
+ * @return Number of tasks written.
+ */
+int deps_blockers(int id, int *ids, int max) {
+    int n = deps_find(id);
+    int k = 0;
+    if (n < 0) return 0;
+    for (int i = 0; i < deps_nodes[n].in_count && k < max; i++) {
+        const DepNode *blocker = &deps_nodes[deps_nodes[n].in[i]];
+        if (deps_blocking(blocker)) ids[k++] = blocker->id;
+    }
+    return k;
+}
+
+/**
+ * @brief Finds the longest chain of unfinished tasks in the list.
+ *
+ * Walks the nodes in topological order, so every blocker's chain length is known
+ * before the tasks it blocks are reached.
+ *
+ * @param ids Array receiving the chain, first task first (up to max IDs).
+ * @param max Capacity of ids.
+ * @return Length of the chain (may exceed max), or -1 on allocation failure.
+ */
+int deps_criticalPath(int *ids, int max) {
+    if (deps_count == 0) return 0;
+    long long span = span_begin();
+    size_t size = (size_t)deps_count * sizeof(int);
+    int *length = mem_alloc(MEM_SCRATCH, size);
+    int *previous = mem_alloc(MEM_SCRATCH, size);
+    if (!length || !previous) {
+        mem_free(MEM_SCRATCH, length, size);
+        mem_free(MEM_SCRATCH, previous, size);
+        return -1;
+    }
+
+    int best = -1;
+    for (int p = 0; p < deps_count; p++) {
+        int n = deps_position[p];
+        const DepNode *node = &deps_nodes[n];
+        length[n] = 0;
+        previous[n] = -1;
+        if (!deps_blocking(node)) continue;
+        length[n] = 1;
+        for (int i = 0; i < node->in_count; i++) {
+            int w = node->in[i];
+            if (length[w] + 1 > length[n]) {
+                length[n] = length[w] + 1;
+                previous[n] = w;
+            }
+        }
+        if (best < 0 || length[n] > length[best]) best = n;
+    }
+
+    int total = best >= 0 ? length[best] : 0;
+    int k = total;
+    for (int n = best; n >= 0; n = previous[n]) {
+        k--;
+        if (k < max) ids[k] = deps_nodes[n].id;
+    }
+    mem_free(MEM_SCRATCH, length, size);
+    mem_free(MEM_SCRATCH, previous, size);
+    span_end(span, "deps.critical", deps_count);
+    return total;
+}
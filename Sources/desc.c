@@ -0,0 +1,393 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "desc.h"
+#include "mem.h"
+#include "span.h"
+#include "rwlock.h"
+
+/**
+ * @brief Number of low bits of a handle holding the entry index + 1; the rest hold its generation.
+ */
+#define DESC_INDEX_BITS 24
+#define DESC_INDEX_MASK ((1u << DESC_INDEX_BITS) - 1)
+
+/**
+ * @brief Dead bytes in the cold file from which it is compacted (if they are also most of it).
+ */
+#define DESC_COMPACT_BYTES (64 * 1024)
+
+/**
+ * @brief A stored description.
+ */
+typedef struct DescEntry {
+    char *text;               // Text in memory, or NULL if only in the cold file
+    long offset;              // Offset of the text in the cold file, or -1 if never written
+    int prev;                 // Previous (more recently used) entry in memory, or -1
+    int next;                 // Next entry in memory, or next free entry; -1 at the end
+    unsigned char length;     // Length of the text (at most DESC_MAX)
+    unsigned char generation; // Bumped on reuse, so stale handles are recognised
+    unsigned char used;       // The entry holds a description
+} DescEntry;
+
+static DescEntry *desc_entries = NULL;
+static int desc_count = 0;           // Entries handed out so far, free or not
+static int desc_capacity = 0;
+static int desc_freeHead = -1;       // First free entry
+static int desc_lruHead = -1;        // Most recently used entry in memory
+static int desc_lruTail = -1;        // Least recently used entry in memory
+static size_t desc_budget = 0;
+static FILE *desc_cold = NULL;       // Temporary file of evicted descriptions
+static long desc_coldSize = 0;
+static long desc_deadBytes = 0;      // Bytes of the cold file no entry refers to
+static DescUsage desc_stats;
+static RwLock *desc_lock = NULL;     // Created with the first description
+
+/**
+ * @brief Takes the store lock, creating it on first use.
+ *
+ * The first call comes from whoever creates the first description, before any
+ * other thread can hold a handle. Without a lock (allocation failure) the store
+ * still works for a single thread.
+ */
+static void desc_acquire() {
+    if (!desc_lock) desc_lock = rwlock_create();
+    if (desc_lock) rwlock_writeLock(desc_lock);
+}
+
+/**
+ * @brief Releases the store lock.
+ */
+static void desc_release() {
+    if (desc_lock) rwlock_writeUnlock(desc_lock);
+}
+
+/**
+ * @brief Finds the entry of a handle.
+ *
+ * @param ref The handle.
+ * @return Index of the entry, or -1 if the handle is DESC_NONE or stale.
+ */
+static int desc_find(DescRef ref) {
+    int index = (int)(ref & DESC_INDEX_MASK) - 1;
+    if (index < 0 || index >= desc_count) return -1;
+    DescEntry *entry = &desc_entries[index];
+    return entry->used && entry->generation == (unsigned char)(ref >> DESC_INDEX_BITS) ? index : -1;
+}
+
+/**
+ * @brief Unlinks an entry from the LRU list.
+ *
+ * @param index Index of an entry in memory.
+ */
+static void desc_unlink(int index) {
+    DescEntry *entry = &desc_entries[index];
+    if (entry->prev >= 0) desc_entries[entry->prev].next = entry->next;
+    else desc_lruHead = entry->next;
+    if (entry->next >= 0) desc_entries[entry->next].prev = entry->prev;
+    else desc_lruTail = entry->prev;
+    entry->prev = entry->next = -1;
+}
+
+/**
+ * @brief Links an entry at the most recently used end of the LRU list.
+ *
+ * @param index Index of an entry in memory, not in the list.
+ */
+static void desc_pushFront(int index) {
+    DescEntry *entry = &desc_entries[index];
+    entry->prev = -1;
+    entry->next = desc_lruHead;
+    if (desc_lruHead >= 0) desc_entries[desc_lruHead].prev = index;
+    else desc_lruTail = index;
+    desc_lruHead = index;
+}
+
+/**
+ * @brief Rewrites the cold file with only the descriptions still referred to.
+ *
+ * Called when most of the file is dead. On any failure the old file is kept.
+ */
+static void desc_compact() {
+    FILE *file = tmpfile();
+    if (!file) return;
+    long long span = span_begin();
+    char text[DESC_MAX + 1];
+    long size = 0;
+    size_t offsets_size = (size_t)(desc_count > 0 ? desc_count : 1) * sizeof(long);
+    long *offsets = mem_alloc(MEM_SCRATCH, offsets_size);
+    int ok = offsets != NULL;
+    for (int i = 0; ok && i < desc_count; i++) {
+        DescEntry *entry = &desc_entries[i];
+        offsets[i] = -1;
+        if (!entry->used || entry->offset < 0) continue;
+        ok = fseek(desc_cold, entry->offset, SEEK_SET) == 0 &&
+             fread(text, 1, entry->length, desc_cold) == entry->length &&
+             fwrite(text, 1, entry->length, file) == entry->length;
+        offsets[i] = size;
+        size += entry->length;
+    }
+    if (!ok) {
+        mem_free(MEM_SCRATCH, offsets, offsets_size);
+        fclose(file);
+        return;
+    }
+    for (int i = 0; i < desc_count; i++) desc_entries[i].offset = offsets[i];
+    mem_free(MEM_SCRATCH, offsets, offsets_size);
+    fclose(desc_cold);
+    desc_cold = file;
+    desc_coldSize = size;
+    desc_deadBytes = 0;
+    span_end(span, "desc.compact", desc_count);
+}
+
+/**
+ * @brief Drops an entry's text from memory, writing it to the cold file first if needed.
+ *
+ * @param index Index of an entry in memory.
+ * @return 1 on success, 0 if the cold file could not be written (the entry stays).
+ */
+static int desc_evict(int index) {
+    DescEntry *entry = &desc_entries[index];
+    if (entry->offset < 0) {
+        if (!desc_cold && !(desc_cold = tmpfile())) return 0;
+        if (fseek(desc_cold, desc_coldSize, SEEK_SET) != 0 ||
+            fwrite(entry->text, 1, entry->length, desc_cold) != entry->length) return 0;
+        entry->offset = desc_coldSize;
+        desc_coldSize += entry->length;
+    }
+    desc_unlink(index);
+    mem_free(MEM_DESC, entry->text, entry->length + 1u);
+    entry->text = NULL;
+    desc_stats.resident--;
+    desc_stats.resident_bytes -= entry->length + 1u;
+    desc_stats.cold++;
+    desc_stats.evictions++;
+    return 1;
+}
+
+/**
+ * @brief Evicts the least recently used descriptions until the rest fit the budget.
+ */
+static void desc_trim() {
+    while (desc_budget > 0 && desc_stats.resident_bytes > desc_budget && desc_lruTail >= 0) {
+        if (!desc_evict(desc_lruTail)) break;
+    }
+}
+
+/**
+ * @brief Stores a text in a new entry.
+ *
+ * @param text The text.
+ * @param length Its length (1 to DESC_MAX).
+ * @param ref Set to the handle.
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int desc_store(const char *text, size_t length, DescRef *ref) {
+    char *copy = mem_alloc(MEM_DESC, length + 1);
+    if (!copy) return 0;
+    int index = desc_freeHead;
+    if (index >= 0) {
+        desc_freeHead = desc_entries[index].next;
+    } else {
+        if (desc_count == desc_capacity) {
+            int capacity = desc_capacity ? desc_capacity * 2 : 1024;
+            if (capacity > (int)DESC_INDEX_MASK) capacity = (int)DESC_INDEX_MASK;
+            DescEntry *entries = capacity > desc_capacity ? mem_realloc(MEM_DESC, desc_entries,
+                                                (size_t)desc_capacity * sizeof(DescEntry),
+                                                capacity * sizeof(DescEntry)) : NULL;
+            if (!entries) {
+                mem_free(MEM_DESC, copy, length + 1);
+                return 0;
+            }
+            desc_entries = entries;
+            desc_capacity = capacity;
+        }
+        index = desc_count++;
+        desc_entries[index].generation = 0;
+    }
+
+    DescEntry *entry = &desc_entries[index];
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    entry->text = copy;
+    entry->offset = -1;
+    entry->length = (unsigned char)length;
+    entry->used = 1;
+    desc_pushFront(index);
+    desc_stats.resident++;
+    desc_stats.resident_bytes += length + 1;
+    *ref = ((DescRef)entry->generation << DESC_INDEX_BITS) | (DescRef)(index + 1);
+    desc_trim();
+    return 1;
+}
+
+/**
+ * @brief Stores a description.
+ *
+ * @param text The text (truncated to DESC_MAX characters).
+ * @param ref Set to the handle, or DESC_NONE for an empty text.
+ * @return 1 on success, 0 on allocation failure (ref set to DESC_NONE).
+ */
+int desc_create(const char *text, DescRef *ref) {
+    size_t length = strlen(text);
+    if (length > DESC_MAX) length = DESC_MAX;
+    *ref = DESC_NONE;
+    if (length == 0) return 1;
+
+    desc_acquire();
+    int ok = desc_store(text, length, ref);
+    desc_release();
+    return ok;
+}
+
+/**
+ * @brief Stores a copy of a description under a new handle.
+ *
+ * @param ref Handle of the description to copy.
+ * @param copy Set to the new handle.
+ * @return 1 on success, 0 on allocation failure (copy set to DESC_NONE).
+ */
+int desc_copy(DescRef ref, DescRef *copy) {
+    char text[DESC_MAX + 1];
+    size_t length = desc_get(ref, text, sizeof(text));
+    *copy = DESC_NONE;
+    if (length == 0) return 1;
+
+    desc_acquire();
+    int ok = desc_store(text, length, copy);
+    desc_release();
+    return ok;
+}
+
+/**
+ * @brief Copies a description into a buffer, reading it back from the cold file if needed.
+ *
+ * A description read back becomes the most recently used one, and may push older
+ * ones out to stay within the budget.
+ *
+ * @param ref Handle of the description (DESC_NONE, or a handle already freed, gives "").
+ * @param buffer Buffer receiving the text.
+ * @param size Size of buffer.
+ * @return Length of the text copied.
+ */
+size_t desc_get(DescRef ref, char *buffer, size_t size) {
+    buffer[0] = '\0';
+    if (ref == DESC_NONE || size == 0) return 0;
+
+    desc_acquire();
+    int index = desc_find(ref);
+    size_t length = 0;
+    if (index >= 0) {
+        DescEntry *entry = &desc_entries[index];
+        if (entry->text) {
+            desc_unlink(index);
+            desc_pushFront(index);
+        } else {
+            char *text = mem_alloc(MEM_DESC, entry->length + 1u);
+            if (text && fseek(desc_cold, entry->offset, SEEK_SET) == 0 &&
+                fread(text, 1, entry->length, desc_cold) == entry->length) {
+                text[entry->length] = '\0';
+                entry->text = text;
+                desc_pushFront(index);
+                desc_stats.resident++;
+                desc_stats.resident_bytes += entry->length + 1u;
+                desc_stats.cold--;
+                desc_stats.loads++;
+            } else {
+                mem_free(MEM_DESC, text, entry->length + 1u);
+            }
+        }
+        if (entry->text) {
+            length = entry->length < size - 1 ? entry->length : size - 1;
+            memcpy(buffer, entry->text, length);
+            buffer[length] = '\0';
+            desc_trim();
+        }
+    }
+    desc_release();
+    return length;
+}
+
+/**
+ * @brief Frees a description.
+ *
+ * @param ref Handle of the description (DESC_NONE is ignored).
+ */
+void desc_free(DescRef ref) {
+    if (ref == DESC_NONE) return;
+
+    desc_acquire();
+    int index = desc_find(ref);
+    if (index >= 0) {
+        DescEntry *entry = &desc_entries[index];
+        if (entry->text) {
+            desc_unlink(index);
+            mem_free(MEM_DESC, entry->text, entry->length + 1u);
+            entry->text = NULL;
+            desc_stats.resident--;
+            desc_stats.resident_bytes -= entry->length + 1u;
+        } else {
+            desc_stats.cold--;
+        }
+        if (entry->offset >= 0) desc_deadBytes += entry->length;
+        entry->used = 0;
+        entry->generation++;
+        entry->next = desc_freeHead;
+        desc_freeHead = index;
+        if (desc_deadBytes >= DESC_COMPACT_BYTES && desc_deadBytes * 2 > desc_coldSize) desc_compact();
+    }
+    desc_release();
+}
+
+/**
+ * @brief Sets the memory budget for descriptions, evicting at once if it is exceeded.
+ *
+ * @param bytes Budget in bytes, or 0 to keep every description in memory.
+ */
+void desc_setBudget(size_t bytes) {
+    desc_acquire();
+    desc_budget = bytes;
+    desc_trim();
+    desc_release();
+}
+
+/**
+ * @brief Returns the memory budget for descriptions.
+ *
+ * @return Budget in bytes (0 if unlimited).
+ */
+size_t desc_getBudget() {
+    return desc_budget;
+}
+
+/**
+ * @brief Reads the counters of the store.
+ *
+ * @param usage Filled with the counters.
+ */
+void desc_usage(DescUsage *usage) {
+    desc_acquire();
+    *usage = desc_stats;
+    usage->cold_bytes = (size_t)desc_coldSize;
+    desc_release();
+}
+
+/**
+ * @brief Frees every description and closes the cold file.
+ */
+void desc_reset() {
+    for (int i = 0; i < desc_count; i++) mem_free(MEM_DESC, desc_entries[i].text, desc_entries[i].length + 1u);
+    mem_free(MEM_DESC, desc_entries, (size_t)desc_capacity * sizeof(DescEntry));
+    desc_entries = NULL;
+    desc_count = 0;
+    desc_capacity = 0;
+    desc_freeHead = desc_lruHead = desc_lruTail = -1;
+    if (desc_cold) fclose(desc_cold);
+    desc_cold = NULL;
+    desc_coldSize = 0;
+    desc_deadBytes = 0;
+    memset(&desc_stats, 0, sizeof(desc_stats));
+    rwlock_free(desc_lock);
+    desc_lock = NULL;
+}
@@ -1,107 +1,339 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "file.h"
 #include "task.h"
 #include "list.h"
 #include "stack.h"
 #include "tree.h"
+#include "progress.h"
+#include "tags.h"
+#include "deps.h"
+#include "metrics.h"
+#include "mem.h"
+#include "span.h"
 
-#define FILENAME "tasks.dat"
+/**
+ * @brief Tags written in place of the task count of old files, which is never negative.
+ *
+ * V2 files hold Task records with timestamps; V3 files add the task tags after
+ * them, and V4 files the dependencies after the tags.
+ */
+#define FILE_FORMAT_V2 -2
+#define FILE_FORMAT_V3 -3
+#define FILE_FORMAT_V4 -4
+
+/**
+ * @brief A tag of a task, as stored after the Task records of a V3 file.
+ */
+typedef struct FileTag {
+    int id;
+    char name[TAG_NAME_MAX + 1];
+} FileTag;
 
 /**
- * @brief Saves all tasks in the list to a binary file.
+ * @brief Output state of file_writeTag() and file_writeEdge().
+ */
+typedef struct FileWriter {
+    FILE *file;
+    int count;                // Records written (or counted, if file is NULL)
+    int ok;                   // No write failed
+} FileWriter;
+
+/**
+ * @brief Counts or writes one tag of a task (a TagsFn for tags_forEach()).
  *
- * Writes each task to "tasks.dat" in binary format.
+ * @param id ID of the task.
+ * @param name Name of the tag.
+ * @param context Pointer to the FileWriter.
+ */
+static void file_writeTag(int id, const char *name, void *context) {
+    FileWriter *writer = context;
+    writer->count++;
+    if (!writer->file || !writer->ok) return;
+    FileTag tag = { id, "" };
+    strcpy(tag.name, name);
+    writer->ok = fwrite(&tag, sizeof(tag), 1, writer->file) == 1;
+}
+
+/**
+ * @brief Counts or writes one dependency (a DepsEdgeFn for deps_forEachEdge()).
  *
- * @param head Pointer to the head of the list.
+ * @param blocker_id ID of the blocking task.
+ * @param blocked_id ID of the blocked task.
+ * @param context Pointer to the FileWriter.
+ */
+static void file_writeEdge(int blocker_id, int blocked_id, void *context) {
+    FileWriter *writer = context;
+    writer->count++;
+    if (!writer->file || !writer->ok) return;
+    int edge[2] = { blocker_id, blocked_id };
+    writer->ok = fwrite(edge, sizeof(int), 2, writer->file) == 2;
+}
+
+/**
+ * @brief Reads the header of a task file.
+ *
+ * @param file The file, positioned at its start.
+ * @param version Set to the format version (1 for files without a format tag).
+ * @param count Set to the number of Task records.
+ * @return 1 if the file is left at the first record, 0 if it has no header.
  */
-void file_saveTasks(List *head) {
-    FILE *file = fopen(FILENAME, "wb");
-    if (!file) {
-        printf("Failed to open file for saving.\n");
-        return;
+static int file_readHeader(FILE *file, int *version, int *count) {
+    *count = -1;
+    *version = 1;
+    if (fread(count, sizeof(int), 1, file) == 1 && *count <= FILE_FORMAT_V2 && *count >= FILE_FORMAT_V4) {
+        *version = -*count;
+        if (fread(count, sizeof(int), 1, file) != 1) *count = -1;
     }
+    return *count >= 0;
+}
 
-    List *current = head;
-    int count = 0;
-    while (current) {
-        count++;
-        current = current->next;
+/**
+ * @brief Opens a task file and reads its header.
+ *
+ * @param path Path of the file, or NULL for "tasks.dat".
+ * @param version Set to the format version (1 for files without a format tag).
+ * @param count Set to the number of Task records.
+ * @return The file positioned at the first record, or NULL if it could not be
+ *         opened or has no header.
+ */
+static FILE* file_open(const char *path, int *version, int *count) {
+    FILE *file = fopen(path ? path : TASKS_FILENAME, "rb");
+    if (file && !file_readHeader(file, version, count)) {
+        fclose(file);
+        return NULL;
     }
+    return file;
+}
+
+/**
+ * @brief Reads the next task record of a file, converting old records.
+ *
+ * @param file The file, positioned at a record.
+ * @param version Format version of the file.
+ * @param record Filled with the record.
+ * @return 1 on success, 0 at the end of the file or on a short record.
+ */
+static int file_readRecord(FILE *file, int version, TaskRecord *record) {
+    if (version > 1) return fread(record, sizeof(TaskRecord), 1, file) == 1;
+    TaskV1 old;
+    if (fread(&old, sizeof(TaskV1), 1, file) != 1) return 0;
+    task_fromV1(record, &old);
+    return 1;
+}
 
-    fwrite(&count, sizeof(int), 1, file);
-    current = head;
-    while (current) {
-        fwrite(current->task, sizeof(Task), 1, file);
-        current = current->next;
+/**
+ * @brief Writes all tasks in the list to an open stream in the task file format.
+ *
+ * The stream gets the FILE_FORMAT_V4 tag and the task count, followed by the task
+ * records, head first, then the number of task tags and one FileTag record
+ * per tag, then the number of dependencies and one (blocker, blocked) ID pair per
+ * dependency. Large lists show a progress bar (see progress_setEnabled()).
+ *
+ * @param head Pointer to the head of the list.
+ * @param file Stream to write to (flushed, not closed).
+ * @return Number of tasks written, or -1 if a write failed.
+ */
+int file_writeStream(List *head, FILE *file) {
+    long long start = metrics_begin(METRIC_FILE_WRITE);
+    long long span = span_begin(), section_span = span;
+    Progress progress;
+    TaskRecord record;
+    int header[2] = { FILE_FORMAT_V4, listCounter_get() };
+    int count = header[1];
+    long written = 0;
+    int ok = fwrite(header, sizeof(int), 2, file) == 2;
+    progress_begin(&progress, "Saving tasks", count);
+    for (List *current = head; ok && current; current = current->next) {
+        task_toRecord(&record, current->task);
+        ok = fwrite(&record, sizeof(TaskRecord), 1, file) == 1;
+        progress_update(&progress, ++written);
     }
+    progress_end(&progress);
+    span_end(section_span, "file.encode", written);
 
-    fclose(file);
-    printf("Saving tasks to file");
-    loadingBar(10);
-    printf("Tasks saved successfully.\n");
+    // Each section is counted in a first pass, since its size comes first
+    section_span = span_begin();
+    FileWriter tag_count = { NULL, 0, 1 }, tags = { file, 0, ok };
+    ok = ok && tags_forEach(file_writeTag, &tag_count);
+    ok = ok && fwrite(&tag_count.count, sizeof(int), 1, file) == 1;
+    ok = ok && tags_forEach(file_writeTag, &tags) && tags.ok && tags.count == tag_count.count;
+    span_end(section_span, "file.tags", -1);
+
+    section_span = span_begin();
+    FileWriter edge_count = { NULL, 0, 1 }, edges = { file, 0, ok };
+    deps_forEachEdge(file_writeEdge, &edge_count);
+    ok = ok && fwrite(&edge_count.count, sizeof(int), 1, file) == 1;
+    if (ok) deps_forEachEdge(file_writeEdge, &edges);
+    ok = ok && edges.ok && edges.count == edge_count.count;
+    span_end(section_span, "file.deps", -1);
+
+    if (fflush(file) != 0) ok = 0;
+    metrics_count(METRIC_FILE_WRITE, written, 0);
+    metrics_end(METRIC_FILE_WRITE, start);
+    span_end(span, "file.write", written);
+    return ok ? count : -1;
 }
 
 /**
- * @brief Loads tasks from a binary file into the list.
+ * @brief Writes all tasks in the list to a binary file, without messages.
  *
- * Reads tasks from "tasks.dat" and reconstructs the list, updating BSTs and counter.
+ * See file_writeStream() for the layout.
  *
  * @param head Pointer to the head of the list.
- * @param stack Pointer to the undo stack.
+ * @param path Path of the file, or NULL for "tasks.dat".
+ * @return Number of tasks written, or -1 if the file could not be written.
+ */
+int file_writeTasks(List *head, const char *path) {
+    FILE *file = fopen(path ? path : TASKS_FILENAME, "wb");
+    if (!file) return -1;
+
+    int count = file_writeStream(head, file);
+    if (fclose(file) != 0) count = -1;
+    return count;
+}
+
+/**
+ * @brief Reads the tasks of a binary file one at a time, without loading them.
+ *
+ * Only one record is in memory at a time, whatever the size of the file; the
+ * list is not touched.
+ *
+ * @param path Path of the file, or NULL for "tasks.dat".
+ * @param visit Called for each task (NULL to only read the task count).
+ * @param context Opaque pointer passed to visit.
+ * @return Number of tasks read (the count in the header if visit is NULL), or -1
+ *         if the file could not be opened or has no header.
+ */
+int file_scanTasks(const char *path, FileTaskFn visit, void *context) {
+    int version, count;
+    FILE *file = file_open(path, &version, &count);
+    if (!file) return -1;
+
+    long long start = metrics_begin(METRIC_FILE_SCAN);
+    long long span = span_begin();
+    TaskRecord record;
+    Task task;
+    int read = 0, more = 1;
+    while (visit && more && read < count && file_readRecord(file, version, &record)) {
+        read++;
+        task_fromRecord(&task, &record);
+        more = visit(&task, context);
+        desc_free(task.description);
+    }
+    fclose(file);
+    metrics_count(METRIC_FILE_SCAN, read, 0);
+    metrics_end(METRIC_FILE_SCAN, start);
+    span_end(span, "file.scan", read);
+    return visit ? read : count;
+}
+
+/**
+ * @brief Replaces the list with the tasks read from an open stream in the task file format.
+ *
+ * The current tasks are freed without going to the trash, and the undo history is
+ * cleared, since a load cannot be undone; the loaded tasks keep their order from the file and are indexed in one batch. Records with an ID already
+ * loaded are skipped. Large files show a progress bar (see progress_setEnabled()).
+ * Files written before tasks had timestamps (a bare count and TaskV1 records) are
+ * still read; their tasks get no creation time and no due date. The tags (V3) and
+ * dependencies (V4) of a file replace those of the tasks it loads; older files
+ * leave them as they are.
+ *
+ * @param file Stream to read from, positioned at the header (left open).
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack, cleared (may be NULL).
  * @param id_tree Pointer to the BST sorted by ID.
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
- * @return New head of the list.
+ * @param skipped Set to the number of unreadable or duplicate records (may be NULL).
+ * @return Number of tasks loaded, or -1 if the stream has no header (the list is then untouched).
  */
-List* file_loadTasks(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
-    FILE *file = fopen(FILENAME, "rb");
-    if (!file) {
-        printf("No saved tasks found or failed to open file.\n");
-        return head;
-    }
+int file_readStream(FILE *file, List **head, Stack *stack,
+                    Tree *id_tree, Tree *priority_tree, Tree *status_tree, int *skipped) {
+    int version, count;
+    if (!file_readHeader(file, &version, &count)) return -1;
 
-    int count;
-    if (fread(&count, sizeof(int), 1, file) != 1) {
-        fclose(file);
-        printf("Error reading task count.\n");
-        return head;
-    }
-
-    list_freeAll(head, stack, id_tree, priority_tree, status_tree);
-    head = NULL;
+    long long start = metrics_begin(METRIC_FILE_READ);
+    long long span = span_begin();
+    list_clear(head, NULL, id_tree, priority_tree, status_tree);
+    stack_clear(stack);
 
+    // Index the whole file in one batch instead of one insertion per task
+    long long section_span = span_begin();
+    Progress progress;
+    progress_begin(&progress, "Loading tasks", count);
+    list_deferIndexes();
+    int loaded = 0, bad = 0;
+    TaskRecord record;
     for (int i = 0; i < count; i++) {
-        Task *new_task = malloc(sizeof(Task));
-        if (!new_task) {
-            printf("Failed to allocate memory for task.\n");
-            continue;
+        progress_update(&progress, i);
+        Task *new_task = mem_alloc(MEM_TASK, sizeof(Task));
+        if (!new_task || !file_readRecord(file, version, &record)) {
+            mem_free(MEM_TASK, new_task, sizeof(Task));
+            bad += count - i;
+            break;
         }
-        if (fread(new_task, sizeof(Task), 1, file) != 1) {
-            free(new_task);
-            printf("Error reading task data.\n");
+        metrics_count(METRIC_FILE_READ, 1, 0);
+        if (!task_fromRecord(new_task, &record) ||
+            list_insertTask(head, new_task, POS_END, 0, NULL, id_tree, priority_tree, status_tree) != LIST_OK) {
+            task_free(new_task);
+            bad++;
             continue;
         }
+        loaded++;
+    }
+    span_end(section_span, "file.decode", loaded);
+    list_resumeIndexes(*head, id_tree, priority_tree, status_tree);
+    progress_end(&progress);
 
-        List *new_node = malloc(sizeof(List));
-        if (!new_node) {
-            free(new_task);
-            printf("Failed to allocate memory for list node.\n");
-            continue;
+    int section, edge[2];
+    FileTag tag;
+    section_span = span_begin();
+    if (version > 2 && fread(&section, sizeof(int), 1, file) == 1) {
+        for (int i = 0; i < section && fread(&tag, sizeof(tag), 1, file) == 1; i++) {
+            tag.name[TAG_NAME_MAX] = '\0';
+            Task *task = list_findTask(*head, tag.id);
+            if (task) tags_add(task, tag.name);
+        }
+    }
+    span_end(section_span, "file.tags", -1);
+    section_span = span_begin();
+    if (version > 3 && fread(&section, sizeof(int), 1, file) == 1) {
+        for (int i = 0; i < section && fread(edge, sizeof(int), 2, file) == 2; i++) {
+            Task *blocker = list_findTask(*head, edge[0]);
+            Task *blocked = list_findTask(*head, edge[1]);
+            if (blocker && blocked) deps_addEdge(blocker, blocked);
         }
-
-        new_node->task = new_task;
-        new_node->next = head;
-        head = new_node;
-        listCounter_increment();
-        tree_insert(id_tree, new_task);
-        tree_insert(priority_tree, new_task);
-        tree_insert(status_tree, new_task);
     }
+    span_end(section_span, "file.deps", -1);
+
+    if (skipped) *skipped = bad;
+    metrics_end(METRIC_FILE_READ, start);
+    span_end(span, "file.read", loaded);
+    return loaded;
+}
+
+/**
+ * @brief Replaces the list with the tasks of a binary file, without messages.
+ *
+ * See file_readStream(); the list is untouched if the file cannot be opened.
+ *
+ * @param path Path of the file, or NULL for "tasks.dat".
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack, cleared (may be NULL).
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @param skipped Set to the number of unreadable or duplicate records (may be NULL).
+ * @return Number of tasks loaded, or -1 if the file could not be opened or has no header.
+ */
+int file_readTasks(const char *path, List **head, Stack *stack,
+                   Tree *id_tree, Tree *priority_tree, Tree *status_tree, int *skipped) {
+    FILE *file = fopen(path ? path : TASKS_FILENAME, "rb");
+    if (!file) return -1;
 
+    int loaded = file_readStream(file, head, stack, id_tree, priority_tree, status_tree, skipped);
     fclose(file);
-    printf("Loading tasks from file");
-    loadingBar(10);
-    printf("Tasks loaded successfully.\n");
-    return head;
+    return loaded;
 }
@@ -0,0 +1,204 @@
+#include <stdlib.h>
+#include <string.h>
+#include "idmap.h"
+#include "mem.h"
+
+#define IDMAP_MIN_CAPACITY 16
+
+/**
+ * @brief Returns the home slot of a key (Fibonacci hashing).
+ *
+ * @param key The task ID.
+ * @param capacity Table size (power of two).
+ * @return Slot index in [0, capacity).
+ */
+static size_t idmap_slot(int key, size_t capacity) {
+    unsigned int h = (unsigned int)key * 2654435769u;
+    h ^= h >> 16;
+    return h & (capacity - 1);
+}
+
+/**
+ * @brief Frees the arrays of a table.
+ *
+ * @param keys The keys (may be NULL).
+ * @param values The values (may be NULL).
+ * @param used The slot flags (may be NULL).
+ * @param capacity Number of slots the arrays were allocated for.
+ */
+static void idmap_freeTable(int *keys, long long *values, unsigned char *used, size_t capacity) {
+    mem_free(MEM_INDEX, keys, capacity * sizeof(int));
+    mem_free(MEM_INDEX, values, capacity * sizeof(long long));
+    mem_free(MEM_INDEX, used, capacity);
+}
+
+/**
+ * @brief Rehashes all entries into a table of a new size.
+ *
+ * @param map Pointer to the map.
+ * @param capacity New table size (power of two).
+ * @return 1 on success, 0 if allocation fails (map unchanged).
+ */
+static int idmap_resize(IdMap *map, size_t capacity) {
+    int *keys = mem_alloc(MEM_INDEX, capacity * sizeof(int));
+    long long *values = mem_alloc(MEM_INDEX, capacity * sizeof(long long));
+    unsigned char *used = mem_calloc(MEM_INDEX, capacity, 1);
+    if (!keys || !values || !used) {
+        idmap_freeTable(keys, values, used, capacity);
+        return 0;
+    }
+
+    for (size_t i = 0; i < map->capacity; i++) {
+        if (!map->used[i]) continue;
+        size_t slot = idmap_slot(map->keys[i], capacity);
+        while (used[slot]) slot = (slot + 1) & (capacity - 1);
+        used[slot] = 1;
+        keys[slot] = map->keys[i];
+        values[slot] = map->values[i];
+    }
+
+    idmap_freeTable(map->keys, map->values, map->used, map->capacity);
+    map->keys = keys;
+    map->values = values;
+    map->used = used;
+    map->capacity = capacity;
+    return 1;
+}
+
+/**
+ * @brief Finds the slot holding a key.
+ *
+ * @param map Pointer to the map.
+ * @param key The task ID.
+ * @return Slot index, or map->capacity if the key is absent.
+ */
+static size_t idmap_find(const IdMap *map, int key) {
+    if (map->capacity == 0) return 0;
+    size_t slot = idmap_slot(key, map->capacity);
+    while (map->used[slot]) {
+        if (map->keys[slot] == key) return slot;
+        slot = (slot + 1) & (map->capacity - 1);
+    }
+    return map->capacity;
+}
+
+/**
+ * @brief Initializes an empty map.
+ *
+ * No memory is allocated until the first insertion.
+ *
+ * @param map Pointer to the map.
+ */
+void idmap_init(IdMap *map) {
+    memset(map, 0, sizeof(*map));
+}
+
+/**
+ * @brief Inserts or overwrites the value stored for a key.
+ *
+ * @param map Pointer to the map.
+ * @param key The task ID.
+ * @param value The value to store.
+ * @return 1 on success, 0 if the table could not grow.
+ */
+int idmap_put(IdMap *map, int key, long long value) {
+    // Keep the load factor under 70%
+    if ((map->count + 1) * 10 > map->capacity * 7) {
+        size_t capacity = map->capacity ? map->capacity * 2 : IDMAP_MIN_CAPACITY;
+        if (!idmap_resize(map, capacity)) return 0;
+    }
+
+    size_t slot = idmap_slot(key, map->capacity);
+    while (map->used[slot] && map->keys[slot] != key) {
+        slot = (slot + 1) & (map->capacity - 1);
+    }
+    if (!map->used[slot]) {
+        map->used[slot] = 1;
+        map->keys[slot] = key;
+        map->count++;
+    }
+    map->values[slot] = value;
+    return 1;
+}
+
+/**
+ * @brief Overwrites the value stored for a key already in the map.
+ *
+ * Never allocates, so it cannot fail once the key is in.
+ *
+ * @param map Pointer to the map.
+ * @param key The task ID.
+ * @param value The value to store.
+ * @return 1 if the key is present, 0 otherwise (nothing is stored).
+ */
+int idmap_set(IdMap *map, int key, long long value) {
+    size_t slot = idmap_find(map, key);
+    if (slot >= map->capacity || !map->used[slot]) return 0;
+    map->values[slot] = value;
+    return 1;
+}
+
+/**
+ * @brief Looks up the value stored for a key.
+ *
+ * @param map Pointer to the map.
+ * @param key The task ID.
+ * @param value Set to the stored value if found (may be NULL).
+ * @return 1 if the key is present, 0 otherwise.
+ */
+int idmap_get(const IdMap *map, int key, long long *value) {
+    size_t slot = idmap_find(map, key);
+    if (slot >= map->capacity || !map->used[slot]) return 0;
+    if (value) *value = map->values[slot];
+    return 1;
+}
+
+/**
+ * @brief Removes a key from the map.
+ *
+ * Shifts the following entries of the probe run back so no tombstone is left.
+ *
+ * @param map Pointer to the map.
+ * @param key The task ID.
+ * @return 1 if the key was present, 0 otherwise.
+ */
+int idmap_remove(IdMap *map, int key) {
+    size_t hole = idmap_find(map, key);
+    if (hole >= map->capacity || !map->used[hole]) return 0;
+
+    size_t mask = map->capacity - 1;
+    size_t slot = (hole + 1) & mask;
+    while (map->used[slot]) {
+        size_t home = idmap_slot(map->keys[slot], map->capacity);
+        // Move the entry back if its home is not in the (hole, slot] range
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            map->keys[hole] = map->keys[slot];
+            map->values[hole] = map->values[slot];
+            hole = slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    map->used[hole] = 0;
+    map->count--;
+    return 1;
+}
+
+/**
+ * @brief Removes all entries, keeping the allocated table.
+ *
+ * @param map Pointer to the map.
+ */
+void idmap_clear(IdMap *map) {
+    if (map->capacity) memset(map->used, 0, map->capacity);
+    map->count = 0;
+}
+
+/**
+ * @brief Frees the table and resets the map to empty.
+ *
+ * @param map Pointer to the map.
+ */
+void idmap_free(IdMap *map) {
+    idmap_freeTable(map->keys, map->values, map->used, map->capacity);
+    idmap_init(map);
+}
@@ -106,3 +106,16 @@ void readString(const char *prompt, char *buffer, size_t size) {
         buffer[0] = '\0';
     }
 }
+
+/**
+ * @brief Waits until the user presses Enter.
+ *
+ * Replaces system("pause") and fixed delays: the user reads the result at their
+ * own pace and the program does no work meanwhile. Returns at end of input.
+ */
+void waitForEnter() {
+    int c;
+    printf("\nPress Enter to continue...");
+    fflush(stdout);
+    while ((c = getchar()) != EOF && c != '\n') {}
+}
@@ -0,0 +1,314 @@
+#ifdef __linux__
+    #define _POSIX_C_SOURCE 200809L   // open_memstream, fmemopen, clock_gettime
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "journal.h"
+#include "batch.h"
+#include "file.h"
+#include "list.h"
+#include "mem.h"
+
+// Only the daemon ships and applies journals, so like it the journal needs Linux
+#ifdef __linux__
+
+#define JOURNAL_LINE_MAX (2 * BATCH_LINE_MAX + 32)   // A daemon request and its clock and outcome
+
+static char *journal_lines = NULL;       // "CLOCK +|- command\n" lines not shipped yet
+static size_t journal_length = 0;
+static size_t journal_capacity = 0;
+static size_t journal_committed = 0;     // Bytes of journal_lines outside the open transaction
+static int journal_replaced = 0;         // Committed work replaced the list
+static int journal_txnReplaced = 0;      // The open transaction replaced the list
+static int journal_inTxn = 0;            // A transaction was open after the last line noted
+static unsigned long journal_lastSeq = 0;
+static char *journal_body = NULL;        // Body of the last record made
+static size_t journal_bodySize = 0;
+
+/**
+ * @brief Returns the current time in milliseconds since the epoch.
+ *
+ * @return The time.
+ */
+long long journal_now() {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Formats a record header.
+ *
+ * @param record Pointer to the header.
+ * @param buffer Buffer of at least JOURNAL_HEADER_MAX bytes.
+ * @return Length of the header, newline included.
+ */
+int journal_formatHeader(const JournalRecord *record, char *buffer) {
+    return snprintf(buffer, JOURNAL_HEADER_MAX, "%c %lu %lld %zu\n",
+                    (char)record->kind, record->seq, record->time, record->length);
+}
+
+/**
+ * @brief Parses a record header.
+ *
+ * @param line The header line, without its newline.
+ * @param record Filled with the header.
+ * @return 1 on success, 0 if the line is not a header.
+ */
+int journal_parseHeader(const char *line, JournalRecord *record) {
+    char kind;
+    if (sscanf(line, "%c %lu %lld %zu", &kind, &record->seq, &record->time, &record->length) != 4) return 0;
+    if (kind != JOURNAL_GROUP && kind != JOURNAL_SNAPSHOT && kind != JOURNAL_HEARTBEAT) return 0;
+    record->kind = (JournalKind)kind;
+    return 1;
+}
+
+/**
+ * @brief Appends one line to the lines not shipped yet.
+ *
+ * On allocation failure the list is shipped whole instead.
+ *
+ * @param line The command line.
+ * @param clock Time the command ran at.
+ * @param ok 1 if it succeeded on the primary.
+ */
+static void journal_append(const char *line, unsigned int clock, int ok) {
+    size_t line_length = strcspn(line, "\r\n");
+    size_t needed = journal_length + line_length + 16;
+    if (needed > journal_capacity) {
+        size_t capacity = journal_capacity ? journal_capacity : 4096;
+        while (capacity < needed) capacity *= 2;
+        char *lines = mem_realloc(MEM_NET, journal_lines, journal_capacity, capacity);
+        if (!lines) {
+            if (journal_inTxn) journal_txnReplaced = 1;
+            else journal_replaced = 1;
+            return;
+        }
+        journal_lines = lines;
+        journal_capacity = capacity;
+    }
+    journal_length += (size_t)sprintf(journal_lines + journal_length, "%u %c ", clock, ok ? '+' : '-');
+    memcpy(journal_lines + journal_length, line, line_length);
+    journal_length += line_length;
+    journal_lines[journal_length++] = '\n';
+}
+
+/**
+ * @brief Notes a command line run on the primary.
+ *
+ * @param line The command line, as it was before being run.
+ * @param clock Time the command ran at (BatchContext.clock).
+ * @param result Outcome of the line.
+ */
+void journal_note(const char *line, unsigned int clock, BatchResult result) {
+    // A failed line may still have changed some tasks (a tag list, say), and fails the same way when replayed
+    if (result == BATCH_OK || result == BATCH_FAILED) {
+        BatchEffect effect = batch_effect(line);
+        if (effect == BATCH_WRITES) journal_append(line, clock, result == BATCH_OK);
+        else if (effect == BATCH_REPLACES && list_inTransaction()) journal_txnReplaced = 1;
+        else if (effect == BATCH_REPLACES) journal_replaced = 1;
+    }
+
+    if (journal_inTxn && !list_inTransaction()) {
+        char cmd[16] = "";
+        sscanf(line, "%15s", cmd);
+        if (strcmp(cmd, "rollback") == 0) {
+            journal_rollback(result == BATCH_OK);
+        } else {
+            journal_replaced |= journal_txnReplaced;
+            journal_txnReplaced = 0;
+        }
+    }
+    journal_inTxn = list_inTransaction();
+    if (!journal_inTxn) journal_committed = journal_length;
+}
+
+/**
+ * @brief Drops the work of the transaction that was just rolled back.
+ *
+ * @param complete 1 if every change was reverted, 0 if the rollback was refused.
+ */
+void journal_rollback(int complete) {
+    journal_length = journal_committed;
+    journal_txnReplaced = 0;
+    journal_inTxn = 0;
+    if (!complete) journal_replaced = 1;
+}
+
+/**
+ * @brief Opens the body buffer of a new record.
+ *
+ * @return Stream writing to journal_body, or NULL on failure.
+ */
+static FILE* journal_openBody() {
+    free(journal_body);
+    journal_body = NULL;
+    journal_bodySize = 0;
+    return open_memstream(&journal_body, &journal_bodySize);
+}
+
+/**
+ * @brief Writes the list into a snapshot record.
+ *
+ * @param head Pointer to the head of the list.
+ * @param record Filled with the header (seq left to the caller).
+ * @return 1 on success, -1 on failure.
+ */
+static int journal_writeSnapshot(List *head, JournalRecord *record) {
+    FILE *body = journal_openBody();
+    if (!body) return -1;
+    int ok = file_writeStream(head, body) >= 0;
+    if (fclose(body) != 0) ok = 0;
+    if (!ok) return -1;
+
+    record->kind = JOURNAL_SNAPSHOT;
+    record->time = journal_now();
+    record->length = journal_bodySize;
+    return 1;
+}
+
+/**
+ * @brief Makes the next record from the committed work not shipped yet.
+ *
+ * Lines of an open transaction stay behind; if committed work replaced the list,
+ * the snapshot waits for the transaction to end, since the list then holds
+ * uncommitted changes.
+ *
+ * @param head Pointer to the head of the list.
+ * @param record Filled with the header.
+ * @param body Set to the body, valid until the next call to journal_take() or journal_snapshot().
+ * @return 1 if a record was made, 0 if there is nothing to ship now, -1 on allocation failure.
+ */
+int journal_take(List *head, JournalRecord *record, const char **body) {
+    if (journal_replaced) {
+        if (list_inTransaction()) return 0;
+        if (journal_writeSnapshot(head, record) < 0) return -1;
+        journal_length = journal_committed = 0;
+        journal_replaced = 0;
+    } else {
+        if (journal_committed == 0) return 0;
+        FILE *stream = journal_openBody();
+        if (!stream) return -1;
+        int ok = fwrite(journal_lines, 1, journal_committed, stream) == journal_committed;
+        if (fclose(stream) != 0 || !ok) return -1;
+
+        // The lines of the open transaction, if any, wait for it to end
+        memmove(journal_lines, journal_lines + journal_committed, journal_length - journal_committed);
+        journal_length -= journal_committed;
+        journal_committed = 0;
+        record->kind = JOURNAL_GROUP;
+        record->time = journal_now();
+        record->length = journal_bodySize;
+    }
+    record->seq = ++journal_lastSeq;
+    *body = journal_body;
+    return 1;
+}
+
+/**
+ * @brief Makes a snapshot of the list for a replica that is starting.
+ *
+ * @param head Pointer to the head of the list.
+ * @param record Filled with the header.
+ * @param body Set to the body, valid until the next call to journal_take() or journal_snapshot().
+ * @return 1 on success, -1 on allocation failure.
+ */
+int journal_snapshot(List *head, JournalRecord *record, const char **body) {
+    if (journal_writeSnapshot(head, record) < 0) return -1;
+    record->seq = journal_lastSeq;
+    *body = journal_body;
+    return 1;
+}
+
+/**
+ * @brief Makes a heartbeat record.
+ *
+ * @param record Filled with the header.
+ */
+void journal_heartbeat(JournalRecord *record) {
+    record->kind = JOURNAL_HEARTBEAT;
+    record->seq = journal_lastSeq;
+    record->time = journal_now();
+    record->length = 0;
+}
+
+/**
+ * @brief Returns the number of the last record made.
+ *
+ * @return The number (0 before the first).
+ */
+unsigned long journal_seq() {
+    return journal_lastSeq;
+}
+
+/**
+ * @brief Replays the lines of a group record.
+ *
+ * @param body The lines.
+ * @param length Length of body.
+ * @param ctx Pointer to the batch context.
+ * @return Number of lines whose outcome differed from the primary's, or -1 on a malformed line.
+ */
+static long journal_replay(const char *body, size_t length, BatchContext *ctx) {
+    char line[JOURNAL_LINE_MAX];
+    long diverged = 0;
+    const char *end = body + length;
+
+    while (body < end) {
+        const char *newline = memchr(body, '\n', (size_t)(end - body));
+        size_t size = newline ? (size_t)(newline - body) : (size_t)(end - body);
+        if (size >= sizeof(line)) return -1;
+        memcpy(line, body, size);
+        line[size] = '\0';
+        body += size + 1;
+
+        unsigned int clock;
+        char outcome;
+        int offset;
+        if (sscanf(line, "%u %c %n", &clock, &outcome, &offset) != 2) return -1;
+        ctx->clock = clock;
+        rewind(ctx->out);
+        BatchResult result = batch_executeLine(ctx, line + offset);
+        if ((result == BATCH_OK) != (outcome == '+')) diverged++;
+    }
+    ctx->clock = 0;
+    return diverged;
+}
+
+/**
+ * @brief Applies a record received from the primary to the list.
+ *
+ * @param record Pointer to the header.
+ * @param body The body (record->length bytes).
+ * @param ctx Pointer to the batch context of the list (must not be read-only).
+ * @return Number of lines whose outcome differed from the primary's, or -1 if a
+ *         snapshot or a line could not be read.
+ */
+long journal_apply(const JournalRecord *record, const char *body, BatchContext *ctx) {
+    if (record->kind == JOURNAL_GROUP) return journal_replay(body, record->length, ctx);
+    if (record->kind != JOURNAL_SNAPSHOT) return 0;
+    if (record->length == 0) return -1;
+
+    FILE *stream = fmemopen((void *)body, record->length, "rb");
+    if (!stream) return -1;
+    int loaded = file_readStream(stream, ctx->head, NULL, ctx->id_tree, ctx->priority_tree, ctx->status_tree, NULL);
+    fclose(stream);
+    return loaded < 0 ? -1 : 0;
+}
+
+/**
+ * @brief Frees the buffers and forgets the work not shipped.
+ */
+void journal_reset() {
+    mem_free(MEM_NET, journal_lines, journal_capacity);
+    free(journal_body);   // Grown by open_memstream()
+    journal_lines = journal_body = NULL;
+    journal_length = journal_capacity = journal_committed = journal_bodySize = 0;
+    journal_replaced = journal_txnReplaced = journal_inTxn = 0;
+    journal_lastSeq = 0;
+}
+
+#endif
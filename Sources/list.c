@@ -1,35 +1,31 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <windows.h>
+#include <stdint.h>
+#include <limits.h>
 #include "list.h"
 #include "task.h"
-#include "input_utils.h"
 #include "stack.h"
 #include "tree.h"
+#include "stats.h"
+#include "deps.h"
+#include "deadline.h"
+#include "tags.h"
+#include "trash.h"
+#include "idmap.h"
+#include "parallel.h"
+#include "metrics.h"
+#include "mem.h"
+#include "span.h"
 
 static int list_counter = 0;
-
-/**
- * @brief Displays a simple terminal-based loading animation.
- *
- * Prints a progress-style loading bar using dots (.) with a short delay
- * between each dot to simulate loading.
- *
- * Example Output:
- *  [..........] Done!
- *
- * @param total The number of dots to print (represents progress steps).
- */
-void loadingBar(int total) {
-    printf(" [");
-    for (int i = 0; i < total; i++) {
-        fflush(stdout);
-        Sleep(100);
-        printf(".");
-    }
-    printf("] Done!\n");
-    Sleep(500);
-}
+static List *list_tail = NULL;   // Last node of the list, for O(1) appends
+static IdMap list_index;         // Task ID -> List node, for O(1) lookups
+static int index_deferred = 0;   // Nesting depth of deferred BST maintenance
+static int index_dirty = 0;      // BSTs no longer match the list
+static int txn_active = 0;       // A transaction is open
+static int txn_records = 0;      // Undo records pushed by the open transaction
+static int txn_broken = 0;       // The undo history lost records of the open transaction
+static int txn_deferred = 0;     // The open transaction grew large enough to defer BST maintenance
 
 /**
  * @brief Increments the task counter.
@@ -63,485 +59,1350 @@ void listCounter_reset() {
 }
 
 /**
- * @brief Adds a new task to the head of the linked list.
+ * @brief Returns a short description of a status code.
  *
- * Allocates memory for a new List node and Task, fills the task with user input,
- * and inserts it at the head of the list. Updates the task counter and BSTs.
+ * @param status The status code.
+ * @return Static string describing the status.
+ */
+const char* list_statusName(ListStatus status) {
+    switch (status) {
+        case LIST_OK: return "ok";
+        case LIST_NOT_FOUND: return "not found";
+        case LIST_DUPLICATE_ID: return "duplicate ID";
+        case LIST_NO_MEMORY: return "out of memory";
+        case LIST_EMPTY: return "list is empty";
+        case LIST_BAD_STATE: return "not allowed in the current transaction state";
+        default: return "unknown error";
+    }
+}
+
+/**
+ * @brief Accounts for a task that has just been linked into the list.
  *
- * @param head Pointer to the current head of the list.
- * @param stack Pointer to the undo stack.
+ * Updates the task counter, the statistics and the three BSTs (unless BST
+ * maintenance is deferred, in which case they are only marked stale).
+ *
+ * @param task Pointer to the linked Task.
  * @param id_tree Pointer to the BST sorted by ID.
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
- * @return New head of the list.
  */
-List* list_addToHead(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
-    List *new_node = malloc(sizeof(List));
-    if (!new_node) {
-        printf("Failed to allocate memory for new node.\n");
-        return head;
-    }
-
-    Task *new_task = malloc(sizeof(Task));
-    if (!new_task) {
-        printf("Failed to allocate memory for task.\n");
-        free(new_node);
-        return head;
-    }
-
-    fillTask(new_task);
-    new_node->task = new_task;
-    new_node->next = head;
+static void list_indexTask(Task *task, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
     listCounter_increment();
-    tree_insert(id_tree, new_task);
-    tree_insert(priority_tree, new_task);
-    tree_insert(status_tree, new_task);
-
-    printf("\nSaving your task");
-    loadingBar(10);
-    return new_node;
+    stats_onAdd(task);
+    deps_onAdd(task);
+    deadline_onAdd(task);
+    tags_onAdd(task);
+    if (index_deferred) {
+        index_dirty = 1;
+        return;
+    }
+    tree_insert(id_tree, task);
+    tree_insert(priority_tree, task);
+    tree_insert(status_tree, task);
 }
 
 /**
- * @brief Adds a new task to the end of the linked list.
+ * @brief Accounts for a task that has just been unlinked from the list.
  *
- * Allocates memory for a new List node and Task, fills the task with user input,
- * and appends it to the end of the list. Updates the task counter and BSTs.
+ * Updates the task counter, the statistics and removes the task from the three BSTs
+ * (unless BST maintenance is deferred).
  *
- * @param head Pointer to the head of the list.
- * @param stack Pointer to the undo stack.
+ * @param task Pointer to the unlinked Task.
  * @param id_tree Pointer to the BST sorted by ID.
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
  */
-void list_addToEnd(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
-    if (head == NULL) {
-        printf("The list has not been initialized.\n");
+static void list_unindexTask(Task *task, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    listCounter_decrement();
+    stats_onRemove(task);
+    deps_onRemove(task);
+    deadline_onRemove(task);
+    tags_onRemove(task);
+    if (index_deferred) {
+        index_dirty = 1;
         return;
     }
+    tree_remove(id_tree, task);
+    tree_remove(priority_tree, task);
+    tree_remove(status_tree, task);
+}
 
-    Task *new_task = malloc(sizeof(Task));
-    if (!new_task) {
-        printf("Failed to allocate memory for task.\n");
-        return;
-    }
+/**
+ * @brief Checks whether a bulk change is large enough to rebuild the BSTs instead of patching them.
+ *
+ * @param changes Number of tasks to change.
+ * @return 1 to defer BST maintenance to one rebuild, 0 to update the BSTs per task.
+ */
+static int list_bulkRebuilds(long changes) {
+    return changes > LIST_BULK_PATCH_MAX || changes > listCounter_get() / 64;
+}
 
-    fillTask(new_task);
-    List *new_node = malloc(sizeof(List));
-    if (!new_node) {
-        printf("Failed to allocate memory for list node.\n");
-        free(new_task);
-        return;
-    }
+/**
+ * @brief Defers BST maintenance once a group of changes outgrows patching.
+ *
+ * Groups whose size is only known as they go (transactions, undo and redo of a
+ * group) patch the BSTs per change until list_bulkRebuilds() says one rebuild at
+ * the end is cheaper.
+ *
+ * @param changes Number of changes made by the group so far.
+ * @param deferred Set to 1 once the group defers (the caller resumes at its end).
+ */
+static void list_growGroup(long changes, int *deferred) {
+    if (*deferred || !list_bulkRebuilds(changes)) return;
+    *deferred = 1;
+    index_deferred++;
+}
 
-    new_node->task = new_task;
-    new_node->next = NULL;
-    List *temp = head;
-    while (temp->next != NULL) {
-        temp = temp->next;
+/**
+ * @brief Pushes a record to the undo history, chaining it into the open group.
+ *
+ * Records pushed after the first one of a transaction (or when the caller asks for
+ * it) are flagged REC_CHAINED so the whole group undoes as a unit.
+ *
+ * A record the stack could not keep marks the open transaction as one that can no
+ * longer be rolled back.
+ *
+ * @param stack Pointer to the undo stack (NULL to keep no history).
+ * @param record Pointer to the record to push.
+ * @param chained 1 to chain with the previous record regardless of transactions.
+ */
+static void list_record(Stack *stack, StackNode *record, int chained) {
+    int kept = 0;
+    if (stack) {
+        if (chained || (txn_active && txn_records > 0))
+            record->flags |= REC_CHAINED;
+        kept = stack_pushRecord(stack, record);
+    } else {
+        task_free(record->task);
     }
+    if (txn_active) {
+        txn_records++;
+        if (!kept) txn_broken = 1;
+        list_growGroup(txn_records, &txn_deferred);
+    }
+}
 
-    temp->next = new_node;
-    listCounter_increment();
-    tree_insert(id_tree, new_task);
-    tree_insert(priority_tree, new_task);
-    tree_insert(status_tree, new_task);
+/**
+ * @brief Makes room in the undo history for the records of a bulk operation.
+ *
+ * @param stack Pointer to the undo stack (NULL to keep no history).
+ * @param records Number of records the operation will push.
+ * @return 1 on success, 0 if memory ran out (the operation must not start).
+ */
+static int list_reserveRecords(Stack *stack, long records) {
+    if (!stack || records <= 0) return 1;
+    if (records > INT_MAX) return 0;
+    return stack_reserve(stack, (int)records, txn_active && txn_records > 0);
+}
 
-    printf("\nSaving your task");
-    loadingBar(10);
+/**
+ * @brief Records an insertion in the undo history.
+ *
+ * @param stack Pointer to the undo stack.
+ * @param task Pointer to the inserted Task (stays owned by the list).
+ * @param position Where the task was inserted.
+ * @param target_id ID of the task it was inserted after (for POS_MIDDLE).
+ */
+static void list_logAdd(Stack *stack, Task *task, TaskPosition position, int target_id) {
+    StackNode record = {0};
+    record.type = OP_ADD;
+    record.task_id = task->id;
+    record.position = (unsigned char)position;
+    record.target_id = target_id;
+    list_record(stack, &record, 0);
 }
 
 /**
- * @brief Adds a new task after a node with a given ID.
+ * @brief Records a removal in the undo history, handing the task to the stack.
  *
- * Prompts for the ID of the task to insert after, allocates memory for a new List
- * node and Task, and inserts it. Updates the task counter and BSTs.
+ * @param stack Pointer to the undo stack (NULL frees the task).
+ * @param task Pointer to the removed Task (ownership passes to the stack).
+ * @param position Where the task was.
+ * @param target_id ID of the task before it (for POS_MIDDLE).
+ * @param chained 1 to chain with the previous record (e.g. clearing the list).
+ */
+static void list_logRemove(Stack *stack, Task *task, TaskPosition position, int target_id, int chained) {
+    StackNode record = {0};
+    record.type = OP_REMOVE;
+    record.task = task;
+    record.task_id = task->id;
+    record.position = (unsigned char)position;
+    record.target_id = target_id;
+    list_record(stack, &record, chained);
+}
+
+/**
+ * @brief Finds the list node holding a task ID through the ID index.
  *
  * @param head Pointer to the head of the list.
- * @param stack Pointer to the undo stack.
+ * @param id The ID to look for.
+ * @return Pointer to the node, or NULL if not found.
+ */
+static List* list_findByID(List *head, int id) {
+    long long value;
+    if (head == NULL || !idmap_get(&list_index, id, &value)) return NULL;
+    return (List *)(intptr_t)value;
+}
+
+/**
+ * @brief Links a task into the list at a given position.
+ *
+ * POS_MIDDLE inserts after the task with ID target_id, falling back to the head if
+ * that task no longer exists. Updates the ID index, task counter, statistics and BSTs.
+ *
+ * @param head Pointer to the head of the list.
+ * @param task Pointer to the Task to link (ownership passes to the list on success).
+ * @param position Where to insert the task.
+ * @param target_id ID of the task to insert after (for POS_MIDDLE).
+ * @param ok Set to 1 on success, 0 if memory could not be allocated.
  * @param id_tree Pointer to the BST sorted by ID.
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
+ * @return New head of the list.
  */
-void list_addToMiddle(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
-    if (head == NULL) {
-        printf("The list is not initialized.\n");
-        return;
-    }
+static List* list_linkTask(List *head, Task *task, TaskPosition position, int target_id, int *ok,
+                           Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    List *prev = NULL;
+    if (head == NULL) list_tail = NULL;
+    else if (position == POS_END) prev = list_tail;
+    else if (position == POS_MIDDLE) prev = list_findByID(head, target_id);
 
-    int target_id = readInt("Enter the ID of the task to insert after: ");
-    List *current = head;
-    while (current != NULL && current->task->id != target_id) {
-        current = current->next;
+    List *new_node = mem_alloc(MEM_LIST, sizeof(List));
+    if (!new_node || !idmap_put(&list_index, task->id, (long long)(intptr_t)new_node)) {
+        mem_free(MEM_LIST, new_node, sizeof(List));
+        *ok = 0;
+        return head;
     }
+    metrics_count(METRIC_CURRENT, 0, 1);
 
-    if (current == NULL) {
-        printf("Task with ID %d not found.\n", target_id);
-        return;
+    *ok = 1;
+    new_node->task = task;
+    new_node->prev = prev;
+    if (prev == NULL) {
+        new_node->next = head;
+        head = new_node;
+    } else {
+        new_node->next = prev->next;
+        prev->next = new_node;
     }
+    if (new_node->next) new_node->next->prev = new_node;
+    else list_tail = new_node;
 
-    Task *new_task = malloc(sizeof(Task));
-    if (!new_task) {
-        printf("Failed to allocate memory for new task.\n");
-        return;
-    }
+    list_indexTask(task, id_tree, priority_tree, status_tree);
+    return head;
+}
 
-    fillTask(new_task);
-    List *new_node = malloc(sizeof(List));
-    if (!new_node) {
-        printf("Failed to allocate memory for new node.\n");
-        free(new_task);
-        return;
+/**
+ * @brief Unlinks a node from the list and frees it (not its task).
+ *
+ * Updates the ID index, task counter, statistics and BSTs. The position is reported
+ * as POS_HEAD or POS_MIDDLE after the previous task.
+ *
+ * @param head Pointer to the head of the list.
+ * @param node Pointer to the node to unlink.
+ * @param position Set to the position the task occupied.
+ * @param prev_id Set to the ID of the previous task (for POS_MIDDLE).
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return New head of the list.
+ */
+static List* list_unlinkNode(List *head, List *node, TaskPosition *position, int *prev_id,
+                             Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    *position = node->prev ? POS_MIDDLE : POS_HEAD;
+    *prev_id = node->prev ? node->prev->task->id : 0;
+
+    if (node->prev) node->prev->next = node->next;
+    else head = node->next;
+    if (node->next) node->next->prev = node->prev;
+    else list_tail = node->prev;
+
+    // Files written by older versions may hold duplicate IDs: only drop our own entry
+    if (list_findByID(node, node->task->id) == node)
+        idmap_remove(&list_index, node->task->id);
+    list_unindexTask(node->task, id_tree, priority_tree, status_tree);
+    mem_free(MEM_LIST, node, sizeof(List));
+    return head;
+}
+
+/**
+ * @brief Unlinks the task with a given ID from the list.
+ *
+ * @param head Pointer to the head of the list.
+ * @param id The ID of the task to unlink.
+ * @param task Set to the unlinked Task, or NULL if the ID was not found.
+ * @param position Set to the position the task occupied.
+ * @param prev_id Set to the ID of the previous task (for POS_MIDDLE).
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return New head of the list.
+ */
+static List* list_unlinkByID(List *head, int id, Task **task, TaskPosition *position, int *prev_id,
+                             Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    List *node = list_findByID(head, id);
+    *task = node ? node->task : NULL;
+    if (node == NULL) return head;
+    return list_unlinkNode(head, node, position, prev_id, id_tree, priority_tree, status_tree);
+}
+
+/**
+ * @brief Changes the priority and status of a task in the list.
+ *
+ * Repositions the task in the priority and status BSTs and updates the statistics.
+ *
+ * @param task Pointer to the Task to change.
+ * @param priority The new priority.
+ * @param status The new status.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+static void list_setFields(Task *task, Priority priority, Status status, Tree *priority_tree, Tree *status_tree) {
+    Priority old_priority = task->priority;
+    Status old_status = task->status;
+    if (index_deferred) {
+        index_dirty = 1;
+    } else {
+        tree_remove(priority_tree, task);
+        tree_remove(status_tree, task);
     }
+    task->priority = priority;
+    task->status = status;
+    if (!index_deferred) {
+        tree_insert(priority_tree, task);
+        tree_insert(status_tree, task);
+    }
+    stats_onUpdate(old_priority, old_status, task);
+    if (priority != old_priority || status != old_status) tags_onUpdate(old_priority, old_status, task);
+    if (status != old_status) {
+        deps_onUpdate(task);
+        deadline_onUpdate(task);
+    }
+}
 
-    new_node->task = new_task;
-    new_node->next = current->next;
-    current->next = new_node;
-    listCounter_increment();
-    tree_insert(id_tree, new_task);
-    tree_insert(priority_tree, new_task);
-    tree_insert(status_tree, new_task);
+/**
+ * @brief Finds a task by its ID in O(1).
+ *
+ * @param head Pointer to the head of the list.
+ * @param id The ID to look for.
+ * @return Pointer to the Task (still owned by the list), or NULL if not found.
+ */
+Task* list_findTask(List *head, int id) {
+    long long start = metrics_begin(METRIC_LIST_FIND);
+    List *node = list_findByID(head, id);
+    metrics_end(METRIC_LIST_FIND, start);
+    return node ? node->task : NULL;
+}
 
-    printf("\nSaving your task");
-    loadingBar(10);
+/**
+ * @brief Returns the task after a given one in list order, in O(1).
+ *
+ * @param head Pointer to the head of the list.
+ * @param task Pointer to a Task in the list.
+ * @return The next Task, or NULL at the tail or if the task is not in the list.
+ */
+Task* list_nextTask(List *head, Task *task) {
+    long long start = metrics_begin(METRIC_LIST_STEP);
+    List *node = list_findByID(head, task->id);
+    metrics_end(METRIC_LIST_STEP, start);
+    return node && node->task == task && node->next ? node->next->task : NULL;
 }
 
 /**
- * @brief Prints all tasks in the linked list.
+ * @brief Returns the task before a given one in list order, in O(1).
  *
- * Traverses the list from head to tail and prints each task using printTask().
+ * @param head Pointer to the head of the list.
+ * @param task Pointer to a Task in the list.
+ * @return The previous Task, or NULL at the head or if the task is not in the list.
+ */
+Task* list_prevTask(List *head, Task *task) {
+    long long start = metrics_begin(METRIC_LIST_STEP);
+    List *node = list_findByID(head, task->id);
+    metrics_end(METRIC_LIST_STEP, start);
+    return node && node->task == task && node->prev ? node->prev->task : NULL;
+}
+
+/**
+ * @brief Returns the last task of the list, in O(1).
  *
  * @param head Pointer to the head of the list.
+ * @return The Task at the tail, or NULL if the list is empty.
  */
-void list_printAll(List *head) {
-    if (head == NULL) {
-        printf("No tasks to display. List is empty.\n");
-        return;
-    }
+Task* list_lastTask(List *head) {
+    return head && list_tail ? list_tail->task : NULL;
+}
 
-    int index = 1;
-    List *current = head;
-    printf("\n> Task List:\n");
-    printf("---------------------------------\n");
+/**
+ * @brief Body of list_insertTask().
+ */
+static ListStatus list_insert(List **head, Task *task, TaskPosition position, int target_id, Stack *stack,
+                              Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    if (list_hasID(*head, task->id)) return LIST_DUPLICATE_ID;
+    if (position == POS_MIDDLE && !list_hasID(*head, target_id)) return LIST_NOT_FOUND;
 
-    while (current != NULL) {
-        printf("\nTask #%d:\n", index);
-        printTask(current->task);
-        current = current->next;
-        index++;
-    }
+    // Edges and tags left by a removed task with the same ID (kept for its undo) are not the new task's
+    deps_dropTask(task->id);
+    tags_removeAll(task->id);
 
-    printf("\nTotal tasks: %d\n\n", listCounter_get());
+    int ok;
+    *head = list_linkTask(*head, task, position, target_id, &ok, id_tree, priority_tree, status_tree);
+    if (!ok) return LIST_NO_MEMORY;
+    list_logAdd(stack, task, position, target_id);
+    return LIST_OK;
 }
 
 /**
- * @brief Removes the first task (head) from the list.
+ * @brief Inserts a task at a given position, without prompts or output.
  *
- * Pushes the task to the undo stack and frees the List node. Updates the task counter.
+ * The list takes ownership of the task only when LIST_OK is returned.
  *
- * @param head Pointer to the head of the list.
- * @param stack Pointer to the undo stack.
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param task Pointer to the Task to insert.
+ * @param position Where to insert the task.
+ * @param target_id ID of the task to insert after (for POS_MIDDLE).
+ * @param stack Pointer to the undo stack (NULL to keep no history).
  * @param id_tree Pointer to the BST sorted by ID.
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
- * @return New head of the list (could be NULL).
+ * @return LIST_OK, LIST_DUPLICATE_ID, LIST_NOT_FOUND (no such target) or LIST_NO_MEMORY.
  */
-List* list_removeFromHead(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
-    if (head == NULL) {
-        printf("List is already empty.\n");
-        return NULL;
-    }
+ListStatus list_insertTask(List **head, Task *task, TaskPosition position, int target_id, Stack *stack,
+                           Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    long long start = metrics_begin(METRIC_LIST_INSERT);
+    ListStatus status = list_insert(head, task, position, target_id, stack, id_tree, priority_tree, status_tree);
+    metrics_end(METRIC_LIST_INSERT, start);
+    return status;
+}
 
-    List *temp = head;
-    stack_push(stack, temp->task, POS_HEAD, 0);
-    head = head->next;
-    free(temp);
-    listCounter_decrement();
+/**
+ * @brief Body of list_removeTask().
+ */
+static ListStatus list_remove(List **head, int id, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    Task *task;
+    TaskPosition position;
+    int prev_id;
+    *head = list_unlinkByID(*head, id, &task, &position, &prev_id, id_tree, priority_tree, status_tree);
+    if (task == NULL) return LIST_NOT_FOUND;
+    list_logRemove(stack, task, position, prev_id, 0);
+    return LIST_OK;
+}
 
-    printf("Removing the task");
-    loadingBar(10);
-    return head;
+/**
+ * @brief Removes the task with a given ID, without prompts or output.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param id The ID of the task to remove.
+ * @param stack Pointer to the undo stack (NULL frees the task).
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK or LIST_NOT_FOUND.
+ */
+ListStatus list_removeTask(List **head, int id, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    long long start = metrics_begin(METRIC_LIST_REMOVE);
+    ListStatus status = list_remove(head, id, stack, id_tree, priority_tree, status_tree);
+    metrics_end(METRIC_LIST_REMOVE, start);
+    return status;
 }
 
 /**
- * @brief Removes the last task from the list.
+ * @brief Body of list_removeEdge().
+ */
+static ListStatus list_removeAtEdge(List **head, TaskPosition position, Stack *stack,
+                                    Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    if (*head == NULL) return LIST_EMPTY;
+
+    List *node = (position == POS_END) ? list_tail : *head;
+    Task *task = node->task;
+    TaskPosition at;
+    int prev_id;
+    *head = list_unlinkNode(*head, node, &at, &prev_id, id_tree, priority_tree, status_tree);
+    // A removed tail goes back to the end on undo, wherever the end is by then
+    list_logRemove(stack, task, at == POS_HEAD ? POS_HEAD : POS_END, 0, 0);
+    return LIST_OK;
+}
+
+/**
+ * @brief Removes the first or the last task, without prompts or output.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param position POS_HEAD or POS_END.
+ * @param stack Pointer to the undo stack (NULL frees the task).
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK or LIST_EMPTY.
+ */
+ListStatus list_removeEdge(List **head, TaskPosition position, Stack *stack,
+                           Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    long long start = metrics_begin(METRIC_LIST_REMOVE_EDGE);
+    ListStatus status = list_removeAtEdge(head, position, stack, id_tree, priority_tree, status_tree);
+    metrics_end(METRIC_LIST_REMOVE_EDGE, start);
+    return status;
+}
+
+/**
+ * @brief Body of list_setTaskFields().
+ */
+static ListStatus list_update(List *head, int id, Priority priority, Status status, Stack *stack,
+                              Tree *priority_tree, Tree *status_tree) {
+    List *node = list_findByID(head, id);
+    if (node == NULL) return LIST_NOT_FOUND;
+    Task *task = node->task;
+    if (priority == task->priority && status == task->status) return LIST_OK;
+
+    StackNode record = {0};
+    record.type = OP_UPDATE;
+    record.task_id = id;
+    record.old_priority = (unsigned char)task->priority;
+    record.old_status = (unsigned char)task->status;
+    record.new_priority = (unsigned char)priority;
+    record.new_status = (unsigned char)status;
+    list_setFields(task, priority, status, priority_tree, status_tree);
+    list_record(stack, &record, 0);
+    return LIST_OK;
+}
+
+/**
+ * @brief Sets the priority and status of a task, without prompts or output.
  *
- * Pushes the task to the undo stack and frees the List node. Updates the task counter.
+ * The change is recorded for undo only if something actually changed.
  *
  * @param head Pointer to the head of the list.
- * @param stack Pointer to the undo stack.
- * @param id_tree Pointer to the BST sorted by ID.
+ * @param id The ID of the task to update.
+ * @param priority The new priority.
+ * @param status The new status.
+ * @param stack Pointer to the undo stack (NULL to keep no history).
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK or LIST_NOT_FOUND.
  */
-void list_removeFromEnd(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
-    if (head == NULL) {
-        printf("List is already empty.\n");
-        return;
-    }
+ListStatus list_setTaskFields(List *head, int id, Priority priority, Status status, Stack *stack,
+                              Tree *priority_tree, Tree *status_tree) {
+    long long start = metrics_begin(METRIC_LIST_UPDATE);
+    ListStatus result = list_update(head, id, priority, status, stack, priority_tree, status_tree);
+    metrics_end(METRIC_LIST_UPDATE, start);
+    return result;
+}
 
-    if (head->next == NULL) {
-        stack_push(stack, head->task, POS_HEAD, 0);
-        free(head);
-        head = NULL;
-        listCounter_decrement();
-        printf("Removing the task");
-        loadingBar(10);
-        return;
+/**
+ * @brief Body of list_setTaskDue().
+ *
+ * @param chained 1 to chain the record to the one just pushed, so both undo as one step.
+ */
+static ListStatus list_reschedule(List *head, int id, unsigned int due, Stack *stack, int chained) {
+    List *node = list_findByID(head, id);
+    if (node == NULL) return LIST_NOT_FOUND;
+    Task *task = node->task;
+    if (due == task->due) return LIST_OK;
+
+    StackNode record = {0};
+    record.type = OP_RESCHEDULE;
+    record.task_id = id;
+    record.target_id = (int)task->due;
+    task->due = due;
+    deadline_onUpdate(task);
+    list_record(stack, &record, chained);
+    return LIST_OK;
+}
+
+/**
+ * @brief Sets the due date of a task, without prompts or output.
+ *
+ * The change is recorded for undo only if the date actually changed.
+ *
+ * @param head Pointer to the head of the list.
+ * @param id The ID of the task to update.
+ * @param due The new due date (seconds since the Unix epoch), or 0 for none.
+ * @param stack Pointer to the undo stack (NULL to keep no history).
+ * @return LIST_OK or LIST_NOT_FOUND.
+ */
+ListStatus list_setTaskDue(List *head, int id, unsigned int due, Stack *stack) {
+    long long start = metrics_begin(METRIC_LIST_SET_DUE);
+    ListStatus status = list_reschedule(head, id, due, stack, 0);
+    metrics_end(METRIC_LIST_SET_DUE, start);
+    return status;
+}
+
+/**
+ * @brief Sets the priority, status and due date of a task as one undo step, without prompts or output.
+ *
+ * The due date record is chained to the field record when both change, so no
+ * transaction is needed to undo them together.
+ *
+ * @param head Pointer to the head of the list.
+ * @param id The ID of the task to update.
+ * @param priority The new priority.
+ * @param status The new status.
+ * @param due The new due date (seconds since the Unix epoch), or 0 for none.
+ * @param stack Pointer to the undo stack (NULL to keep no history).
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK or LIST_NOT_FOUND.
+ */
+ListStatus list_setTaskFieldsDue(List *head, int id, Priority priority, Status status, unsigned int due,
+                                 Stack *stack, Tree *priority_tree, Tree *status_tree) {
+    long long start = metrics_begin(METRIC_LIST_UPDATE);
+    List *node = list_findByID(head, id);
+    ListStatus result = LIST_NOT_FOUND;
+    if (node) {
+        int changed = priority != node->task->priority || status != node->task->status;
+        list_update(head, id, priority, status, stack, priority_tree, status_tree);
+        result = list_reschedule(head, id, due, stack, changed);
     }
+    metrics_end(METRIC_LIST_UPDATE, start);
+    return result;
+}
 
-    List *current = head;
-    while (current->next->next != NULL) {
+/**
+ * @brief Removes every task as one undo group, without output.
+ *
+ * @param head Pointer to the head pointer of the list (set to NULL).
+ * @param stack Pointer to the undo stack (NULL frees the tasks).
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void list_clear(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    long long start = metrics_begin(METRIC_LIST_CLEAR);
+    long long span = span_begin();
+    List *temp;
+    List *current = *head;
+    int chained = 0;
+    long cleared = 0;
+    // Without the room, the group is discarded whole rather than kept in part
+    list_reserveRecords(stack, listCounter_get());
+    while (current != NULL) {
+        cleared++;
+        temp = current;
+        list_logRemove(stack, temp->task, POS_HEAD, 0, chained);
+        chained = 1;
         current = current->next;
+        mem_free(MEM_LIST, temp, sizeof(List));
     }
 
-    stack_push(stack, current->next->task, POS_END, 0);
-    free(current->next);
-    current->next = NULL;
-    listCounter_decrement();
+    *head = NULL;
+    list_tail = NULL;
+    idmap_clear(&list_index);
+    tree_clear(id_tree);
+    tree_clear(priority_tree);
+    tree_clear(status_tree);
+    listCounter_reset();
+    stats_reset();
+    deps_onClear();
+    deadline_onClear();
+    tags_onClear();
+    metrics_count(METRIC_LIST_CLEAR, cleared, 0);
+    metrics_end(METRIC_LIST_CLEAR, start);
+    span_end(span, "list.clear", cleared);
+}
 
-    printf("Removing the task");
-    loadingBar(10);
+/**
+ * @brief Predicate evaluation shared by the threads of a bulk operation.
+ */
+typedef struct MatchJob {
+    List **nodes;              // Every node, in list order
+    unsigned char *hits;       // Set to 1 for each node whose task matches
+    TaskPredicate match;
+    void *context;
+} MatchJob;
+
+/**
+ * @brief Evaluates the predicate on one chunk of the nodes.
+ */
+static void list_matchChunk(long begin, long end, void *arg) {
+    MatchJob *job = arg;
+    for (long i = begin; i < end; i++)
+        job->hits[i] = job->match(job->nodes[i]->task, job->context) != 0;
 }
 
 /**
- * @brief Removes a task by its ID.
+ * @brief Collects the nodes whose task matches a predicate.
  *
- * Prompts for the ID, pushes the task to the undo stack, and frees the List node.
- * Updates the task counter.
+ * The nodes are gathered in one walk, then the predicate runs over chunks of them
+ * on parallel threads (see parallel_for()).
  *
  * @param head Pointer to the head of the list.
- * @param stack Pointer to the undo stack.
- * @param id_tree Pointer to the BST sorted by ID.
- * @param priority_tree Pointer to the BST sorted by priority.
- * @param status_tree Pointer to the BST sorted by status.
- * @return New head of the list (in case the head was removed).
+ * @param match The predicate.
+ * @param context Opaque pointer passed to the predicate.
+ * @param matched Set to the number of matching nodes.
+ * @param size Set to the size of the array in bytes, for mem_free().
+ * @return Array of the matching nodes in list order (to be freed), or NULL if memory ran out.
  */
-List* list_removeByID(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
-    if (head == NULL) {
-        printf("The list is empty.\n");
+static List** list_collectMatches(List *head, TaskPredicate match, void *context, long *matched, size_t *size) {
+    long count = listCounter_get();
+    size_t slots = (size_t)(count > 0 ? count : 1);
+    *size = slots * sizeof(List *);
+    List **nodes = mem_alloc(MEM_SCRATCH, *size);
+    unsigned char *hits = mem_alloc(MEM_SCRATCH, slots);
+    if (!nodes || !hits) {
+        mem_free(MEM_SCRATCH, nodes, *size);
+        mem_free(MEM_SCRATCH, hits, slots);
         return NULL;
     }
 
-    int target_id = readInt("Enter the ID of the task to remove: ");
-    if (head->task->id == target_id) {
-        stack_push(stack, head->task, POS_HEAD, 0);
-        List *new_head = head->next;
-        free(head);
-        listCounter_decrement();
-        printf("Removing the task");
-        loadingBar(10);
-        printf("Task with ID %d removed (it was at the head).\n", target_id);
-        return new_head;
+    long long span = span_begin();
+    long n = 0;
+    for (List *node = head; node != NULL && n < count; node = node->next) nodes[n++] = node;
+    metrics_count(METRIC_CURRENT, n, 0);
+    MatchJob job = { nodes, hits, match, context };
+    parallel_for(n, list_matchChunk, &job);
+
+    *matched = 0;
+    for (long i = 0; i < n; i++)
+        if (hits[i]) nodes[(*matched)++] = nodes[i];
+    mem_free(MEM_SCRATCH, hits, slots);
+    span_end(span, "list.match", n);
+    return nodes;
+}
+
+/**
+ * @brief Body of list_updateWhere().
+ */
+static ListStatus list_updateMatches(List *head, TaskPredicate match, void *context, Priority priority, Status status,
+                                     Stack *stack, long *changed, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    long matched, count = 0;
+    size_t size;
+    if (changed) *changed = 0;
+    List **nodes = list_collectMatches(head, match, context, &matched, &size);
+    if (!nodes) return LIST_NO_MEMORY;
+    if (!list_reserveRecords(stack, matched)) {
+        mem_free(MEM_SCRATCH, nodes, size);
+        return LIST_NO_MEMORY;
     }
 
-    List *current = head;
-    int prev_id = current->task->id;
-    while (current->next != NULL && current->next->task->id != target_id) {
-        prev_id = current->task->id;
-        current = current->next;
+    int rebuild = list_bulkRebuilds(matched);
+    if (rebuild) index_deferred++;
+    for (long i = 0; i < matched; i++) {
+        Task *task = nodes[i]->task;
+        Priority new_priority = priority ? priority : task->priority;
+        Status new_status = status ? status : task->status;
+        if (new_priority == task->priority && new_status == task->status) continue;
+
+        StackNode record = {0};
+        record.type = OP_UPDATE;
+        record.task_id = task->id;
+        record.old_priority = (unsigned char)task->priority;
+        record.old_status = (unsigned char)task->status;
+        record.new_priority = (unsigned char)new_priority;
+        record.new_status = (unsigned char)new_status;
+        list_setFields(task, new_priority, new_status, priority_tree, status_tree);
+        list_record(stack, &record, count > 0);
+        count++;
     }
+    mem_free(MEM_SCRATCH, nodes, size);
+    if (rebuild) list_resumeIndexes(head, id_tree, priority_tree, status_tree);
 
-    if (current->next == NULL) {
-        printf("Task with ID %d not found.\n", target_id);
-        return head;
+    if (changed) *changed = count;
+    return LIST_OK;
+}
+
+/**
+ * @brief Sets the priority and/or status of every task matching a predicate.
+ *
+ * The predicate runs on parallel threads over chunks of the list, so it must be
+ * safe to call concurrently and must not modify tasks. The matching tasks are then
+ * changed in one pass, recorded as a single undo group, and the BSTs are fixed once.
+ *
+ * @param head Pointer to the head of the list.
+ * @param match The predicate.
+ * @param context Opaque pointer passed to the predicate.
+ * @param priority The new priority, or 0 to keep each task's own.
+ * @param status The new status, or 0 to keep each task's own.
+ * @param stack Pointer to the undo stack (NULL to keep no history).
+ * @param changed Set to the number of tasks actually changed (may be NULL).
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK, or LIST_NO_MEMORY (nothing changed).
+ */
+ListStatus list_updateWhere(List *head, TaskPredicate match, void *context, Priority priority, Status status,
+                            Stack *stack, long *changed, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    long long start = metrics_begin(METRIC_LIST_UPDATE_WHERE);
+    long long span = span_begin();
+    long count = 0;
+    ListStatus result = list_updateMatches(head, match, context, priority, status, stack, &count,
+                                           id_tree, priority_tree, status_tree);
+    if (changed) *changed = count;
+    metrics_end(METRIC_LIST_UPDATE_WHERE, start);
+    span_end(span, "list.updateWhere", count);
+    return result;
+}
+
+/**
+ * @brief Body of list_removeWhere().
+ */
+static ListStatus list_removeMatches(List **head, TaskPredicate match, void *context, Stack *stack, long *removed,
+                                     Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    long matched;
+    size_t size;
+    if (removed) *removed = 0;
+    List **nodes = list_collectMatches(*head, match, context, &matched, &size);
+    if (!nodes) return LIST_NO_MEMORY;
+    if (!list_reserveRecords(stack, matched)) {
+        mem_free(MEM_SCRATCH, nodes, size);
+        return LIST_NO_MEMORY;
     }
 
-    List *to_delete = current->next;
-    stack_push(stack, to_delete->task, POS_MIDDLE, prev_id);
-    current->next = to_delete->next;
-    free(to_delete);
-    listCounter_decrement();
+    int rebuild = list_bulkRebuilds(matched);
+    if (rebuild) index_deferred++;
+    for (long i = 0; i < matched; i++) {
+        Task *task = nodes[i]->task;
+        TaskPosition position;
+        int prev_id;
+        // In list order, each task's predecessor is a survivor, so undo can relink after it
+        *head = list_unlinkNode(*head, nodes[i], &position, &prev_id, id_tree, priority_tree, status_tree);
+        list_logRemove(stack, task, position, prev_id, i > 0);
+    }
+    mem_free(MEM_SCRATCH, nodes, size);
+    if (rebuild) list_resumeIndexes(*head, id_tree, priority_tree, status_tree);
 
-    printf("Removing the task");
-    loadingBar(10);
-    printf("Task with ID %d removed successfully.\n", target_id);
-    return head;
+    if (removed) *removed = matched;
+    return LIST_OK;
 }
 
 /**
- * @brief Frees all tasks and nodes in the list.
+ * @brief Removes every task matching a predicate.
  *
- * Pushes all tasks to the undo stack and frees all List nodes. Resets the task counter.
+ * Evaluated like list_updateWhere(). The removals are recorded as a single undo
+ * group; undoing it puts every task back at its place in the list.
  *
- * @param head Pointer to the head of the list.
- * @param stack Pointer to the undo stack.
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param match The predicate.
+ * @param context Opaque pointer passed to the predicate.
+ * @param stack Pointer to the undo stack (NULL frees the tasks).
+ * @param removed Set to the number of tasks removed (may be NULL).
  * @param id_tree Pointer to the BST sorted by ID.
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK, or LIST_NO_MEMORY (nothing removed).
+ */
+ListStatus list_removeWhere(List **head, TaskPredicate match, void *context, Stack *stack, long *removed,
+                            Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    long long start = metrics_begin(METRIC_LIST_REMOVE_WHERE);
+    long long span = span_begin();
+    long count = 0;
+    ListStatus status = list_removeMatches(head, match, context, stack, &count, id_tree, priority_tree, status_tree);
+    if (removed) *removed = count;
+    metrics_end(METRIC_LIST_REMOVE_WHERE, start);
+    span_end(span, "list.removeWhere", count);
+    return status;
+}
+
+/**
+ * @brief Frees all tasks and nodes in the list without touching the undo stack.
+ *
+ * Used on exit, where pushing every task to the stack would only spill them to the trash.
+ *
+ * @param head Pointer to the head of the list.
  */
-void list_freeAll(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+void list_destroy(List *head) {
+    long long span = span_begin();
+    long freed = 0;
     List *temp;
     while (head != NULL) {
+        freed++;
         temp = head;
-        stack_push(stack, temp->task, POS_HEAD, 0);
         head = head->next;
-        free(temp);
+        task_free(temp->task);
+        mem_free(MEM_LIST, temp, sizeof(List));
     }
-
-    printf("Removing all tasks ");
-    loadingBar(20);
-    printf("All tasks cleared and moved to stack.\n");
+    list_tail = NULL;
+    idmap_free(&list_index);
     listCounter_reset();
+    stats_reset();
+    deps_reset();
+    deadline_reset();
+    tags_reset();
+    span_end(span, "list.destroy", freed);
 }
 
 /**
  * @brief Checks if a task ID exists in the list.
  *
+ * Answers in O(1) from the ID index.
+ *
  * @param head Pointer to the head of the list.
  * @param id The ID to check for.
  * @return 1 if the ID exists, 0 otherwise.
  */
 int list_hasID(List *head, int id) {
-    List *current = head;
-    while (current != NULL) {
-        if (current->task->id == id) return 1;
-        current = current->next;
-    }
-    return 0;
+    return list_findByID(head, id) != NULL;
 }
 
 /**
- * @brief Restores a task from the undo stack to its original position.
+ * @brief Undoes or redoes a reschedule: swaps the task's due date with the record's.
  *
- * Pops a task from the stack, checks for ID conflicts, and inserts it back into the list
- * at its original position (head, middle, or end). Updates the task counter and BSTs.
+ * @param head Pointer to the head of the list.
+ * @param op Pointer to the OP_RESCHEDULE record.
+ */
+static void list_swapDue(List *head, StackNode *op) {
+    List *node = list_findByID(head, op->task_id);
+    if (!node) return;
+    unsigned int due = (unsigned int)op->target_id;
+    op->target_id = (int)node->task->due;
+    node->task->due = due;
+    deadline_onUpdate(node->task);
+}
+
+/**
+ * @brief Reverts one operation record.
+ *
+ * An undone add unlinks the task again, an undone removal relinks the task at its
+ * original position, an undone update restores the previous priority and status,
+ * and an undone reschedule the previous due date.
  *
  * @param head Pointer to the head of the list.
- * @param stack Pointer to the undo stack.
+ * @param op Pointer to the record (already moved to the redo side).
+ * @param status Set to LIST_OK, or to the reason the record must stay on the undo side.
  * @param id_tree Pointer to the BST sorted by ID.
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
- * @return New head of the list (if restored to head).
+ * @return New head of the list.
  */
-List* list_restoreTask(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+static List* list_revert(List *head, StackNode *op, ListStatus *status,
+                         Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
     TaskPosition position;
-    int target_id;
-    Task *task = stack_pop(stack, &position, &target_id);
-    if (!task) {
-        printf("No tasks to undo.\n");
-        return head;
+    List *node;
+    int ok;
+    *status = LIST_OK;
+    metrics_count(METRIC_CURRENT, 1, 0);
+    switch (op->type) {
+        case OP_ADD:
+            head = list_unlinkByID(head, op->task_id, &op->task, &position, &op->target_id,
+                                   id_tree, priority_tree, status_tree);
+            if (op->task) op->position = (unsigned char)position;
+            break;
+
+        case OP_REMOVE:
+            if (list_hasID(head, op->task->id)) {
+                *status = LIST_DUPLICATE_ID;
+                break;
+            }
+            op->task_id = op->task->id;
+            head = list_linkTask(head, op->task, (TaskPosition)op->position, op->target_id, &ok,
+                                 id_tree, priority_tree, status_tree);
+            if (ok) op->task = NULL;
+            else *status = LIST_NO_MEMORY;
+            break;
+
+        case OP_UPDATE:
+            node = list_findByID(head, op->task_id);
+            if (node)
+                list_setFields(node->task, (Priority)op->old_priority, (Status)op->old_status,
+                               priority_tree, status_tree);
+            break;
+
+        case OP_RESCHEDULE:
+            list_swapDue(head, op);
+            break;
     }
+    return head;
+}
 
-    // Check for ID conflict
-    if (list_hasID(head, task->id)) {
-        printf("Task ID %d already exists. Enter a new ID: ", task->id);
-        task->id = readInt("  New ID: ");
-        while (list_hasID(head, task->id)) {
-            printf("Task ID %d already exists. Enter a different ID: ", task->id);
-            task->id = readInt("  New ID: ");
-        }
+/**
+ * @brief Re-applies one operation record.
+ *
+ * @param head Pointer to the head of the list.
+ * @param op Pointer to the record (already moved back to the undo side).
+ * @param status Set to LIST_OK, or to the reason the record must stay on the redo side.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return New head of the list.
+ */
+static List* list_reapply(List *head, StackNode *op, ListStatus *status,
+                          Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    TaskPosition position;
+    List *node;
+    int ok;
+    *status = LIST_OK;
+    metrics_count(METRIC_CURRENT, 1, 0);
+    switch (op->type) {
+        case OP_ADD:
+            if (!op->task) break;
+            if (list_hasID(head, op->task->id)) {
+                *status = LIST_DUPLICATE_ID;
+                break;
+            }
+            op->task_id = op->task->id;
+            head = list_linkTask(head, op->task, (TaskPosition)op->position, op->target_id, &ok,
+                                 id_tree, priority_tree, status_tree);
+            if (ok) op->task = NULL;
+            else *status = LIST_NO_MEMORY;
+            break;
+
+        case OP_REMOVE:
+            head = list_unlinkByID(head, op->task_id, &op->task, &position, &op->target_id,
+                                   id_tree, priority_tree, status_tree);
+            if (op->task) op->position = (unsigned char)position;
+            break;
+
+        case OP_UPDATE:
+            node = list_findByID(head, op->task_id);
+            if (node)
+                list_setFields(node->task, (Priority)op->new_priority, (Status)op->new_status,
+                               priority_tree, status_tree);
+            break;
+
+        case OP_RESCHEDULE:
+            list_swapDue(head, op);
+            break;
     }
+    return head;
+}
 
-    List *new_node = malloc(sizeof(List));
-    if (!new_node) {
-        printf("Failed to allocate memory for new node.\n");
-        stack_push(stack, task, position, target_id);
-        return head;
+/**
+ * @brief Body of list_undoStep().
+ */
+static ListStatus list_undo(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    if (txn_active) return LIST_BAD_STATE;
+    StackNode *op = stack_undo(stack);
+    if (!op) return LIST_EMPTY;
+
+    ListStatus status = LIST_OK;
+    long changes = 0;
+    int deferred = 0;
+    while (op) {
+        list_growGroup(++changes, &deferred);
+        *head = list_revert(*head, op, &status, id_tree, priority_tree, status_tree);
+        if (status != LIST_OK) {
+            stack_redo(stack); // keep the record on the undo side
+            break;
+        }
+        if (!(op->flags & REC_CHAINED)) break;
+        op = stack_undo(stack);
     }
+    if (deferred) list_resumeIndexes(*head, id_tree, priority_tree, status_tree);
+    return status;
+}
 
-    new_node->task = task;
+/**
+ * @brief Undoes the most recent operation or group, without prompts or output.
+ *
+ * A group (transaction or clear-all) is undone as a unit; a large one rebuilds the
+ * BSTs once at its end instead of patching them per task.
+ * If a removed task cannot come back because its ID is taken, its record stays on
+ * the undo side (stack_peek()) and the records after it in the group stay reverted;
+ * the caller may give the task a new ID and call again to finish the group.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK, LIST_EMPTY (nothing to undo), LIST_BAD_STATE (transaction open),
+ *         LIST_DUPLICATE_ID (a restored task's ID is taken) or LIST_NO_MEMORY.
+ */
+ListStatus list_undoStep(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    long long start = metrics_begin(METRIC_LIST_UNDO);
+    ListStatus status = list_undo(head, stack, id_tree, priority_tree, status_tree);
+    metrics_end(METRIC_LIST_UNDO, start);
+    return status;
+}
 
-    if (position == POS_HEAD || head == NULL) {
-        new_node->next = head;
-        listCounter_increment();
-        tree_insert(id_tree, task);
-        tree_insert(priority_tree, task);
-        tree_insert(status_tree, task);
-        printf("Restoring task with ID %d to head", task->id);
-        loadingBar(10);
-        printf("Task restored successfully.\n");
-        return new_node;
-    } else if (position == POS_END) {
-        new_node->next = NULL;
-        List *current = head;
-        while (current->next != NULL) {
-            current = current->next;
+/**
+ * @brief Body of list_redoStep().
+ */
+static ListStatus list_redo(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    if (txn_active) return LIST_BAD_STATE;
+    StackNode *op = stack_redo(stack);
+    if (!op) return LIST_EMPTY;
+
+    ListStatus status = LIST_OK;
+    StackNode *next;
+    long changes = 0;
+    int deferred = 0;
+    while (op) {
+        list_growGroup(++changes, &deferred);
+        *head = list_reapply(*head, op, &status, id_tree, priority_tree, status_tree);
+        if (status != LIST_OK) {
+            stack_undo(stack); // keep the record on the redo side
+            break;
         }
-        current->next = new_node;
-        listCounter_increment();
-        tree_insert(id_tree, task);
-        tree_insert(priority_tree, task);
-        tree_insert(status_tree, task);
-        printf("Restoring task with ID %d to end", task->id);
-        loadingBar(10);
-        printf("Task restored successfully.\n");
-        return head;
-    } else { // POS_MIDDLE
-        List *current = head;
-        while (current != NULL && current->task->id != target_id) {
-            current = current->next;
+        next = stack_peekRedo(stack);
+        op = (next && (next->flags & REC_CHAINED)) ? stack_redo(stack) : NULL;
+    }
+    if (deferred) list_resumeIndexes(*head, id_tree, priority_tree, status_tree);
+    return status;
+}
+
+/**
+ * @brief Re-applies the most recently undone operation or group, without prompts or output.
+ *
+ * Conflicts are handled as in list_undoStep(), with the record kept on the redo
+ * side (stack_peekRedo()).
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK, LIST_EMPTY (nothing to redo), LIST_BAD_STATE, LIST_DUPLICATE_ID or LIST_NO_MEMORY.
+ */
+ListStatus list_redoStep(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    long long start = metrics_begin(METRIC_LIST_REDO);
+    ListStatus status = list_redo(head, stack, id_tree, priority_tree, status_tree);
+    metrics_end(METRIC_LIST_REDO, start);
+    return status;
+}
+
+/**
+ * @brief Rebuilds the three BSTs from the list in one batch.
+ *
+ * Collects the tasks once and builds each tree balanced in O(n log n).
+ *
+ * @param head Pointer to the head of the list.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void list_rebuildIndexes(List *head, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    long long start = metrics_begin(METRIC_LIST_REBUILD);
+    long long span = span_begin();
+    int count = 0;
+    for (List *current = head; current != NULL; current = current->next) count++;
+    metrics_count(METRIC_LIST_REBUILD, count, 0);
+
+    size_t size = sizeof(Task *) * (count > 0 ? count : 1);
+    Task **tasks = mem_alloc(MEM_SCRATCH, size);
+    if (!tasks) {
+        // Fall back to one insertion per task
+        tree_clear(id_tree);
+        tree_clear(priority_tree);
+        tree_clear(status_tree);
+        for (List *current = head; current != NULL; current = current->next) {
+            tree_insert(id_tree, current->task);
+            tree_insert(priority_tree, current->task);
+            tree_insert(status_tree, current->task);
         }
-        if (current == NULL) {
-            new_node->next = head;
-            listCounter_increment();
-            tree_insert(id_tree, task);
-            tree_insert(priority_tree, task);
-            tree_insert(status_tree, task);
-            printf("Restoring task with ID %d to head (target ID %d not found)", task->id, target_id);
-            loadingBar(10);
-            printf("Task restored successfully.\n");
-            return new_node;
+    } else {
+        Tree *trees[3] = { id_tree, priority_tree, status_tree };
+        for (int t = 0; t < 3; t++) {
+            int i = 0;
+            for (List *current = head; current != NULL; current = current->next) tasks[i++] = current->task;
+            tree_build(trees[t], tasks, count);
         }
-        new_node->next = current->next;
-        current->next = new_node;
-        listCounter_increment();
-        tree_insert(id_tree, task);
-        tree_insert(priority_tree, task);
-        tree_insert(status_tree, task);
-        printf("Restoring task with ID %d after ID %d", task->id, target_id);
-        loadingBar(10);
-        printf("Task restored successfully.\n");
-        return head;
+        mem_free(MEM_SCRATCH, tasks, size);
     }
+    index_dirty = 0;
+    metrics_end(METRIC_LIST_REBUILD, start);
+    span_end(span, "list.rebuild", count);
 }
 
 /**
- * @brief Updates the priority and status of a task by its ID.
+ * @brief Brings the BSTs up to date if maintenance was deferred.
  *
- * Prompts for the task ID, updates its priority and status, and rebuilds the BSTs
- * to reflect the changes.
+ * Cheap when nothing changed; called before any sorted view is displayed.
  *
  * @param head Pointer to the head of the list.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void list_syncIndexes(List *head, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    if (index_dirty) list_rebuildIndexes(head, id_tree, priority_tree, status_tree);
+}
+
+/**
+ * @brief Starts deferring BST maintenance until the matching list_resumeIndexes().
+ *
+ * Calls nest; mutations in between only mark the BSTs stale.
+ */
+void list_deferIndexes() {
+    index_deferred++;
+}
+
+/**
+ * @brief Ends one level of deferral, rebuilding the BSTs once at the outermost level.
+ *
+ * @param head Pointer to the head of the list.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void list_resumeIndexes(List *head, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    if (index_deferred > 0) index_deferred--;
+    if (index_deferred == 0) list_syncIndexes(head, id_tree, priority_tree, status_tree);
+}
+
+/**
+ * @brief Opens a transaction, without output.
+ *
+ * @return LIST_OK, or LIST_BAD_STATE if a transaction is already open.
+ */
+ListStatus list_txnBegin() {
+    if (txn_active) return LIST_BAD_STATE;
+    txn_active = 1;
+    txn_records = 0;
+    txn_broken = 0;
+    txn_deferred = 0;
+    return LIST_OK;
+}
+
+/**
+ * @brief Body of list_txnCommit().
+ */
+static ListStatus list_commit(List *head, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    if (!txn_active) return LIST_BAD_STATE;
+    txn_active = 0;
+    txn_records = 0;
+    txn_broken = 0;
+    if (txn_deferred) list_resumeIndexes(head, id_tree, priority_tree, status_tree);
+    txn_deferred = 0;
+    return LIST_OK;
+}
+
+/**
+ * @brief Commits the open transaction, without output.
+ *
+ * @param head Pointer to the head of the list.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK, or LIST_BAD_STATE if no transaction is open.
+ */
+ListStatus list_txnCommit(List *head, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    long long start = metrics_begin(METRIC_LIST_COMMIT);
+    ListStatus status = list_commit(head, id_tree, priority_tree, status_tree);
+    metrics_end(METRIC_LIST_COMMIT, start);
+    return status;
+}
+
+/**
+ * @brief Rolls back the open transaction, without output.
+ *
+ * Either every operation of the transaction is reverted, or none is: when the undo
+ * history could not keep all of them (undo disabled, out of memory, or the history
+ * was cleared meanwhile) the rollback is refused and the transaction is closed with
+ * its changes kept.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
  * @param stack Pointer to the undo stack.
+ * @param reverted Set to the number of operations reverted (may be NULL).
  * @param id_tree Pointer to the BST sorted by ID.
  * @param priority_tree Pointer to the BST sorted by priority.
  * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK, LIST_BAD_STATE if no transaction is open, or LIST_NO_MEMORY if the
+ *         rollback was refused (nothing reverted).
  */
-void list_updateTask(List *head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
-    if (head == NULL) {
-        printf("The list is empty.\n");
-        return;
-    }
+ListStatus list_txnRollback(List **head, Stack *stack, int *reverted,
+                            Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    if (!txn_active) return LIST_BAD_STATE;
 
-    int target_id = readInt("Enter the ID of the task to update: ");
-    List *current = head;
-    while (current != NULL && current->task->id != target_id) {
-        current = current->next;
+    long long start = metrics_begin(METRIC_LIST_ROLLBACK);
+    long long span = span_begin();
+    int count = 0;
+    int whole = !txn_broken && stack_getSize(stack) >= txn_records;
+    ListStatus status = whole ? LIST_OK : LIST_NO_MEMORY;
+    while (status == LIST_OK && count < txn_records) {
+        StackNode *op = stack_undo(stack);
+        if (!op) break;
+        *head = list_revert(*head, op, &status, id_tree, priority_tree, status_tree);
+        if (status != LIST_OK) {
+            stack_redo(stack);
+            break;
+        }
+        count++;
     }
+    stack_dropRedo(stack, count);
 
-    if (current == NULL) {
-        printf("Task with ID %d not found.\n", target_id);
-        return;
+    if (reverted) *reverted = count;
+    txn_active = 0;
+    txn_records = 0;
+    txn_broken = 0;
+    if (txn_deferred) list_resumeIndexes(*head, id_tree, priority_tree, status_tree);
+    txn_deferred = 0;
+    metrics_end(METRIC_LIST_ROLLBACK, start);
+    span_end(span, "list.rollback", count);
+    return status;
+}
+
+/**
+ * @brief Checks whether a transaction is open.
+ *
+ * @return 1 if a transaction is open, 0 otherwise.
+ */
+int list_inTransaction() {
+    return txn_active;
+}
+
+/**
+ * @brief Returns the number of operations recorded by the open transaction.
+ *
+ * @return Number of operations, or 0 if no transaction is open.
+ */
+int list_transactionSize() {
+    return txn_active ? txn_records : 0;
+}
+
+/**
+ * @brief Checks whether the BSTs lag behind the list (deferred maintenance).
+ *
+ * @return 1 if list_syncIndexes() would rebuild them, 0 otherwise.
+ */
+int list_indexesStale() {
+    return index_dirty;
+}
+
+/**
+ * @brief Forgets a task the undo history discards for good, then hands it to the trash.
+ *
+ * Used as the undo stack's eviction handler. Edges and tags kept for the task's
+ * undo go with it (freeing its tag slot), unless a live task has taken its ID since.
+ *
+ * @param task Pointer to the discarded Task (not freed).
+ */
+void list_evictTask(const Task *task) {
+    if (!task) return;
+    long long value;
+    if (!idmap_get(&list_index, task->id, &value)) {
+        deps_dropTask(task->id);
+        tags_removeAll(task->id);
     }
+    trash_append(task);
+}
+
+/**
+ * @brief Body of list_restoreTask().
+ */
+static ListStatus list_restore(List **head, int id, int new_id, Stack *stack,
+                               Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    if (!trash_contains(id)) return LIST_NOT_FOUND;
+    if (list_hasID(*head, new_id ? new_id : id)) return LIST_DUPLICATE_ID;
 
-    printf("\n> Updating Task ID %d\n", target_id);
-    current->task->priority = (Priority)readIntInRange("  New Priority (1 = High, 2 = Medium, 3 = Low): ", PRIORITY_HIGH, PRIORITY_LOW);
-    current->task->status = (Status)readIntInRange("  New Status (1 = Not Started, 2 = In Progress, 3 = Finished): ", STATUS_NOT_STARTED, STATUS_FINISHED);
-
-    // Rebuild priority and status trees
-    tree_free(priority_tree);
-    tree_free(status_tree);
-    *priority_tree = *tree_create(KEY_PRIORITY);
-    *status_tree = *tree_create(KEY_STATUS);
-    List *temp = head;
-    while (temp != NULL) {
-        tree_insert(priority_tree, temp->task);
-        tree_insert(status_tree, temp->task);
-        temp = temp->next;
+    Task *task = trash_take(id);
+    if (!task) return LIST_NO_MEMORY;
+    if (new_id) task->id = new_id;
+    ListStatus status = list_insertTask(head, task, POS_HEAD, 0, stack, id_tree, priority_tree, status_tree);
+    if (status != LIST_OK) {
+        task->id = id;
+        trash_append(task);
+        task_free(task);
     }
+    return status;
+}
 
-    printf("Updating task");
-    loadingBar(10);
-    printf("Task updated successfully.\n");
+/**
+ * @brief Moves a task from the trash file back to the head of the list, without prompts or output.
+ *
+ * The most recently deleted copy is restored, and the insertion is recorded for undo.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param id The ID of the task in the trash.
+ * @param new_id ID to give the restored task, or 0 to keep its own.
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return LIST_OK, LIST_NOT_FOUND (not in the trash), LIST_DUPLICATE_ID (the ID is taken;
+ *         the task stays in the trash) or LIST_NO_MEMORY.
+ */
+ListStatus list_restoreTask(List **head, int id, int new_id, Stack *stack,
+                            Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    long long start = metrics_begin(METRIC_LIST_RESTORE);
+    ListStatus status = list_restore(head, id, new_id, stack, id_tree, priority_tree, status_tree);
+    metrics_end(METRIC_LIST_RESTORE, start);
+    return status;
 }
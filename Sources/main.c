@@ -1,25 +1,30 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <windows.h>
+#include <string.h>
+#include <time.h>
 #include "task.h"
 #include "list.h"
 #include "input_utils.h"
 #include "stack.h"
 #include "tree.h"
 #include "file.h"
-
-/**
- * @brief Clears the terminal screen.
- *
- * Uses system("cls") on Windows or system("clear") on other platforms.
- */
-void clearScreen() {
-    #ifdef _WIN32
-        system("cls");
-    #else
-        system("clear");
-    #endif
-}
+#include "stats.h"
+#include "trash.h"
+#include "batch.h"
+#include "progress.h"
+#include "render.h"
+#include "term.h"
+#include "tui.h"
+#include "menu.h"
+#include "daemon.h"
+#include "client.h"
+#include "deadline.h"
+#include "project.h"
+#include "desc.h"
+#include "trace.h"
+#include "metrics.h"
+#include "mem.h"
+#include "span.h"
 
 /**
  * @brief Main function to run the Task Manager program.
@@ -27,13 +32,81 @@ void clearScreen() {
  * Initializes the linked list, undo stack, and BSTs, and provides a menu-driven interface
  * for adding, removing, viewing, sorting, saving, loading, and updating tasks.
  *
+ * Command-line options:
+ *   --undo-depth N   Number of removals kept for undo (default STACK_DEFAULT_CAPACITY).
+ *   --desc-cache KB  Keep at most KB kilobytes of task descriptions in memory; the
+ *                    least recently used go to a temporary file (default: no limit).
+ *   --batch FILE     Run the commands in FILE ("-" for stdin) without any menu and exit.
+ *   --daemon SOCKET  Serve batch commands to local clients on a Unix socket until stopped.
+ *   --ship SOCKET    With --daemon: stream committed changes to replicas connecting on SOCKET.
+ *   --follow SOCKET  With --daemon: serve read-only queries on a replica of the primary shipping on SOCKET.
+ *   --client SOCKET  Send the commands on stdin to a daemon and print the responses.
+ *   --trace FILE     Record every operation, with its timing, to FILE (see trace.h).
+ *   --replay FILE    Run the operations recorded in FILE at full speed, report throughput and latency, and exit.
+ *   --paced          With --replay: keep the recorded time between operations.
+ *   --metrics-dump FILE       Write the per-operation metrics to FILE periodically and on exit (see metrics.h).
+ *   --metrics-interval SECS   Seconds between two writes of the metrics dump (default METRICS_DEFAULT_INTERVAL).
+ *   --no-metrics     Do not record the per-operation metrics.
+ *   --spans FILE     Write the long operations to FILE as Chrome trace events (see span.h).
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
  * @return 0 on successful exit.
  */
-int main() {
+int main(int argc, char *argv[]) {
     int choice1, choice2;
+    long long trace_start;
+    int undo_depth = STACK_DEFAULT_CAPACITY;
+    const char *batch_path = NULL;
+    const char *daemon_path = NULL;
+    const char *trace_path = NULL;
+    const char *replay_path = NULL;
+    int paced = 0;
+    const char *metrics_path = NULL;
+    int metrics_interval = METRICS_DEFAULT_INTERVAL;
+    const char *spans_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--undo-depth") == 0 && i + 1 < argc) {
+            undo_depth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--desc-cache") == 0 && i + 1 < argc) {
+            long kilobytes = atol(argv[++i]);
+            desc_setBudget(kilobytes > 0 ? (size_t)kilobytes * 1024 : 0);
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch_path = argv[++i];
+        } else if (strcmp(argv[i], "--daemon") == 0 && i + 1 < argc) {
+            daemon_path = argv[++i];
+        } else if (strcmp(argv[i], "--ship") == 0 && i + 1 < argc) {
+            daemon_setShipPath(argv[++i]);
+        } else if (strcmp(argv[i], "--follow") == 0 && i + 1 < argc) {
+            daemon_setFollowPath(argv[++i]);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--paced") == 0) {
+            paced = 1;
+        } else if (strcmp(argv[i], "--metrics-dump") == 0 && i + 1 < argc) {
+            metrics_path = argv[++i];
+        } else if (strcmp(argv[i], "--metrics-interval") == 0 && i + 1 < argc) {
+            metrics_interval = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--no-metrics") == 0) {
+            metrics_setEnabled(0);
+        } else if (strcmp(argv[i], "--spans") == 0 && i + 1 < argc) {
+            spans_path = argv[++i];
+        } else if (strcmp(argv[i], "--client") == 0 && i + 1 < argc) {
+            static char out_buffer[1 << 16];
+            setvbuf(stdout, out_buffer, _IOFBF, sizeof(out_buffer));
+            int errors = client_run(argv[++i]);
+            return errors < 0 ? 1 : errors ? 2 : 0;
+        } else {
+            printf("Usage: %s [--undo-depth N] [--desc-cache KB] [--batch FILE|-] [--daemon SOCKET [--ship SOCKET|--follow SOCKET]] [--client SOCKET] [--trace FILE] [--replay FILE [--paced]] [--metrics-dump FILE [--metrics-interval SECS]] [--no-metrics] [--spans FILE]\n", argv[0]);
+            return 1;
+        }
+    }
 
     List *head_list = NULL;
-    Stack *undo_stack = stack_create();
+    Stack *undo_stack = stack_create(undo_depth);
     Tree *id_tree = tree_create(KEY_ID);
     Tree *priority_tree = tree_create(KEY_PRIORITY);
     Tree *status_tree = tree_create(KEY_STATUS);
@@ -42,63 +115,167 @@ int main() {
         printf("Failed to initialize data structures.\n");
         return 1;
     }
+    stack_setEvictHandler(undo_stack, list_evictTask);
+    if (trace_path) {
+        const char *mode = daemon_path ? "daemon" : (batch_path || replay_path) ? "batch" : "interactive";
+        if (!trace_open(trace_path, mode)) {
+            fprintf(stderr, "Cannot create trace file %s.\n", trace_path);
+            return 1;
+        }
+    }
+    if (metrics_path) metrics_setDump(metrics_path, metrics_interval);
+    if (spans_path && !span_open(spans_path)) {
+        fprintf(stderr, "Cannot create span file %s.\n", spans_path);
+        return 1;
+    }
+
+    // Replay mode: like batch mode, with the commands and their pacing coming from a trace
+    if (replay_path) {
+        TraceReport report;
+        progress_setEnabled(0);
+        long replayed = trace_replay(replay_path, paced, &report, &head_list, undo_stack,
+                                     id_tree, priority_tree, status_tree);
+        if (replayed < 0) fprintf(stderr, "Cannot replay %s: not a trace file or out of memory.\n", replay_path);
+        else trace_printReport(&report, stdout);
+        trace_close();
+        metrics_dump();
+        list_destroy(head_list);
+        stack_free(undo_stack);
+        project_reset();
+        desc_reset();
+        tree_free(id_tree);
+        tree_free(priority_tree);
+        tree_free(status_tree);
+        span_close();
+        return replayed < 0 ? 1 : 0;
+    }
+
+    // Batch mode: no menu, no startup load, no trash; scripts use load/save explicitly
+    if (batch_path) {
+        FILE *in = strcmp(batch_path, "-") == 0 ? stdin : fopen(batch_path, "r");
+        if (!in) {
+            fprintf(stderr, "Cannot open batch file %s.\n", batch_path);
+            return 1;
+        }
+        static char out_buffer[1 << 16];
+        setvbuf(stdout, out_buffer, _IOFBF, sizeof(out_buffer));
+        progress_setEnabled(0);
+        int errors = batch_run(in, in == stdin ? "stdin" : batch_path, &head_list, undo_stack,
+                               id_tree, priority_tree, status_tree);
+        if (in != stdin) fclose(in);
+        trace_close();
+        metrics_dump();
+        list_destroy(head_list);
+        stack_free(undo_stack);
+        project_reset();
+        desc_reset();
+        tree_free(id_tree);
+        tree_free(priority_tree);
+        tree_free(status_tree);
+        span_close();
+        return errors ? 2 : 0;
+    }
+
+    // Daemon mode: same rules as batch mode, with the commands coming from clients
+    if (daemon_path) {
+        progress_setEnabled(0);
+        int result = daemon_run(daemon_path, &head_list, undo_stack, id_tree, priority_tree, status_tree);
+        trace_close();
+        metrics_dump();
+        list_destroy(head_list);
+        stack_free(undo_stack);
+        project_reset();
+        desc_reset();
+        tree_free(id_tree);
+        tree_free(priority_tree);
+        tree_free(status_tree);
+        span_close();
+        return result;
+    }
+
+    term_init();
+
+    // Tasks evicted from the undo history are kept in the trash file
+    if (!trash_open(project_trashPath()))
+        printf("Failed to open trash file %s.\n", project_trashPath());
 
     // Load tasks at startup
-    head_list = file_loadTasks(head_list, undo_stack, id_tree, priority_tree, status_tree);
-    Sleep(1000);
+    menu_loadTasks(&head_list, undo_stack, id_tree, priority_tree, status_tree);
+    project_bind();
 
     do {
-        clearScreen();
-        printf("\n> Advanced Terminal-Based Task Manager in C \n\n");
-        printf("  1. Add a task\n");
-        printf("  2. Remove a task\n");
-        printf("  3. Show all tasks\n");
-        printf("  4. Show tasks sorted\n");
-        printf("  5. Save tasks to file\n");
-        printf("  6. Load tasks from file\n");
-        printf("  7. Update a task\n");
-        printf("  0. Quit\n\n");
+        deadline_advance((unsigned int)time(NULL), NULL, NULL);
+        metrics_tick();
+        term_beginFrame();
+        term_line("");
+        term_line("> Advanced Terminal-Based Task Manager in C ");
+        term_line("");
+        term_line("  1. Add a task");
+        term_line("  2. Remove a task");
+        term_line("  3. Show all tasks");
+        term_line("  4. Show tasks sorted");
+        term_line("  5. Save tasks to file");
+        term_line("  6. Load tasks from file");
+        term_line("  7. Update a task");
+        term_line("  8. Show statistics");
+        term_line("  9. Undo last operation (%d available)", stack_getSize(undo_stack));
+        term_line("  10. Redo last undone operation (%d available)", stack_getRedoSize(undo_stack));
+        term_line("  11. Restore a deleted task from trash (%d in trash)", trash_count());
+        if (list_inTransaction())
+            term_line("  12. Transaction (open, %d operations pending)", list_transactionSize());
+        else
+            term_line("  12. Transaction");
+        term_line("  13. Change display format (current: %s)", render_formatName(render_getFormat()));
+        term_line("  14. Browse tasks (full screen)");
+        term_line("  15. Due dates (%d overdue)", deadline_overdueCount());
+        term_line("  16. Tags");
+        term_line("  17. Projects (current: %s)", project_active());
+        term_line("  0. Quit");
+        term_line("");
+        term_endFrame();
 
         choice1 = readInt("Choice: ");
 
         switch (choice1) {
             case 1:
                 do {
-                    clearScreen();
-                    printf("\n> Add a Task \n\n");
-                    printf("  1. Add to the head of the list\n");
-                    printf("  2. Add to the middle of the list\n");
-                    printf("  3. Add to the end of the list\n");
-                    printf("  4. Return to main menu\n\n");
+                    term_beginFrame();
+                    term_line("");
+                    term_line("> Add a Task ");
+                    term_line("");
+                    term_line("  1. Add to the head of the list");
+                    term_line("  2. Add to the middle of the list");
+                    term_line("  3. Add to the end of the list");
+                    term_line("  4. Return to main menu");
+                    term_line("");
+                    term_endFrame();
 
                     choice2 = readInt("Choice: ");
 
                     switch (choice2) {
                         case 1:
-                            clearScreen();
+                            term_clear();
                             printf("\n> Adding a Task to the Head \n");
-                            head_list = list_addToHead(head_list, undo_stack, id_tree, priority_tree, status_tree);
-                            Sleep(1000);
+                            menu_addTask(&head_list, POS_HEAD, undo_stack, id_tree, priority_tree, status_tree);
+                            waitForEnter();
                             break;
                         case 2:
-                            clearScreen();
+                            term_clear();
                             printf("\n> Adding a Task to the Middle \n");
-                            list_addToMiddle(head_list, undo_stack, id_tree, priority_tree, status_tree);
-                            Sleep(1000);
+                            menu_addTask(&head_list, POS_MIDDLE, undo_stack, id_tree, priority_tree, status_tree);
+                            waitForEnter();
                             break;
                         case 3:
-                            clearScreen();
+                            term_clear();
                             printf("\n> Adding a Task to the End \n");
-                            list_addToEnd(head_list, undo_stack, id_tree, priority_tree, status_tree);
-                            Sleep(1000);
+                            menu_addTask(&head_list, POS_END, undo_stack, id_tree, priority_tree, status_tree);
+                            waitForEnter();
                             break;
                         case 4:
-                            printf("\n> Returning to main menu...");
-                            Sleep(1000);
                             break;
                         default:
                             printf("\nInvalid choice. Try again.\n");
-                            Sleep(1000);
+                            waitForEnter();
                             break;
                     }
                 } while (choice2 != 4);
@@ -106,154 +283,333 @@ int main() {
 
             case 2:
                 do {
-                    clearScreen();
-                    printf("\n> Remove a Task \n\n");
-                    printf("  1. Remove from the head\n");
-                    printf("  2. Remove from the end\n");
-                    printf("  3. Remove by ID\n");
-                    printf("  4. Clear entire list\n");
-                    printf("  5. Undo last removal (%d available", stack_getSize(undo_stack));
-                    Task *next_task = stack_peek(undo_stack);
-                    if (next_task) printf(", next ID: %d)\n", next_task->id);
-                    else printf(")\n");
-                    printf("  6. Clear undo stack\n");
-                    printf("  7. Return to main menu\n\n");
+                    StackNode *next_op = stack_peek(undo_stack);
+                    term_beginFrame();
+                    term_line("");
+                    term_line("> Remove a Task ");
+                    term_line("");
+                    term_line("  1. Remove from the head");
+                    term_line("  2. Remove from the end");
+                    term_line("  3. Remove by ID");
+                    term_line("  4. Clear entire list");
+                    if (next_op)
+                        term_line("  5. Undo last operation (%d/%d available, next: %s ID %d)", stack_getSize(undo_stack),
+                                  stack_getCapacity(undo_stack), stack_opName(next_op->type), next_op->task_id);
+                    else
+                        term_line("  5. Undo last operation (%d/%d available)", stack_getSize(undo_stack), stack_getCapacity(undo_stack));
+                    term_line("  6. Clear undo history");
+                    term_line("  7. Return to main menu");
+                    term_line("");
+                    term_endFrame();
 
                     choice2 = readInt("Choice: ");
 
                     switch (choice2) {
                         case 1:
-                            clearScreen();
+                            term_clear();
                             printf("\n> Removing task from head...\n");
-                            head_list = list_removeFromHead(head_list, undo_stack, id_tree, priority_tree, status_tree);
-                            Sleep(1000);
+                            menu_removeTask(&head_list, POS_HEAD, undo_stack, id_tree, priority_tree, status_tree);
+                            waitForEnter();
                             break;
                         case 2:
-                            clearScreen();
+                            term_clear();
                             printf("\n> Removing task from end...\n");
-                            list_removeFromEnd(head_list, undo_stack, id_tree, priority_tree, status_tree);
-                            Sleep(1000);
+                            menu_removeTask(&head_list, POS_END, undo_stack, id_tree, priority_tree, status_tree);
+                            waitForEnter();
                             break;
                         case 3:
-                            clearScreen();
+                            term_clear();
                             printf("\n> Removing task by ID...\n");
-                            head_list = list_removeByID(head_list, undo_stack, id_tree, priority_tree, status_tree);
-                            Sleep(1000);
+                            menu_removeTask(&head_list, POS_MIDDLE, undo_stack, id_tree, priority_tree, status_tree);
+                            waitForEnter();
                             break;
                         case 4:
-                            clearScreen();
+                            term_clear();
                             printf("\n> Clearing entire list...\n");
-                            list_freeAll(head_list, undo_stack, id_tree, priority_tree, status_tree);
-                            head_list = NULL;
-                            Sleep(1000);
+                            menu_clearAll(&head_list, undo_stack, id_tree, priority_tree, status_tree);
+                            waitForEnter();
                             break;
                         case 5:
-                            clearScreen();
-                            printf("\n> Undoing last removal...\n");
-                            head_list = list_restoreTask(head_list, undo_stack, id_tree, priority_tree, status_tree);
-                            Sleep(1000);
+                            term_clear();
+                            printf("\n> Undoing last operation...\n");
+                            menu_undo(&head_list, undo_stack, id_tree, priority_tree, status_tree);
+                            waitForEnter();
                             break;
                         case 6:
-                            clearScreen();
-                            printf("\n> Clearing undo stack...\n");
-                            stack_clear(undo_stack);
-                            printf("Undo stack cleared");
-                            loadingBar(10);
-                            Sleep(1000);
-                            undo_stack = stack_create();
+                            term_clear();
+                            printf("\n> Clearing undo history...\n");
+                            menu_clearHistory(undo_stack);
+                            waitForEnter();
                             break;
                         case 7:
-                            printf("\n> Returning to main menu...");
-                            Sleep(1000);
                             break;
                         default:
                             printf("\nInvalid choice. Try again.\n");
-                            Sleep(1000);
+                            waitForEnter();
                             break;
                     }
                 } while (choice2 != 7);
                 break;
 
             case 3:
-                clearScreen();
-                list_printAll(head_list);
-                system("pause");
+                term_clear();
+                menu_printAll(head_list);
+                waitForEnter();
                 break;
 
             case 4:
-                clearScreen();
-                printf("\n> Show Tasks Sorted \n\n");
-                printf("  1. Sort by ID\n");
-                printf("  2. Sort by Priority\n");
-                printf("  3. Sort by Status\n");
-                printf("  4. Return to main menu\n\n");
+                term_beginFrame();
+                term_line("");
+                term_line("> Show Tasks Sorted ");
+                term_line("");
+                term_line("  1. Sort by ID");
+                term_line("  2. Sort by Priority");
+                term_line("  3. Sort by Status");
+                term_line("  4. Return to main menu");
+                term_line("");
+                term_endFrame();
 
                 choice2 = readInt("Choice: ");
+                list_syncIndexes(head_list, id_tree, priority_tree, status_tree);
                 switch (choice2) {
                     case 1:
-                        clearScreen();
+                        term_clear();
+                        trace_start = trace_clock();
                         tree_printInorder(id_tree);
-                        system("pause");
+                        trace_record(trace_start, 1, "sorted id %s", render_formatName(render_getFormat()));
+                        waitForEnter();
                         break;
                     case 2:
-                        clearScreen();
+                        term_clear();
+                        trace_start = trace_clock();
                         tree_printInorder(priority_tree);
-                        system("pause");
+                        trace_record(trace_start, 1, "sorted priority %s", render_formatName(render_getFormat()));
+                        waitForEnter();
                         break;
                     case 3:
-                        clearScreen();
+                        term_clear();
+                        trace_start = trace_clock();
                         tree_printInorder(status_tree);
-                        system("pause");
+                        trace_record(trace_start, 1, "sorted status %s", render_formatName(render_getFormat()));
+                        waitForEnter();
                         break;
                     case 4:
-                        printf("\n> Returning to main menu...");
-                        Sleep(1000);
                         break;
                     default:
                         printf("\nInvalid choice. Try again.\n");
-                        Sleep(1000);
+                        waitForEnter();
                         break;
                     }
                 break;
 
             case 5:
-                clearScreen();
+                term_clear();
                 printf("\n> Saving tasks to file...\n");
-                file_saveTasks(head_list);
-                Sleep(1000);
+                menu_saveTasks(head_list);
+                waitForEnter();
                 break;
 
             case 6:
-                clearScreen();
+                term_clear();
                 printf("\n> Loading tasks from file...\n");
-                head_list = file_loadTasks(head_list, undo_stack, id_tree, priority_tree, status_tree);
-                Sleep(1000);
+                menu_loadTasks(&head_list, undo_stack, id_tree, priority_tree, status_tree);
+                waitForEnter();
                 break;
 
             case 7:
-                clearScreen();
+                term_clear();
                 printf("\n> Updating a Task \n");
-                list_updateTask(head_list, undo_stack, id_tree, priority_tree, status_tree);
-                Sleep(1000);
+                menu_updateTask(head_list, undo_stack, priority_tree, status_tree);
+                waitForEnter();
+                break;
+
+            case 8:
+                term_clear();
+                trace_start = trace_clock();
+                stats_print();
+                trace_record(trace_start, 1, "stats");
+                printf("\n> Operation Metrics\n");
+                metrics_print(stdout, 0);
+                printf("\n> Memory\n");
+                mem_print(stdout, 0, listCounter_get());
+                waitForEnter();
+                break;
+
+            case 9:
+                term_clear();
+                printf("\n> Undoing last operation...\n");
+                menu_undo(&head_list, undo_stack, id_tree, priority_tree, status_tree);
+                waitForEnter();
+                break;
+
+            case 10:
+                term_clear();
+                printf("\n> Redoing last undone operation...\n");
+                menu_redo(&head_list, undo_stack, id_tree, priority_tree, status_tree);
+                waitForEnter();
+                break;
+
+            case 11:
+                term_clear();
+                menu_showTrash();
+                menu_restoreFromTrash(&head_list, undo_stack, id_tree, priority_tree, status_tree);
+                waitForEnter();
+                break;
+
+            case 12:
+                term_beginFrame();
+                term_line("");
+                term_line("> Transaction ");
+                term_line("");
+                term_line("  1. Begin transaction");
+                term_line("  2. Commit transaction");
+                term_line("  3. Roll back transaction");
+                term_line("  4. Return to main menu");
+                term_line("");
+                term_endFrame();
+
+                choice2 = readInt("Choice: ");
+                switch (choice2) {
+                    case 1:
+                        menu_beginTransaction();
+                        break;
+                    case 2:
+                        menu_commitTransaction(head_list, id_tree, priority_tree, status_tree);
+                        break;
+                    case 3:
+                        menu_rollbackTransaction(&head_list, undo_stack, id_tree, priority_tree, status_tree);
+                        break;
+                    case 4:
+                        break;
+                    default:
+                        printf("\nInvalid choice. Try again.\n");
+                        break;
+                }
+                if (choice2 != 4) waitForEnter();
+                break;
+
+            case 13:
+                // Cycle plain -> compact -> tsv -> plain
+                render_setFormat((RenderFormat)((render_getFormat() + 1) % 3));
+                break;
+
+            case 14:
+                list_syncIndexes(head_list, id_tree, priority_tree, status_tree);
+                tui_run(head_list, id_tree, priority_tree, status_tree);
+                break;
+
+            case 15:
+                term_beginFrame();
+                term_line("");
+                term_line("> Due Dates ");
+                term_line("");
+                term_line("  1. Set the due date of a task");
+                term_line("  2. Show overdue tasks");
+                term_line("  3. Return to main menu");
+                term_line("");
+                term_endFrame();
+
+                choice2 = readInt("Choice: ");
+                switch (choice2) {
+                    case 1:
+                        menu_setDue(head_list, undo_stack);
+                        break;
+                    case 2:
+                        term_clear();
+                        menu_showOverdue(head_list);
+                        break;
+                    case 3:
+                        break;
+                    default:
+                        printf("\nInvalid choice. Try again.\n");
+                        break;
+                }
+                if (choice2 != 3) waitForEnter();
+                break;
+
+            case 16:
+                term_beginFrame();
+                term_line("");
+                term_line("> Tags ");
+                term_line("");
+                term_line("  1. Tag a task");
+                term_line("  2. Untag a task");
+                term_line("  3. Find tasks by tag");
+                term_line("  4. Return to main menu");
+                term_line("");
+                term_endFrame();
+
+                choice2 = readInt("Choice: ");
+                switch (choice2) {
+                    case 1:
+                    case 2:
+                        menu_editTags(head_list, choice2 == 1);
+                        break;
+                    case 3:
+                        term_clear();
+                        menu_selectTasks(head_list);
+                        break;
+                    case 4:
+                        break;
+                    default:
+                        printf("\nInvalid choice. Try again.\n");
+                        break;
+                }
+                if (choice2 != 4) waitForEnter();
+                break;
+
+            case 17:
+                term_beginFrame();
+                term_line("");
+                term_line("> Projects ");
+                term_line("");
+                term_line("  1. Switch to or create a project");
+                term_line("  2. Show tasks of all projects");
+                term_line("  3. Return to main menu");
+                term_line("");
+                term_endFrame();
+
+                choice2 = readInt("Choice: ");
+                switch (choice2) {
+                    case 1:
+                        term_clear();
+                        menu_switchProject(&head_list, undo_stack, id_tree, priority_tree, status_tree);
+                        break;
+                    case 2:
+                        term_clear();
+                        menu_showAllProjects(head_list);
+                        break;
+                    case 3:
+                        break;
+                    default:
+                        printf("\nInvalid choice. Try again.\n");
+                        break;
+                }
+                if (choice2 != 3) waitForEnter();
                 break;
 
             case 0:
-                clearScreen();
+                term_clear();
                 printf("\nExiting Task Manager. Goodbye!\n");
-                Sleep(1000);
                 break;
 
             default:
                 printf("\nInvalid choice. Try again.\n");
-                Sleep(1000);
+                waitForEnter();
                 break;
         }
     } while (choice1 != 0);
 
-    list_freeAll(head_list, undo_stack, id_tree, priority_tree, status_tree);
+    list_destroy(head_list);
     stack_free(undo_stack);
+    project_reset();
+    trash_close();
+    trace_close();
+    metrics_dump();
+    desc_reset();
     tree_free(id_tree);
     tree_free(priority_tree);
     tree_free(status_tree);
+    span_close();
     return 0;
 }
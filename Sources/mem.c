@@ -0,0 +1,227 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mem.h"
+
+#define MEM_HEADER 8              // Bytes the allocator keeps in front of a block
+#define MEM_ALIGN 16              // Granularity of block sizes
+#define MEM_MIN_CHUNK 32          // Smallest block the allocator hands out
+
+#ifdef __GNUC__
+    #define MEM_ADD(counter, amount) __atomic_add_fetch(&(counter), (amount), __ATOMIC_RELAXED)
+#else
+    #define MEM_ADD(counter, amount) ((counter) += (amount))
+#endif
+
+/**
+ * @brief Counters of one subsystem.
+ */
+typedef struct MemCounters {
+    long long live;
+    long long peak;
+    long long blocks;
+    long long allocations;
+    long long overhead;
+} MemCounters;
+
+static MemCounters mem_tags[MEM_COUNT];
+static long long mem_live = 0;             // All subsystems together
+static long long mem_peak = 0;
+static long long mem_footprint = 0;        // Live bytes plus overhead
+static long long mem_peakFootprint = 0;
+
+static const char *mem_names[MEM_COUNT + 1] = {
+    "list", "tree", "stack", "task", "desc", "index", "tags", "deps", "scratch", "net", "total"
+};
+
+/**
+ * @brief Estimates the bytes the allocator adds to a block of a given size.
+ *
+ * @param size Size of the block.
+ * @return The estimated overhead in bytes.
+ */
+static long long mem_overhead(size_t size) {
+    size_t chunk = (size + MEM_HEADER + MEM_ALIGN - 1) & ~(size_t)(MEM_ALIGN - 1);
+    if (chunk < MEM_MIN_CHUNK) chunk = MEM_MIN_CHUNK;
+    return (long long)(chunk - size);
+}
+
+/**
+ * @brief Raises a peak, safely against other threads.
+ *
+ * @param peak Pointer to the peak.
+ * @param value The new value.
+ */
+static void mem_raisePeak(long long *peak, long long value) {
+#ifdef __GNUC__
+    long long seen = __atomic_load_n(peak, __ATOMIC_RELAXED);
+    while (value > seen && !__atomic_compare_exchange_n(peak, &seen, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+#else
+    if (value > *peak) *peak = value;
+#endif
+}
+
+/**
+ * @brief Accounts a block allocated.
+ *
+ * @param tag The subsystem.
+ * @param size Size of the block.
+ */
+static void mem_onAlloc(MemTag tag, size_t size) {
+    MemCounters *c = &mem_tags[tag];
+    long long overhead = mem_overhead(size);
+    mem_raisePeak(&c->peak, MEM_ADD(c->live, (long long)size));
+    MEM_ADD(c->blocks, 1);
+    MEM_ADD(c->allocations, 1);
+    MEM_ADD(c->overhead, overhead);
+    mem_raisePeak(&mem_peak, MEM_ADD(mem_live, (long long)size));
+    mem_raisePeak(&mem_peakFootprint, MEM_ADD(mem_footprint, (long long)size + overhead));
+}
+
+/**
+ * @brief Accounts a block freed.
+ *
+ * @param tag The subsystem.
+ * @param size Size of the block.
+ */
+static void mem_onFree(MemTag tag, size_t size) {
+    MemCounters *c = &mem_tags[tag];
+    long long overhead = mem_overhead(size);
+    MEM_ADD(c->live, -(long long)size);
+    MEM_ADD(c->blocks, -1);
+    MEM_ADD(c->overhead, -overhead);
+    MEM_ADD(mem_live, -(long long)size);
+    MEM_ADD(mem_footprint, -((long long)size + overhead));
+}
+
+/**
+ * @brief Allocates a block, like malloc().
+ *
+ * @param tag Subsystem to account the block to.
+ * @param size Size in bytes.
+ * @return Pointer to the block, or NULL if memory ran out.
+ */
+void* mem_alloc(MemTag tag, size_t size) {
+    void *ptr = malloc(size);
+    if (ptr) mem_onAlloc(tag, size);
+    return ptr;
+}
+
+/**
+ * @brief Allocates a zeroed array, like calloc().
+ *
+ * @param tag Subsystem to account the block to.
+ * @param count Number of elements.
+ * @param size Size of an element in bytes.
+ * @return Pointer to the block, or NULL if memory ran out.
+ */
+void* mem_calloc(MemTag tag, size_t count, size_t size) {
+    void *ptr = calloc(count, size);
+    if (ptr) mem_onAlloc(tag, count * size);
+    return ptr;
+}
+
+/**
+ * @brief Resizes a block, like realloc().
+ *
+ * @param tag Subsystem the block is accounted to.
+ * @param ptr Pointer to the block, or NULL to allocate one.
+ * @param old_size Current size of the block in bytes (0 if ptr is NULL).
+ * @param size New size in bytes.
+ * @return Pointer to the resized block, or NULL if memory ran out (the block is then unchanged).
+ */
+void* mem_realloc(MemTag tag, void *ptr, size_t old_size, size_t size) {
+    void *resized = realloc(ptr, size);
+    if (!resized) return NULL;
+    if (ptr) mem_onFree(tag, old_size);
+    mem_onAlloc(tag, size);
+    return resized;
+}
+
+/**
+ * @brief Frees a block, like free().
+ *
+ * @param tag Subsystem the block is accounted to.
+ * @param ptr Pointer to the block (NULL is ignored).
+ * @param size Size of the block in bytes, as allocated.
+ */
+void mem_free(MemTag tag, void *ptr, size_t size) {
+    if (!ptr) return;
+    free(ptr);
+    mem_onFree(tag, size);
+}
+
+/**
+ * @brief Reads the figures of a subsystem.
+ *
+ * @param tag The subsystem, or MEM_COUNT for all of them together.
+ * @param usage Filled with the figures.
+ */
+void mem_get(MemTag tag, MemUsage *usage) {
+    memset(usage, 0, sizeof(*usage));
+    if (tag >= 0 && tag < MEM_COUNT) {
+        const MemCounters *c = &mem_tags[tag];
+        usage->live = c->live;
+        usage->peak = c->peak;
+        usage->blocks = c->blocks;
+        usage->allocations = c->allocations;
+        usage->overhead = c->overhead;
+        return;
+    }
+    for (int i = 0; i < MEM_COUNT; i++) {
+        usage->blocks += mem_tags[i].blocks;
+        usage->allocations += mem_tags[i].allocations;
+        usage->overhead += mem_tags[i].overhead;
+    }
+    usage->live = mem_live;
+    usage->peak = mem_peak;
+}
+
+/**
+ * @brief Returns the name of a subsystem.
+ *
+ * @param tag The subsystem (MEM_COUNT gives "total").
+ * @return Static string.
+ */
+const char* mem_name(MemTag tag) {
+    return tag >= 0 && tag <= MEM_COUNT ? mem_names[tag] : "unknown";
+}
+
+/**
+ * @brief Prints the memory report.
+ *
+ * @param out Stream to print to.
+ * @param tsv 1 for tab-separated lines, 0 for an aligned table.
+ * @param tasks Number of tasks the bytes per task are computed for (0 to leave them out).
+ */
+void mem_print(FILE *out, int tsv, long tasks) {
+    if (tsv) fprintf(out, "subsystem\tlive\tpeak\tblocks\toverhead\tper_task\n");
+    else fprintf(out, "%-10s %14s %14s %12s %12s %10s\n", "Subsystem", "live", "peak", "blocks", "overhead", "per task");
+
+    for (int tag = 0; tag <= MEM_COUNT; tag++) {
+        MemUsage u;
+        mem_get((MemTag)tag, &u);
+        if (tag < MEM_COUNT && u.allocations == 0) continue;
+        double per_task = tasks > 0 ? (double)u.live / tasks : 0.0;
+        if (tsv) {
+            fprintf(out, "%s\t%lld\t%lld\t%lld\t%lld\t%.1f\n", mem_names[tag], u.live, u.peak, u.blocks, u.overhead,
+                    per_task);
+        } else {
+            fprintf(out, "%-10s %14lld %14lld %12lld %12lld %10.1f\n", mem_names[tag], u.live, u.peak, u.blocks,
+                    u.overhead, per_task);
+        }
+    }
+
+    long long footprint = mem_footprint, peak_footprint = mem_peakFootprint;
+    MemUsage total;
+    mem_get(MEM_COUNT, &total);
+    double internal = footprint > 0 ? (double)total.overhead / footprint : 0.0;
+    double external = peak_footprint > 0 ? (double)(peak_footprint - footprint) / peak_footprint : 0.0;
+    if (tsv) {
+        fprintf(out, "footprint\t%lld\tpeak_footprint\t%lld\tinternal_frag\t%.3f\texternal_frag\t%.3f\n",
+                footprint, peak_footprint, internal, external);
+    } else {
+        fprintf(out, "Footprint %lld bytes (peak %lld); fragmentation: %.1f%% internal, %.1f%% external (estimates)\n",
+                footprint, peak_footprint, internal * 100, external * 100);
+    }
+}
@@ -0,0 +1,755 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "menu.h"
+#include "task.h"
+#include "input_utils.h"
+#include "file.h"
+#include "trash.h"
+#include "render.h"
+#include "deadline.h"
+#include "tags.h"
+#include "project.h"
+#include "trace.h"
+#include "mem.h"
+
+/**
+ * @brief Completes an operation message such as "Saving your task".
+ *
+ * Prints " Done!" right away; inside a transaction it notes that the change is
+ * pending instead, since the feedback is given once at commit. Deleted tasks the
+ * trash file could not take since the last report are mentioned as well.
+ *
+ * Example Output:
+ *  Saving your task... Done!
+ */
+static void menu_reportDone() {
+    static int lost = 0;
+    if (list_inTransaction()) printf(" (pending commit)\n");
+    else printf("... Done!\n");
+    if (trash_lostCount() > lost)
+        printf("%d deleted tasks could not be written to the trash file.\n", trash_lostCount() - lost);
+    lost = trash_lostCount();
+}
+
+/**
+ * @brief Fills a Task structure with validated user input.
+ *
+ * Uses safe input functions to avoid buffer overflow and invalid entries:
+ * - readInt() for numeric inputs like ID
+ * - readIntInRange() for validated enum selection (priority, status)
+ * - readString() for title and description (supports spaces)
+ *
+ * @param task Pointer to a Task structure to populate.
+ */
+static void menu_fillTask(Task *task) {
+    char description[DESC_MAX + 1];
+    printf("\n> Fill the task information:\n");
+
+    // Task ID
+    task->id = readInt("  ID: ");
+
+    // Task Title
+    readString("  Title (max 50 characters): ", task->title, sizeof(task->title));
+
+    // Task Description
+    readString("  Description (max 200 characters): ", description, sizeof(description));
+    task->description = DESC_NONE;
+    if (!task_setDescription(task, description)) printf("  Failed to store the description; it is left empty.\n");
+
+    // Task Priority using enum
+    task->priority = (Priority)readIntInRange("  Priority (1 = High, 2 = Medium, 3 = Low): ", PRIORITY_HIGH, PRIORITY_LOW);
+
+    // Task Status using enum
+    task->status = (Status)readIntInRange("  Status (1 = Not Started, 2 = In Progress, 3 = Finished): ", STATUS_NOT_STARTED, STATUS_FINISHED);
+
+    // Due dates are set from the due date menu
+    task->created = (unsigned int)time(NULL);
+    task->due = 0;
+}
+
+/**
+ * @brief Records the addition of a task as the batch command doing the same (see trace_record()).
+ *
+ * Double quotes in the title and description become single quotes, as the batch
+ * syntax cannot escape them.
+ *
+ * @param start trace_clock() when the insertion started.
+ * @param ok 1 if the task was added.
+ * @param task Pointer to the Task.
+ * @param position Where it was inserted.
+ * @param target_id The task it was inserted after (POS_MIDDLE).
+ */
+static void menu_traceAdd(long long start, int ok, const Task *task, TaskPosition position, int target_id) {
+    char title[sizeof(task->title)];
+    char description[DESC_MAX + 1];
+    char at[24];
+    if (!trace_isRecording()) return;
+
+    snprintf(title, sizeof(title), "%s", task->title);
+    desc_get(task->description, description, sizeof(description));
+    for (char *c = title; *c; c++) if (*c == '"') *c = '\'';
+    for (char *c = description; *c; c++) if (*c == '"') *c = '\'';
+    if (position == POS_MIDDLE) snprintf(at, sizeof(at), "after:%d", target_id);
+    else snprintf(at, sizeof(at), "%s", position == POS_HEAD ? "head" : "end");
+    trace_record(start, ok, "add id=%d title=\"%s\" desc=\"%s\" prio=%d status=%d at=%s",
+                 task->id, title, description, (int)task->priority, (int)task->status, at);
+}
+
+/**
+ * @brief Prompts for a new ID until it no longer conflicts with the list.
+ *
+ * @param head Pointer to the head of the list.
+ * @param id The conflicting ID.
+ * @return An ID not in the list.
+ */
+static int menu_resolveConflict(List *head, int id) {
+    if (list_hasID(head, id)) {
+        printf("Task ID %d already exists. Enter a new ID: ", id);
+        id = readInt("  New ID: ");
+        while (list_hasID(head, id)) {
+            printf("Task ID %d already exists. Enter a different ID: ", id);
+            id = readInt("  New ID: ");
+        }
+    }
+    return id;
+}
+
+/**
+ * @brief Prompts for a new task and adds it.
+ *
+ * A task ID that is already taken is asked for again.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param position POS_HEAD, POS_END, or POS_MIDDLE to also prompt for the task to insert after.
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_addTask(List **head, TaskPosition position, Stack *stack,
+                  Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    int target_id = 0;
+    if (position != POS_HEAD && *head == NULL) {
+        printf(position == POS_END ? "The list has not been initialized.\n" : "The list is not initialized.\n");
+        return;
+    }
+    if (position == POS_MIDDLE) {
+        target_id = readInt("Enter the ID of the task to insert after: ");
+        if (!list_hasID(*head, target_id)) {
+            printf("Task with ID %d not found.\n", target_id);
+            return;
+        }
+    }
+
+    Task *new_task = mem_alloc(MEM_TASK, sizeof(Task));
+    if (!new_task) {
+        printf("Failed to allocate memory for task.\n");
+        return;
+    }
+
+    menu_fillTask(new_task);
+    new_task->id = menu_resolveConflict(*head, new_task->id);
+    long long start = trace_clock();
+    ListStatus status = list_insertTask(head, new_task, position, target_id, stack, id_tree, priority_tree, status_tree);
+    menu_traceAdd(start, status == LIST_OK, new_task, position, target_id);
+    if (status != LIST_OK) {
+        printf("Failed to allocate memory for new node.\n");
+        task_free(new_task);
+        return;
+    }
+
+    printf("\nSaving your task");
+    menu_reportDone();
+}
+
+/**
+ * @brief Removes a task, recording it for undo.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param position POS_HEAD, POS_END, or POS_MIDDLE to prompt for the ID of the task.
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_removeTask(List **head, TaskPosition position, Stack *stack,
+                     Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    if (position != POS_MIDDLE) {
+        long long start = trace_clock();
+        ListStatus status = list_removeEdge(head, position, stack, id_tree, priority_tree, status_tree);
+        trace_record(start, status == LIST_OK, position == POS_HEAD ? "rm head" : "rm end");
+        if (status == LIST_EMPTY) {
+            printf("List is already empty.\n");
+            return;
+        }
+        printf("Removing the task");
+        menu_reportDone();
+        return;
+    }
+
+    if (*head == NULL) {
+        printf("The list is empty.\n");
+        return;
+    }
+
+    int target_id = readInt("Enter the ID of the task to remove: ");
+    int was_head = (*head)->task->id == target_id;
+    long long start = trace_clock();
+    ListStatus status = list_removeTask(head, target_id, stack, id_tree, priority_tree, status_tree);
+    trace_record(start, status == LIST_OK, "rm %d", target_id);
+    if (status != LIST_OK) {
+        printf("Task with ID %d not found.\n", target_id);
+        return;
+    }
+
+    printf("Removing the task");
+    menu_reportDone();
+    if (was_head)
+        printf("Task with ID %d removed (it was at the head).\n", target_id);
+    else
+        printf("Task with ID %d removed successfully.\n", target_id);
+}
+
+/**
+ * @brief Removes every task as one undo group.
+ *
+ * @param head Pointer to the head pointer of the list (set to NULL).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_clearAll(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    long long start = trace_clock();
+    list_clear(head, stack, id_tree, priority_tree, status_tree);
+    trace_record(start, 1, "clear");
+
+    printf("Removing all tasks");
+    menu_reportDone();
+    printf("All tasks cleared and moved to stack.\n");
+}
+
+/**
+ * @brief Drops the undo and redo history.
+ *
+ * @param stack Pointer to the undo stack.
+ */
+void menu_clearHistory(Stack *stack) {
+    stack_clear(stack);
+    printf("Undo history cleared");
+    menu_reportDone();
+}
+
+/**
+ * @brief Prints all tasks in the current display format (see render_setFormat()).
+ *
+ * @param head Pointer to the head of the list.
+ */
+void menu_printAll(List *head) {
+    if (head == NULL) {
+        printf("No tasks to display. List is empty.\n");
+        return;
+    }
+
+    long long start = trace_clock();
+    render_list(head, stdout, render_getFormat());
+    trace_record(start, 1, "list %s", render_formatName(render_getFormat()));
+}
+
+/**
+ * @brief Prompts for a task ID and its new priority and status, and applies them.
+ *
+ * @param head Pointer to the head of the list.
+ * @param stack Pointer to the undo stack.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_updateTask(List *head, Stack *stack, Tree *priority_tree, Tree *status_tree) {
+    if (head == NULL) {
+        printf("The list is empty.\n");
+        return;
+    }
+
+    int target_id = readInt("Enter the ID of the task to update: ");
+    if (!list_hasID(head, target_id)) {
+        printf("Task with ID %d not found.\n", target_id);
+        return;
+    }
+
+    printf("\n> Updating Task ID %d\n", target_id);
+    Priority priority = (Priority)readIntInRange("  New Priority (1 = High, 2 = Medium, 3 = Low): ", PRIORITY_HIGH, PRIORITY_LOW);
+    Status status = (Status)readIntInRange("  New Status (1 = Not Started, 2 = In Progress, 3 = Finished): ", STATUS_NOT_STARTED, STATUS_FINISHED);
+    long long start = trace_clock();
+    ListStatus result = list_setTaskFields(head, target_id, priority, status, stack, priority_tree, status_tree);
+    trace_record(start, result == LIST_OK, "update %d prio=%d status=%d", target_id, (int)priority, (int)status);
+
+    printf("Updating task");
+    menu_reportDone();
+    printf("Task updated successfully.\n");
+}
+
+/**
+ * @brief Prompts for a task ID and its new due date, and applies it.
+ *
+ * @param head Pointer to the head of the list.
+ * @param stack Pointer to the undo stack.
+ */
+void menu_setDue(List *head, Stack *stack) {
+    char text[32];
+    unsigned int due;
+    if (head == NULL) {
+        printf("The list is empty.\n");
+        return;
+    }
+
+    int target_id = readInt("Enter the ID of the task to schedule: ");
+    if (!list_hasID(head, target_id)) {
+        printf("Task with ID %d not found.\n", target_id);
+        return;
+    }
+
+    readString("  Due date (YYYY-MM-DD, YYYY-MM-DDTHH:MM, +N[s|m|h|d] or none): ", text, sizeof(text));
+    if (!deadline_parse(text, (unsigned int)time(NULL), &due)) {
+        printf("Invalid date: %s\n", text);
+        return;
+    }
+    long long start = trace_clock();
+    ListStatus status = list_setTaskDue(head, target_id, due, stack);
+    trace_record(start, status == LIST_OK, "update %d due=%s", target_id, text);
+
+    printf("Scheduling task");
+    menu_reportDone();
+}
+
+/**
+ * @brief Prints the unfinished tasks whose due date has passed, in the current display format.
+ *
+ * @param head Pointer to the head of the list.
+ */
+void menu_showOverdue(List *head) {
+    long long start = trace_clock();
+    deadline_advance((unsigned int)time(NULL), NULL, NULL);
+    int count = deadline_overdueCount();
+    if (count == 0) {
+        printf("No overdue tasks.\n");
+        trace_record(start, 1, "overdue %s", render_formatName(render_getFormat()));
+        return;
+    }
+
+    size_t size = (size_t)count * sizeof(int);
+    int *ids = mem_alloc(MEM_SCRATCH, size);
+    if (!ids) {
+        printf("Failed to allocate memory.\n");
+        return;
+    }
+    deadline_overdue(ids, count);
+    printf("\n> Overdue tasks (%d):\n", count);
+    render_begin(stdout);
+    for (int i = 0; i < count; i++)
+        render_task(list_findTask(head, ids[i]), render_getFormat(), i + 1);
+    render_end();
+    mem_free(MEM_SCRATCH, ids, size);
+    trace_record(start, 1, "overdue %s", render_formatName(render_getFormat()));
+}
+
+/**
+ * @brief Prompts for a task ID and tag names, and puts the tags on the task or takes them off.
+ *
+ * @param head Pointer to the head of the list.
+ * @param add 1 to put the tags on, 0 to take them off.
+ */
+void menu_editTags(List *head, int add) {
+    char text[256];
+    if (head == NULL) {
+        printf("The list is empty.\n");
+        return;
+    }
+
+    int target_id = readInt(add ? "Enter the ID of the task to tag: " : "Enter the ID of the task to untag: ");
+    Task *task = list_findTask(head, target_id);
+    if (!task) {
+        printf("Task with ID %d not found.\n", target_id);
+        return;
+    }
+
+    readString("  Tags (separated by spaces): ", text, sizeof(text));
+    char names[sizeof(text)] = "";
+    size_t length = 0;
+    int changed = 0, count = 0;
+    long long start = trace_clock();
+    for (char *name = strtok(text, " \t"); name; name = strtok(NULL, " \t")) {
+        TagsStatus status = add ? tags_add(task, name) : tags_remove(target_id, name);
+        if (status != TAGS_OK) printf("  %s: %s\n", name, tags_statusName(status));
+        else changed++;
+        length += (size_t)snprintf(names + length, sizeof(names) - length, " %s", name);
+        count++;
+    }
+    if (count > 0) trace_record(start, changed == count, "%s %d%s", add ? "tag" : "untag", target_id, names);
+    if (changed == 0) return;
+
+    printf(add ? "Tagging task" : "Untagging task");
+    menu_reportDone();
+}
+
+/**
+ * @brief Prompts for a tag query and prints the matching tasks in the current display format.
+ *
+ * @param head Pointer to the head of the list.
+ */
+void menu_selectTasks(List *head) {
+    char query[256];
+    printf("Tags in use:");
+    for (int i = 0; i < tags_nameCount(); i++) {
+        long tasks;
+        const char *name = tags_name(i, &tasks);
+        if (tasks > 0) printf(" %s (%ld)", name, tasks);
+    }
+    printf("\n");
+    readString("Query (e.g. tag:infra AND NOT status:done): ", query, sizeof(query));
+
+    long long start = trace_clock();
+    size_t size = (size_t)(listCounter_get() + 1) * sizeof(int);
+    int *ids = mem_alloc(MEM_SCRATCH, size);
+    if (!ids) {
+        printf("Failed to allocate memory.\n");
+        return;
+    }
+    int count, error_at;
+    TagsStatus status = tags_select(query, ids, listCounter_get(), &count, &error_at);
+    if (status == TAGS_SYNTAX && query[error_at] == '\0') {
+        printf("Syntax error at end of query.\n");
+    } else if (status == TAGS_SYNTAX) {
+        printf("Syntax error at \"%s\".\n", query + error_at);
+    } else if (status != TAGS_OK) {
+        printf("Query failed: %s.\n", tags_statusName(status));
+    } else if (count == 0) {
+        printf("No matching tasks.\n");
+    } else {
+        printf("\n> Matching tasks (%d):\n", count);
+        render_begin(stdout);
+        for (int i = 0; i < count; i++)
+            render_task(list_findTask(head, ids[i]), render_getFormat(), i + 1);
+        render_end();
+    }
+    mem_free(MEM_SCRATCH, ids, size);
+    trace_record(start, status == TAGS_OK, "select %s %s", query, render_formatName(render_getFormat()));
+}
+
+void menu_switchProject(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    char name[64];
+    printf("\n> Projects:\n");
+    for (int i = 0; i < project_count(); i++) {
+        printf("  %-31s  %6d tasks%s\n", project_name(i), project_taskCount(i),
+               i == project_activeIndex() ? "  (active)" : "");
+    }
+    readString("\nProject to switch to (a new name creates it): ", name, sizeof(name));
+
+    long long start = trace_clock();
+    ProjectStatus status = project_switch(name, head, stack, id_tree, priority_tree, status_tree);
+    trace_record(start, status == PROJECT_OK, "project %s", name);
+    if (status != PROJECT_OK) {
+        printf("Cannot switch project: %s.\n", project_statusName(status));
+        return;
+    }
+    printf("Switching to project %s", project_active());
+    menu_reportDone();
+    printf("%d tasks loaded.\n", listCounter_get());
+}
+
+/**
+ * @brief State of menu_showAllProjects() within one project.
+ */
+typedef struct MenuProjectWalk {
+    int active;               // The tasks come from the list, not from a file
+    long count;               // Tasks printed so far
+} MenuProjectWalk;
+
+/**
+ * @brief Prints one task of a project (a ProjectTaskFn for project_scan()).
+ *
+ * @param task Pointer to the Task.
+ * @param context Pointer to the MenuProjectWalk.
+ * @return 1 to continue.
+ */
+static int menu_printProjectTask(const Task *task, void *context) {
+    MenuProjectWalk *walk = context;
+    if (walk->active) render_task(task, render_getFormat(), ++walk->count);
+    else render_storedTask(task, render_getFormat(), ++walk->count);
+    return 1;
+}
+
+void menu_showAllProjects(List *head) {
+    long long start = trace_clock();
+    render_begin(stdout);
+    for (int i = 0; i < project_count(); i++) {
+        MenuProjectWalk walk = { i == project_activeIndex(), 0 };
+        render_text("\n> Project ");
+        render_text(project_name(i));
+        render_text(walk.active ? " (active):\n" : ":\n");
+        project_scan(i, head, menu_printProjectTask, &walk);
+        if (walk.count == 0) render_text("  (no tasks)\n");
+    }
+    render_end();
+    trace_record(start, 1, "list all %s", render_formatName(render_getFormat()));
+}
+
+/**
+ * @brief Undoes the most recent operation or group.
+ *
+ * A task whose ID was taken in the meantime is given a new ID at a prompt.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_undo(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    StackNode *op = stack_peek(stack);
+    int type = op ? op->type : OP_ADD;
+    int task_id = op ? op->task_id : 0;
+    int available = stack_getSize(stack);
+
+    // Only the first step is timed: resolving an ID conflict waits for the user
+    long long start = trace_clock();
+    ListStatus status = list_undoStep(head, stack, id_tree, priority_tree, status_tree);
+    trace_record(start, status == LIST_OK, "undo");
+    while (status == LIST_DUPLICATE_ID) {
+        // The record that could not be reverted is back on top of the undo side
+        Task *task = stack_peek(stack)->task;
+        task->id = menu_resolveConflict(*head, task->id);
+        status = list_undoStep(head, stack, id_tree, priority_tree, status_tree);
+    }
+    if (status == LIST_BAD_STATE) {
+        printf("Commit or roll back the open transaction first.\n");
+        return;
+    }
+    if (status == LIST_EMPTY) {
+        printf("Nothing to undo.\n");
+        return;
+    }
+    if (status != LIST_OK) printf("Undo stopped: %s.\n", list_statusName(status));
+    int steps = available - stack_getSize(stack);
+    if (steps == 0) return;
+
+    if (steps == 1) printf("Undoing %s of task ID %d", stack_opName(type), task_id);
+    else printf("Undoing a group of %d operations", steps);
+    menu_reportDone();
+    printf("Undo completed (%d more available).\n", stack_getSize(stack));
+}
+
+/**
+ * @brief Re-applies the most recently undone operation or group.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_redo(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    StackNode *op = stack_peekRedo(stack);
+    int type = op ? op->type : OP_ADD;
+    int task_id = op ? op->task_id : 0;
+    int available = stack_getRedoSize(stack);
+
+    long long start = trace_clock();
+    ListStatus status = list_redoStep(head, stack, id_tree, priority_tree, status_tree);
+    trace_record(start, status == LIST_OK, "redo");
+    while (status == LIST_DUPLICATE_ID) {
+        Task *task = stack_peekRedo(stack)->task;
+        task->id = menu_resolveConflict(*head, task->id);
+        status = list_redoStep(head, stack, id_tree, priority_tree, status_tree);
+    }
+    if (status == LIST_BAD_STATE) {
+        printf("Commit or roll back the open transaction first.\n");
+        return;
+    }
+    if (status == LIST_EMPTY) {
+        printf("Nothing to redo.\n");
+        return;
+    }
+    if (status != LIST_OK) printf("Redo stopped: %s.\n", list_statusName(status));
+    int steps = available - stack_getRedoSize(stack);
+    if (steps == 0) return;
+
+    if (steps == 1) printf("Redoing %s of task ID %d", stack_opName(type), task_id);
+    else printf("Redoing a group of %d operations", steps);
+    menu_reportDone();
+    printf("Redo completed (%d more available).\n", stack_getRedoSize(stack));
+}
+
+/**
+ * @brief Prints the ID and title of one restorable task (a visitor for trash_forEach()).
+ */
+static void menu_printTrashed(int id, const char *title, void *context) {
+    (void)context;
+    printf("  ID %-8d %s\n", id, title);
+}
+
+/**
+ * @brief Prints the ID and title of every task in the trash file.
+ */
+void menu_showTrash() {
+    if (trash_count() == 0) return;
+    printf("\n> Trash (%d tasks):\n", trash_count());
+    printf("---------------------------------\n");
+    trash_forEach(menu_printTrashed, NULL);
+    printf("\n");
+}
+
+/**
+ * @brief Prompts for an ID and restores that task from the trash file to the head of the list.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_restoreFromTrash(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    if (trash_count() == 0) {
+        printf("Trash is empty.\n");
+        return;
+    }
+
+    int target_id = readInt("Enter the ID of the task to restore: ");
+    if (!trash_contains(target_id)) {
+        printf("Task with ID %d not found in trash.\n", target_id);
+        return;
+    }
+
+    int new_id = list_hasID(*head, target_id) ? menu_resolveConflict(*head, target_id) : 0;
+    ListStatus status = list_restoreTask(head, target_id, new_id, stack, id_tree, priority_tree, status_tree);
+    if (status != LIST_OK) {
+        printf("Failed to restore the task: %s.\n", list_statusName(status));
+        return;
+    }
+
+    printf("Restoring task with ID %d from trash", new_id ? new_id : target_id);
+    menu_reportDone();
+    printf("Task restored successfully.\n");
+}
+
+/**
+ * @brief Opens a transaction grouping the following list operations.
+ *
+ * Until commit or rollback, BST maintenance and progress feedback are deferred, and
+ * every recorded operation joins a single undo group.
+ */
+void menu_beginTransaction() {
+    long long start = trace_clock();
+    ListStatus status = list_txnBegin();
+    trace_record(start, status == LIST_OK, "begin");
+    if (status != LIST_OK) {
+        printf("A transaction is already open (%d operations).\n", list_transactionSize());
+        return;
+    }
+    printf("Transaction started.\n");
+}
+
+/**
+ * @brief Commits the open transaction.
+ *
+ * Applies the deferred BST maintenance in one batch rebuild.
+ *
+ * @param head Pointer to the head of the list.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_commitTransaction(List *head, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    int records = list_transactionSize();
+    long long start = trace_clock();
+    ListStatus status = list_txnCommit(head, id_tree, priority_tree, status_tree);
+    trace_record(start, status == LIST_OK, "commit");
+    if (status != LIST_OK) {
+        printf("No transaction is open.\n");
+        return;
+    }
+
+    printf("Committing %d operations", records);
+    menu_reportDone();
+    printf("Transaction committed.\n");
+}
+
+/**
+ * @brief Rolls back the open transaction.
+ *
+ * Reverts every operation recorded since the transaction began and drops them from
+ * the history. If the history could not keep all of them, nothing is reverted and the
+ * transaction is closed with its changes kept.
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_rollbackTransaction(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    int records = list_transactionSize(), reverted = 0;
+    long long start = trace_clock();
+    ListStatus status = list_txnRollback(head, stack, &reverted, id_tree, priority_tree, status_tree);
+    trace_record(start, status == LIST_OK, "rollback");
+    if (status == LIST_BAD_STATE) {
+        printf("No transaction is open.\n");
+        return;
+    }
+    if (status != LIST_OK) {
+        printf("The %d operations could not be rolled back (undo history incomplete); they were kept.\n", records);
+        return;
+    }
+
+    printf("Rolling back %d operations", reverted);
+    menu_reportDone();
+    printf("Transaction rolled back.\n");
+}
+
+/**
+ * @brief Saves all tasks to "tasks.dat".
+ *
+ * @param head Pointer to the head of the list.
+ */
+void menu_saveTasks(List *head) {
+    long long start = trace_clock();
+    int saved = file_writeTasks(head, project_storePath());
+    trace_record(start, saved >= 0, "save");
+    if (saved < 0) {
+        printf("Failed to open file for saving.\n");
+        return;
+    }
+
+    printf("Saving tasks to file");
+    menu_reportDone();
+    printf("Tasks saved successfully.\n");
+    project_bind();
+}
+
+/**
+ * @brief Replaces the list with the tasks in "tasks.dat".
+ *
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void menu_loadTasks(List **head, Stack *stack, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    int skipped;
+    long long start = trace_clock();
+    int loaded = file_readTasks(project_storePath(), head, stack, id_tree, priority_tree, status_tree, &skipped);
+    trace_record(start, loaded >= 0, "load");
+    if (loaded < 0) {
+        printf("No saved tasks found or failed to open file.\n");
+        return;
+    }
+    if (skipped > 0)
+        printf("Skipped %d unreadable or duplicate task records.\n", skipped);
+
+    printf("Loading tasks from file");
+    menu_reportDone();
+    printf("Tasks loaded successfully.\n");
+    project_bind();
+}
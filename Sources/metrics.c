@@ -0,0 +1,332 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "metrics.h"
+#include "trace.h"
+#include "mem.h"
+
+#define METRICS_SUB_BITS 5                       // 32 linear sub-buckets per power of two
+#define METRICS_SUB (1 << METRICS_SUB_BITS)
+#define METRICS_MAX_MAGNITUDE 40                 // Latencies from 2^40 ns (about 18 minutes) share the last bucket
+#define METRICS_BUCKETS (METRICS_SUB + (METRICS_MAX_MAGNITUDE - METRICS_SUB_BITS + 1) * METRICS_SUB)
+#define METRICS_SAMPLE_MASK 15                   // Sampled entry points time one call in 16...
+#define METRICS_WARMUP 1024                      // ...once they have been called this many times
+
+#define METRICS_SAMPLED 1                        // Single-task operation, called in loops: timing sampled
+#define METRICS_TRACKED 2                        // List or file operation: owns the METRIC_CURRENT counts
+#define METRICS_PER_TASK (METRICS_SAMPLED | METRICS_TRACKED)
+
+#ifdef __GNUC__
+    #define METRICS_ADD(counter, amount) __atomic_fetch_add(&(counter), (amount), __ATOMIC_RELAXED)
+#else
+    #define METRICS_ADD(counter, amount) ((counter) += (amount))
+#endif
+
+/**
+ * @brief Counters and latency histogram of one entry point.
+ */
+typedef struct Metric {
+    long long calls;
+    long long timed;
+    long long scanned;
+    long long allocated;
+    long long total;          // Sum of the latencies recorded, in nanoseconds
+    long long max;
+    long long buckets[METRICS_BUCKETS];
+} Metric;
+
+static Metric metrics_ops[METRIC_COUNT];
+static int metrics_enabled = 1;
+static int metrics_depth = 0;                    // Nesting of the tracked operations running
+static int metrics_current = METRIC_CURRENT;     // Outermost tracked operation running
+static char *metrics_dumpPath = NULL;
+static int metrics_interval = 0;
+static time_t metrics_nextDump = 0;
+
+static const char *metrics_names[METRIC_COUNT] = {
+    "list.insert", "list.remove", "list.remove_edge", "list.find", "list.step", "list.update",
+    "list.set_due", "list.clear", "list.update_where", "list.remove_where", "list.undo", "list.redo",
+    "list.commit", "list.rollback", "list.restore", "list.rebuild",
+    "tree.insert", "tree.remove", "tree.build", "tree.clear", "tree.walk", "tree.step",
+    "stack.push", "stack.undo", "stack.redo", "stack.clear",
+    "file.write", "file.read", "file.scan"
+};
+
+static const unsigned char metrics_flags[METRIC_COUNT] = {
+    METRICS_PER_TASK, METRICS_PER_TASK, METRICS_PER_TASK, METRICS_SAMPLED, METRICS_SAMPLED, METRICS_PER_TASK,
+    METRICS_PER_TASK, METRICS_TRACKED, METRICS_TRACKED, METRICS_TRACKED, METRICS_PER_TASK, METRICS_PER_TASK,
+    METRICS_TRACKED, METRICS_TRACKED, METRICS_TRACKED, METRICS_TRACKED,
+    METRICS_SAMPLED, METRICS_SAMPLED, 0, 0, 0, METRICS_SAMPLED,
+    METRICS_SAMPLED, METRICS_SAMPLED, METRICS_SAMPLED, 0,
+    0, METRICS_TRACKED, 0
+};
+
+/**
+ * @brief Returns the histogram bucket of a latency.
+ *
+ * Below 2^METRICS_SUB_BITS every value has its own bucket; above, each power of
+ * two is split into METRICS_SUB buckets of equal width.
+ *
+ * @param value The latency in nanoseconds.
+ * @return Index of the bucket.
+ */
+static int metrics_bucket(unsigned long long value) {
+    if (value < METRICS_SUB) return (int)value;
+#ifdef __GNUC__
+    int magnitude = 63 - __builtin_clzll(value);
+#else
+    int magnitude = 0;
+    for (unsigned long long rest = value; rest > 1; rest >>= 1) magnitude++;
+#endif
+    if (magnitude > METRICS_MAX_MAGNITUDE) return METRICS_BUCKETS - 1;
+    int shift = magnitude - METRICS_SUB_BITS;
+    return METRICS_SUB + shift * METRICS_SUB + (int)(value >> shift) - METRICS_SUB;
+}
+
+/**
+ * @brief Returns the latency a bucket stands for: the middle of its range.
+ *
+ * @param index Index of the bucket.
+ * @return The latency in nanoseconds.
+ */
+static long long metrics_bucketValue(int index) {
+    if (index < METRICS_SUB) return index;
+    int shift = index / METRICS_SUB - 1;
+    long long low = (long long)(index % METRICS_SUB + METRICS_SUB) << shift;
+    return low + ((1LL << shift) - 1) / 2;
+}
+
+/**
+ * @brief Raises a maximum, safely against other threads.
+ *
+ * @param max Pointer to the maximum.
+ * @param value The new value.
+ */
+static void metrics_raiseMax(long long *max, long long value) {
+#ifdef __GNUC__
+    long long seen = __atomic_load_n(max, __ATOMIC_RELAXED);
+    while (value > seen && !__atomic_compare_exchange_n(max, &seen, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+#else
+    if (value > *max) *max = value;
+#endif
+}
+
+/**
+ * @brief Counts a call to an entry point and starts timing it.
+ *
+ * @param op The entry point.
+ * @return Value to pass to metrics_end(): the start time, or 0 if the call is not timed.
+ */
+long long metrics_begin(MetricOp op) {
+    if (!metrics_enabled) return 0;
+    if (metrics_flags[op] & METRICS_TRACKED) {
+        if (metrics_depth++ == 0) metrics_current = op;
+    }
+    long long calls = METRICS_ADD(metrics_ops[op].calls, 1);
+    if ((metrics_flags[op] & METRICS_SAMPLED) && calls >= METRICS_WARMUP && (calls & METRICS_SAMPLE_MASK) != 0)
+        return 0;
+    return trace_clock();
+}
+
+/**
+ * @brief Records the latency of a call started with metrics_begin().
+ *
+ * @param op The entry point.
+ * @param start Value returned by metrics_begin().
+ */
+void metrics_end(MetricOp op, long long start) {
+    if (!metrics_enabled) return;
+    if ((metrics_flags[op] & METRICS_TRACKED) && metrics_depth > 0) {
+        if (--metrics_depth == 0) metrics_current = METRIC_CURRENT;
+    }
+    if (start == 0) return;
+
+    long long elapsed = trace_clock() - start;
+    if (elapsed < 0) elapsed = 0;
+    Metric *metric = &metrics_ops[op];
+    METRICS_ADD(metric->timed, 1);
+    METRICS_ADD(metric->total, elapsed);
+    METRICS_ADD(metric->buckets[metrics_bucket((unsigned long long)elapsed)], 1);
+    metrics_raiseMax(&metric->max, elapsed);
+}
+
+/**
+ * @brief Adds to the tasks scanned and nodes allocated by an entry point.
+ *
+ * @param op The entry point, or METRIC_CURRENT for the outermost list or file operation running.
+ * @param scanned Tasks scanned.
+ * @param allocated Nodes allocated.
+ */
+void metrics_count(int op, long long scanned, long long allocated) {
+    if (!metrics_enabled) return;
+    if (op == METRIC_CURRENT) op = metrics_current;
+    if (op < 0 || op >= METRIC_COUNT) return;
+    if (scanned) METRICS_ADD(metrics_ops[op].scanned, scanned);
+    if (allocated) METRICS_ADD(metrics_ops[op].allocated, allocated);
+}
+
+/**
+ * @brief Turns recording on or off.
+ *
+ * @param enabled 1 to record, 0 to stop.
+ */
+void metrics_setEnabled(int enabled) {
+    metrics_enabled = enabled;
+    metrics_depth = 0;
+    metrics_current = METRIC_CURRENT;
+}
+
+/**
+ * @brief Returns a percentile of a histogram.
+ *
+ * @param metric Pointer to the counters.
+ * @param permille The percentile, in thousandths.
+ * @return The latency in nanoseconds, at most the largest recorded.
+ */
+static long long metrics_percentile(const Metric *metric, int permille) {
+    long long rank = (metric->timed * permille + 999) / 1000, seen = 0;
+    if (rank < 1) rank = 1;
+    for (int i = 0; i < METRICS_BUCKETS; i++) {
+        seen += metric->buckets[i];
+        if (seen >= rank) {
+            long long value = metrics_bucketValue(i);
+            return value < metric->max ? value : metric->max;
+        }
+    }
+    return metric->max;
+}
+
+/**
+ * @brief Reads the figures of an entry point.
+ *
+ * @param op The entry point.
+ * @param snapshot Filled with the figures.
+ */
+void metrics_get(MetricOp op, MetricsSnapshot *snapshot) {
+    const Metric *metric = &metrics_ops[op];
+    memset(snapshot, 0, sizeof(*snapshot));
+    snapshot->calls = metric->calls;
+    snapshot->timed = metric->timed;
+    snapshot->scanned = metric->scanned;
+    snapshot->allocated = metric->allocated;
+    if (metric->timed == 0) return;
+    snapshot->mean = metric->total / metric->timed;
+    snapshot->p50 = metrics_percentile(metric, 500);
+    snapshot->p90 = metrics_percentile(metric, 900);
+    snapshot->p99 = metrics_percentile(metric, 990);
+    snapshot->p999 = metrics_percentile(metric, 999);
+    snapshot->max = metric->max;
+}
+
+/**
+ * @brief Returns the name of an entry point.
+ *
+ * @param op The entry point.
+ * @return Static string.
+ */
+const char* metrics_name(MetricOp op) {
+    return op >= 0 && op < METRIC_COUNT ? metrics_names[op] : "unknown";
+}
+
+/**
+ * @brief Prints the figures of every entry point called so far.
+ *
+ * @param out Stream to print to.
+ * @param tsv 1 for tab-separated lines in nanoseconds, 0 for an aligned table in microseconds.
+ */
+void metrics_print(FILE *out, int tsv) {
+    if (tsv) fprintf(out, "op\tcalls\ttimed\tscanned\tallocated\tmean_ns\tp50_ns\tp90_ns\tp99_ns\tp999_ns\tmax_ns\n");
+    else fprintf(out, "%-17s %10s %13s %13s %9s %9s %9s %9s %9s %9s\n", "Operation (us)", "calls", "scanned",
+                 "allocated", "mean", "p50", "p90", "p99", "p99.9", "max");
+
+    for (int op = 0; op < METRIC_COUNT; op++) {
+        MetricsSnapshot s;
+        metrics_get((MetricOp)op, &s);
+        if (s.calls == 0) continue;
+        if (tsv) {
+            fprintf(out, "%s\t%lld\t%lld\t%lld\t%lld\t%lld\t%lld\t%lld\t%lld\t%lld\t%lld\n", metrics_names[op],
+                    s.calls, s.timed, s.scanned, s.allocated, s.mean, s.p50, s.p90, s.p99, s.p999, s.max);
+        } else {
+            fprintf(out, "%-17s %10lld %13lld %13lld %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f\n", metrics_names[op],
+                    s.calls, s.scanned, s.allocated, s.mean / 1e3, s.p50 / 1e3, s.p90 / 1e3, s.p99 / 1e3,
+                    s.p999 / 1e3, s.max / 1e3);
+        }
+    }
+}
+
+/**
+ * @brief Sets every histogram and counter back to zero.
+ */
+void metrics_reset() {
+    memset(metrics_ops, 0, sizeof(metrics_ops));
+}
+
+/**
+ * @brief Sets the file the figures are written to periodically.
+ *
+ * @param path Path of the file, or NULL to stop writing it.
+ * @param seconds Seconds between two writes (METRICS_DEFAULT_INTERVAL if 0 or less).
+ */
+void metrics_setDump(const char *path, int seconds) {
+    if (metrics_dumpPath) mem_free(MEM_SCRATCH, metrics_dumpPath, strlen(metrics_dumpPath) + 1);
+    metrics_dumpPath = NULL;
+    metrics_interval = 0;
+    if (!path) return;
+
+    metrics_dumpPath = mem_alloc(MEM_SCRATCH, strlen(path) + 1);
+    if (!metrics_dumpPath) return;
+    strcpy(metrics_dumpPath, path);
+    metrics_interval = seconds > 0 ? seconds : METRICS_DEFAULT_INTERVAL;
+    metrics_nextDump = time(NULL) + metrics_interval;
+}
+
+/**
+ * @brief Returns the number of seconds between two writes of the dump file.
+ *
+ * @return The interval, or 0 if no dump file is set.
+ */
+int metrics_dumpInterval() {
+    return metrics_interval;
+}
+
+/**
+ * @brief Writes the dump file if the interval has passed since the last write.
+ */
+void metrics_tick() {
+    if (!metrics_dumpPath) return;
+    time_t now = time(NULL);
+    if (now < metrics_nextDump) return;
+    metrics_nextDump = now + metrics_interval;
+    metrics_dump();
+}
+
+/**
+ * @brief Writes the dump file now, through a temporary file.
+ *
+ * @return 1 on success, 0 if no dump file is set or it could not be written.
+ */
+int metrics_dump() {
+    if (!metrics_dumpPath) return 0;
+    size_t length = strlen(metrics_dumpPath);
+    char *temp = mem_alloc(MEM_SCRATCH, length + 5);
+    if (!temp) return 0;
+    memcpy(temp, metrics_dumpPath, length);
+    memcpy(temp + length, ".tmp", 5);
+
+    FILE *file = fopen(temp, "w");
+    int ok = file != NULL;
+    if (file) {
+        fprintf(file, "# taskmgr metrics %lld\n", (long long)time(NULL));
+        metrics_print(file, 1);
+        if (fclose(file) != 0) ok = 0;
+    }
+    // rename() does not replace an existing file everywhere
+    if (ok && rename(temp, metrics_dumpPath) != 0) {
+        remove(metrics_dumpPath);
+        ok = rename(temp, metrics_dumpPath) == 0;
+    }
+    if (!ok) remove(temp);
+    mem_free(MEM_SCRATCH, temp, length + 5);
+    return ok;
+}
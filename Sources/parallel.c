@@ -0,0 +1,123 @@
+#ifndef _WIN32
+    #define _POSIX_C_SOURCE 200809L   // sysconf
+#endif
+
+#include "parallel.h"
+#include "span.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+/**
+ * @brief One chunk of a parallel loop.
+ */
+typedef struct Chunk {
+    long begin;
+    long end;
+    ParallelFn fn;
+    void *context;
+#ifdef _WIN32
+    HANDLE thread;
+#else
+    pthread_t thread;
+#endif
+    int started;              // Running on a thread of its own
+} Chunk;
+
+/**
+ * @brief Runs one chunk on the calling thread, recording it as a span.
+ *
+ * @param chunk Pointer to the chunk.
+ */
+static void parallel_run(Chunk *chunk) {
+    long long span = span_begin();
+    chunk->fn(chunk->begin, chunk->end, chunk->context);
+    span_end(span, "parallel.chunk", chunk->end - chunk->begin);
+}
+
+/**
+ * @brief Thread entry point: runs one chunk.
+ */
+#ifdef _WIN32
+static DWORD WINAPI parallel_runChunk(LPVOID arg) {
+    parallel_run(arg);
+    return 0;
+}
+#else
+static void* parallel_runChunk(void *arg) {
+    parallel_run(arg);
+    return NULL;
+}
+#endif
+
+/**
+ * @brief Returns the number of threads a large loop is split across.
+ *
+ * @return Number of online processors, between 1 and PARALLEL_MAX_THREADS.
+ */
+int parallel_threads() {
+    static int threads = 0;
+    if (threads == 0) {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        long cores = (long)info.dwNumberOfProcessors;
+#else
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+        threads = cores < 1 ? 1 : cores > PARALLEL_MAX_THREADS ? PARALLEL_MAX_THREADS : (int)cores;
+    }
+    return threads;
+}
+
+/**
+ * @brief Runs fn over items [0, count) split into contiguous chunks, one per thread.
+ *
+ * @param count Number of items.
+ * @param fn Work function.
+ * @param context Opaque pointer passed to fn.
+ */
+void parallel_for(long count, ParallelFn fn, void *context) {
+    Chunk chunks[PARALLEL_MAX_THREADS];
+    long wanted = count / PARALLEL_MIN_CHUNK;
+    int parts = wanted < 1 ? 1 : wanted < parallel_threads() ? (int)wanted : parallel_threads();
+
+    if (parts == 1) {
+        if (count > 0) fn(0, count, context);
+        return;
+    }
+
+    for (int i = 0; i < parts; i++) {
+        chunks[i].begin = count * i / parts;
+        chunks[i].end = count * (i + 1) / parts;
+        chunks[i].fn = fn;
+        chunks[i].context = context;
+        chunks[i].started = 0;
+    }
+    for (int i = 0; i < parts - 1; i++) {
+#ifdef _WIN32
+        chunks[i].thread = CreateThread(NULL, 0, parallel_runChunk, &chunks[i], 0, NULL);
+        chunks[i].started = chunks[i].thread != NULL;
+#else
+        chunks[i].started = pthread_create(&chunks[i].thread, NULL, parallel_runChunk, &chunks[i]) == 0;
+#endif
+    }
+
+    parallel_run(&chunks[parts - 1]);
+    for (int i = 0; i < parts - 1; i++) {
+        if (!chunks[i].started) {
+            parallel_run(&chunks[i]);
+            continue;
+        }
+#ifdef _WIN32
+        WaitForSingleObject(chunks[i].thread, INFINITE);
+        CloseHandle(chunks[i].thread);
+#else
+        pthread_join(chunks[i].thread, NULL);
+#endif
+    }
+}
@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include "progress.h"
+
+static int progress_enabled = 1;
+
+/**
+ * @brief Enables or disables progress bars globally (e.g. off in batch mode).
+ *
+ * @param enabled 1 to show bars for large operations, 0 to never show them.
+ */
+void progress_setEnabled(int enabled) {
+    progress_enabled = enabled;
+}
+
+/**
+ * @brief Draws the bar for a percentage, overwriting the current line.
+ *
+ * @param progress Pointer to the report.
+ * @param percent Percentage to draw (0-100).
+ */
+static void progress_draw(Progress *progress, int percent) {
+    char bar[PROGRESS_BAR_WIDTH + 1];
+    int filled = percent * PROGRESS_BAR_WIDTH / 100;
+    for (int i = 0; i < PROGRESS_BAR_WIDTH; i++) bar[i] = i < filled ? '#' : '.';
+    bar[PROGRESS_BAR_WIDTH] = '\0';
+
+    printf("\r%s [%s] %3d%%", progress->label, bar, percent);
+    fflush(stdout);
+    progress->percent = percent;
+}
+
+/**
+ * @brief Starts a progress report.
+ *
+ * Nothing is drawn if progress is disabled or total is below PROGRESS_MIN_ITEMS.
+ *
+ * @param progress Pointer to the report to initialize.
+ * @param label Text shown before the bar.
+ * @param total Number of items the operation will process.
+ */
+void progress_begin(Progress *progress, const char *label, long total) {
+    progress->label = label;
+    progress->total = total;
+    progress->percent = 0;
+    progress->visible = progress_enabled && total >= PROGRESS_MIN_ITEMS;
+    // When hidden, never reach the redraw threshold
+    progress->next = progress->visible ? total / 100 : total + 1;
+    if (progress->visible) progress_draw(progress, 0);
+}
+
+/**
+ * @brief Redraws the bar when another percent of the items is done.
+ *
+ * Costs one comparison per call between redraws, so it can be called for every item.
+ *
+ * @param progress Pointer to the report.
+ * @param done Number of items processed so far.
+ */
+void progress_update(Progress *progress, long done) {
+    if (done < progress->next || !progress->visible) return;
+
+    int percent = (int)(done * 100 / progress->total);
+    if (percent > 100) percent = 100;
+    if (percent != progress->percent) progress_draw(progress, percent);
+    progress->next = (long)(percent + 1) * progress->total / 100;
+}
+
+/**
+ * @brief Finishes a progress report, completing and ending the bar line if shown.
+ *
+ * @param progress Pointer to the report.
+ */
+void progress_end(Progress *progress) {
+    if (!progress->visible) return;
+    if (progress->percent != 100) progress_draw(progress, 100);
+    printf("\n");
+    progress->visible = 0;
+}
@@ -0,0 +1,407 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "project.h"
+#include "file.h"
+#include "trash.h"
+#include "span.h"
+#include "mem.h"
+
+/**
+ * @brief A project of the registry.
+ */
+typedef struct Project {
+    char name[PROJECT_NAME_MAX + 1];
+    Stack *parked;            // Undo history while the project is inactive, or NULL
+    unsigned long used;       // Switch count when the project was last active (for LRU eviction)
+} Project;
+
+static Project *project_entries = NULL;
+static int project_entryCount = 0;
+static int project_entryCapacity = 0;
+static int project_loaded = 0;       // The registry file has been read
+static int project_current = 0;      // Index of the active project
+static int project_bound = 0;        // The list holds the active project's tasks
+static unsigned long project_clock = 0;
+static size_t project_budget = PROJECT_PARKED_BYTES;
+static char project_storeFile[PROJECT_NAME_MAX + 16] = TASKS_FILENAME;
+static char project_trashFile[PROJECT_NAME_MAX + 16] = TRASH_FILENAME;
+
+/**
+ * @brief Returns a short description of a status code.
+ *
+ * @param status The status code.
+ * @return Static string describing the status.
+ */
+const char* project_statusName(ProjectStatus status) {
+    switch (status) {
+        case PROJECT_OK: return "ok";
+        case PROJECT_BAD_NAME: return "project names are 1-31 letters, digits, '-' or '_'";
+        case PROJECT_IN_TRANSACTION: return "a transaction is open";
+        case PROJECT_UNSAVED: return "tasks not loaded from this project; save or clear them first";
+        case PROJECT_IO_ERROR: return "failed to write or read project file";
+        case PROJECT_NO_MEMORY: return "out of memory";
+        default: return "unknown error";
+    }
+}
+
+/**
+ * @brief Checks that a name is a valid project name.
+ *
+ * Names end up in file names, so only letters, digits, '-' and '_' are allowed.
+ *
+ * @param name The name.
+ * @return 1 if valid, 0 otherwise.
+ */
+static int project_validName(const char *name) {
+    size_t length = 0;
+    for (; name[length]; length++) {
+        unsigned char c = (unsigned char)name[length];
+        if (!isalnum(c) && c != '-' && c != '_') return 0;
+    }
+    return length > 0 && length <= PROJECT_NAME_MAX;
+}
+
+/**
+ * @brief Writes the path of one of a project's files.
+ *
+ * @param name Name of the project.
+ * @param trash 1 for the trash file, 0 for the task file.
+ * @param path Buffer of PROJECT_NAME_MAX + 16 characters.
+ */
+static void project_path(const char *name, int trash, char *path) {
+    if (strcmp(name, PROJECT_DEFAULT) == 0) strcpy(path, trash ? TRASH_FILENAME : TASKS_FILENAME);
+    else sprintf(path, "%s.%s", name, trash ? TRASH_FILENAME : TASKS_FILENAME);
+}
+
+/**
+ * @brief Finds a project by name.
+ *
+ * @param name The name.
+ * @return Index of the project, or -1 if unknown.
+ */
+static int project_find(const char *name) {
+    for (int i = 0; i < project_entryCount; i++) {
+        if (strcmp(project_entries[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Appends a project to the in-memory registry.
+ *
+ * @param name A valid name not in the registry.
+ * @return Index of the new project, or -1 on allocation failure.
+ */
+static int project_append(const char *name) {
+    if (project_entryCount == project_entryCapacity) {
+        int capacity = project_entryCapacity ? project_entryCapacity * 2 : 8;
+        Project *entries = mem_realloc(MEM_LIST, project_entries, (size_t)project_entryCapacity * sizeof(Project),
+                                       capacity * sizeof(Project));
+        if (!entries) return -1;
+        project_entries = entries;
+        project_entryCapacity = capacity;
+    }
+    Project *project = &project_entries[project_entryCount];
+    strcpy(project->name, name);
+    project->parked = NULL;
+    project->used = 0;
+    return project_entryCount++;
+}
+
+/**
+ * @brief Reads the registry file on first use. The default project always comes first.
+ *
+ * @return 1 if the registry is available, 0 on allocation failure.
+ */
+static int project_load() {
+    if (project_loaded) return 1;
+    if (project_append(PROJECT_DEFAULT) < 0) return 0;
+    project_loaded = 1;
+
+    FILE *file = fopen(PROJECT_REGISTRY, "r");
+    if (!file) return 1;
+    char line[64];
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (project_validName(line) && project_find(line) < 0 && project_append(line) < 0) break;
+    }
+    fclose(file);
+    return 1;
+}
+
+/**
+ * @brief Returns the number of known projects.
+ *
+ * @return Number of projects (at least 1).
+ */
+int project_count() {
+    project_load();
+    return project_entryCount > 0 ? project_entryCount : 1;
+}
+
+/**
+ * @brief Returns the name of a project.
+ *
+ * @param index Position in the registry, from 0 to project_count() - 1.
+ * @return The name, or NULL if index is out of range.
+ */
+const char* project_name(int index) {
+    if (!project_load()) return index == 0 ? PROJECT_DEFAULT : NULL;
+    return index >= 0 && index < project_entryCount ? project_entries[index].name : NULL;
+}
+
+/**
+ * @brief Returns the position of the active project.
+ *
+ * @return Index of the active project.
+ */
+int project_activeIndex() {
+    return project_current;
+}
+
+/**
+ * @brief Returns the name of the active project.
+ *
+ * @return The name.
+ */
+const char* project_active() {
+    return project_loaded ? project_entries[project_current].name : PROJECT_DEFAULT;
+}
+
+/**
+ * @brief Returns the task file of the active project.
+ *
+ * @return Path of the file ("tasks.dat" for the default project).
+ */
+const char* project_storePath() {
+    return project_storeFile;
+}
+
+/**
+ * @brief Returns the trash file of the active project.
+ *
+ * @return Path of the file ("trash.dat" for the default project).
+ */
+const char* project_trashPath() {
+    return project_trashFile;
+}
+
+/**
+ * @brief Marks the list as holding the active project's tasks.
+ */
+void project_bind() {
+    project_bound = 1;
+}
+
+/**
+ * @brief Returns the number of tasks of a project.
+ *
+ * @param index Position in the registry.
+ * @return Number of tasks (0 if the project has no file yet), or -1 if index is out of range.
+ */
+int project_taskCount(int index) {
+    const char *name = project_name(index);
+    if (!name) return -1;
+    if (index == project_current) return listCounter_get();
+    char path[PROJECT_NAME_MAX + 16];
+    project_path(name, 0, path);
+    int count = file_scanTasks(path, NULL, NULL);
+    return count < 0 ? 0 : count;
+}
+
+/**
+ * @brief Checks whether a project has an undo history parked in memory.
+ *
+ * @param index Position in the registry.
+ * @return 1 if parked, 0 otherwise.
+ */
+int project_isParked(int index) {
+    return project_name(index) && project_loaded && project_entries[index].parked != NULL;
+}
+
+/**
+ * @brief Returns the memory held by the parked undo histories.
+ *
+ * @return Size in bytes.
+ */
+size_t project_parkedMemory() {
+    size_t bytes = 0;
+    for (int i = 0; i < project_entryCount; i++) bytes += stack_memoryUsage(project_entries[i].parked);
+    return bytes;
+}
+
+/**
+ * @brief Drops a parked history, spilling its deleted tasks to the project's trash file.
+ *
+ * The trash file is only written if the caller keeps one open; it is reopened on
+ * the active project's file afterwards.
+ *
+ * @param index Position of the project in the registry.
+ */
+static void project_evict(int index) {
+    Stack *parked = project_entries[index].parked;
+    project_entries[index].parked = NULL;
+    if (trash_isOpen()) {
+        char path[PROJECT_NAME_MAX + 16];
+        project_path(project_entries[index].name, 1, path);
+        if (trash_open(path)) {
+            stack_setEvictHandler(parked, trash_append);
+            stack_clear(parked);
+        }
+        trash_open(project_trashFile);
+    }
+    stack_free(parked);
+}
+
+/**
+ * @brief Evicts parked histories, least recently used first, until they fit the budget.
+ */
+static void project_trim() {
+    size_t bytes = project_parkedMemory();
+    while (bytes > project_budget) {
+        int victim = -1;
+        for (int i = 0; i < project_entryCount; i++) {
+            if (project_entries[i].parked && (victim < 0 || project_entries[i].used < project_entries[victim].used))
+                victim = i;
+        }
+        if (victim < 0) break;
+        bytes -= stack_memoryUsage(project_entries[victim].parked);
+        project_evict(victim);
+    }
+}
+
+/**
+ * @brief Sets the memory budget for parked undo histories, evicting at once if it is exceeded.
+ *
+ * @param bytes Budget in bytes (0 parks nothing).
+ */
+void project_setParkedBudget(size_t bytes) {
+    project_budget = bytes;
+    project_trim();
+}
+
+/**
+ * @brief Adds a project to the registry and to the registry file.
+ *
+ * @param name A valid name not in the registry.
+ * @return Index of the new project, or -1 if it could not be recorded.
+ */
+static int project_create(const char *name) {
+    FILE *file = fopen(PROJECT_REGISTRY, "a");
+    if (!file) return -1;
+    int ok = fprintf(file, "%s\n", name) > 0;
+    if (fclose(file) != 0) ok = 0;
+    return ok ? project_append(name) : -1;
+}
+
+/**
+ * @brief Makes a project active, creating it if the name is new.
+ *
+ * The active project is saved first; if that fails nothing else changes. Its undo
+ * history is swapped with the target's parked one through stack_exchange(), so
+ * the caller's stack pointer stays valid. A target whose file cannot be read
+ * starts empty.
+ *
+ * @param name Name of the project.
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return PROJECT_OK, or the reason nothing was changed.
+ */
+ProjectStatus project_switch(const char *name, List **head, Stack *stack,
+                             Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    if (!project_validName(name)) return PROJECT_BAD_NAME;
+    if (list_inTransaction()) return PROJECT_IN_TRANSACTION;
+    if (!project_load()) return PROJECT_NO_MEMORY;
+    int target = project_find(name);
+    if (target == project_current) return PROJECT_OK;
+    if (!project_bound && *head) return PROJECT_UNSAVED;
+
+    long long span = span_begin();
+    if (project_bound && file_writeTasks(*head, project_storeFile) < 0) return PROJECT_IO_ERROR;
+    Stack *fresh = NULL;
+    if (target < 0 || !project_entries[target].parked) {
+        fresh = stack_create(stack_getCapacity(stack));
+        if (!fresh) return PROJECT_NO_MEMORY;
+    }
+    if (target < 0 && (target = project_create(name)) < 0) {
+        stack_free(fresh);
+        return PROJECT_IO_ERROR;
+    }
+
+    // Park the history of the project left behind and bring back the target's
+    Project *from = &project_entries[project_current];
+    Project *to = &project_entries[target];
+    Stack *history = to->parked ? to->parked : fresh;
+    int capacity = stack_getCapacity(stack);
+    to->parked = NULL;
+    stack_exchange(stack, history);
+    from->parked = history;
+    from->used = ++project_clock;
+    to->used = ++project_clock;
+    if (stack_getCapacity(stack) != capacity) stack_setCapacity(stack, capacity);
+
+    list_destroy(*head);
+    *head = NULL;
+    tree_clear(id_tree);
+    tree_clear(priority_tree);
+    tree_clear(status_tree);
+
+    project_current = target;
+    project_path(to->name, 0, project_storeFile);
+    project_path(to->name, 1, project_trashFile);
+    if (trash_isOpen()) trash_open(project_trashFile);
+    file_readTasks(project_storeFile, head, NULL, id_tree, priority_tree, status_tree, NULL);
+    project_bound = 1;
+
+    project_trim();
+    span_end(span, "project.switch", listCounter_get());
+    return PROJECT_OK;
+}
+
+/**
+ * @brief Calls a function for each task of a project, in list order.
+ *
+ * @param index Position in the registry.
+ * @param head Pointer to the head of the list (the active project).
+ * @param visit Function to call.
+ * @param context Opaque pointer passed to visit.
+ * @return Number of tasks visited, or -1 if index is out of range.
+ */
+int project_scan(int index, List *head, ProjectTaskFn visit, void *context) {
+    const char *name = project_name(index);
+    if (!name) return -1;
+    if (index == project_current) {
+        int count = 0;
+        for (List *current = head; current; current = current->next) {
+            count++;
+            if (!visit(current->task, context)) break;
+        }
+        return count;
+    }
+    char path[PROJECT_NAME_MAX + 16];
+    project_path(name, 0, path);
+    int count = file_scanTasks(path, visit, context);
+    return count < 0 ? 0 : count;
+}
+
+/**
+ * @brief Frees the parked undo histories and forgets the registry.
+ */
+void project_reset() {
+    for (int i = 0; i < project_entryCount; i++) stack_free(project_entries[i].parked);
+    mem_free(MEM_LIST, project_entries, (size_t)project_entryCapacity * sizeof(Project));
+    project_entries = NULL;
+    project_entryCount = 0;
+    project_entryCapacity = 0;
+    project_loaded = 0;
+    project_current = 0;
+    project_bound = 0;
+    project_clock = 0;
+    strcpy(project_storeFile, TASKS_FILENAME);
+    strcpy(project_trashFile, TRASH_FILENAME);
+}
@@ -0,0 +1,382 @@
+#include <stdio.h>
+#include <string.h>
+#include "render.h"
+#include "task.h"
+#include "list.h"
+#include "tree.h"
+#include "deadline.h"
+#include "tags.h"
+
+static char render_buffer[RENDER_BUFFER_SIZE];
+static size_t render_length = 0;
+static FILE *render_out = NULL;
+static int render_failed = 0;
+static RenderFormat render_format = RENDER_PLAIN;
+
+/**
+ * @brief Context of a tree traversal being rendered.
+ */
+typedef struct RenderWalk {
+    RenderFormat format;      // Layout to use
+    long count;               // Tasks rendered so far
+} RenderWalk;
+
+/**
+ * @brief Sets the format used by the interactive listings.
+ *
+ * @param format The new format.
+ */
+void render_setFormat(RenderFormat format) {
+    render_format = format;
+}
+
+/**
+ * @brief Returns the format used by the interactive listings.
+ *
+ * @return The current format.
+ */
+RenderFormat render_getFormat() {
+    return render_format;
+}
+
+/**
+ * @brief Returns the name of a format ("plain", "compact" or "tsv").
+ *
+ * @param format The format.
+ * @return Static string.
+ */
+const char* render_formatName(RenderFormat format) {
+    switch (format) {
+        case RENDER_COMPACT: return "compact";
+        case RENDER_TSV: return "tsv";
+        default: return "plain";
+    }
+}
+
+/**
+ * @brief Parses a format name.
+ *
+ * @param name "plain", "compact" or "tsv".
+ * @param format Set to the parsed format.
+ * @return 1 on success, 0 if the name is unknown.
+ */
+int render_parseFormat(const char *name, RenderFormat *format) {
+    if (strcmp(name, "plain") == 0) *format = RENDER_PLAIN;
+    else if (strcmp(name, "compact") == 0) *format = RENDER_COMPACT;
+    else if (strcmp(name, "tsv") == 0) *format = RENDER_TSV;
+    else return 0;
+    return 1;
+}
+
+/**
+ * @brief Writes the buffered text to the stream and empties the buffer.
+ */
+static void render_flush() {
+    if (render_length == 0) return;
+    if (fwrite(render_buffer, 1, render_length, render_out) != render_length) render_failed = 1;
+    render_length = 0;
+}
+
+/**
+ * @brief Appends bytes to the output buffer, flushing it whenever it fills up.
+ *
+ * @param data The bytes.
+ * @param size Number of bytes.
+ */
+static void render_write(const char *data, size_t size) {
+    while (size > 0) {
+        if (render_length == RENDER_BUFFER_SIZE) render_flush();
+        size_t room = RENDER_BUFFER_SIZE - render_length;
+        size_t chunk = size < room ? size : room;
+        memcpy(render_buffer + render_length, data, chunk);
+        render_length += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+}
+
+/**
+ * @brief Appends a string padded with spaces to a minimum width.
+ *
+ * @param text The string.
+ * @param width Minimum number of characters.
+ */
+static void render_padded(const char *text, int width) {
+    static const char spaces[] = "                ";
+    size_t length = strlen(text);
+    render_write(text, length);
+    if ((int)length < width) render_write(spaces, (size_t)width - length);
+}
+
+/**
+ * @brief Appends a string with tabs, newlines and backslashes escaped.
+ *
+ * @param text The string.
+ */
+static void render_escaped(const char *text) {
+    const char *start = text;
+    for (; *text; text++) {
+        char escape;
+        if (*text == '\t') escape = 't';
+        else if (*text == '\n') escape = 'n';
+        else if (*text == '\r') escape = 'r';
+        else if (*text == '\\') escape = '\\';
+        else continue;
+
+        char pair[2] = { '\\', escape };
+        render_write(start, (size_t)(text - start));
+        render_write(pair, 2);
+        start = text + 1;
+    }
+    render_write(start, (size_t)(text - start));
+}
+
+/**
+ * @brief Formats an integer right-aligned to a minimum width.
+ *
+ * Digits are produced two at a time from a lookup table instead of going
+ * through printf.
+ *
+ * @param value The integer.
+ * @param width Minimum number of characters (0 for none).
+ */
+static void render_intPadded(long long value, int width) {
+    static const char digits[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    char text[24];
+    char *end = text + sizeof(text);
+    char *p = end;
+    unsigned long long n = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+
+    while (n >= 100) {
+        unsigned int pair = (unsigned int)(n % 100) * 2;
+        n /= 100;
+        *--p = digits[pair + 1];
+        *--p = digits[pair];
+    }
+    if (n >= 10) {
+        *--p = digits[n * 2 + 1];
+        *--p = digits[n * 2];
+    } else {
+        *--p = (char)('0' + n);
+    }
+    if (value < 0) *--p = '-';
+    while (end - p < width && p > text) *--p = ' ';
+    render_write(p, (size_t)(end - p));
+}
+
+/**
+ * @brief Starts rendering into the output buffer.
+ *
+ * Text is appended to a static buffer and written to the stream only when the
+ * buffer fills up or at render_end(), so a listing costs a few large writes and
+ * no allocation.
+ *
+ * @param out Stream the buffer is flushed to.
+ */
+void render_begin(FILE *out) {
+    render_out = out;
+    render_length = 0;
+    render_failed = 0;
+}
+
+/**
+ * @brief Appends a string to the output buffer.
+ *
+ * @param text The string.
+ */
+void render_text(const char *text) {
+    render_write(text, strlen(text));
+}
+
+/**
+ * @brief Appends an integer in decimal to the output buffer.
+ *
+ * @param value The integer.
+ */
+void render_int(long long value) {
+    render_intPadded(value, 0);
+}
+
+/**
+ * @brief Appends one task in a given format, with or without its tags.
+ *
+ * @param task Pointer to the Task.
+ * @param format The layout to use.
+ * @param index Position shown as "Task #index" in the plain format (0 to omit).
+ * @param with_tags Look up the tags of the task (plain format only).
+ */
+static void render_taskFields(const Task *task, RenderFormat format, long index, int with_tags) {
+    char date[32], description[DESC_MAX + 1];
+    const char *tag_names[8];
+    int tag_count;
+    switch (format) {
+        case RENDER_COMPACT:
+            render_intPadded(task->id, 8);
+            render_text("  ");
+            render_padded(priorityName(task->priority), 6);
+            render_text("  ");
+            render_padded(statusName(task->status), 11);
+            render_text("  ");
+            render_text(task->title);
+            render_write("\n", 1);
+            break;
+
+        case RENDER_TSV:
+            render_int(task->id);
+            render_write("\t", 1);
+            render_text(priorityName(task->priority));
+            render_write("\t", 1);
+            render_text(statusName(task->status));
+            render_write("\t", 1);
+            render_escaped(task->title);
+            render_write("\t", 1);
+            desc_get(task->description, description, sizeof(description));
+            render_escaped(description);
+            render_write("\t", 1);
+            render_int(task->created);
+            render_write("\t", 1);
+            render_int(task->due);
+            render_write("\n", 1);
+            break;
+
+        default:
+            if (index > 0) {
+                render_text("\nTask #");
+                render_int(index);
+                render_text(":\n");
+            }
+            render_text("> Task Information:\n  ID          : ");
+            render_int(task->id);
+            render_text("\n  Title       : ");
+            render_text(task->title);
+            render_text("\n  Description : ");
+            desc_get(task->description, description, sizeof(description));
+            render_text(description);
+            render_text("\n  Priority    : ");
+            render_text(priorityName(task->priority));
+            render_text("\n  Status      : ");
+            render_text(statusName(task->status));
+            if (task->created) {
+                deadline_format(task->created, date, sizeof(date));
+                render_text("\n  Created     : ");
+                render_text(date);
+            }
+            if (task->due) {
+                deadline_format(task->due, date, sizeof(date));
+                render_text("\n  Due         : ");
+                render_text(date);
+            }
+            tag_count = with_tags ? tags_ofTask(task->id, tag_names, 8) : 0;
+            for (int i = 0; i < tag_count && i < 8; i++) {
+                render_text(i == 0 ? "\n  Tags        : " : ", ");
+                render_text(tag_names[i]);
+            }
+            if (tag_count > 8) render_text(", ...");
+            render_write("\n", 1);
+            break;
+    }
+}
+
+/**
+ * @brief Appends one task in a given format.
+ *
+ * @param task Pointer to the Task.
+ * @param format The layout to use.
+ * @param index Position shown as "Task #index" in the plain format (0 to omit).
+ */
+void render_task(const Task *task, RenderFormat format, long index) {
+    render_taskFields(task, format, index, 1);
+}
+
+/**
+ * @brief Appends one task that is not in the list, such as a task read from another project's file.
+ *
+ * Same as render_task(), except that the tags are left out: they are looked up by
+ * ID among the tasks of the list, where this ID may belong to another task.
+ *
+ * @param task Pointer to the Task.
+ * @param format The layout to use.
+ * @param index Position shown as "Task #index" in the plain format (0 to omit).
+ */
+void render_storedTask(const Task *task, RenderFormat format, long index) {
+    render_taskFields(task, format, index, 0);
+}
+
+/**
+ * @brief Writes out the buffered text.
+ *
+ * @return 1 on success, 0 if the stream reported a write error.
+ */
+int render_end() {
+    render_flush();
+    if (fflush(render_out) != 0) render_failed = 1;
+    render_out = NULL;
+    return !render_failed;
+}
+
+/**
+ * @brief Appends the column header of the compact format.
+ */
+static void render_compactHeader() {
+    render_text("      ID  PRIO    STATUS       TITLE\n");
+}
+
+/**
+ * @brief Renders every task of the list, head to tail.
+ *
+ * The plain format numbers the tasks and ends with the total, as the menu listing always has.
+ *
+ * @param head Pointer to the head of the list.
+ * @param out Stream to write to.
+ * @param format The layout to use.
+ * @return Number of tasks rendered.
+ */
+long render_list(List *head, FILE *out, RenderFormat format) {
+    long count = 0;
+    render_begin(out);
+    if (format == RENDER_PLAIN) render_text("\n> Task List:\n---------------------------------\n");
+    else if (format == RENDER_COMPACT) render_compactHeader();
+
+    for (List *current = head; current != NULL; current = current->next)
+        render_task(current->task, format, ++count);
+
+    if (format != RENDER_TSV) {
+        render_text(format == RENDER_PLAIN ? "\nTotal tasks: " : "Total tasks: ");
+        render_int(count);
+        render_text(format == RENDER_PLAIN ? "\n\n" : "\n");
+    }
+    render_end();
+    return count;
+}
+
+/**
+ * @brief Renders one task visited during a tree traversal.
+ *
+ * @param task Pointer to the Task.
+ * @param context Pointer to the RenderWalk.
+ */
+static void render_visit(Task *task, void *context) {
+    RenderWalk *walk = context;
+    walk->count++;
+    render_task(task, walk->format, 0);
+}
+
+/**
+ * @brief Renders every task of a BST in sorted order.
+ *
+ * @param tree Pointer to the tree.
+ * @param out Stream to write to.
+ * @param format The layout to use.
+ * @return Number of tasks rendered.
+ */
+long render_tree(Tree *tree, FILE *out, RenderFormat format) {
+    RenderWalk walk = { format, 0 };
+    render_begin(out);
+    if (format == RENDER_COMPACT) render_compactHeader();
+    tree_forEach(tree, render_visit, &walk);
+    render_end();
+    return walk.count;
+}
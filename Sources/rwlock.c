@@ -0,0 +1,115 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE   // pthread_rwlockattr_setkind_np
+#endif
+
+#include <stdlib.h>
+#include "rwlock.h"
+#include "mem.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+struct RwLock {
+#ifdef _WIN32
+    SRWLOCK handle;
+#else
+    pthread_rwlock_t handle;
+#endif
+};
+
+/**
+ * @brief Creates a lock.
+ *
+ * @return Pointer to the new lock, or NULL on failure.
+ */
+RwLock* rwlock_create() {
+    RwLock *lock = mem_alloc(MEM_LIST, sizeof(RwLock));
+    if (!lock) return NULL;
+#ifdef _WIN32
+    InitializeSRWLock(&lock->handle);
+#else
+    pthread_rwlockattr_t attr;
+    int ok = pthread_rwlockattr_init(&attr) == 0;
+#ifdef __GLIBC__
+    // The default prefers readers, which lets busy readers starve the writer
+    if (ok) pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    if (ok) {
+        ok = pthread_rwlock_init(&lock->handle, &attr) == 0;
+        pthread_rwlockattr_destroy(&attr);
+    }
+    if (!ok) {
+        mem_free(MEM_LIST, lock, sizeof(RwLock));
+        return NULL;
+    }
+#endif
+    return lock;
+}
+
+/**
+ * @brief Frees a lock that is no longer held.
+ *
+ * @param lock Pointer to the lock (may be NULL).
+ */
+void rwlock_free(RwLock *lock) {
+    if (!lock) return;
+#ifndef _WIN32
+    pthread_rwlock_destroy(&lock->handle);
+#endif
+    mem_free(MEM_LIST, lock, sizeof(RwLock));
+}
+
+/**
+ * @brief Acquires the lock for reading, waiting while a writer holds it.
+ *
+ * @param lock Pointer to the lock.
+ */
+void rwlock_readLock(RwLock *lock) {
+#ifdef _WIN32
+    AcquireSRWLockShared(&lock->handle);
+#else
+    pthread_rwlock_rdlock(&lock->handle);
+#endif
+}
+
+/**
+ * @brief Releases a read acquisition.
+ *
+ * @param lock Pointer to the lock.
+ */
+void rwlock_readUnlock(RwLock *lock) {
+#ifdef _WIN32
+    ReleaseSRWLockShared(&lock->handle);
+#else
+    pthread_rwlock_unlock(&lock->handle);
+#endif
+}
+
+/**
+ * @brief Acquires the lock for writing, waiting until no reader or writer holds it.
+ *
+ * @param lock Pointer to the lock.
+ */
+void rwlock_writeLock(RwLock *lock) {
+#ifdef _WIN32
+    AcquireSRWLockExclusive(&lock->handle);
+#else
+    pthread_rwlock_wrlock(&lock->handle);
+#endif
+}
+
+/**
+ * @brief Releases a write acquisition.
+ *
+ * @param lock Pointer to the lock.
+ */
+void rwlock_writeUnlock(RwLock *lock) {
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(&lock->handle);
+#else
+    pthread_rwlock_unlock(&lock->handle);
+#endif
+}
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <string.h>
+#include "span.h"
+#include "trace.h"
+
+#define SPAN_EVENT_MAX 256        // Longest event line written
+
+#if defined(__GNUC__)
+    #define SPAN_THREAD_LOCAL __thread
+    #define SPAN_NEXT_THREAD() __atomic_add_fetch(&span_threads, 1, __ATOMIC_RELAXED)
+#elif defined(_MSC_VER)
+    #define SPAN_THREAD_LOCAL __declspec(thread)
+    #define SPAN_NEXT_THREAD() (++span_threads)
+#else
+    #define SPAN_THREAD_LOCAL    // No thread-local storage: every span is put on thread 1
+    #define SPAN_NEXT_THREAD() 1
+#endif
+
+static FILE *span_file = NULL;
+static char span_buffer[1 << 16];
+static long long span_origin = 0;         // trace_clock() when the file was opened
+static int span_threads = 0;              // Threads numbered so far
+static SPAN_THREAD_LOCAL int span_tid = 0;
+
+/**
+ * @brief Writes the metadata event naming a thread.
+ *
+ * @param tid Number of the thread.
+ * @param name Name shown for it.
+ */
+static void span_nameThread(int tid, const char *name) {
+    char event[SPAN_EVENT_MAX];
+    snprintf(event, sizeof(event), ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+             "\"args\":{\"name\":\"%s\"}}", tid, name);
+    fputs(event, span_file);
+}
+
+/**
+ * @brief Returns the number of the calling thread, numbering it if it has none yet.
+ *
+ * @return Number of the thread, from 1.
+ */
+static int span_thread() {
+    if (span_tid == 0) {
+        char name[32];
+        span_tid = SPAN_NEXT_THREAD();
+        snprintf(name, sizeof(name), "worker %d", span_tid - 1);
+        if (span_tid > 1) span_nameThread(span_tid, name);
+    }
+    return span_tid;
+}
+
+/**
+ * @brief Starts writing spans to a trace-event file, replacing it.
+ *
+ * @param path Path of the file.
+ * @return 1 on success, 0 if the file could not be created.
+ */
+int span_open(const char *path) {
+    span_close();
+    span_file = fopen(path, "w");
+    if (!span_file) return 0;
+    setvbuf(span_file, span_buffer, _IOFBF, sizeof(span_buffer));
+    fputs("[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"taskmgr\"}}", span_file);
+    span_threads = 1;
+    span_tid = 1;
+    span_nameThread(1, "main");
+    span_origin = trace_clock();
+    return 1;
+}
+
+/**
+ * @brief Stops writing spans and closes the file.
+ */
+void span_close() {
+    if (!span_file) return;
+    fputs("\n]\n", span_file);
+    fclose(span_file);
+    span_file = NULL;
+}
+
+/**
+ * @brief Starts a span.
+ *
+ * @return Value to pass to span_end(): the start time, or 0 if no file is open.
+ */
+long long span_begin() {
+    return span_file ? trace_clock() : 0;
+}
+
+/**
+ * @brief Ends a span started with span_begin() and writes it.
+ *
+ * @param start Value returned by span_begin() (0 writes nothing).
+ * @param name Name of the span; the part before the first dot is its category.
+ * @param tasks Number of tasks the operation handled, or -1 to leave it out.
+ */
+void span_end(long long start, const char *name, long tasks) {
+    if (!start || !span_file) return;
+    long long end = trace_clock();
+    int tid = span_thread();
+    const char *dot = strchr(name, '.');
+    int category = dot ? (int)(dot - name) : (int)strlen(name);
+    char event[SPAN_EVENT_MAX], args[48] = "";
+    if (tasks >= 0) snprintf(args, sizeof(args), ",\"args\":{\"tasks\":%ld}", tasks);
+    snprintf(event, sizeof(event), ",\n{\"name\":\"%s\",\"cat\":\"%.*s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+             "\"pid\":1,\"tid\":%d%s}", name, category, name, (start - span_origin) / 1e3, (end - start) / 1e3,
+             tid, args);
+    fputs(event, span_file);
+}
@@ -1,29 +1,282 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <limits.h>
 #include "stack.h"
+#include "metrics.h"
+#include "mem.h"
 
-#define MAX_STACK_SIZE 10
+/**
+ * @brief Returns the ring index that lies `offset` slots before `index`.
+ *
+ * @param stack Pointer to the stack (capacity must be > 0).
+ * @param index Starting slot.
+ * @param offset Number of slots to step back.
+ * @return Wrapped slot index.
+ */
+static int stack_wrapBack(Stack *stack, int index, int offset) {
+    index -= offset;
+    while (index < 0) index += stack->allocated;
+    return index;
+}
+
+/**
+ * @brief Returns an undo record by age.
+ *
+ * @param stack Pointer to the stack.
+ * @param age 0 for the oldest undo record, up to size - 1 for the newest.
+ * @return Pointer to the record.
+ */
+static StackNode* stack_atAge(Stack *stack, int age) {
+    return &stack->slots[stack_wrapBack(stack, stack->top, stack->size - age)];
+}
+
+/**
+ * @brief Hands a discarded task to the eviction handler, then frees it.
+ *
+ * @param stack Pointer to the stack.
+ * @param task Pointer to the owned Task (may be NULL).
+ */
+static void stack_release(Stack *stack, Task *task) {
+    if (!task) return;
+    if (stack->on_evict) stack->on_evict(task);
+    task_free(task);
+}
+
+/**
+ * @brief Frees the tasks owned by the redo records and forgets them.
+ *
+ * @param stack Pointer to the stack.
+ */
+static void stack_discardRedo(Stack *stack) {
+    for (int i = 0; i < stack->redo; i++) {
+        StackNode *node = &stack->slots[(stack->top + i) % stack->allocated];
+        stack_release(stack, node->task);
+        node->task = NULL;
+    }
+    stack->redo = 0;
+}
+
+/**
+ * @brief Frees the oldest group of undo records, all of it.
+ *
+ * The group is the oldest record and the chained records above it.
+ *
+ * @param stack Pointer to the stack (not empty).
+ */
+static void stack_evictOldest(Stack *stack) {
+    int length = 1;
+    while (length < stack->size && (stack_atAge(stack, length)->flags & REC_CHAINED)) length++;
+    for (int age = 0; age < length; age++) {
+        StackNode *node = stack_atAge(stack, age);
+        stack_release(stack, node->task);
+        node->task = NULL;
+    }
+    stack->size -= length;
+    if (stack->open > stack->size) stack->open = stack->size;
+}
 
 /**
- * @brief Creates a new empty stack.
+ * @brief Moves the records, oldest first, to the start of a new ring and frees the old one.
  *
- * Allocates memory for the stack and initializes it with no tasks.
+ * @param stack Pointer to the stack.
+ * @param ring The new ring (NULL if slots is 0).
+ * @param slots Number of slots of the new ring (at least size + redo).
+ */
+static void stack_moveTo(Stack *stack, StackNode *ring, int slots) {
+    int count = stack->size + stack->redo;
+    int first = count > 0 ? stack_wrapBack(stack, stack->top, stack->size) : 0;
+    for (int i = 0; i < count; i++) ring[i] = stack->slots[(first + i) % stack->allocated];
+    mem_free(MEM_STACK, stack->slots, (size_t)stack->allocated * sizeof(StackNode));
+    stack->slots = ring;
+    stack->allocated = slots;
+    stack->top = slots > 0 ? stack->size % slots : 0;
+}
+
+/**
+ * @brief Gives the ring a new number of slots, keeping every record.
  *
+ * @param stack Pointer to the stack.
+ * @param slots Number of slots (at least size + redo).
+ * @return 1 on success, 0 on allocation failure (stack unchanged).
+ */
+static int stack_resize(Stack *stack, int slots) {
+    StackNode *ring = NULL;
+    if (slots > 0) {
+        ring = mem_calloc(MEM_STACK, slots, sizeof(StackNode));
+        if (!ring) return 0;
+    }
+    stack_moveTo(stack, ring, slots);
+    return 1;
+}
+
+/**
+ * @brief Creates a new empty stack with the given capacity.
+ *
+ * Allocates the stack and its ring buffer up front. A capacity of 0 disables undo:
+ * pushed records are discarded (and their tasks freed) immediately.
+ *
+ * @param capacity Maximum number of records to keep (negative values are treated as 0).
  * @return Pointer to the new Stack, or NULL if allocation fails.
  */
-Stack* stack_create() {
-    Stack *stack = malloc(sizeof(Stack));
+Stack* stack_create(int capacity) {
+    if (capacity < 0) capacity = 0;
+    Stack *stack = mem_alloc(MEM_STACK, sizeof(Stack));
     if (!stack) return NULL;
-    stack->top = NULL;
+    stack->slots = NULL;
+    if (capacity > 0) {
+        stack->slots = mem_calloc(MEM_STACK, capacity, sizeof(StackNode));
+        if (!stack->slots) {
+            mem_free(MEM_STACK, stack, sizeof(Stack));
+            return NULL;
+        }
+    }
+    stack->allocated = capacity;
+    stack->capacity = capacity;
+    stack->top = 0;
     stack->size = 0;
+    stack->redo = 0;
+    stack->open = 0;
+    stack->dropping = 0;
+    stack->reserved = 0;
+    stack->on_evict = NULL;
     return stack;
 }
 
 /**
- * @brief Pushes a task onto the stack with its position metadata.
+ * @brief Changes the capacity of the stack at runtime.
+ *
+ * Discards the redo records and keeps the most recent undo records; if the new
+ * capacity is smaller than the current size, the oldest groups are freed, whole.
+ *
+ * @param stack Pointer to the stack.
+ * @param capacity New maximum number of records.
+ * @return 1 on success, 0 if the new buffer could not be allocated (stack unchanged).
+ */
+int stack_setCapacity(Stack *stack, int capacity) {
+    if (!stack) return 0;
+    if (capacity < 0) capacity = 0;
+    if (capacity == stack->capacity) return 1;
+
+    StackNode *slots = NULL;
+    if (capacity > 0) {
+        slots = mem_calloc(MEM_STACK, capacity, sizeof(StackNode));
+        if (!slots) return 0;
+    }
+
+    // Free the oldest groups that no longer fit, then move the rest to the new ring
+    stack_discardRedo(stack);
+    while (stack->size > capacity) stack_evictOldest(stack);
+    stack_moveTo(stack, slots, capacity);
+    stack->capacity = capacity;
+    stack->dropping = 0;
+    stack->reserved = 0;
+    return 1;
+}
+
+/**
+ * @brief Sets the callback invoked for tasks the stack discards.
+ *
+ * Applies to eviction of the oldest record, discarded redo records, capacity
+ * reductions and stack_clear(), but not to stack_free().
+ *
+ * @param stack Pointer to the stack.
+ * @param on_evict Callback, or NULL to simply free discarded tasks.
+ */
+void stack_setEvictHandler(Stack *stack, StackEvictFn on_evict) {
+    if (stack) stack->on_evict = on_evict;
+}
+
+/**
+ * @brief Returns the maximum number of records the stack can hold.
+ *
+ * @param stack Pointer to the stack.
+ * @return Capacity of the stack.
+ */
+int stack_getCapacity(Stack *stack) {
+    return stack ? stack->capacity : 0;
+}
+
+/**
+ * @brief Makes room for a group of records before the operation that pushes them starts.
+ *
+ * @param stack Pointer to the stack.
+ * @param records Number of records the operation will push.
+ * @param chained 1 if the records extend the newest group (an open transaction).
+ * @return 1 on success (or if undo is disabled), 0 if the ring could not grow.
+ */
+int stack_reserve(Stack *stack, int records, int chained) {
+    if (!stack || stack->capacity == 0) return 1;
+    // Older groups are evicted as the group grows, so it only needs slots of its own
+    long need = (long)records + (chained ? stack->open : 0);
+    if (need > INT_MAX / 2) return 0;
+    if (need > stack->allocated && !stack_resize(stack, (int)need)) return 0;
+    if (!chained) stack->reserved = (int)need;
+    return 1;
+}
+
+/**
+ * @brief Pushes an operation record onto the stack.
+ *
+ * Discards any redo records, then stores a copy of the record. When the stack is
+ * full, the oldest group (and the tasks its records own) is freed to make room; a
+ * record chained to a group that fills the whole stack grows the ring instead.
+ * Ownership of record->task passes to the stack.
+ *
+ * If the ring cannot grow, the group the record belongs to is discarded as a whole,
+ * along with the rest of its records as they are pushed.
+ *
+ * @param stack Pointer to the stack.
+ * @param record Pointer to the record to copy.
+ * @return 1 if the record was kept, 0 if undo is disabled or memory ran out.
+ */
+int stack_pushRecord(Stack *stack, const StackNode *record) {
+    if (!stack || !record) return 0;
+    int extends = (record->flags & REC_CHAINED) != 0;
+
+    // Undo disabled, or the group lost records already: the stack cannot take ownership
+    if (stack->capacity == 0 || (extends && stack->dropping)) {
+        stack_release(stack, record->task);
+        return 0;
+    }
+
+    long long start = metrics_begin(METRIC_STACK_PUSH);
+    stack_discardRedo(stack);
+    stack->dropping = 0;
+    int keep = stack->capacity;
+    if (!extends) {
+        stack->open = 0;
+        if (stack->reserved > keep) keep = stack->reserved;
+        stack->reserved = 0;
+    }
+
+    // Evict whole groups, oldest first, but never the group the record extends
+    while (stack->size >= stack->capacity && !(extends && stack->open >= stack->size))
+        stack_evictOldest(stack);
+    // A ring grown for a large group shrinks back once a new group starts
+    if (!extends && stack->allocated > keep) stack_resize(stack, keep);
+
+    if (stack->size == stack->allocated && !stack_resize(stack, stack->allocated * 2)) {
+        // The group fills the ring and cannot grow: discard all of it, not a prefix
+        while (stack->size > 0) stack_evictOldest(stack);
+        stack_release(stack, record->task);
+        stack->open = 0;
+        stack->dropping = 1;
+        metrics_end(METRIC_STACK_PUSH, start);
+        return 0;
+    }
+
+    stack->slots[stack->top] = *record;
+    stack->top = (stack->top + 1) % stack->allocated;
+    stack->size++;
+    stack->open++;
+    metrics_end(METRIC_STACK_PUSH, start);
+    return 1;
+}
+
+/**
+ * @brief Pushes a removed task onto the stack with its position metadata.
  *
- * Stores the task along with its original position and target ID (for middle insertions).
- * Enforces a maximum stack size of 10, freeing the oldest task if necessary.
+ * Shorthand for stack_pushRecord() with an OP_REMOVE record owning the task.
  *
  * @param stack Pointer to the stack.
  * @param task Pointer to the Task to push.
@@ -32,110 +285,231 @@ Stack* stack_create() {
  */
 void stack_push(Stack *stack, Task *task, TaskPosition position, int target_id) {
     if (!stack || !task) return;
+    StackNode record = {0};
+    record.type = OP_REMOVE;
+    record.task = task;
+    record.task_id = task->id;
+    record.position = (unsigned char)position;
+    record.target_id = target_id;
+    stack_pushRecord(stack, &record);
+}
 
-    // If stack is full, remove oldest task (bottom of stack)
-    if (stack->size >= MAX_STACK_SIZE) {
-        StackNode *current = stack->top;
-        StackNode *prev = NULL;
-        while (current->next) {
-            prev = current;
-            current = current->next;
-        }
-        if (prev) {
-            prev->next = NULL;
-            free(current->task);
-            free(current);
-            stack->size--;
-        }
-    }
+/**
+ * @brief Moves the newest undo record to the redo side and returns it.
+ *
+ * The record stays in the buffer; the caller applies its inverse and updates
+ * record->task to reflect ownership after the change.
+ *
+ * @param stack Pointer to the stack.
+ * @return Pointer to the record to undo, or NULL if there is nothing to undo.
+ */
+StackNode* stack_undo(Stack *stack) {
+    if (stack_isEmpty(stack)) return NULL;
+    long long start = metrics_begin(METRIC_STACK_UNDO);
+    stack->top = stack_wrapBack(stack, stack->top, 1);
+    stack->size--;
+    stack->redo++;
+    if (stack->open > 0) stack->open--;
+    metrics_end(METRIC_STACK_UNDO, start);
+    return &stack->slots[stack->top];
+}
 
-    StackNode *node = malloc(sizeof(StackNode));
-    if (!node) return;
-    node->task = task;
-    node->position = position;
-    node->target_id = target_id;
-    node->next = stack->top;
-    stack->top = node;
+/**
+ * @brief Moves the oldest redo record back to the undo side and returns it.
+ *
+ * The caller re-applies the record and updates record->task accordingly.
+ *
+ * @param stack Pointer to the stack.
+ * @return Pointer to the record to redo, or NULL if there is nothing to redo.
+ */
+StackNode* stack_redo(Stack *stack) {
+    if (!stack || stack->redo == 0) return NULL;
+    long long start = metrics_begin(METRIC_STACK_REDO);
+    StackNode *node = &stack->slots[stack->top];
+    stack->top = (stack->top + 1) % stack->allocated;
+    stack->redo--;
     stack->size++;
+    stack->open = 0;
+    metrics_end(METRIC_STACK_REDO, start);
+    return node;
 }
 
 /**
- * @brief Pops a task from the stack along with its position metadata.
+ * @brief Drops the redo records undone last without calling the eviction handler.
  *
- * Removes and returns the top task, along with its position and target ID.
+ * Used by transaction rollback: tasks owned by the dropped records were created
+ * inside the transaction and never became visible, so they are simply freed.
+ * Older redo records stay and can still be redone.
  *
  * @param stack Pointer to the stack.
- * @param position Pointer to store the task's original position.
- * @param target_id Pointer to store the target ID (for POS_MIDDLE).
- * @return Pointer to the popped Task, or NULL if the stack is empty.
+ * @param count Number of redo records to drop, nearest to the undo side first.
  */
-Task* stack_pop(Stack *stack, TaskPosition *position, int *target_id) {
-    if (!stack || !stack->top) return NULL;
-    StackNode *node = stack->top;
-    Task *task = node->task;
-    *position = node->position;
-    *target_id = node->target_id;
-    stack->top = node->next;
-    free(node);
-    stack->size--;
-    return task;
+void stack_dropRedo(Stack *stack, int count) {
+    if (!stack || count <= 0) return;
+    if (count > stack->redo) count = stack->redo;
+    for (int i = 0; i < stack->redo; i++) {
+        StackNode *node = &stack->slots[(stack->top + i) % stack->allocated];
+        if (i < count) {
+            task_free(node->task);
+        } else {
+            stack->slots[(stack->top + i - count) % stack->allocated] = *node;
+        }
+        node->task = NULL;
+    }
+    stack->redo -= count;
+}
+
+/**
+ * @brief Peeks at the record the next undo would apply.
+ *
+ * @param stack Pointer to the stack.
+ * @return Pointer to the record, or NULL if there is nothing to undo.
+ */
+StackNode* stack_peek(Stack *stack) {
+    if (stack_isEmpty(stack)) return NULL;
+    return &stack->slots[stack_wrapBack(stack, stack->top, 1)];
 }
 
 /**
- * @brief Peeks at the top task on the stack without removing it.
+ * @brief Peeks at the record the next redo would apply.
  *
  * @param stack Pointer to the stack.
- * @return Pointer to the top Task, or NULL if the stack is empty.
+ * @return Pointer to the record, or NULL if there is nothing to redo.
  */
-Task* stack_peek(Stack *stack) {
-    if (!stack || !stack->top) return NULL;
-    return stack->top->task;
+StackNode* stack_peekRedo(Stack *stack) {
+    if (!stack || stack->redo == 0) return NULL;
+    return &stack->slots[stack->top];
 }
 
 /**
  * @brief Checks if the stack is empty.
  *
  * @param stack Pointer to the stack.
- * @return 1 if the stack is empty, 0 otherwise.
+ * @return 1 if there is nothing to undo, 0 otherwise.
  */
 int stack_isEmpty(Stack *stack) {
-    return !stack || !stack->top;
+    return !stack || stack->size == 0;
 }
 
 /**
- * @brief Returns the number of tasks in the stack.
+ * @brief Returns the number of records that can be undone.
  *
  * @param stack Pointer to the stack.
- * @return Number of tasks in the stack.
+ * @return Number of undo records in the stack.
  */
 int stack_getSize(Stack *stack) {
     return stack ? stack->size : 0;
 }
 
 /**
- * @brief Clears all tasks from the stack.
+ * @brief Returns the number of records that can be redone.
+ *
+ * @param stack Pointer to the stack.
+ * @return Number of redo records in the stack.
+ */
+int stack_getRedoSize(Stack *stack) {
+    return stack ? stack->redo : 0;
+}
+
+/**
+ * @brief Returns a short name for an operation type ("add", "remove", "update").
+ *
+ * @param type The OpType value.
+ * @return Static string describing the operation.
+ */
+const char* stack_opName(int type) {
+    switch (type) {
+        case OP_ADD: return "add";
+        case OP_REMOVE: return "remove";
+        case OP_UPDATE: return "update";
+        case OP_RESCHEDULE: return "reschedule";
+        default: return "unknown";
+    }
+}
+
+/**
+ * @brief Swaps the records of two stacks, keeping each one's eviction handler.
+ *
+ * @param a Pointer to the first stack.
+ * @param b Pointer to the second stack.
+ */
+void stack_exchange(Stack *a, Stack *b) {
+    Stack held = *a;
+    StackEvictFn a_evict = a->on_evict;
+    *a = *b;
+    a->on_evict = a_evict;
+    b->slots = held.slots;
+    b->allocated = held.allocated;
+    b->capacity = held.capacity;
+    b->top = held.top;
+    b->size = held.size;
+    b->redo = held.redo;
+    b->open = held.open;
+    b->dropping = held.dropping;
+    b->reserved = held.reserved;
+}
+
+/**
+ * @brief Returns the memory held by the stack: its ring buffer and the tasks its records own.
+ *
+ * Only the live records (undo and redo) can own a task; the other slots are cleared.
+ *
+ * @param stack Pointer to the stack.
+ * @return Size in bytes.
+ */
+size_t stack_memoryUsage(Stack *stack) {
+    if (!stack) return 0;
+    size_t bytes = sizeof(Stack) + (size_t)stack->allocated * sizeof(StackNode);
+    for (int i = 0; i < stack->size; i++) {
+        if (stack->slots[stack_wrapBack(stack, stack->top, i + 1)].task) bytes += sizeof(Task);
+    }
+    for (int i = 0; i < stack->redo; i++) {
+        if (stack->slots[(stack->top + i) % stack->allocated].task) bytes += sizeof(Task);
+    }
+    return bytes;
+}
+
+/**
+ * @brief Clears all records from the stack.
  *
- * Frees all tasks and nodes in the stack, resetting it to empty.
+ * Frees all owned tasks (passing them to the eviction handler first), resetting both
+ * the undo and redo sides. The ring buffer is kept.
  *
  * @param stack Pointer to the stack.
  */
 void stack_clear(Stack *stack) {
-    while (!stack_isEmpty(stack)) {
-        TaskPosition pos;
-        int target_id;
-        Task *task = stack_pop(stack, &pos, &target_id);
-        free(task);
+    if (!stack) return;
+    long long start = metrics_begin(METRIC_STACK_CLEAR);
+    metrics_count(METRIC_STACK_CLEAR, stack->size + stack->redo, 0);
+    stack_discardRedo(stack);
+    while (stack->size > 0) {
+        stack->top = stack_wrapBack(stack, stack->top, 1);
+        stack->size--;
+        StackNode *node = &stack->slots[stack->top];
+        stack_release(stack, node->task);
+        node->task = NULL;
     }
+    stack->redo = 0;
+    stack->top = 0;
+    stack->open = 0;
+    stack->dropping = 0;
+    stack->reserved = 0;
+    if (stack->allocated > stack->capacity) stack_resize(stack, stack->capacity);
+    metrics_end(METRIC_STACK_CLEAR, start);
 }
 
 /**
  * @brief Frees the stack and all its tasks.
  *
- * Clears all tasks and frees the stack structure itself.
+ * Clears all records and frees the ring buffer and the stack structure itself.
+ * The eviction handler is not called.
  *
  * @param stack Pointer to the stack.
  */
 void stack_free(Stack *stack) {
+    if (!stack) return;
+    stack->on_evict = NULL;
     stack_clear(stack);
-    free(stack);
+    mem_free(MEM_STACK, stack->slots, (size_t)stack->allocated * sizeof(StackNode));
+    mem_free(MEM_STACK, stack, sizeof(Stack));
 }
@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <string.h>
+#include "stats.h"
+
+static TaskStats stats;
+
+/**
+ * @brief Maps a priority to its array index.
+ *
+ * @param priority The priority to map.
+ * @return Index in [0, 2], or -1 if the value is out of range.
+ */
+static int priorityIndex(Priority priority) {
+    if (priority < PRIORITY_HIGH || priority > PRIORITY_LOW) return -1;
+    return priority - PRIORITY_HIGH;
+}
+
+/**
+ * @brief Maps a status to its array index.
+ *
+ * @param status The status to map.
+ * @return Index in [0, 2], or -1 if the value is out of range.
+ */
+static int statusIndex(Status status) {
+    if (status < STATUS_NOT_STARTED || status > STATUS_FINISHED) return -1;
+    return status - STATUS_NOT_STARTED;
+}
+
+/**
+ * @brief Adds delta to every bucket a (priority, status) pair belongs to.
+ *
+ * Out-of-range values (e.g. from a corrupted file) are only counted in the total.
+ *
+ * @param priority The task priority.
+ * @param status The task status.
+ * @param delta +1 or -1.
+ */
+static void stats_apply(Priority priority, Status status, int delta) {
+    int p = priorityIndex(priority);
+    int s = statusIndex(status);
+    if (p >= 0) stats.by_priority[p] += delta;
+    if (s >= 0) stats.by_status[s] += delta;
+    if (p >= 0 && s >= 0) stats.by_pair[p][s] += delta;
+}
+
+/**
+ * @brief Accounts for a task that has just been inserted into the list.
+ *
+ * @param task Pointer to the inserted Task.
+ */
+void stats_onAdd(const Task *task) {
+    if (!task) return;
+    stats.total++;
+    stats_apply(task->priority, task->status, 1);
+}
+
+/**
+ * @brief Accounts for a task that has just been unlinked from the list.
+ *
+ * @param task Pointer to the removed Task.
+ */
+void stats_onRemove(const Task *task) {
+    if (!task) return;
+    if (stats.total > 0) stats.total--;
+    stats_apply(task->priority, task->status, -1);
+}
+
+/**
+ * @brief Accounts for a priority and/or status change on a task in the list.
+ *
+ * @param old_priority Priority before the change.
+ * @param old_status Status before the change.
+ * @param task Pointer to the Task holding the new values.
+ */
+void stats_onUpdate(Priority old_priority, Status old_status, const Task *task) {
+    if (!task) return;
+    stats_apply(old_priority, old_status, -1);
+    stats_apply(task->priority, task->status, 1);
+}
+
+/**
+ * @brief Resets all aggregates to zero (used when the list is cleared).
+ */
+void stats_reset() {
+    memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * @brief Returns the number of tasks with the given priority.
+ *
+ * @param priority The priority to query.
+ * @return Number of tasks, or 0 for an invalid priority.
+ */
+int stats_countByPriority(Priority priority) {
+    int p = priorityIndex(priority);
+    return p >= 0 ? stats.by_priority[p] : 0;
+}
+
+/**
+ * @brief Returns the number of tasks with the given status.
+ *
+ * @param status The status to query.
+ * @return Number of tasks, or 0 for an invalid status.
+ */
+int stats_countByStatus(Status status) {
+    int s = statusIndex(status);
+    return s >= 0 ? stats.by_status[s] : 0;
+}
+
+/**
+ * @brief Returns the number of tasks with the given priority and status.
+ *
+ * @param priority The priority to query.
+ * @param status The status to query.
+ * @return Number of tasks, or 0 for invalid values.
+ */
+int stats_countByPair(Priority priority, Status status) {
+    int p = priorityIndex(priority);
+    int s = statusIndex(status);
+    return (p >= 0 && s >= 0) ? stats.by_pair[p][s] : 0;
+}
+
+/**
+ * @brief Returns the fraction of tasks that are finished.
+ *
+ * @return Value in [0, 1], or 0 if the list is empty.
+ */
+double stats_finishedRatio() {
+    if (stats.total == 0) return 0.0;
+    return (double)stats_countByStatus(STATUS_FINISHED) / stats.total;
+}
+
+/**
+ * @brief Copies the current aggregates into a caller-provided snapshot.
+ *
+ * @param out Pointer to the TaskStats to fill.
+ */
+void stats_get(TaskStats *out) {
+    if (!out) return;
+    *out = stats;
+}
+
+/**
+ * @brief Prints the aggregates as a priority/status table.
+ */
+void stats_print() {
+    static const char *priority_names[3] = { "HIGH", "MEDIUM", "LOW" };
+
+    printf("\n> Task Statistics\n");
+    printf("---------------------------------------------------------------\n");
+    printf("  %-10s %12s %12s %12s %8s\n", "Priority", "Not Started", "In Progress", "Finished", "Total");
+    for (int p = 0; p < 3; p++) {
+        printf("  %-10s %12d %12d %12d %8d\n", priority_names[p],
+               stats.by_pair[p][0], stats.by_pair[p][1], stats.by_pair[p][2], stats.by_priority[p]);
+    }
+    printf("  %-10s %12d %12d %12d %8d\n", "Total",
+           stats.by_status[0], stats.by_status[1], stats.by_status[2], stats.total);
+    printf("---------------------------------------------------------------\n");
+    printf("  Finished ratio: %.1f%%\n\n", stats_finishedRatio() * 100.0);
+}
@@ -0,0 +1,264 @@
+#include <stdlib.h>
+#include <string.h>
+#include "store.h"
+#include "desc.h"
+#include "mem.h"
+
+/**
+ * @brief Creates an empty store.
+ *
+ * @param undo_depth Number of operations kept for undo.
+ * @return Pointer to the new store, or NULL if allocation fails.
+ */
+TaskStore* store_create(int undo_depth) {
+    TaskStore *store = mem_calloc(MEM_LIST, 1, sizeof(TaskStore));
+    if (!store) return NULL;
+
+    store->stack = stack_create(undo_depth);
+    store->id_tree = tree_create(KEY_ID);
+    store->priority_tree = tree_create(KEY_PRIORITY);
+    store->status_tree = tree_create(KEY_STATUS);
+    store->lock = rwlock_create();
+    if (!store->stack || !store->id_tree || !store->priority_tree || !store->status_tree || !store->lock) {
+        store_free(store);
+        return NULL;
+    }
+    stack_setEvictHandler(store->stack, list_evictTask);
+    return store;
+}
+
+/**
+ * @brief Frees the store and every task in it.
+ *
+ * No other thread may be using the store.
+ *
+ * @param store Pointer to the store (may be NULL).
+ */
+void store_free(TaskStore *store) {
+    if (!store) return;
+    list_destroy(store->head);
+    stack_free(store->stack);
+    tree_free(store->id_tree);
+    tree_free(store->priority_tree);
+    tree_free(store->status_tree);
+    rwlock_free(store->lock);
+    mem_free(MEM_LIST, store, sizeof(TaskStore));
+}
+
+/**
+ * @brief Adds a copy of a task, description included.
+ *
+ * The copy is allocated before the write lock is taken, so writers hold it only
+ * for the link itself.
+ *
+ * @param store Pointer to the store.
+ * @param task The task to copy.
+ * @param position Where to insert it.
+ * @param target_id ID of the task to insert after (for POS_MIDDLE).
+ * @return LIST_OK, LIST_DUPLICATE_ID, LIST_NOT_FOUND (no such target) or LIST_NO_MEMORY.
+ */
+ListStatus store_add(TaskStore *store, const Task *task, TaskPosition position, int target_id) {
+    Task *copy = mem_alloc(MEM_TASK, sizeof(Task));
+    if (!copy) return LIST_NO_MEMORY;
+    *copy = *task;
+    if (!desc_copy(task->description, &copy->description)) {
+        mem_free(MEM_TASK, copy, sizeof(Task));
+        return LIST_NO_MEMORY;
+    }
+
+    rwlock_writeLock(store->lock);
+    ListStatus status = list_insertTask(&store->head, copy, position, target_id, store->stack,
+                                        store->id_tree, store->priority_tree, store->status_tree);
+    rwlock_writeUnlock(store->lock);
+
+    if (status != LIST_OK) task_free(copy);
+    return status;
+}
+
+/**
+ * @brief Removes the task with a given ID.
+ *
+ * @param store Pointer to the store.
+ * @param id The ID of the task to remove.
+ * @return LIST_OK or LIST_NOT_FOUND.
+ */
+ListStatus store_remove(TaskStore *store, int id) {
+    rwlock_writeLock(store->lock);
+    ListStatus status = list_removeTask(&store->head, id, store->stack,
+                                        store->id_tree, store->priority_tree, store->status_tree);
+    rwlock_writeUnlock(store->lock);
+    return status;
+}
+
+/**
+ * @brief Sets the priority and status of a task.
+ *
+ * @param store Pointer to the store.
+ * @param id The ID of the task to update.
+ * @param priority The new priority.
+ * @param status The new status.
+ * @return LIST_OK or LIST_NOT_FOUND.
+ */
+ListStatus store_update(TaskStore *store, int id, Priority priority, Status status) {
+    rwlock_writeLock(store->lock);
+    ListStatus result = list_setTaskFields(store->head, id, priority, status, store->stack,
+                                           store->priority_tree, store->status_tree);
+    rwlock_writeUnlock(store->lock);
+    return result;
+}
+
+/**
+ * @brief Undoes the last operation.
+ *
+ * @param store Pointer to the store.
+ * @return LIST_OK, LIST_EMPTY (nothing to undo) or another ListStatus on failure.
+ */
+ListStatus store_undo(TaskStore *store) {
+    rwlock_writeLock(store->lock);
+    ListStatus status = list_undoStep(&store->head, store->stack,
+                                      store->id_tree, store->priority_tree, store->status_tree);
+    rwlock_writeUnlock(store->lock);
+    return status;
+}
+
+/**
+ * @brief Redoes the last undone operation.
+ *
+ * @param store Pointer to the store.
+ * @return LIST_OK, LIST_EMPTY (nothing to redo) or another ListStatus on failure.
+ */
+ListStatus store_redo(TaskStore *store) {
+    rwlock_writeLock(store->lock);
+    ListStatus status = list_redoStep(&store->head, store->stack,
+                                      store->id_tree, store->priority_tree, store->status_tree);
+    rwlock_writeUnlock(store->lock);
+    return status;
+}
+
+/**
+ * @brief Removes every task as one undo step.
+ *
+ * @param store Pointer to the store.
+ */
+void store_clear(TaskStore *store) {
+    rwlock_writeLock(store->lock);
+    list_clear(&store->head, store->stack, store->id_tree, store->priority_tree, store->status_tree);
+    rwlock_writeUnlock(store->lock);
+}
+
+/**
+ * @brief Copies the task with a given ID, description included.
+ *
+ * The handle would not outlive the lock: the stored description may be freed and
+ * its entry reused as soon as a writer gets in.
+ *
+ * @param store Pointer to the store.
+ * @param id The ID to look for.
+ * @param out Filled with a copy of the task (its description handle DESC_NONE).
+ * @param description Buffer receiving the description (may be NULL to skip it).
+ * @param size Size of the buffer.
+ * @return LIST_OK or LIST_NOT_FOUND.
+ */
+ListStatus store_get(TaskStore *store, int id, Task *out, char *description, size_t size) {
+    rwlock_readLock(store->lock);
+    Task *task = list_findTask(store->head, id);
+    if (task) {
+        *out = *task;
+        if (description && size > 0) desc_get(task->description, description, size);
+        out->description = DESC_NONE;
+    }
+    rwlock_readUnlock(store->lock);
+    return task ? LIST_OK : LIST_NOT_FOUND;
+}
+
+/**
+ * @brief Returns the number of tasks.
+ *
+ * @param store Pointer to the store.
+ * @return The task count.
+ */
+int store_count(TaskStore *store) {
+    rwlock_readLock(store->lock);
+    int count = listCounter_get();
+    rwlock_readUnlock(store->lock);
+    return count;
+}
+
+/**
+ * @brief Copies the aggregate statistics.
+ *
+ * @param store Pointer to the store.
+ * @param out Filled with the statistics.
+ */
+void store_stats(TaskStore *store, TaskStats *out) {
+    rwlock_readLock(store->lock);
+    stats_get(out);
+    rwlock_readUnlock(store->lock);
+}
+
+/**
+ * @brief Visits the tasks in list order under one read lock.
+ *
+ * @param store Pointer to the store.
+ * @param visit Callback invoked for each task until it returns 0.
+ * @param context Opaque pointer passed to the callback.
+ * @return Number of tasks visited.
+ */
+long store_scan(TaskStore *store, StoreVisitFn visit, void *context) {
+    long count = 0;
+    rwlock_readLock(store->lock);
+    for (List *current = store->head; current != NULL; current = current->next) {
+        count++;
+        if (!visit(current->task, context)) break;
+    }
+    rwlock_readUnlock(store->lock);
+    return count;
+}
+
+/**
+ * @brief Takes the read lock with the BSTs up to date.
+ *
+ * Stale BSTs are rebuilt under the write lock, and the check is repeated after
+ * switching back to the read lock since a writer may have run in between.
+ *
+ * @param store Pointer to the store.
+ */
+static void store_readLockIndexed(TaskStore *store) {
+    rwlock_readLock(store->lock);
+    while (list_indexesStale()) {
+        rwlock_readUnlock(store->lock);
+        rwlock_writeLock(store->lock);
+        list_syncIndexes(store->head, store->id_tree, store->priority_tree, store->status_tree);
+        rwlock_writeUnlock(store->lock);
+        rwlock_readLock(store->lock);
+    }
+}
+
+/**
+ * @brief Visits up to limit tasks in the order of a BST, under one read lock.
+ *
+ * If the BSTs are stale (e.g. after a deferred load), they are rebuilt first under
+ * the write lock.
+ *
+ * @param store Pointer to the store.
+ * @param key Order to visit the tasks in.
+ * @param from_id ID of the first task to visit; if no task has it, the scan starts at the first task.
+ * @param limit Maximum number of tasks to visit.
+ * @param visit Callback invoked for each task until it returns 0.
+ * @param context Opaque pointer passed to the callback.
+ * @return Number of tasks visited.
+ */
+long store_scanSorted(TaskStore *store, SortKey key, int from_id, long limit, StoreVisitFn visit, void *context) {
+    Tree *tree = key == KEY_PRIORITY ? store->priority_tree : key == KEY_STATUS ? store->status_tree : store->id_tree;
+    long count = 0;
+
+    store_readLockIndexed(store);
+    Task *task = list_findTask(store->head, from_id);
+    if (!task) task = tree_first(tree);
+    for (; task && count < limit; task = tree_next(tree, task)) {
+        count++;
+        if (!visit(task, context)) break;
+    }
+    rwlock_readUnlock(store->lock);
+    return count;
+}
@@ -0,0 +1,847 @@
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "tags.h"
+#include "bitmap.h"
+#include "idmap.h"
+#include "mem.h"
+#include "span.h"
+
+/**
+ * @brief A name of the tag dictionary.
+ */
+typedef struct TagEntry {
+    char name[TAG_NAME_MAX + 1];
+    Bitmap slots;             // Slots of the tasks carrying the tag, in the list or not
+} TagEntry;
+
+/**
+ * @brief A task holding a slot: in the list, carrying tags, or both.
+ */
+typedef struct TagSlot {
+    int id;                   // Task ID
+    int tags;                 // Number of tags the task carries
+    unsigned char present;    // The task is in the list
+} TagSlot;
+
+static TagEntry *tags_entries = NULL;
+static int tags_entryCount = 0;
+static int tags_entryCapacity = 0;
+static int *tags_table = NULL;       // Name hash -> entry + 1 (0 for an empty bucket)
+static int tags_tableSize = 0;       // Number of buckets (power of two)
+static TagSlot *tags_slots = NULL;
+static int tags_slotCount = 0;       // Slots handed out so far, free or not
+static int tags_slotCapacity = 0;
+static int *tags_freeSlots = NULL;   // Released slots, reused first
+static int tags_freeCount = 0;
+static IdMap tags_index;             // Task ID -> slot
+static Bitmap tags_present;          // Slots of the tasks in the list
+static Bitmap tags_byPriority[3];    // Slots of the tasks in the list per priority
+static Bitmap tags_byStatus[3];      // Slots of the tasks in the list per status
+static const Bitmap tags_none;       // Matches nothing (unknown tags)
+
+/**
+ * @brief Returns a short description of a status code.
+ *
+ * @param status The status code.
+ * @return Static string describing the status.
+ */
+const char* tags_statusName(TagsStatus status) {
+    switch (status) {
+        case TAGS_OK: return "ok";
+        case TAGS_BAD_NAME: return "tag names are 1-31 letters, digits, '-', '_', '.' or '/'";
+        case TAGS_NO_TAG: return "task does not have that tag";
+        case TAGS_SYNTAX: return "syntax error";
+        case TAGS_NO_MEMORY: return "out of memory";
+        default: return "unknown error";
+    }
+}
+
+/**
+ * @brief Checks that a name is a valid tag name.
+ *
+ * @param name The name.
+ * @return 1 if valid, 0 otherwise.
+ */
+static int tags_validName(const char *name) {
+    size_t length = 0;
+    for (; name[length]; length++) {
+        unsigned char c = (unsigned char)name[length];
+        if (!isalnum(c) && c != '-' && c != '_' && c != '.' && c != '/') return 0;
+    }
+    return length > 0 && length <= TAG_NAME_MAX;
+}
+
+/**
+ * @brief Hashes a tag name (FNV-1a).
+ *
+ * @param name The name.
+ * @return Hash value.
+ */
+static unsigned int tags_hash(const char *name) {
+    unsigned int h = 2166136261u;
+    while (*name) {
+        h ^= (unsigned char)*name++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief Looks up a name in the dictionary.
+ *
+ * @param name The name.
+ * @return Entry index, or -1 if the name is not in the dictionary.
+ */
+static int tags_lookup(const char *name) {
+    if (tags_tableSize == 0) return -1;
+    unsigned int bucket = tags_hash(name) & (tags_tableSize - 1);
+    while (tags_table[bucket]) {
+        int entry = tags_table[bucket] - 1;
+        if (strcmp(tags_entries[entry].name, name) == 0) return entry;
+        bucket = (bucket + 1) & (tags_tableSize - 1);
+    }
+    return -1;
+}
+
+/**
+ * @brief Returns the dictionary entry of a name, adding it if needed.
+ *
+ * @param name A valid tag name.
+ * @return Entry index, or -1 on allocation failure.
+ */
+static int tags_intern(const char *name) {
+    int entry = tags_lookup(name);
+    if (entry >= 0) return entry;
+
+    if ((tags_entryCount + 1) * 2 > tags_tableSize) {
+        int size = tags_tableSize ? tags_tableSize * 2 : 64;
+        int *table = mem_calloc(MEM_TAGS, size, sizeof(int));
+        if (!table) return -1;
+        for (int i = 0; i < tags_entryCount; i++) {
+            unsigned int bucket = tags_hash(tags_entries[i].name) & (size - 1);
+            while (table[bucket]) bucket = (bucket + 1) & (size - 1);
+            table[bucket] = i + 1;
+        }
+        mem_free(MEM_TAGS, tags_table, (size_t)tags_tableSize * sizeof(int));
+        tags_table = table;
+        tags_tableSize = size;
+    }
+    if (tags_entryCount == tags_entryCapacity) {
+        int capacity = tags_entryCapacity ? tags_entryCapacity * 2 : 16;
+        TagEntry *entries = mem_realloc(MEM_TAGS, tags_entries, (size_t)tags_entryCapacity * sizeof(TagEntry),
+                                        capacity * sizeof(TagEntry));
+        if (!entries) return -1;
+        tags_entries = entries;
+        tags_entryCapacity = capacity;
+    }
+
+    entry = tags_entryCount++;
+    strcpy(tags_entries[entry].name, name);
+    bitmap_init(&tags_entries[entry].slots);
+    unsigned int bucket = tags_hash(name) & (tags_tableSize - 1);
+    while (tags_table[bucket]) bucket = (bucket + 1) & (tags_tableSize - 1);
+    tags_table[bucket] = entry + 1;
+    return entry;
+}
+
+/**
+ * @brief Looks up the slot of a task ID.
+ *
+ * @param id The task ID.
+ * @return Slot, or -1 if the task holds none.
+ */
+static int tags_slotOf(int id) {
+    long long value;
+    return idmap_get(&tags_index, id, &value) ? (int)value : -1;
+}
+
+/**
+ * @brief Gives a task ID a slot, reusing a released one if there is any.
+ *
+ * @param id The task ID (holding no slot).
+ * @return Slot, or -1 on allocation failure.
+ */
+static int tags_newSlot(int id) {
+    int slot;
+    if (tags_freeCount > 0) {
+        slot = tags_freeSlots[--tags_freeCount];
+    } else {
+        if (tags_slotCount == tags_slotCapacity) {
+            int capacity = tags_slotCapacity ? tags_slotCapacity * 2 : 1024;
+            TagSlot *slots = mem_realloc(MEM_TAGS, tags_slots, (size_t)tags_slotCapacity * sizeof(TagSlot),
+                                         capacity * sizeof(TagSlot));
+            if (!slots) return -1;
+            tags_slots = slots;
+            int *free_slots = mem_realloc(MEM_TAGS, tags_freeSlots, (size_t)tags_slotCapacity * sizeof(int),
+                                          capacity * sizeof(int));
+            if (!free_slots) return -1;
+            tags_freeSlots = free_slots;
+            tags_slotCapacity = capacity;
+        }
+        slot = tags_slotCount;
+    }
+    if (!idmap_put(&tags_index, id, slot)) {
+        if (slot < tags_slotCount) tags_freeCount++;
+        return -1;
+    }
+    if (slot == tags_slotCount) tags_slotCount++;
+    tags_slots[slot].id = id;
+    tags_slots[slot].tags = 0;
+    tags_slots[slot].present = 0;
+    return slot;
+}
+
+/**
+ * @brief Releases a slot once its task is out of the list and carries no tag.
+ *
+ * A released slot is in no bitmap, so it can be handed to another task as is.
+ *
+ * @param slot The slot.
+ */
+static void tags_release(int slot) {
+    if (tags_slots[slot].present || tags_slots[slot].tags > 0) return;
+    idmap_remove(&tags_index, tags_slots[slot].id);
+    tags_freeSlots[tags_freeCount++] = slot;
+}
+
+/**
+ * @brief Checks that a task's priority and status index the per-value bitmaps.
+ *
+ * @param priority The priority.
+ * @param status The status.
+ * @return 1 if both are in range.
+ */
+static int tags_validFields(Priority priority, Status status) {
+    return priority >= PRIORITY_HIGH && priority <= PRIORITY_LOW &&
+           status >= STATUS_NOT_STARTED && status <= STATUS_FINISHED;
+}
+
+/**
+ * @brief Puts a tag on a task, adding the name to the dictionary if it is new.
+ *
+ * Names are 1 to TAG_NAME_MAX letters, digits and the characters - _ . / and
+ * are case-sensitive.
+ *
+ * @param task Pointer to the task (in the list).
+ * @param name The tag name.
+ * @return TAGS_OK (also if the task already had the tag), TAGS_BAD_NAME or TAGS_NO_MEMORY.
+ */
+TagsStatus tags_add(const Task *task, const char *name) {
+    if (!tags_validName(name)) return TAGS_BAD_NAME;
+    int entry = tags_intern(name);
+    if (entry < 0) return TAGS_NO_MEMORY;
+    int slot = tags_slotOf(task->id);
+    if (slot < 0 && (slot = tags_newSlot(task->id)) < 0) return TAGS_NO_MEMORY;
+
+    Bitmap *slots = &tags_entries[entry].slots;
+    if (bitmap_contains(slots, (uint32_t)slot)) return TAGS_OK;
+    if (!bitmap_add(slots, (uint32_t)slot)) {
+        tags_release(slot);
+        return TAGS_NO_MEMORY;
+    }
+    tags_slots[slot].tags++;
+    return TAGS_OK;
+}
+
+/**
+ * @brief Takes a tag off a task.
+ *
+ * @param id ID of the task.
+ * @param name The tag name.
+ * @return TAGS_OK, or TAGS_NO_TAG if the task does not carry the tag.
+ */
+TagsStatus tags_remove(int id, const char *name) {
+    int entry = tags_lookup(name);
+    int slot = tags_slotOf(id);
+    if (entry < 0 || slot < 0 || !bitmap_contains(&tags_entries[entry].slots, (uint32_t)slot))
+        return TAGS_NO_TAG;
+
+    bitmap_remove(&tags_entries[entry].slots, (uint32_t)slot);
+    tags_slots[slot].tags--;
+    tags_release(slot);
+    return TAGS_OK;
+}
+
+/**
+ * @brief Takes every tag off a task.
+ *
+ * @param id ID of the task.
+ */
+void tags_removeAll(int id) {
+    int slot = tags_slotOf(id);
+    if (slot < 0 || tags_slots[slot].tags == 0) return;
+    for (int i = 0; i < tags_entryCount && tags_slots[slot].tags > 0; i++) {
+        if (!bitmap_contains(&tags_entries[i].slots, (uint32_t)slot)) continue;
+        bitmap_remove(&tags_entries[i].slots, (uint32_t)slot);
+        tags_slots[slot].tags--;
+    }
+    tags_release(slot);
+}
+
+/**
+ * @brief Lists the tags of a task, in dictionary order.
+ *
+ * @param id ID of the task.
+ * @param names Array receiving up to max names (static strings owned by the dictionary).
+ * @param max Capacity of names.
+ * @return Number of tags of the task (may exceed max).
+ */
+int tags_ofTask(int id, const char **names, int max) {
+    int slot = tags_slotOf(id);
+    if (slot < 0) return 0;
+    int found = 0;
+    for (int i = 0; i < tags_entryCount && found < tags_slots[slot].tags; i++) {
+        if (!bitmap_contains(&tags_entries[i].slots, (uint32_t)slot)) continue;
+        if (found < max) names[found] = tags_entries[i].name;
+        found++;
+    }
+    return found;
+}
+
+/**
+ * @brief Returns the number of names in the dictionary.
+ *
+ * @return Number of tag names ever used.
+ */
+int tags_nameCount() {
+    return tags_entryCount;
+}
+
+/**
+ * @brief Returns a name of the dictionary and the number of tasks in the list carrying it.
+ *
+ * @param index Position in the dictionary, from 0 to tags_nameCount() - 1.
+ * @param tasks Set to the number of tasks in the list with the tag (may be NULL).
+ * @return The name, or NULL if index is out of range.
+ */
+const char* tags_name(int index, long *tasks) {
+    if (index < 0 || index >= tags_entryCount) return NULL;
+    if (tasks) {
+        Bitmap listed;
+        bitmap_init(&listed);
+        bitmap_and(&listed, &tags_entries[index].slots, &tags_present);
+        *tasks = bitmap_cardinality(&listed);
+        bitmap_free(&listed);
+    }
+    return tags_entries[index].name;
+}
+
+/**
+ * @brief Calls a function for each tag of each task in the list.
+ *
+ * Tags are visited one after another; the tasks of a tag in slot order.
+ *
+ * @param fn Function to call.
+ * @param context Opaque pointer passed to fn.
+ * @return 1 on success, 0 on allocation failure (some tags may not have been visited).
+ */
+int tags_forEach(TagsFn fn, void *context) {
+    Bitmap listed;
+    bitmap_init(&listed);
+    int ok = 1;
+    for (int i = 0; i < tags_entryCount && ok; i++) {
+        ok = bitmap_and(&listed, &tags_entries[i].slots, &tags_present);
+        long count = bitmap_cardinality(&listed);
+        size_t size = (count + 1) * sizeof(uint32_t);
+        uint32_t *slots = mem_alloc(MEM_SCRATCH, size);
+        if (!ok || !slots) {
+            mem_free(MEM_SCRATCH, slots, size);
+            ok = 0;
+            break;
+        }
+        bitmap_values(&listed, slots, count);
+        for (long k = 0; k < count; k++) fn(tags_slots[slots[k]].id, tags_entries[i].name, context);
+        mem_free(MEM_SCRATCH, slots, size);
+    }
+    bitmap_free(&listed);
+    return ok;
+}
+
+/**
+ * @brief Kinds of query tree nodes.
+ */
+typedef enum {
+    QUERY_LEAF,
+    QUERY_AND,
+    QUERY_OR,
+    QUERY_NOT
+} QueryKind;
+
+/**
+ * @brief A node of a parsed query.
+ */
+typedef struct QueryNode {
+    QueryKind kind;
+    int left;                 // Operand (NOT) or left operand
+    int right;                // Right operand (AND, OR)
+    const Bitmap *leaf;       // Slots matched by a term
+} QueryNode;
+
+/**
+ * @brief State of the query parser.
+ */
+typedef struct Query {
+    const char *text;
+    int pos;                  // Current position in text
+    int error;                // Position of the first error, or -1
+    QueryNode *nodes;
+    int count;
+} Query;
+
+/**
+ * @brief Compares a word with a lowercase keyword, ignoring case.
+ *
+ * @param word The word.
+ * @param length Length of the word.
+ * @param keyword The keyword.
+ * @return 1 if they match.
+ */
+static int tags_isWord(const char *word, int length, const char *keyword) {
+    if ((int)strlen(keyword) != length) return 0;
+    for (int i = 0; i < length; i++) {
+        if (tolower((unsigned char)word[i]) != keyword[i]) return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Skips blanks and measures the next word.
+ *
+ * @param q Pointer to the parser state (pos moved to the start of the word).
+ * @return Length of the word; 1 for a parenthesis, 0 at the end of the text.
+ */
+static int tags_peek(Query *q) {
+    while (q->text[q->pos] == ' ' || q->text[q->pos] == '\t') q->pos++;
+    const char *start = q->text + q->pos;
+    if (*start == '(' || *start == ')') return 1;
+    int length = 0;
+    while (start[length] && start[length] != ' ' && start[length] != '\t' &&
+           start[length] != '(' && start[length] != ')')
+        length++;
+    return length;
+}
+
+/**
+ * @brief Adds a node to the query tree.
+ *
+ * @param q Pointer to the parser state.
+ * @param kind The node kind.
+ * @param left Left operand.
+ * @param right Right operand.
+ * @param leaf Slots of a term.
+ * @return Index of the node.
+ */
+static int tags_node(Query *q, QueryKind kind, int left, int right, const Bitmap *leaf) {
+    QueryNode *node = &q->nodes[q->count];
+    node->kind = kind;
+    node->left = left;
+    node->right = right;
+    node->leaf = leaf;
+    return q->count++;
+}
+
+/**
+ * @brief Resolves a term to the bitmap of its slots.
+ *
+ * @param word The term.
+ * @param length Length of the term.
+ * @return The bitmap, or NULL if the word is not a term.
+ */
+static const Bitmap* tags_term(const char *word, int length) {
+    const char *value = memchr(word, ':', length);
+    if (!value) return tags_isWord(word, length, "all") ? &tags_present : NULL;
+    int key_length = (int)(value - word);
+    int value_length = length - key_length - 1;
+    value++;
+
+    if (tags_isWord(word, key_length, "tag")) {
+        char name[TAG_NAME_MAX + 1];
+        if (value_length == 0 || value_length > TAG_NAME_MAX) return NULL;
+        memcpy(name, value, value_length);
+        name[value_length] = '\0';
+        if (!tags_validName(name)) return NULL;
+        int entry = tags_lookup(name);
+        return entry >= 0 ? &tags_entries[entry].slots : &tags_none;
+    }
+    if (tags_isWord(word, key_length, "status")) {
+        if (tags_isWord(value, value_length, "1") || tags_isWord(value, value_length, "todo") ||
+            tags_isWord(value, value_length, "not_started"))
+            return &tags_byStatus[0];
+        if (tags_isWord(value, value_length, "2") || tags_isWord(value, value_length, "doing") ||
+            tags_isWord(value, value_length, "in_progress"))
+            return &tags_byStatus[1];
+        if (tags_isWord(value, value_length, "3") || tags_isWord(value, value_length, "done") ||
+            tags_isWord(value, value_length, "finished"))
+            return &tags_byStatus[2];
+        return NULL;
+    }
+    if (tags_isWord(word, key_length, "prio") || tags_isWord(word, key_length, "priority")) {
+        if (tags_isWord(value, value_length, "1") || tags_isWord(value, value_length, "high"))
+            return &tags_byPriority[0];
+        if (tags_isWord(value, value_length, "2") || tags_isWord(value, value_length, "medium"))
+            return &tags_byPriority[1];
+        if (tags_isWord(value, value_length, "3") || tags_isWord(value, value_length, "low"))
+            return &tags_byPriority[2];
+    }
+    return NULL;
+}
+
+static int tags_parseOr(Query *q);
+
+/**
+ * @brief Parses a term, a parenthesized query or a negation.
+ *
+ * @param q Pointer to the parser state.
+ * @return Index of the node, or -1 on a syntax error.
+ */
+static int tags_parseUnary(Query *q) {
+    int length = tags_peek(q);
+    const char *word = q->text + q->pos;
+    if (length == 0 || *word == ')') {
+        q->error = q->pos;
+        return -1;
+    }
+    if (*word == '(') {
+        q->pos++;
+        int node = tags_parseOr(q);
+        if (node < 0) return -1;
+        if (tags_peek(q) != 1 || q->text[q->pos] != ')') {
+            q->error = q->pos;
+            return -1;
+        }
+        q->pos++;
+        return node;
+    }
+    if (tags_isWord(word, length, "not")) {
+        q->pos += length;
+        int operand = tags_parseUnary(q);
+        return operand < 0 ? -1 : tags_node(q, QUERY_NOT, operand, -1, NULL);
+    }
+
+    const Bitmap *leaf = tags_term(word, length);
+    if (!leaf) {
+        q->error = q->pos;
+        return -1;
+    }
+    q->pos += length;
+    return tags_node(q, QUERY_LEAF, -1, -1, leaf);
+}
+
+/**
+ * @brief Parses terms joined by AND (or by nothing).
+ *
+ * @param q Pointer to the parser state.
+ * @return Index of the node, or -1 on a syntax error.
+ */
+static int tags_parseAnd(Query *q) {
+    int left = tags_parseUnary(q);
+    while (left >= 0) {
+        int length = tags_peek(q);
+        const char *word = q->text + q->pos;
+        if (length == 0 || *word == ')' || tags_isWord(word, length, "or")) break;
+        if (tags_isWord(word, length, "and")) q->pos += length;
+        int right = tags_parseUnary(q);
+        left = right < 0 ? -1 : tags_node(q, QUERY_AND, left, right, NULL);
+    }
+    return left;
+}
+
+/**
+ * @brief Parses groups of terms joined by OR.
+ *
+ * @param q Pointer to the parser state.
+ * @return Index of the node, or -1 on a syntax error.
+ */
+static int tags_parseOr(Query *q) {
+    int left = tags_parseAnd(q);
+    while (left >= 0) {
+        int length = tags_peek(q);
+        if (!tags_isWord(q->text + q->pos, length, "or")) break;
+        q->pos += length;
+        int right = tags_parseAnd(q);
+        left = right < 0 ? -1 : tags_node(q, QUERY_OR, left, right, NULL);
+    }
+    return left;
+}
+
+/**
+ * @brief Moves the evaluated value of a node into its own bitmap, unless it is a term's.
+ *
+ * @param value Value computed by tags_eval().
+ * @param work The bitmap that may hold it.
+ * @param out Bitmap receiving it.
+ * @return value, or out if the value was held by work.
+ */
+static const Bitmap* tags_keep(const Bitmap *value, Bitmap *work, Bitmap *out) {
+    if (value != work) return value;
+    bitmap_free(out);
+    *out = *work;
+    bitmap_init(work);
+    return out;
+}
+
+/**
+ * @brief Evaluates a query node.
+ *
+ * The operands of a chain of ANDs are gathered first: the plain ones are
+ * intersected smallest first, stopping as soon as nothing is left, and the
+ * negated ones are then subtracted, so "NOT" never complements the whole list.
+ *
+ * @param q Pointer to the parsed query.
+ * @param n Index of the node.
+ * @param out Initialized bitmap that may receive the value.
+ * @param value Set to the value: out, or a term's own bitmap.
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int tags_eval(Query *q, int n, Bitmap *out, const Bitmap **value) {
+    QueryNode *node = &q->nodes[n];
+    if (node->kind == QUERY_LEAF) {
+        *value = node->leaf;
+        return 1;
+    }
+
+    if (node->kind != QUERY_AND) {
+        Bitmap left, right;
+        const Bitmap *a, *b = NULL;
+        bitmap_init(&left);
+        bitmap_init(&right);
+        int ok = tags_eval(q, node->left, &left, &a) &&
+                 (node->kind == QUERY_NOT || tags_eval(q, node->right, &right, &b));
+        if (ok) ok = node->kind == QUERY_NOT ? bitmap_andNot(out, &tags_present, a) : bitmap_or(out, a, b);
+        bitmap_free(&left);
+        bitmap_free(&right);
+        *value = out;
+        return ok;
+    }
+
+    // Gather the operands of the chain: plain ones first, negated ones from the end
+    int *operands = mem_alloc(MEM_SCRATCH, q->count * sizeof(int));
+    int *pending = mem_alloc(MEM_SCRATCH, q->count * sizeof(int));
+    Bitmap *owned = mem_alloc(MEM_SCRATCH, q->count * sizeof(Bitmap));
+    const Bitmap **values = mem_alloc(MEM_SCRATCH, q->count * sizeof(Bitmap*));
+    long *sizes = mem_alloc(MEM_SCRATCH, q->count * sizeof(long));
+    int ok = operands && pending && owned && values && sizes;
+    int plain = 0, negated = 0, top = 0;
+    if (ok) pending[top++] = n;
+    while (ok && top > 0) {
+        QueryNode *current = &q->nodes[pending[--top]];
+        if (current->kind == QUERY_AND) {
+            pending[top++] = current->right;
+            pending[top++] = current->left;
+        } else if (current->kind == QUERY_NOT) {
+            operands[q->count - 1 - negated++] = current->left;
+        } else {
+            operands[plain++] = (int)(current - q->nodes);
+        }
+    }
+    for (int i = 0; ok && i < q->count; i++) bitmap_init(&owned[i]);
+    for (int i = 0; ok && i < q->count; i++) {
+        if (i >= plain && i < q->count - negated) continue;
+        ok = tags_eval(q, operands[i], &owned[i], &values[i]);
+        sizes[i] = ok ? bitmap_cardinality(values[i]) : 0;
+    }
+
+    // Smallest first (the chains are short)
+    for (int i = 1; ok && i < plain; i++) {
+        for (int j = i; j > 0 && sizes[j] < sizes[j - 1]; j--) {
+            const Bitmap *v = values[j]; values[j] = values[j - 1]; values[j - 1] = v;
+            long s = sizes[j]; sizes[j] = sizes[j - 1]; sizes[j - 1] = s;
+        }
+    }
+
+    Bitmap work[2];
+    bitmap_init(&work[0]);
+    bitmap_init(&work[1]);
+    const Bitmap *result = plain > 0 ? values[0] : &tags_present;
+    int next = 0;
+    for (int i = 1; ok && i < plain && bitmap_cardinality(result) > 0; i++) {
+        ok = bitmap_and(&work[next], result, values[i]);
+        result = &work[next];
+        next ^= 1;
+    }
+    for (int i = q->count - negated; ok && i < q->count && bitmap_cardinality(result) > 0; i++) {
+        ok = bitmap_andNot(&work[next], result, values[i]);
+        result = &work[next];
+        next ^= 1;
+    }
+
+    // Move a value held by a scratch bitmap into out before they are freed
+    if (ok) {
+        result = tags_keep(result, &work[0], out);
+        result = tags_keep(result, &work[1], out);
+        for (int i = 0; i < q->count; i++) result = tags_keep(result, &owned[i], out);
+    }
+    *value = result;
+
+    bitmap_free(&work[0]);
+    bitmap_free(&work[1]);
+    for (int i = 0; owned && operands && i < q->count; i++) bitmap_free(&owned[i]);
+    mem_free(MEM_SCRATCH, operands, q->count * sizeof(int));
+    mem_free(MEM_SCRATCH, pending, q->count * sizeof(int));
+    mem_free(MEM_SCRATCH, owned, q->count * sizeof(Bitmap));
+    mem_free(MEM_SCRATCH, (void*)values, q->count * sizeof(Bitmap*));
+    mem_free(MEM_SCRATCH, sizes, q->count * sizeof(long));
+    return ok;
+}
+
+/**
+ * @brief Orders task IDs for qsort().
+ */
+static int tags_compareIds(const void *a, const void *b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Finds the tasks in the list matching a query.
+ *
+ * A query combines terms with AND, OR, NOT and parentheses (AND binds tighter
+ * than OR and may be left out between terms; keywords in any case). Terms are
+ * tag:NAME, status:VALUE, prio:VALUE and all. Status values are todo, doing and
+ * done (or not_started, in_progress and finished), priority values high, medium
+ * and low; both also as 1-3. A tag that is not in the dictionary matches nothing.
+ *
+ * @param query The query text.
+ * @param ids Array receiving up to max task IDs, in increasing order.
+ * @param max Capacity of ids.
+ * @param count Set to the number of matching tasks (may exceed max).
+ * @param error_at Set to the position in query where parsing failed (may be NULL).
+ * @return TAGS_OK, TAGS_SYNTAX or TAGS_NO_MEMORY.
+ */
+TagsStatus tags_select(const char *query, int *ids, int max, int *count, int *error_at) {
+    Query q = { query, 0, -1, NULL, 0 };
+    long long span = span_begin();
+    *count = 0;
+    // Every node but an implicit AND takes at least one character
+    size_t nodes_size = (2 * strlen(query) + 1) * sizeof(QueryNode);
+    q.nodes = mem_alloc(MEM_SCRATCH, nodes_size);
+    if (!q.nodes) return TAGS_NO_MEMORY;
+
+    int root = tags_parseOr(&q);
+    if (root >= 0 && tags_peek(&q) != 0) {
+        q.error = q.pos;
+        root = -1;
+    }
+    if (root < 0) {
+        if (error_at) *error_at = q.error;
+        mem_free(MEM_SCRATCH, q.nodes, nodes_size);
+        return TAGS_SYNTAX;
+    }
+
+    Bitmap value, listed;
+    const Bitmap *result;
+    bitmap_init(&value);
+    bitmap_init(&listed);
+    // Tag bitmaps also hold tasks that are out of the list
+    int ok = tags_eval(&q, root, &value, &result) && bitmap_and(&listed, result, &tags_present);
+    long total = ok ? bitmap_cardinality(&listed) : 0;
+    size_t slots_size = (total + 1) * sizeof(uint32_t);
+    uint32_t *slots = ok ? mem_alloc(MEM_SCRATCH, slots_size) : NULL;
+    if (slots) {
+        bitmap_values(&listed, slots, total);
+        // Reuse the slot array for the IDs, which are no wider
+        int *found = (int*)slots;
+        for (long i = 0; i < total; i++) found[i] = tags_slots[slots[i]].id;
+        qsort(found, total, sizeof(int), tags_compareIds);
+        for (long i = 0; i < total && i < max; i++) ids[i] = found[i];
+        *count = (int)total;
+    }
+    mem_free(MEM_SCRATCH, slots, slots_size);
+    bitmap_free(&value);
+    bitmap_free(&listed);
+    mem_free(MEM_SCRATCH, q.nodes, nodes_size);
+    span_end(span, "tags.select", total);
+    return slots ? TAGS_OK : TAGS_NO_MEMORY;
+}
+
+/**
+ * @brief Accounts for a task that has just been linked into the list.
+ *
+ * @param task Pointer to the linked Task.
+ */
+void tags_onAdd(const Task *task) {
+    int slot = tags_slotOf(task->id);
+    if (slot < 0 && (slot = tags_newSlot(task->id)) < 0) return;
+    tags_slots[slot].present = 1;
+    bitmap_add(&tags_present, (uint32_t)slot);
+    if (!tags_validFields(task->priority, task->status)) return;
+    bitmap_add(&tags_byPriority[task->priority - PRIORITY_HIGH], (uint32_t)slot);
+    bitmap_add(&tags_byStatus[task->status - STATUS_NOT_STARTED], (uint32_t)slot);
+}
+
+/**
+ * @brief Accounts for a task that has just been unlinked from the list.
+ *
+ * @param task Pointer to the unlinked Task.
+ */
+void tags_onRemove(const Task *task) {
+    int slot = tags_slotOf(task->id);
+    if (slot < 0) return;
+    bitmap_remove(&tags_present, (uint32_t)slot);
+    if (tags_validFields(task->priority, task->status)) {
+        bitmap_remove(&tags_byPriority[task->priority - PRIORITY_HIGH], (uint32_t)slot);
+        bitmap_remove(&tags_byStatus[task->status - STATUS_NOT_STARTED], (uint32_t)slot);
+    }
+    tags_slots[slot].present = 0;
+    tags_release(slot);
+}
+
+/**
+ * @brief Accounts for a priority and/or status change on a task in the list.
+ *
+ * @param old_priority Priority before the change.
+ * @param old_status Status before the change.
+ * @param task Pointer to the Task holding the new values.
+ */
+void tags_onUpdate(Priority old_priority, Status old_status, const Task *task) {
+    int slot = tags_slotOf(task->id);
+    if (slot < 0) return;
+    if (tags_validFields(old_priority, old_status)) {
+        bitmap_remove(&tags_byPriority[old_priority - PRIORITY_HIGH], (uint32_t)slot);
+        bitmap_remove(&tags_byStatus[old_status - STATUS_NOT_STARTED], (uint32_t)slot);
+    }
+    if (tags_validFields(task->priority, task->status)) {
+        bitmap_add(&tags_byPriority[task->priority - PRIORITY_HIGH], (uint32_t)slot);
+        bitmap_add(&tags_byStatus[task->status - STATUS_NOT_STARTED], (uint32_t)slot);
+    }
+}
+
+/**
+ * @brief Accounts for every task leaving the list at once (the tags are kept).
+ */
+void tags_onClear() {
+    for (int slot = 0; slot < tags_slotCount; slot++) {
+        if (!tags_slots[slot].present) continue;
+        tags_slots[slot].present = 0;
+        tags_release(slot);
+    }
+    bitmap_free(&tags_present);
+    for (int i = 0; i < 3; i++) {
+        bitmap_free(&tags_byPriority[i]);
+        bitmap_free(&tags_byStatus[i]);
+    }
+}
+
+/**
+ * @brief Drops every tag and the dictionary, and frees the bitmaps.
+ */
+void tags_reset() {
+    tags_onClear();
+    for (int i = 0; i < tags_entryCount; i++) bitmap_free(&tags_entries[i].slots);
+    mem_free(MEM_TAGS, tags_entries, (size_t)tags_entryCapacity * sizeof(TagEntry));
+    mem_free(MEM_TAGS, tags_table, (size_t)tags_tableSize * sizeof(int));
+    mem_free(MEM_TAGS, tags_slots, (size_t)tags_slotCapacity * sizeof(TagSlot));
+    mem_free(MEM_TAGS, tags_freeSlots, (size_t)tags_slotCapacity * sizeof(int));
+    idmap_free(&tags_index);
+    tags_entries = NULL;
+    tags_entryCount = 0;
+    tags_entryCapacity = 0;
+    tags_table = NULL;
+    tags_tableSize = 0;
+    tags_slots = NULL;
+    tags_slotCount = 0;
+    tags_slotCapacity = 0;
+    tags_freeSlots = NULL;
+    tags_freeCount = 0;
+}
@@ -2,72 +2,135 @@
 #include <stdlib.h>
 #include <string.h>
 #include "task.h"
-#include "input_utils.h"
+#include "render.h"
+#include "mem.h"
 
 /**
- * @brief Fills a Task structure with validated user input.
+ * @brief Prints the contents of a single Task in a formatted way.
  *
- * Uses safe input functions to avoid buffer overflow and invalid entries:
- * - readInt() for numeric inputs like ID
- * - readIntInRange() for validated enum selection (priority, status)
- * - readString() for title and description (supports spaces)
+ * Formats the whole block in the output buffer and writes it at once.
  *
- * @param task Pointer to a Task structure to populate.
+ * @param task Pointer to a Task structure to print.
  */
-void fillTask(Task *task) {
-    if (!task) return;
-
-    printf("\n> Fill the task information:\n");
-
-    // Task ID
-    task->id = readInt("  ID: ");
+void printTask(Task *task) {
+    if (!task) {
+        printf("No task to display.\n");
+        return;
+    }
 
-    // Task Title
-    readString("  Title (max 50 characters): ", task->title, sizeof(task->title));
+    render_begin(stdout);
+    render_task(task, RENDER_PLAIN, 0);
+    render_end();
+}
 
-    // Task Description
-    readString("  Description (max 200 characters): ", task->description, sizeof(task->description));
+/**
+ * @brief Returns the display name of a priority level.
+ *
+ * @param priority The priority.
+ * @return Static string ("HIGH", "MEDIUM", "LOW" or "UNKNOWN").
+ */
+const char* priorityName(Priority priority) {
+    switch (priority) {
+        case PRIORITY_HIGH:   return "HIGH";
+        case PRIORITY_MEDIUM: return "MEDIUM";
+        case PRIORITY_LOW:    return "LOW";
+        default:              return "UNKNOWN";
+    }
+}
 
-    // Task Priority using enum
-    task->priority = (Priority)readIntInRange("  Priority (1 = High, 2 = Medium, 3 = Low): ", PRIORITY_HIGH, PRIORITY_LOW);
+/**
+ * @brief Returns the display name of a status level.
+ *
+ * @param status The status.
+ * @return Static string ("Not Started", "In Progress", "Finished" or "Unknown").
+ */
+const char* statusName(Status status) {
+    switch (status) {
+        case STATUS_NOT_STARTED: return "Not Started";
+        case STATUS_IN_PROGRESS: return "In Progress";
+        case STATUS_FINISHED:    return "Finished";
+        default:                 return "Unknown";
+    }
+}
 
-    // Task Status using enum
-    task->status = (Status)readIntInRange("  Status (1 = Not Started, 2 = In Progress, 3 = Finished): ", STATUS_NOT_STARTED, STATUS_FINISHED);
+/**
+ * @brief Converts an old record to a record with no timestamps.
+ *
+ * @param record Pointer to the record to fill.
+ * @param old Pointer to the old record.
+ */
+void task_fromV1(TaskRecord *record, const TaskV1 *old) {
+    memset(record, 0, sizeof(TaskRecord));
+    record->id = old->id;
+    memcpy(record->title, old->title, sizeof(record->title));
+    memcpy(record->description, old->description, sizeof(record->description));
+    record->priority = old->priority;
+    record->status = old->status;
 }
 
 /**
- * @brief Prints the contents of a single Task in a formatted way.
+ * @brief Fills a Task from a file record, storing its description.
  *
- * Uses switch statements for enum-based fields to increase readability.
+ * Records from files are not trusted to be terminated.
  *
- * @param task Pointer to a Task structure to print.
+ * @param task Pointer to the Task to fill.
+ * @param record Pointer to the record.
+ * @return 1 on success, 0 if the description could not be stored.
  */
-void printTask(Task *task) {
-    if (!task) {
-        printf("No task to display.\n");
-        return;
-    }
+int task_fromRecord(Task *task, const TaskRecord *record) {
+    char description[sizeof(record->description)];
+    memset(task, 0, sizeof(Task));
+    task->id = record->id;
+    memcpy(task->title, record->title, sizeof(task->title));
+    task->title[sizeof(task->title) - 1] = '\0';
+    task->priority = record->priority;
+    task->status = record->status;
+    task->created = record->created;
+    task->due = record->due;
+    memcpy(description, record->description, sizeof(description));
+    description[sizeof(description) - 1] = '\0';
+    return desc_create(description, &task->description);
+}
 
-    printf("> Task Information:\n");
-    printf("  ID          : %d\n", task->id);
-    printf("  Title       : %s\n", task->title);
-    printf("  Description : %s\n", task->description);
+/**
+ * @brief Fills a file record from a Task, looking up its description.
+ *
+ * @param record Pointer to the record to fill.
+ * @param task Pointer to the Task.
+ */
+void task_toRecord(TaskRecord *record, const Task *task) {
+    memset(record, 0, sizeof(TaskRecord));
+    record->id = task->id;
+    memcpy(record->title, task->title, sizeof(record->title));
+    desc_get(task->description, record->description, sizeof(record->description));
+    record->priority = task->priority;
+    record->status = task->status;
+    record->created = task->created;
+    record->due = task->due;
+}
 
-    // Priority
-    printf("  Priority    : ");
-    switch (task->priority) {
-        case PRIORITY_HIGH:   printf("HIGH\n"); break;
-        case PRIORITY_MEDIUM: printf("MEDIUM\n"); break;
-        case PRIORITY_LOW:    printf("LOW\n"); break;
-        default:              printf("UNKNOWN\n"); break;
-    }
+/**
+ * @brief Replaces the description of a task.
+ *
+ * @param task Pointer to the Task.
+ * @param text The new description (truncated to DESC_MAX characters).
+ * @return 1 on success, 0 on allocation failure (the old description is kept).
+ */
+int task_setDescription(Task *task, const char *text) {
+    DescRef description;
+    if (!desc_create(text, &description)) return 0;
+    desc_free(task->description);
+    task->description = description;
+    return 1;
+}
 
-    // Status
-    printf("  Status      : ");
-    switch (task->status) {
-        case STATUS_NOT_STARTED: printf("Not Started\n"); break;
-        case STATUS_IN_PROGRESS: printf("In Progress\n"); break;
-        case STATUS_FINISHED:    printf("Finished\n"); break;
-        default:                 printf("Unknown\n"); break;
-    }
+/**
+ * @brief Frees a task and its description.
+ *
+ * @param task Pointer to the Task (may be NULL), allocated with mem_alloc(MEM_TASK, sizeof(Task)).
+ */
+void task_free(Task *task) {
+    if (!task) return;
+    desc_free(task->description);
+    mem_free(MEM_TASK, task, sizeof(Task));
 }
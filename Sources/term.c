@@ -0,0 +1,282 @@
+#ifndef _WIN32
+    #define _POSIX_C_SOURCE 200809L   // isatty, fileno
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "term.h"
+
+#ifdef _WIN32
+    #include <io.h>
+    #include <conio.h>
+    #include <windows.h>
+    #define term_isatty _isatty
+    #define term_fileno _fileno
+#else
+    #include <unistd.h>
+    #include <poll.h>
+    #include <termios.h>
+    #include <sys/ioctl.h>
+    #define term_isatty isatty
+    #define term_fileno fileno
+#endif
+
+#define TERM_ESCAPE_WAIT_MS 30   // Time for the rest of an escape sequence to arrive
+
+/**
+ * @brief One frame: the text of each line as it appears on screen.
+ */
+typedef struct Frame {
+    char lines[TERM_MAX_LINES][TERM_LINE_MAX];
+    int count;
+} Frame;
+
+static Frame term_frames[2];
+static Frame *term_shown = &term_frames[0];      // Frame currently on screen
+static Frame *term_next = &term_frames[1];       // Frame being built
+static int term_valid = 0;                       // 1 if term_shown is still on screen
+static int term_ansi = 0;
+#ifndef _WIN32
+static struct termios term_saved;                // Input mode restored by term_leaveFullScreen()
+#endif
+
+/**
+ * @brief Detects whether stdout is an ANSI-capable terminal.
+ *
+ * On Windows this also enables escape sequence processing on the console.
+ * Without a terminal (pipes, files, TERM=dumb) no escape sequence is ever written.
+ */
+void term_init() {
+    term_ansi = term_isatty(term_fileno(stdout));
+#ifdef _WIN32
+    if (term_ansi) {
+        HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD mode;
+        term_ansi = GetConsoleMode(console, &mode) &&
+                    SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    }
+#else
+    const char *name = getenv("TERM");
+    if (name && strcmp(name, "dumb") == 0) term_ansi = 0;
+#endif
+    term_valid = 0;
+}
+
+/**
+ * @brief Returns 1 if escape sequences are written to stdout.
+ *
+ * @return 1 for a terminal, 0 otherwise.
+ */
+int term_isInteractive() {
+    return term_ansi;
+}
+
+/**
+ * @brief Clears the screen and moves the cursor to the top-left corner.
+ *
+ * Forgets the last frame, so the next one is painted in full.
+ */
+void term_clear() {
+    term_valid = 0;
+    if (!term_ansi) return;
+    fputs("\x1b[H\x1b[2J", stdout);
+    fflush(stdout);
+}
+
+/**
+ * @brief Starts a new frame.
+ *
+ * Lines added with term_line() are kept until term_endFrame() paints them.
+ */
+void term_beginFrame() {
+    term_next->count = 0;
+}
+
+/**
+ * @brief Adds one line to the frame being built.
+ *
+ * Lines beyond TERM_MAX_LINES are ignored and long lines are truncated.
+ *
+ * @param format printf-style format of the line, without the newline.
+ */
+void term_line(const char *format, ...) {
+    if (term_next->count == TERM_MAX_LINES) return;
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(term_next->lines[term_next->count++], TERM_LINE_MAX, format, args);
+    va_end(args);
+}
+
+/**
+ * @brief Paints the frame.
+ *
+ * If the previous frame is still on screen, only the lines that changed are
+ * rewritten and anything printed below it is erased; otherwise the screen is
+ * cleared and every line is written. The cursor is left on the line after the frame.
+ */
+void term_endFrame() {
+    if (!term_ansi) {
+        for (int i = 0; i < term_next->count; i++) {
+            fputs(term_next->lines[i], stdout);
+            fputc('\n', stdout);
+        }
+    } else if (!term_valid) {
+        fputs("\x1b[H\x1b[2J", stdout);
+        for (int i = 0; i < term_next->count; i++) {
+            fputs(term_next->lines[i], stdout);
+            fputc('\n', stdout);
+        }
+    } else {
+        // Rows are 1-based; rewrite a changed row and erase what is left of the old text
+        for (int i = 0; i < term_next->count; i++) {
+            if (i < term_shown->count && strcmp(term_next->lines[i], term_shown->lines[i]) == 0) continue;
+            printf("\x1b[%d;1H%s\x1b[K", i + 1, term_next->lines[i]);
+        }
+        // Erase prompts, input and messages left below the frame
+        printf("\x1b[%d;1H\x1b[J", term_next->count + 1);
+    }
+    fflush(stdout);
+
+    Frame *shown = term_shown;
+    term_shown = term_next;
+    term_next = shown;
+    term_valid = term_ansi;
+}
+
+/**
+ * @brief Reads the size of the terminal window.
+ *
+ * @param rows Set to the number of rows (24 if unknown).
+ * @param cols Set to the number of columns (80 if unknown).
+ */
+void term_size(int *rows, int *cols) {
+    *rows = 24;
+    *cols = 80;
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+        *rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+        *cols = info.srWindow.Right - info.srWindow.Left + 1;
+    }
+#else
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0) {
+        *rows = size.ws_row;
+        *cols = size.ws_col;
+    }
+#endif
+}
+
+/**
+ * @brief Switches to the alternate screen with the cursor hidden and unbuffered, unechoed keys.
+ *
+ * Must be paired with term_leaveFullScreen().
+ */
+void term_enterFullScreen() {
+#ifndef _WIN32
+    struct termios raw;
+    tcgetattr(STDIN_FILENO, &term_saved);
+    raw = term_saved;
+    // Keys arrive one at a time, are not echoed, and Ctrl-C is read as a key
+    raw.c_lflag &= ~(ICANON | ECHO | ISIG);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+#endif
+    fputs("\x1b[?1049h\x1b[?25l", stdout);
+    term_clear();
+}
+
+/**
+ * @brief Restores the normal screen, the cursor and line-buffered input.
+ */
+void term_leaveFullScreen() {
+    fputs("\x1b[?25h\x1b[?1049l", stdout);
+    fflush(stdout);
+#ifndef _WIN32
+    tcsetattr(STDIN_FILENO, TCSANOW, &term_saved);
+#endif
+    term_valid = 0;
+}
+
+/**
+ * @brief Reads one byte of input, waiting at most a given time.
+ *
+ * @param timeout_ms Maximum wait in milliseconds (negative to wait forever).
+ * @return The byte, or -1 on timeout or end of input.
+ */
+static int term_readByte(int timeout_ms) {
+#ifdef _WIN32
+    while (!_kbhit()) {
+        if (timeout_ms == 0) return -1;
+        Sleep(1);
+        if (timeout_ms > 0) timeout_ms--;
+    }
+    return _getch();
+#else
+    struct pollfd input = { STDIN_FILENO, POLLIN, 0 };
+    unsigned char byte;
+    if (poll(&input, 1, timeout_ms) <= 0) return -1;
+    if (read(STDIN_FILENO, &byte, 1) != 1) return -1;
+    return byte;
+#endif
+}
+
+/**
+ * @brief Waits for one key press in full-screen mode.
+ *
+ * Arrow, page and Home/End keys are decoded from their escape sequences.
+ *
+ * @param timeout_ms Maximum wait in milliseconds (0 to poll, negative to wait forever).
+ * @return The character, a TermKey value, or TERM_KEY_NONE on timeout.
+ */
+int term_readKey(int timeout_ms) {
+    int c = term_readByte(timeout_ms);
+    if (c < 0) return TERM_KEY_NONE;
+
+#ifdef _WIN32
+    // Extended keys come as a 0 or 0xE0 prefix followed by a scan code
+    if (c == 0 || c == 0xE0) {
+        switch (_getch()) {
+            case 72: return TERM_KEY_UP;
+            case 80: return TERM_KEY_DOWN;
+            case 73: return TERM_KEY_PAGE_UP;
+            case 81: return TERM_KEY_PAGE_DOWN;
+            case 71: return TERM_KEY_HOME;
+            case 79: return TERM_KEY_END;
+            default: return TERM_KEY_NONE;
+        }
+    }
+    return c;
+#else
+    if (c != TERM_KEY_ESCAPE) return c;
+
+    // ESC [ A, ESC O H, ESC [ 5 ~ ...; a lone ESC is the Escape key
+    int kind = term_readByte(TERM_ESCAPE_WAIT_MS);
+    if (kind != '[' && kind != 'O') return TERM_KEY_ESCAPE;
+
+    int code = term_readByte(TERM_ESCAPE_WAIT_MS);
+    switch (code) {
+        case 'A': return TERM_KEY_UP;
+        case 'B': return TERM_KEY_DOWN;
+        case 'H': return TERM_KEY_HOME;
+        case 'F': return TERM_KEY_END;
+        default: break;
+    }
+    if (code < '0' || code > '9') return TERM_KEY_NONE;
+
+    int number = code - '0';
+    while ((c = term_readByte(TERM_ESCAPE_WAIT_MS)) >= '0' && c <= '9') number = number * 10 + c - '0';
+    if (c != '~') return TERM_KEY_NONE;
+    switch (number) {
+        case 1: case 7: return TERM_KEY_HOME;
+        case 4: case 8: return TERM_KEY_END;
+        case 5: return TERM_KEY_PAGE_UP;
+        case 6: return TERM_KEY_PAGE_DOWN;
+        default: return TERM_KEY_NONE;
+    }
+#endif
+}
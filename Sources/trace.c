@@ -0,0 +1,374 @@
+#ifndef _WIN32
+    #define _POSIX_C_SOURCE 200809L   // clock_gettime, nanosleep
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include "trace.h"
+#include "batch.h"
+#include "list.h"
+#include "metrics.h"
+#include "mem.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define TRACE_NULL_DEVICE "NUL"
+#else
+    #define TRACE_NULL_DEVICE "/dev/null"
+#endif
+
+#define TRACE_VERSION 1
+#define TRACE_LINE_MAX (BATCH_LINE_MAX + 64)   // A command line with its timing
+
+static FILE *trace_file = NULL;
+static char trace_buffer[1 << 16];
+static long long trace_last = 0;          // Start of the last operation recorded, as written
+
+/**
+ * @brief Returns a monotonic clock for timing operations.
+ *
+ * @return The time in nanoseconds since an arbitrary point.
+ */
+long long trace_clock() {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER now;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+    return (long long)((double)now.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Waits for a number of nanoseconds.
+ *
+ * @param nanoseconds Time to wait.
+ */
+static void trace_sleep(long long nanoseconds) {
+#ifdef _WIN32
+    Sleep((DWORD)(nanoseconds / 1000000));
+#else
+    struct timespec delay = { (time_t)(nanoseconds / 1000000000LL), (long)(nanoseconds % 1000000000LL) };
+    nanosleep(&delay, NULL);
+#endif
+}
+
+/**
+ * @brief Starts recording operations to a trace file, replacing it.
+ *
+ * @param path Path of the file.
+ * @param mode Where the operations come from: "interactive", "batch" or "daemon".
+ * @return 1 on success, 0 if the file could not be created.
+ */
+int trace_open(const char *path, const char *mode) {
+    trace_close();
+    trace_file = fopen(path, "w");
+    if (!trace_file) return 0;
+    setvbuf(trace_file, trace_buffer, _IOFBF, sizeof(trace_buffer));
+    fprintf(trace_file, "# taskmgr trace %d %s\n", TRACE_VERSION, mode);
+    trace_last = trace_clock();
+    return 1;
+}
+
+/**
+ * @brief Stops recording and closes the trace file.
+ */
+void trace_close() {
+    if (!trace_file) return;
+    fclose(trace_file);
+    trace_file = NULL;
+}
+
+/**
+ * @brief Tells whether operations are being recorded.
+ *
+ * @return 1 if a trace file is open, 0 otherwise.
+ */
+int trace_isRecording() {
+    return trace_file != NULL;
+}
+
+/**
+ * @brief Records an operation, if recording.
+ *
+ * @param start trace_clock() when the operation started.
+ * @param ok 1 if the operation succeeded, 0 otherwise.
+ * @param format printf-style format of the batch command line doing the same, followed by its arguments.
+ */
+void trace_record(long long start, int ok, const char *format, ...) {
+    char command[BATCH_LINE_MAX];
+    va_list args;
+    if (!trace_file) return;
+    long long elapsed = trace_clock() - start;
+
+    va_start(args, format);
+    vsnprintf(command, sizeof(command), format, args);
+    va_end(args);
+    command[strcspn(command, "\r\n")] = '\0';
+
+    // Deltas are rounded down to whole microseconds; keeping the remainder stops the rounding from drifting
+    long long delta = start > trace_last ? (start - trace_last) / 1000 : 0;
+    trace_last += delta * 1000;
+    fprintf(trace_file, "%lld %lld %c %s\n", delta, elapsed, ok ? '+' : '-', command);
+}
+
+/**
+ * @brief Compares two latencies (a comparator for qsort()).
+ */
+static int trace_compare(const void *a, const void *b) {
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Returns a percentile of sorted latencies.
+ *
+ * @param sorted The latencies, in ascending order.
+ * @param count Number of latencies (at least 1).
+ * @param percent The percentile.
+ * @return The latency.
+ */
+static long long trace_percentile(const long long *sorted, long count, int percent) {
+    return sorted[(count - 1) * percent / 100];
+}
+
+/**
+ * @brief Fills the latency figures of a set of operations.
+ *
+ * @param latency Filled with the figures.
+ * @param replayed Latencies of the replay (sorted in place).
+ * @param recorded Latencies of the recording (sorted in place).
+ * @param count Number of operations.
+ */
+static void trace_summarize(TraceLatency *latency, long long *replayed, long long *recorded, long count) {
+    long long total = 0;
+    memset(latency, 0, sizeof(*latency));
+    latency->count = count;
+    if (count == 0) return;
+
+    qsort(replayed, (size_t)count, sizeof(long long), trace_compare);
+    qsort(recorded, (size_t)count, sizeof(long long), trace_compare);
+    for (long i = 0; i < count; i++) total += replayed[i];
+    latency->mean = total / count;
+    latency->p50 = trace_percentile(replayed, count, 50);
+    latency->p90 = trace_percentile(replayed, count, 90);
+    latency->p99 = trace_percentile(replayed, count, 99);
+    latency->max = replayed[count - 1];
+    latency->recorded_p50 = trace_percentile(recorded, count, 50);
+    latency->recorded_p99 = trace_percentile(recorded, count, 99);
+}
+
+/**
+ * @brief Returns the report slot of a command, adding it if needed.
+ *
+ * @param report Pointer to the report.
+ * @param name The command word.
+ * @return Index of the slot; commands beyond the capacity share an "other" slot.
+ */
+static int trace_commandIndex(TraceReport *report, const char *name) {
+    for (int i = 0; i < report->command_count; i++)
+        if (strcmp(report->commands[i], name) == 0) return i;
+    if (report->command_count == TRACE_MAX_COMMANDS - 1) name = "other";
+    if (report->command_count == TRACE_MAX_COMMANDS) return TRACE_MAX_COMMANDS - 1;
+    snprintf(report->commands[report->command_count], sizeof(report->commands[0]), "%s", name);
+    return report->command_count++;
+}
+
+/**
+ * @brief Fills the latency figures of a report, overall and per command.
+ *
+ * @param report Pointer to the report (ops and commands set).
+ * @param replayed Latencies of the replay, in the order run.
+ * @param recorded Latencies of the recording, in the same order.
+ * @param commands Report slot of each operation.
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int trace_summarizeAll(TraceReport *report, const long long *replayed, const long long *recorded,
+                              const unsigned char *commands) {
+    size_t size = (size_t)(report->ops > 0 ? report->ops : 1) * sizeof(long long);
+    long long *a = mem_alloc(MEM_SCRATCH, size);
+    long long *b = mem_alloc(MEM_SCRATCH, size);
+    if (!a || !b) {
+        mem_free(MEM_SCRATCH, a, size);
+        mem_free(MEM_SCRATCH, b, size);
+        return 0;
+    }
+
+    for (int c = 0; c < report->command_count; c++) {
+        long count = 0;
+        for (long i = 0; i < report->ops; i++) {
+            if (commands[i] != c) continue;
+            a[count] = replayed[i];
+            b[count++] = recorded[i];
+        }
+        trace_summarize(&report->by_command[c], a, b, count);
+    }
+    memcpy(a, replayed, (size_t)report->ops * sizeof(long long));
+    memcpy(b, recorded, (size_t)report->ops * sizeof(long long));
+    trace_summarize(&report->all, a, b, report->ops);
+    mem_free(MEM_SCRATCH, a, size);
+    mem_free(MEM_SCRATCH, b, size);
+    return 1;
+}
+
+/**
+ * @brief Runs the operations of a trace file against the list.
+ *
+ * @param path Path of the trace file.
+ * @param paced 1 to keep the recorded time between operations, 0 to run them back to back.
+ * @param report Filled with the outcome.
+ * @param head Pointer to the head pointer of the list (updated in place).
+ * @param stack Pointer to the undo stack.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ * @return Number of operations replayed, or -1 if the file could not be opened, is
+ *         not a trace or memory ran out.
+ */
+long trace_replay(const char *path, int paced, TraceReport *report, List **head, Stack *stack,
+                  Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    char line[TRACE_LINE_MAX];
+    int version;
+    long capacity = 0;
+    long long *replayed = NULL, *recorded = NULL;
+    unsigned char *commands = NULL;
+    int ok = 1;
+
+    memset(report, 0, sizeof(*report));
+    report->paced = paced;
+    FILE *in = fopen(path, "r");
+    if (!in) return -1;
+    if (!fgets(line, sizeof(line), in) || sscanf(line, "# taskmgr trace %d %15s", &version, report->mode) != 2 ||
+        version != TRACE_VERSION) {
+        fclose(in);
+        return -1;
+    }
+    FILE *out = fopen(TRACE_NULL_DEVICE, "w");
+    if (!out) {
+        fclose(in);
+        return -1;
+    }
+    BatchContext ctx = { head, stack, id_tree, priority_tree, status_tree, out, "", 0, 0 };
+
+    // Interactive sessions keep the BSTs up to date after every operation; batch runs and daemons do not
+    int deferred = strcmp(report->mode, "interactive") != 0;
+    if (deferred) list_deferIndexes();
+    long long begin = trace_clock(), scheduled = 0;
+
+    while (ok && fgets(line, sizeof(line), in)) {
+        size_t length = strlen(line);
+        if (length == sizeof(line) - 1 && line[length - 1] != '\n' && !feof(in)) {
+            int c;
+            while ((c = fgetc(in)) != EOF && c != '\n') {}
+            report->unreadable++;
+            continue;
+        }
+
+        long long delta, duration;
+        char outcome, name[16];
+        int offset;
+        if (sscanf(line, "%lld %lld %c %n", &delta, &duration, &outcome, &offset) != 3 ||
+            (outcome != '+' && outcome != '-') || sscanf(line + offset, "%15s", name) != 1) {
+            report->unreadable++;
+            continue;
+        }
+
+        scheduled += delta * 1000;
+        if (paced) {
+            long long now = trace_clock() - begin;
+            if (now < scheduled) trace_sleep(scheduled - now);
+            else if (now - scheduled > report->max_lag) report->max_lag = now - scheduled;
+        }
+
+        if (report->ops == capacity) {
+            // All three arrays grow or none does, so each keeps the size it is freed with
+            long grown = capacity ? capacity * 2 : 4096;
+            long long *grown_replayed = mem_alloc(MEM_SCRATCH, (size_t)grown * sizeof(long long));
+            long long *grown_recorded = mem_alloc(MEM_SCRATCH, (size_t)grown * sizeof(long long));
+            unsigned char *grown_commands = mem_alloc(MEM_SCRATCH, (size_t)grown);
+            if (!grown_replayed || !grown_recorded || !grown_commands) {
+                mem_free(MEM_SCRATCH, grown_replayed, (size_t)grown * sizeof(long long));
+                mem_free(MEM_SCRATCH, grown_recorded, (size_t)grown * sizeof(long long));
+                mem_free(MEM_SCRATCH, grown_commands, (size_t)grown);
+                ok = 0;
+                break;
+            }
+            if (report->ops > 0) {
+                memcpy(grown_replayed, replayed, (size_t)report->ops * sizeof(long long));
+                memcpy(grown_recorded, recorded, (size_t)report->ops * sizeof(long long));
+                memcpy(grown_commands, commands, (size_t)report->ops);
+            }
+            mem_free(MEM_SCRATCH, replayed, (size_t)capacity * sizeof(long long));
+            mem_free(MEM_SCRATCH, recorded, (size_t)capacity * sizeof(long long));
+            mem_free(MEM_SCRATCH, commands, (size_t)capacity);
+            replayed = grown_replayed;
+            recorded = grown_recorded;
+            commands = grown_commands;
+            capacity = grown;
+        }
+
+        long long start = trace_clock();
+        BatchResult result = batch_executeLine(&ctx, line + offset);
+        replayed[report->ops] = trace_clock() - start;
+        recorded[report->ops] = duration;
+        commands[report->ops] = (unsigned char)trace_commandIndex(report, name);
+        report->ops++;
+        if (result != BATCH_OK) report->failed++;
+        if ((result == BATCH_OK) != (outcome == '+')) report->diverged++;
+        metrics_tick();
+    }
+
+    if (list_inTransaction()) list_txnRollback(head, stack, NULL, id_tree, priority_tree, status_tree);
+    if (deferred) list_resumeIndexes(*head, id_tree, priority_tree, status_tree);
+    report->seconds = (trace_clock() - begin) / 1e9;
+    report->recorded_seconds = scheduled / 1e9;
+    fclose(out);
+    fclose(in);
+
+    if (ok) ok = trace_summarizeAll(report, replayed, recorded, commands);
+    mem_free(MEM_SCRATCH, replayed, (size_t)capacity * sizeof(long long));
+    mem_free(MEM_SCRATCH, recorded, (size_t)capacity * sizeof(long long));
+    mem_free(MEM_SCRATCH, commands, (size_t)capacity);
+    return ok ? report->ops : -1;
+}
+
+/**
+ * @brief Prints one row of the latency table, in microseconds.
+ *
+ * @param out Stream to print to.
+ * @param name Label of the row.
+ * @param latency The figures.
+ */
+static void trace_printLatency(FILE *out, const char *name, const TraceLatency *latency) {
+    fprintf(out, "%-10s %9ld %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f\n", name, latency->count,
+            latency->mean / 1e3, latency->p50 / 1e3, latency->p90 / 1e3, latency->p99 / 1e3, latency->max / 1e3,
+            latency->recorded_p50 / 1e3, latency->recorded_p99 / 1e3);
+}
+
+/**
+ * @brief Prints a replay report: throughput, then latency percentiles overall and per command.
+ *
+ * @param report Pointer to the report.
+ * @param out Stream to print to.
+ */
+void trace_printReport(const TraceReport *report, FILE *out) {
+    fprintf(out, "Replayed %ld operations (%s trace) in %.3f s", report->ops, report->mode, report->seconds);
+    if (report->seconds > 0) fprintf(out, " (%.0f ops/s)", report->ops / report->seconds);
+    fprintf(out, ": %ld failed, %ld diverged from the recording", report->failed, report->diverged);
+    if (report->unreadable > 0) fprintf(out, ", %ld unreadable lines skipped", report->unreadable);
+    fprintf(out, "\nRecorded over %.3f s; ", report->recorded_seconds);
+    if (report->paced) fprintf(out, "replayed at the recorded pace, at most %.3f ms behind\n", report->max_lag / 1e6);
+    else fprintf(out, "replayed at full speed\n");
+
+    fprintf(out, "\nLatency (us)   count      mean       p50       p90       p99       max  rec. p50  rec. p99\n");
+    trace_printLatency(out, "all", &report->all);
+    for (int i = 0; i < report->command_count; i++)
+        trace_printLatency(out, report->commands[i], &report->by_command[i]);
+}
@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "trash.h"
+#include "idmap.h"
+#include "mem.h"
+
+/**
+ * @brief Kinds of records in the trash file.
+ */
+enum {
+    TRASH_DELETED = 1,   // Header followed by the deleted task as a TaskV1 (old files)
+    TRASH_TAKEN = 2,     // Tombstone: the ID was restored, no payload
+    TRASH_DELETED_V2 = 3 // Header followed by the deleted task as a TaskRecord
+};
+
+/**
+ * @brief Fixed header written before every trash record.
+ */
+typedef struct TrashHeader {
+    int kind;            // TRASH_DELETED, TRASH_TAKEN or TRASH_DELETED_V2
+    int id;              // Task ID the record refers to
+} TrashHeader;
+
+static FILE *trash_file = NULL;
+static IdMap trash_index;    // Task ID -> offset of the payload * 2, plus 1 for a TaskV1
+static int trash_lost = 0;   // Tasks trash_append() could not write, over every file opened
+
+/**
+ * @brief Opens (or creates) the trash file and rebuilds its in-memory index.
+ *
+ * The index maps each task ID to the offset of its most recently deleted copy.
+ * Only record headers are read, so startup cost is one seek per record.
+ *
+ * @param path Path of the trash file.
+ * @return 1 on success, 0 if the file could not be opened.
+ */
+int trash_open(const char *path) {
+    trash_close();
+    trash_file = fopen(path, "a+b");
+    if (!trash_file) return 0;
+
+    idmap_init(&trash_index);
+    fseek(trash_file, 0, SEEK_SET);
+    TrashHeader header;
+    while (fread(&header, sizeof(header), 1, trash_file) == 1) {
+        if (header.kind == TRASH_DELETED || header.kind == TRASH_DELETED_V2) {
+            int v1 = header.kind == TRASH_DELETED;
+            idmap_put(&trash_index, header.id, (long long)ftell(trash_file) * 2 + v1);
+            if (fseek(trash_file, v1 ? sizeof(TaskV1) : sizeof(TaskRecord), SEEK_CUR) != 0) break;
+        } else if (header.kind == TRASH_TAKEN) {
+            idmap_remove(&trash_index, header.id);
+        } else {
+            break; // Torn or foreign data: stop indexing here
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Flushes and closes the trash file and frees the index.
+ */
+void trash_close() {
+    if (!trash_file) return;
+    fclose(trash_file);
+    trash_file = NULL;
+    idmap_free(&trash_index);
+}
+
+/**
+ * @brief Checks whether a trash file is open.
+ *
+ * @return 1 if deleted tasks are being kept, 0 otherwise.
+ */
+int trash_isOpen() {
+    return trash_file != NULL;
+}
+
+/**
+ * @brief Appends a deleted task to the trash file.
+ *
+ * Used as the undo stack's eviction handler, so tasks that fall out of the undo
+ * window are kept on disk instead of being lost. A task that cannot be written is
+ * counted in trash_lostCount().
+ *
+ * @param task Pointer to the deleted Task (not freed).
+ */
+void trash_append(const Task *task) {
+    if (!trash_file || !task) return;
+
+    TrashHeader header = { TRASH_DELETED_V2, task->id };
+    TaskRecord record;
+    task_toRecord(&record, task);
+    fseek(trash_file, 0, SEEK_END);
+    long offset = ftell(trash_file) + (long)sizeof(header);
+    if (fwrite(&header, sizeof(header), 1, trash_file) != 1 ||
+        fwrite(&record, sizeof(TaskRecord), 1, trash_file) != 1) {
+        trash_lost++;
+        return;
+    }
+    idmap_put(&trash_index, task->id, (long long)offset * 2);
+}
+
+/**
+ * @brief Checks whether a deleted copy of a task ID is in the trash.
+ *
+ * @param id The task ID.
+ * @return 1 if the trash holds the ID, 0 otherwise.
+ */
+int trash_contains(int id) {
+    return trash_file && idmap_get(&trash_index, id, NULL);
+}
+
+/**
+ * @brief Reads one task payload from the trash file.
+ *
+ * @param location Index value of the payload: its offset * 2, plus 1 for a TaskV1.
+ * @param record Pointer to the record to fill.
+ * @return 1 on success, 0 on a read error.
+ */
+static int trash_read(long long location, TaskRecord *record) {
+    TaskV1 old;
+    fflush(trash_file);
+    if (fseek(trash_file, (long)(location / 2), SEEK_SET) != 0) return 0;
+    if (location % 2 == 0) return fread(record, sizeof(TaskRecord), 1, trash_file) == 1;
+    if (fread(&old, sizeof(TaskV1), 1, trash_file) != 1) return 0;
+    task_fromV1(record, &old);
+    return 1;
+}
+
+/**
+ * @brief Reads back the most recently deleted copy of a task.
+ *
+ * The ID is removed from the index and a tombstone is appended, so the task is
+ * not offered again after a restart.
+ *
+ * @param id The task ID.
+ * @return Newly allocated Task (owned by the caller; free with task_free()), or NULL if
+ *         not found, unreadable or out of memory.
+ */
+Task* trash_take(int id) {
+    long long location;
+    if (!trash_file || !idmap_get(&trash_index, id, &location)) return NULL;
+
+    TaskRecord record;
+    if (!trash_read(location, &record)) return NULL;
+    Task *task = mem_alloc(MEM_TASK, sizeof(Task));
+    if (!task || !task_fromRecord(task, &record)) {
+        task_free(task);
+        return NULL;
+    }
+
+    TrashHeader header = { TRASH_TAKEN, id };
+    fseek(trash_file, 0, SEEK_END);
+    fwrite(&header, sizeof(header), 1, trash_file);
+    fflush(trash_file);
+    idmap_remove(&trash_index, id);
+    return task;
+}
+
+/**
+ * @brief Returns the number of distinct task IDs in the trash.
+ *
+ * @return Number of restorable tasks.
+ */
+int trash_count() {
+    return trash_file ? (int)trash_index.count : 0;
+}
+
+/**
+ * @brief Returns the number of deleted tasks that could not be written to the trash file.
+ *
+ * @return Number of tasks lost so far, over every trash file opened.
+ */
+int trash_lostCount() {
+    return trash_lost;
+}
+
+/**
+ * @brief Calls a function with the ID and title of every restorable task.
+ *
+ * @param fn Function to call.
+ * @param context Opaque pointer passed to fn.
+ * @return Number of tasks visited; records that cannot be read are skipped.
+ */
+int trash_forEach(TrashVisitFn fn, void *context) {
+    if (!trash_file) return 0;
+    TaskRecord record;
+    int visited = 0;
+    for (size_t i = 0; i < trash_index.capacity; i++) {
+        if (!trash_index.used[i] || !trash_read(trash_index.values[i], &record)) continue;
+        record.title[sizeof(record.title) - 1] = '\0';
+        fn(record.id, record.title, context);
+        visited++;
+    }
+    return visited;
+}
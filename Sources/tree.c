@@ -1,6 +1,10 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "tree.h"
+#include "render.h"
+#include "metrics.h"
+#include "mem.h"
+#include "span.h"
 
 /**
  * @brief Creates a new binary search tree with a specified sort key.
@@ -9,28 +13,45 @@
  * @return Pointer to the new Tree, or NULL if allocation fails.
  */
 Tree* tree_create(SortKey key) {
-    Tree *tree = malloc(sizeof(Tree));
+    Tree *tree = mem_alloc(MEM_TREE, sizeof(Tree));
     if (!tree) return NULL;
     tree->root = NULL;
     tree->key = key;
     return tree;
 }
 
+/**
+ * @brief Compares two integers without the overflow risk of a subtraction.
+ *
+ * @param a First value.
+ * @param b Second value.
+ * @return -1, 0 or 1.
+ */
+static int compareInts(int a, int b) {
+    return (a > b) - (a < b);
+}
+
 /**
  * @brief Compares two tasks based on the specified sort key.
  *
+ * Ties on the key are broken by ID and then by address, so every task has a unique
+ * place in the tree and can be found again by tree_remove().
+ *
  * @param t1 First task to compare.
  * @param t2 Second task to compare.
  * @param key The sort key (ID, priority, or status).
- * @return Negative if t1 < t2, positive if t1 > t2, zero if equal.
+ * @return Negative if t1 < t2, positive if t1 > t2, zero only if t1 == t2.
  */
 static int compareTasks(Task *t1, Task *t2, SortKey key) {
+    int cmp = 0;
     switch (key) {
-        case KEY_ID: return t1->id - t2->id;
-        case KEY_PRIORITY: return t1->priority - t2->priority;
-        case KEY_STATUS: return t1->status - t2->status;
-        default: return 0;
+        case KEY_PRIORITY: cmp = compareInts(t1->priority, t2->priority); break;
+        case KEY_STATUS: cmp = compareInts(t1->status, t2->status); break;
+        default: break;
     }
+    if (cmp == 0) cmp = compareInts(t1->id, t2->id);
+    if (cmp == 0) cmp = (t1 > t2) - (t1 < t2);
+    return cmp;
 }
 
 /**
@@ -39,21 +60,23 @@ static int compareTasks(Task *t1, Task *t2, SortKey key) {
  * @param node Pointer to the current node (or NULL for new node).
  * @param task Pointer to the Task to insert.
  * @param key The sort key.
+ * @return Number of nodes the task was compared with.
  */
-static void tree_insertNode(TreeNode **node, Task *task, SortKey key) {
+static int tree_insertNode(TreeNode **node, Task *task, SortKey key) {
     if (!*node) {
-        *node = malloc(sizeof(TreeNode));
-        if (!*node) return;
+        *node = mem_alloc(MEM_TREE, sizeof(TreeNode));
+        if (!*node) return 0;
         (*node)->task = task;
         (*node)->left = (*node)->right = NULL;
-        return;
+        metrics_count(METRIC_TREE_INSERT, 0, 1);
+        return 0;
     }
 
     int cmp = compareTasks(task, (*node)->task, key);
     if (cmp < 0)
-        tree_insertNode(&(*node)->left, task, key);
+        return 1 + tree_insertNode(&(*node)->left, task, key);
     else
-        tree_insertNode(&(*node)->right, task, key);
+        return 1 + tree_insertNode(&(*node)->right, task, key);
 }
 
 /**
@@ -66,25 +89,164 @@ static void tree_insertNode(TreeNode **node, Task *task, SortKey key) {
  */
 void tree_insert(Tree *tree, Task *task) {
     if (!tree || !task) return;
-    tree_insertNode(&tree->root, task, tree->key);
+    long long start = metrics_begin(METRIC_TREE_INSERT);
+    metrics_count(METRIC_TREE_INSERT, tree_insertNode(&tree->root, task, tree->key), 0);
+    metrics_end(METRIC_TREE_INSERT, start);
 }
 
 /**
- * @brief Prints tasks in a subtree using inorder traversal.
+ * @brief Sorts an array of tasks by a key (bottom-up merge sort).
  *
- * @param node Pointer to the current node.
+ * @param tasks Array to sort in place.
+ * @param count Number of tasks.
+ * @param key The sort key.
+ * @return 1 on success, 0 if the scratch buffer could not be allocated.
  */
-static void tree_printInorderNode(TreeNode *node) {
-    if (!node) return;
-    tree_printInorderNode(node->left);
-    printTask(node->task);
-    tree_printInorderNode(node->right);
+static int tree_sortTasks(Task **tasks, int count, SortKey key) {
+    size_t size = sizeof(Task *) * (count > 0 ? count : 1);
+    Task **buffer = mem_alloc(MEM_SCRATCH, size);
+    if (!buffer) return 0;
+
+    Task **src = tasks, **dst = buffer;
+    for (int width = 1; width < count; width *= 2) {
+        for (int lo = 0; lo < count; lo += 2 * width) {
+            int mid = lo + width < count ? lo + width : count;
+            int hi = lo + 2 * width < count ? lo + 2 * width : count;
+            int i = lo, j = mid, k = lo;
+            while (i < mid && j < hi)
+                dst[k++] = compareTasks(src[i], src[j], key) <= 0 ? src[i++] : src[j++];
+            while (i < mid) dst[k++] = src[i++];
+            while (j < hi) dst[k++] = src[j++];
+        }
+        Task **swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != tasks) {
+        for (int i = 0; i < count; i++) tasks[i] = src[i];
+    }
+    mem_free(MEM_SCRATCH, buffer, size);
+    return 1;
+}
+
+/**
+ * @brief Builds a perfectly balanced subtree from a sorted slice of tasks.
+ *
+ * @param tasks Sorted array of tasks.
+ * @param lo First index of the slice.
+ * @param hi One past the last index of the slice.
+ * @param ok Cleared to 0 if a node could not be allocated.
+ * @return Root of the subtree, or NULL for an empty slice.
+ */
+static TreeNode* tree_buildNode(Task **tasks, int lo, int hi, int *ok) {
+    if (lo >= hi) return NULL;
+    int mid = lo + (hi - lo) / 2;
+    TreeNode *node = mem_alloc(MEM_TREE, sizeof(TreeNode));
+    if (!node) {
+        *ok = 0;
+        return NULL;
+    }
+    node->task = tasks[mid];
+    node->left = tree_buildNode(tasks, lo, mid, ok);
+    node->right = tree_buildNode(tasks, mid + 1, hi, ok);
+    return node;
+}
+
+/**
+ * @brief Replaces the contents of the tree with a balanced tree over the given tasks.
+ *
+ * Sorts the array in place by the tree's key, then builds the tree in O(n), so a batch
+ * of changes costs one O(n log n) rebuild instead of one insertion per change.
+ *
+ * @param tree Pointer to the tree.
+ * @param tasks Array of task pointers (reordered by this call).
+ * @param count Number of tasks in the array.
+ * @return 1 on success, 0 on allocation failure (the tree is left empty).
+ */
+int tree_build(Tree *tree, Task **tasks, int count) {
+    if (!tree) return 0;
+    long long start = metrics_begin(METRIC_TREE_BUILD);
+    long long span = span_begin();
+    tree_clear(tree);
+    long long sort_span = span_begin();
+    int ok = count <= 0 || tree_sortTasks(tasks, count, tree->key);
+    span_end(sort_span, "tree.sort", count);
+    if (ok && count > 0) {
+        tree->root = tree_buildNode(tasks, 0, count, &ok);
+        if (ok) metrics_count(METRIC_TREE_BUILD, count, count);
+        else tree_clear(tree);
+    }
+    metrics_end(METRIC_TREE_BUILD, start);
+    span_end(span, "tree.build", count);
+    return ok;
+}
+
+/**
+ * @brief Removes a task from a subtree.
+ *
+ * @param node Pointer to the current node link.
+ * @param task Pointer to the Task to remove.
+ * @param key The sort key.
+ * @return 1 if the task was found and removed, 0 otherwise.
+ */
+static int tree_removeNode(TreeNode **node, Task *task, SortKey key) {
+    int visited = 0;
+    while (*node) {
+        visited++;
+        int cmp = compareTasks(task, (*node)->task, key);
+        if (cmp < 0) {
+            node = &(*node)->left;
+        } else if (cmp > 0) {
+            node = &(*node)->right;
+        } else {
+            TreeNode *target = *node;
+            if (!target->left) {
+                *node = target->right;
+            } else if (!target->right) {
+                *node = target->left;
+            } else {
+                // Replace with the inorder successor and unlink it
+                TreeNode **succ = &target->right;
+                while ((*succ)->left) succ = &(*succ)->left;
+                TreeNode *next = *succ;
+                *succ = next->right;
+                next->left = target->left;
+                next->right = target->right;
+                *node = next;
+            }
+            mem_free(MEM_TREE, target, sizeof(TreeNode));
+            metrics_count(METRIC_TREE_REMOVE, visited, 0);
+            return 1;
+        }
+    }
+    metrics_count(METRIC_TREE_REMOVE, visited, 0);
+    return 0;
+}
+
+/**
+ * @brief Removes a task from the binary search tree.
+ *
+ * Must be called before the task's key fields change, since the task is located
+ * by its current key. The task itself is not freed.
+ *
+ * @param tree Pointer to the tree.
+ * @param task Pointer to the Task to remove.
+ * @return 1 if the task was found and removed, 0 otherwise.
+ */
+int tree_remove(Tree *tree, Task *task) {
+    if (!tree || !task) return 0;
+    long long start = metrics_begin(METRIC_TREE_REMOVE);
+    int removed = tree_removeNode(&tree->root, task, tree->key);
+    metrics_end(METRIC_TREE_REMOVE, start);
+    return removed;
 }
 
 /**
  * @brief Prints all tasks in the tree in sorted order (inorder traversal).
  *
- * Displays tasks sorted by the tree's sort key.
+ * Displays tasks sorted by the tree's sort key, in the current display format
+ * (see render_setFormat()) through the buffered renderer.
  *
  * @param tree Pointer to the tree.
  */
@@ -100,19 +262,145 @@ void tree_printInorder(Tree *tree) {
         case KEY_STATUS: printf("Status:\n"); break;
     }
     printf("---------------------------------\n");
-    tree_printInorderNode(tree->root);
+    render_tree(tree, stdout, render_getFormat());
+}
+
+/**
+ * @brief Visits the tasks of a subtree in sorted order.
+ *
+ * @param node Pointer to the current node.
+ * @param visit Callback invoked for each task.
+ * @param context Opaque pointer passed to the callback.
+ * @return Number of tasks visited.
+ */
+static long tree_forEachNode(TreeNode *node, void (*visit)(Task *task, void *context), void *context) {
+    long visited = 0;
+    while (node) {
+        visited += tree_forEachNode(node->left, visit, context) + 1;
+        visit(node->task, context);
+        node = node->right;
+    }
+    return visited;
+}
+
+/**
+ * @brief Calls a function for every task in the tree, in sorted order.
+ *
+ * @param tree Pointer to the tree.
+ * @param visit Callback invoked for each task.
+ * @param context Opaque pointer passed to the callback.
+ */
+void tree_forEach(Tree *tree, void (*visit)(Task *task, void *context), void *context) {
+    if (!tree) return;
+    long long start = metrics_begin(METRIC_TREE_WALK);
+    metrics_count(METRIC_TREE_WALK, tree_forEachNode(tree->root, visit, context), 0);
+    metrics_end(METRIC_TREE_WALK, start);
+}
+
+/**
+ * @brief Returns the first task in sorted order.
+ *
+ * @param tree Pointer to the tree.
+ * @return The smallest Task, or NULL if the tree is empty.
+ */
+Task* tree_first(Tree *tree) {
+    long long start = metrics_begin(METRIC_TREE_STEP);
+    TreeNode *node = tree ? tree->root : NULL;
+    if (node)
+        while (node->left) node = node->left;
+    metrics_end(METRIC_TREE_STEP, start);
+    return node ? node->task : NULL;
+}
+
+/**
+ * @brief Returns the last task in sorted order.
+ *
+ * @param tree Pointer to the tree.
+ * @return The largest Task, or NULL if the tree is empty.
+ */
+Task* tree_last(Tree *tree) {
+    long long start = metrics_begin(METRIC_TREE_STEP);
+    TreeNode *node = tree ? tree->root : NULL;
+    if (node)
+        while (node->right) node = node->right;
+    metrics_end(METRIC_TREE_STEP, start);
+    return node ? node->task : NULL;
+}
+
+/**
+ * @brief Returns the task following a given one in sorted order.
+ *
+ * Walks down from the root by key, so it costs O(height) and needs no parent
+ * links. The task must not have changed its key fields since it was indexed.
+ *
+ * @param tree Pointer to the tree.
+ * @param task Pointer to a Task in the tree.
+ * @return The next Task, or NULL if task is the last one.
+ */
+Task* tree_next(Tree *tree, Task *task) {
+    long long start = metrics_begin(METRIC_TREE_STEP);
+    Task *next = NULL;
+    for (TreeNode *node = tree ? tree->root : NULL; node; ) {
+        if (compareTasks(task, node->task, tree->key) < 0) {
+            next = node->task;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+    metrics_end(METRIC_TREE_STEP, start);
+    return next;
+}
+
+/**
+ * @brief Returns the task preceding a given one in sorted order.
+ *
+ * @param tree Pointer to the tree.
+ * @param task Pointer to a Task in the tree.
+ * @return The previous Task, or NULL if task is the first one.
+ */
+Task* tree_prev(Tree *tree, Task *task) {
+    long long start = metrics_begin(METRIC_TREE_STEP);
+    Task *prev = NULL;
+    for (TreeNode *node = tree ? tree->root : NULL; node; ) {
+        if (compareTasks(task, node->task, tree->key) > 0) {
+            prev = node->task;
+            node = node->right;
+        } else {
+            node = node->left;
+        }
+    }
+    metrics_end(METRIC_TREE_STEP, start);
+    return prev;
 }
 
 /**
  * @brief Frees a subtree recursively (but not the tasks).
  *
  * @param node Pointer to the current node.
+ * @return Number of nodes freed.
  */
-static void tree_freeNode(TreeNode *node) {
-    if (!node) return;
-    tree_freeNode(node->left);
-    tree_freeNode(node->right);
-    free(node);
+static long tree_freeNode(TreeNode *node) {
+    if (!node) return 0;
+    long freed = tree_freeNode(node->left) + tree_freeNode(node->right);
+    mem_free(MEM_TREE, node, sizeof(TreeNode));
+    return freed + 1;
+}
+
+/**
+ * @brief Removes all nodes from the tree (but not the tasks), keeping the tree usable.
+ *
+ * @param tree Pointer to the tree.
+ */
+void tree_clear(Tree *tree) {
+    if (!tree) return;
+    long long start = metrics_begin(METRIC_TREE_CLEAR);
+    long long span = span_begin();
+    long freed = tree_freeNode(tree->root);
+    metrics_count(METRIC_TREE_CLEAR, freed, 0);
+    tree->root = NULL;
+    metrics_end(METRIC_TREE_CLEAR, start);
+    span_end(span, "tree.clear", freed);
 }
 
 /**
@@ -124,6 +412,8 @@ static void tree_freeNode(TreeNode *node) {
  */
 void tree_free(Tree *tree) {
     if (!tree) return;
-    tree_freeNode(tree->root);
-    free(tree);
+    long long span = span_begin();
+    long freed = tree_freeNode(tree->root);
+    mem_free(MEM_TREE, tree, sizeof(Tree));
+    span_end(span, "tree.free", freed);
 }
@@ -0,0 +1,419 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "tui.h"
+#include "term.h"
+#include "task.h"
+
+#define TUI_CHROME_LINES 5                       // Header, column names, details, status, last row
+#define TUI_MAX_WIDTH (TERM_LINE_MAX - 16)       // Room left for the highlight escapes
+
+/**
+ * @brief Order in which the browser walks the tasks.
+ */
+typedef enum {
+    VIEW_LIST,                // Insertion order of the linked list
+    VIEW_ID,                  // id_tree
+    VIEW_PRIORITY,            // priority_tree
+    VIEW_STATUS,              // status_tree
+    VIEW_COUNT
+} TuiView;
+
+/**
+ * @brief Line being typed on the status line, if any.
+ */
+typedef enum {
+    INPUT_NONE,
+    INPUT_FILTER,             // Filter text, applied on every key
+    INPUT_JUMP                // ID to jump to, applied on Enter
+} TuiInput;
+
+/**
+ * @brief State of the browser.
+ */
+typedef struct Tui {
+    List *head;
+    Tree *trees[VIEW_COUNT];          // Index walked by each view (NULL for VIEW_LIST)
+    TuiView view;
+    Task *top;                        // Where the page starts (may be hidden by the filter)
+    Task *rows[TERM_MAX_LINES];       // Tasks on the page
+    int count;                        // Rows filled so far
+    int page;                         // Rows available for tasks
+    int selected;                     // Highlighted row
+    Task *scan;                       // Next task to examine while the page fills
+    int filling;                      // 1 while the page is not complete
+    char filter[TUI_INPUT_MAX];       // Lowercase title substring, "" for all tasks
+    TuiInput input;
+    char entry[TUI_INPUT_MAX];        // ID being typed
+    char message[TUI_MAX_WIDTH];      // Shown on the status line until the next key
+} Tui;
+
+/**
+ * @brief Returns the first task of the current view.
+ */
+static Task* tui_first(Tui *t) {
+    return t->view == VIEW_LIST ? (t->head ? t->head->task : NULL) : tree_first(t->trees[t->view]);
+}
+
+/**
+ * @brief Returns the last task of the current view.
+ */
+static Task* tui_last(Tui *t) {
+    return t->view == VIEW_LIST ? list_lastTask(t->head) : tree_last(t->trees[t->view]);
+}
+
+/**
+ * @brief Returns the task after a given one in the current view.
+ */
+static Task* tui_next(Tui *t, Task *task) {
+    return t->view == VIEW_LIST ? list_nextTask(t->head, task) : tree_next(t->trees[t->view], task);
+}
+
+/**
+ * @brief Returns the task before a given one in the current view.
+ */
+static Task* tui_prev(Tui *t, Task *task) {
+    return t->view == VIEW_LIST ? list_prevTask(t->head, task) : tree_prev(t->trees[t->view], task);
+}
+
+/**
+ * @brief Checks whether a task passes the filter (case-insensitive title substring).
+ *
+ * @param t Pointer to the browser state.
+ * @param task Pointer to the Task.
+ * @return 1 if the task is shown, 0 otherwise.
+ */
+static int tui_matches(Tui *t, Task *task) {
+    if (t->filter[0] == '\0') return 1;
+    for (const char *start = task->title; *start; start++) {
+        const char *a = start;
+        const char *b = t->filter;
+        while (*a && *b && tolower((unsigned char)*a) == *b) {
+            a++;
+            b++;
+        }
+        if (*b == '\0') return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Moves the page to start at a task; the rows are filled by tui_fill().
+ *
+ * @param t Pointer to the browser state.
+ * @param top First task to consider (NULL for an empty view).
+ * @param selected Row to highlight once the page is filled.
+ */
+static void tui_moveTo(Tui *t, Task *top, int selected) {
+    t->top = top;
+    t->selected = selected;
+    t->count = 0;
+    t->scan = top;
+    t->filling = 1;
+}
+
+/**
+ * @brief Fills the page with the tasks that pass the filter, from the top down.
+ *
+ * Examines at most TUI_SCAN_BUDGET tasks per call; t->filling stays set if the page
+ * could not be completed, and the next call carries on from there.
+ *
+ * @param t Pointer to the browser state.
+ */
+static void tui_fill(Tui *t) {
+    long budget = TUI_SCAN_BUDGET;
+    if (!t->filling) return;
+
+    while (t->count < t->page && t->scan && budget-- > 0) {
+        if (tui_matches(t, t->scan)) t->rows[t->count++] = t->scan;
+        t->scan = tui_next(t, t->scan);
+    }
+    t->filling = t->count < t->page && t->scan != NULL;
+    if (t->filling) return;
+
+    if (t->count > 0) t->top = t->rows[0];
+    if (t->selected >= t->count) t->selected = t->count > 0 ? t->count - 1 : 0;
+}
+
+/**
+ * @brief Walks back over up to n tasks that pass the filter.
+ *
+ * Examines at most TUI_SCAN_BUDGET tasks; when the budget runs out, the task reached
+ * so far is returned and the page simply starts there.
+ *
+ * @param t Pointer to the browser state.
+ * @param from Task to start from (not counted).
+ * @param n Number of shown tasks to step over.
+ * @return The task reached, or from if there is nothing before it.
+ */
+static Task* tui_back(Tui *t, Task *from, int n) {
+    long budget = TUI_SCAN_BUDGET;
+    Task *reached = from;
+    if (!from) return NULL;
+
+    for (Task *task = tui_prev(t, from); task && n > 0 && budget-- > 0; task = tui_prev(t, task)) {
+        reached = task;
+        if (tui_matches(t, task)) n--;
+    }
+    return reached;
+}
+
+/**
+ * @brief Returns the highlighted task, or NULL if the page is empty.
+ */
+static Task* tui_current(Tui *t) {
+    return t->selected < t->count ? t->rows[t->selected] : NULL;
+}
+
+/**
+ * @brief Returns the title of a view for the header.
+ */
+static const char* tui_viewName(TuiView view) {
+    switch (view) {
+        case VIEW_ID: return "sorted by ID";
+        case VIEW_PRIORITY: return "sorted by priority";
+        case VIEW_STATUS: return "sorted by status";
+        default: return "list order";
+    }
+}
+
+/**
+ * @brief Adds a line to the frame, cut to the screen width and optionally highlighted.
+ *
+ * @param text The line.
+ * @param width Screen width in characters.
+ * @param highlight 1 to draw the line in reverse video across the whole width.
+ */
+static void tui_line(const char *text, int width, int highlight) {
+    if (highlight) term_line("\x1b[7m%-*.*s\x1b[0m", width, width, text);
+    else term_line("%.*s", width, text);
+}
+
+/**
+ * @brief Paints the page as one frame; only changed lines reach the terminal.
+ *
+ * @param t Pointer to the browser state.
+ * @param cols Screen width in characters.
+ */
+static void tui_draw(Tui *t, int cols) {
+    char line[TUI_MAX_WIDTH + 1];
+    int width = cols < TUI_MAX_WIDTH ? cols : TUI_MAX_WIDTH;
+    Task *current = tui_current(t);
+
+    term_beginFrame();
+    if (t->filter[0])
+        snprintf(line, sizeof(line), " Task browser | %s | %d tasks | filter: \"%s\"",
+                 tui_viewName(t->view), listCounter_get(), t->filter);
+    else
+        snprintf(line, sizeof(line), " Task browser | %s | %d tasks", tui_viewName(t->view), listCounter_get());
+    tui_line(line, width, 1);
+    tui_line("      ID  PRIO    STATUS       TITLE", width, 0);
+
+    for (int i = 0; i < t->page; i++) {
+        if (i < t->count) {
+            Task *task = t->rows[i];
+            snprintf(line, sizeof(line), "%8d  %-6s  %-11s  %s", task->id,
+                     priorityName(task->priority), statusName(task->status), task->title);
+            tui_line(line, width, i == t->selected);
+        } else if (i == 0 && !t->filling) {
+            tui_line(t->filter[0] ? "  No task matches the filter." : "  No tasks to display. List is empty.", width, 0);
+        } else {
+            term_line("");
+        }
+    }
+
+    if (current) {
+        char description[DESC_MAX + 1];
+        desc_get(current->description, description, sizeof(description));
+        snprintf(line, sizeof(line), "  Description: %s", description);
+        tui_line(line, width, 0);
+    } else {
+        term_line("");
+    }
+
+    if (t->input == INPUT_FILTER)
+        snprintf(line, sizeof(line), " Filter: %s_   (Enter: keep, Esc: clear)", t->filter);
+    else if (t->input == INPUT_JUMP)
+        snprintf(line, sizeof(line), " Go to ID: %s_   (Enter: go, Esc: cancel)", t->entry);
+    else if (t->message[0])
+        snprintf(line, sizeof(line), " %s", t->message);
+    else if (t->filling)
+        snprintf(line, sizeof(line), " Searching...");
+    else
+        snprintf(line, sizeof(line), " Up/Down PgUp/PgDn Home/End: scroll   /: filter   #: go to ID   Tab: view   q: quit");
+    tui_line(line, width, 1);
+    term_endFrame();
+}
+
+/**
+ * @brief Handles a key while the filter or an ID is being typed.
+ *
+ * @param t Pointer to the browser state.
+ * @param key The key.
+ */
+static void tui_editKey(Tui *t, int key) {
+    char *text = t->input == INPUT_FILTER ? t->filter : t->entry;
+    size_t length = strlen(text);
+
+    if (key == '\r' || key == '\n') {
+        if (t->input == INPUT_JUMP && length > 0) {
+            int id = atoi(t->entry);
+            Task *task = list_findTask(t->head, id);
+            if (!task) snprintf(t->message, sizeof(t->message), "No task with ID %d.", id);
+            else if (!tui_matches(t, task)) snprintf(t->message, sizeof(t->message), "Task %d is hidden by the filter.", id);
+            else tui_moveTo(t, task, 0);
+        }
+        t->input = INPUT_NONE;
+        return;
+    }
+    if (key == TERM_KEY_ESCAPE) {
+        if (t->input == INPUT_FILTER) {
+            Task *current = tui_current(t);
+            t->filter[0] = '\0';
+            tui_moveTo(t, current ? current : tui_first(t), 0);
+        }
+        t->input = INPUT_NONE;
+        return;
+    }
+
+    if ((key == 127 || key == '\b') && length > 0) {
+        text[length - 1] = '\0';
+    } else if (key >= ' ' && key < 127 && length + 1 < TUI_INPUT_MAX) {
+        if (t->input == INPUT_JUMP && !isdigit(key) && !(key == '-' && length == 0)) return;
+        text[length] = (char)(t->input == INPUT_FILTER ? tolower(key) : key);
+        text[length + 1] = '\0';
+    } else {
+        return;
+    }
+    // The filter applies as it is typed, from the start of the view
+    if (t->input == INPUT_FILTER) tui_moveTo(t, tui_first(t), 0);
+}
+
+/**
+ * @brief Handles a key while browsing.
+ *
+ * @param t Pointer to the browser state.
+ * @param key The key.
+ * @return 0 if the browser should close, 1 otherwise.
+ */
+static int tui_browseKey(Tui *t, int key) {
+    Task *current = tui_current(t);
+
+    switch (key) {
+        case TERM_KEY_UP:
+        case 'k':
+            if (t->selected > 0) t->selected--;
+            else if (t->top && !t->filling) {
+                Task *top = tui_back(t, t->top, 1);
+                if (top != t->top) tui_moveTo(t, top, 0);
+            }
+            break;
+        case TERM_KEY_DOWN:
+        case 'j':
+            if (t->selected < t->count - 1) t->selected++;
+            else if (t->count == t->page && !t->filling) tui_moveTo(t, tui_next(t, t->rows[0]), t->selected);
+            break;
+        case TERM_KEY_PAGE_DOWN:
+        case ' ':
+            if (t->count == t->page && !t->filling) {
+                Task *next = tui_next(t, t->rows[t->count - 1]);
+                if (next) tui_moveTo(t, next, t->selected);
+                else t->selected = t->count - 1;
+            }
+            break;
+        case TERM_KEY_PAGE_UP:
+            if (!t->filling) tui_moveTo(t, tui_back(t, t->top, t->page), t->selected);
+            break;
+        case TERM_KEY_HOME:
+        case 'g':
+            tui_moveTo(t, tui_first(t), 0);
+            break;
+        case TERM_KEY_END:
+        case 'G':
+            tui_moveTo(t, tui_back(t, tui_last(t), t->page - 1), t->page - 1);
+            break;
+        case '\t':
+            // Keep the highlighted task in view when switching order
+            t->view = (TuiView)((t->view + 1) % VIEW_COUNT);
+            tui_moveTo(t, current ? current : tui_first(t), 0);
+            break;
+        case '/':
+            t->input = INPUT_FILTER;
+            break;
+        case '#':
+            t->input = INPUT_JUMP;
+            t->entry[0] = '\0';
+            break;
+        case 'q':
+        case 'Q':
+        case 3:                                  // Ctrl-C
+        case TERM_KEY_ESCAPE:
+            return 0;
+        default:
+            break;
+    }
+    return 1;
+}
+
+/**
+ * @brief Runs the full-screen task browser until the user quits.
+ *
+ * Only the rows that fit on screen are visited, walking the list or a BST from the
+ * first visible task, so a frame costs the same for 100 tasks or 10 million.
+ * Keys: Up/Down, PgUp/PgDn, Home/End to scroll, Tab to switch between list order
+ * and the sorted indexes, '/' to filter by title as you type, '#' to jump to an ID,
+ * q or Esc to quit. The BSTs must be up to date (see list_syncIndexes()).
+ *
+ * @param head Pointer to the head of the list.
+ * @param id_tree Pointer to the BST sorted by ID.
+ * @param priority_tree Pointer to the BST sorted by priority.
+ * @param status_tree Pointer to the BST sorted by status.
+ */
+void tui_run(List *head, Tree *id_tree, Tree *priority_tree, Tree *status_tree) {
+    static Tui t;
+    int rows = 0, cols = 0;
+    int redraw = 1;
+
+    if (!term_isInteractive()) {
+        printf("The full-screen view needs a terminal.\n");
+        return;
+    }
+
+    memset(&t, 0, sizeof(t));
+    t.head = head;
+    t.trees[VIEW_ID] = id_tree;
+    t.trees[VIEW_PRIORITY] = priority_tree;
+    t.trees[VIEW_STATUS] = status_tree;
+
+    term_enterFullScreen();
+    for (;;) {
+        int new_rows, new_cols;
+        term_size(&new_rows, &new_cols);
+        if (new_rows != rows || new_cols != cols) {
+            rows = new_rows;
+            cols = new_cols;
+            t.page = (rows < TERM_MAX_LINES ? rows : TERM_MAX_LINES) - TUI_CHROME_LINES;
+            if (t.page < 1) t.page = 1;
+            tui_moveTo(&t, t.top ? t.top : tui_first(&t), t.selected);
+            term_clear();
+            redraw = 1;
+        }
+
+        if (t.filling) {
+            tui_fill(&t);
+            redraw = 1;
+        }
+        if (redraw) tui_draw(&t, cols);
+
+        // Poll while the page is still filling, otherwise sleep until a key or a resize check
+        int key = term_readKey(t.filling ? 0 : TUI_IDLE_MS);
+        redraw = key != TERM_KEY_NONE;
+        if (!redraw) continue;
+
+        t.message[0] = '\0';
+        if (t.input != INPUT_NONE) tui_editKey(&t, key);
+        else if (!tui_browseKey(&t, key)) break;
+    }
+    term_leaveFullScreen();
+}
@@ -0,0 +1,591 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "list.h"
+#include "stack.h"
+#include "tree.h"
+#include "desc.h"
+#include "file.h"
+#include "deps.h"
+#include "deadline.h"
+#include "tags.h"
+#include "progress.h"
+#include "mem.h"
+#include "bitmap.h"
+
+/**
+ * Regression tests for the list library.
+ *
+ * Each test builds a list in memory, runs list operations on it and checks the
+ * result through the public API. The undo history is kept small (TEST_UNDO_DEPTH)
+ * so the tests also cover groups that hold more records than it.
+ *
+ * Usage: test_list (exit status 1 if a check failed)
+ */
+
+#define TEST_UNDO_DEPTH 10
+
+static List *test_head = NULL;
+static Stack *test_stack = NULL;
+static Tree *test_trees[3];
+static int test_failures = 0;
+
+/**
+ * @brief Reports a failed check.
+ */
+#define TEST_CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            printf("%s:%d: check failed: %s\n", __func__, __LINE__, #condition); \
+            test_failures++; \
+        } \
+    } while (0)
+
+/**
+ * @brief Creates a task with an ID, a priority and a status.
+ */
+static Task* test_makeTask(int id, Priority priority, Status status) {
+    Task *task = mem_alloc(MEM_TASK, sizeof(Task));
+    if (!task) return NULL;
+    memset(task, 0, sizeof(Task));
+    task->id = id;
+    snprintf(task->title, sizeof(task->title), "Task %d", id);
+    task->priority = priority;
+    task->status = status;
+    task->description = DESC_NONE;
+    return task;
+}
+
+/**
+ * @brief Empties the list and the undo history, then adds tasks 1 to count without history.
+ *
+ * Odd IDs get high priority, even IDs low priority; every task is not started.
+ */
+static void test_reset(int count) {
+    list_clear(&test_head, NULL, test_trees[0], test_trees[1], test_trees[2]);
+    stack_clear(test_stack);
+    for (int id = 1; id <= count; id++) {
+        Task *task = test_makeTask(id, id % 2 ? PRIORITY_HIGH : PRIORITY_LOW, STATUS_NOT_STARTED);
+        if (!task || list_insertTask(&test_head, task, POS_END, 0, NULL,
+                                     test_trees[0], test_trees[1], test_trees[2]) != LIST_OK) {
+            printf("Cannot build the test list.\n");
+            exit(2);
+        }
+    }
+}
+
+/**
+ * @brief Counts the tasks of the list, checking they are in ascending ID order.
+ *
+ * @return Number of tasks, or -1 if the order is wrong.
+ */
+static int test_count() {
+    int count = 0, last = 0;
+    for (List *node = test_head; node != NULL; node = node->next) {
+        if (node->task->id <= last) return -1;
+        last = node->task->id;
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Predicate matching every task.
+ */
+static int test_matchAll(const Task *task, void *context) {
+    (void)task;
+    (void)context;
+    return 1;
+}
+
+/**
+ * @brief Undoing "remove where" brings back every task, even past the undo depth.
+ */
+static void test_removeWhereUndo() {
+    long removed = 0;
+    test_reset(50);
+    TEST_CHECK(list_removeWhere(&test_head, test_matchAll, NULL, test_stack, &removed,
+                                test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(removed == 50);
+    TEST_CHECK(test_count() == 0);
+    TEST_CHECK(list_undoStep(&test_head, test_stack, test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(test_count() == 50);
+    TEST_CHECK(list_redoStep(&test_head, test_stack, test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(test_count() == 0);
+}
+
+/**
+ * @brief Undoing "update where" restores every task, even past the undo depth.
+ */
+static void test_updateWhereUndo() {
+    long changed = 0;
+    test_reset(50);
+    TEST_CHECK(list_updateWhere(test_head, test_matchAll, NULL, PRIORITY_MEDIUM, STATUS_FINISHED, test_stack, &changed,
+                                test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(changed == 50);
+    TEST_CHECK(list_undoStep(&test_head, test_stack, test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    int restored = 0;
+    for (List *node = test_head; node != NULL; node = node->next) {
+        Priority priority = node->task->id % 2 ? PRIORITY_HIGH : PRIORITY_LOW;
+        restored += node->task->priority == priority && node->task->status == STATUS_NOT_STARTED;
+    }
+    TEST_CHECK(restored == 50);
+}
+
+/**
+ * @brief Undoing a clear brings back every task, even past the undo depth.
+ */
+static void test_clearUndo() {
+    test_reset(20);
+    list_clear(&test_head, test_stack, test_trees[0], test_trees[1], test_trees[2]);
+    TEST_CHECK(test_count() == 0);
+    TEST_CHECK(list_undoStep(&test_head, test_stack, test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(test_count() == 20);
+}
+
+/**
+ * @brief Rolling back a transaction larger than the undo depth restores the list at begin.
+ */
+static void test_rollbackPastDepth() {
+    int reverted = 0;
+    test_reset(3);
+    TEST_CHECK(list_txnBegin() == LIST_OK);
+    for (int id = 100; id < 115; id++) {
+        Task *task = test_makeTask(id, PRIORITY_LOW, STATUS_NOT_STARTED);
+        TEST_CHECK(task && list_insertTask(&test_head, task, POS_END, 0, test_stack,
+                                           test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    }
+    TEST_CHECK(list_txnRollback(&test_head, test_stack, &reverted,
+                                test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(reverted == 15);
+    TEST_CHECK(test_count() == 3);
+}
+
+/**
+ * @brief Visitor counting the tasks of a priority BST and checking their order.
+ */
+static void test_visitByPriority(Task *task, void *context) {
+    int *state = context;   // {tasks visited, last priority, last ID, out of order}
+    int priority = (int)task->priority;
+    if (state[0] > 0 && (priority < state[1] || (priority == state[1] && task->id <= state[2])))
+        state[3]++;
+    state[0]++;
+    state[1] = priority;
+    state[2] = task->id;
+}
+
+/**
+ * @brief A small transaction patches the BSTs: they are never stale and follow the change.
+ */
+static void test_smallTransactionPatches() {
+    int state[4] = {0, 0, 0, 0};
+    test_reset(200);
+    TEST_CHECK(list_txnBegin() == LIST_OK);
+    TEST_CHECK(list_setTaskFields(test_head, 2, PRIORITY_HIGH, STATUS_IN_PROGRESS, test_stack,
+                                  test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(!list_indexesStale());
+    TEST_CHECK(list_txnCommit(test_head, test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(!list_indexesStale());
+    tree_forEach(test_trees[1], test_visitByPriority, state);
+    TEST_CHECK(state[0] == 200 && state[3] == 0);
+
+    // Undoing the one-record group patches the BSTs back as well
+    TEST_CHECK(list_undoStep(&test_head, test_stack, test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(!list_indexesStale());
+    memset(state, 0, sizeof(state));
+    tree_forEach(test_trees[1], test_visitByPriority, state);
+    TEST_CHECK(state[0] == 200 && state[3] == 0);
+}
+
+/**
+ * @brief An empty rollback keeps the redo history from before begin.
+ */
+static void test_emptyRollbackKeepsRedo() {
+    int reverted = -1;
+    test_reset(0);
+    for (int id = 1; id <= 2; id++) {
+        Task *task = test_makeTask(id, PRIORITY_LOW, STATUS_NOT_STARTED);
+        TEST_CHECK(task && list_insertTask(&test_head, task, POS_END, 0, test_stack,
+                                           test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    }
+    TEST_CHECK(list_undoStep(&test_head, test_stack, test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(list_txnBegin() == LIST_OK);
+    TEST_CHECK(list_txnRollback(&test_head, test_stack, &reverted,
+                                test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(reverted == 0);
+    TEST_CHECK(list_redoStep(&test_head, test_stack, test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(test_count() == 2);
+}
+
+/**
+ * @brief A load replaces the list and clears the undo history, so undo cannot mix the two lists.
+ */
+static void test_loadClearsHistory() {
+    FILE *file = tmpfile();
+    TEST_CHECK(file != NULL);
+    if (!file) return;
+    test_reset(5);
+    TEST_CHECK(file_writeStream(test_head, file) == 5);
+    TEST_CHECK(list_removeTask(&test_head, 1, test_stack, test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    rewind(file);
+    TEST_CHECK(file_readStream(file, &test_head, test_stack, test_trees[0], test_trees[1], test_trees[2], NULL) == 5);
+    fclose(file);
+    TEST_CHECK(stack_getSize(test_stack) == 0);
+    TEST_CHECK(list_undoStep(&test_head, test_stack, test_trees[0], test_trees[1], test_trees[2]) == LIST_EMPTY);
+    TEST_CHECK(test_count() == 5);
+}
+
+/**
+ * @brief A task with no dependencies is ready (unless finished) and has a place in the order.
+ */
+static void test_isolatedTaskReady() {
+    int ids[8];
+    test_reset(4);
+    TEST_CHECK(deps_addEdge(list_findTask(test_head, 1), list_findTask(test_head, 2)) == DEPS_OK);
+    TEST_CHECK(list_setTaskFields(test_head, 4, PRIORITY_LOW, STATUS_FINISHED, NULL,
+                                  test_trees[1], test_trees[2]) == LIST_OK);
+
+    // Task 3 has no edges: ready next to task 1; task 2 is blocked, task 4 finished
+    int count = deps_ready(ids, 8);
+    TEST_CHECK(count == 2);
+    TEST_CHECK(count == 2 && ((ids[0] == 1 && ids[1] == 3) || (ids[0] == 3 && ids[1] == 1)));
+
+    // Every task is ordered, task 1 before task 2
+    int position[5] = {0};
+    count = deps_order(ids, 8);
+    TEST_CHECK(count == 4);
+    for (int i = 0; i < count && i < 8; i++)
+        if (ids[i] >= 1 && ids[i] <= 4) position[ids[i]] = i + 1;
+    TEST_CHECK(position[1] && position[2] && position[3] && position[4]);
+    TEST_CHECK(position[1] < position[2]);
+
+    // Tasks outside the graph follow status changes, removal, undo and clearing
+    TEST_CHECK(list_setTaskFields(test_head, 3, PRIORITY_HIGH, STATUS_FINISHED, test_stack,
+                                  test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(deps_ready(ids, 8) == 1);
+    TEST_CHECK(list_removeTask(&test_head, 3, test_stack, test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(deps_order(ids, 8) == 3);
+    TEST_CHECK(list_undoStep(&test_head, test_stack, test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(list_undoStep(&test_head, test_stack, test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(deps_ready(ids, 8) == 2 && deps_order(ids, 8) == 4);
+    list_clear(&test_head, test_stack, test_trees[0], test_trees[1], test_trees[2]);
+    TEST_CHECK(deps_ready(ids, 8) == 0 && deps_order(ids, 8) == 0);
+    TEST_CHECK(list_undoStep(&test_head, test_stack, test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(deps_ready(ids, 8) == 2 && deps_order(ids, 8) == 4);
+    deps_reset();
+}
+
+/**
+ * @brief A task added under a removed task's ID starts without its edges; evicting the
+ * removed task from the undo history drops its edges.
+ */
+static void test_reusedIdDropsEdges() {
+    int ids[4];
+    test_reset(3);
+    TEST_CHECK(deps_addEdge(list_findTask(test_head, 1), list_findTask(test_head, 2)) == DEPS_OK);
+    TEST_CHECK(list_removeTask(&test_head, 1, test_stack, test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    Task *fresh = test_makeTask(1, PRIORITY_LOW, STATUS_NOT_STARTED);
+    TEST_CHECK(fresh && list_insertTask(&test_head, fresh, POS_END, 0, test_stack,
+                                        test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(deps_blockers(2, ids, 4) == 0);
+    TEST_CHECK(deps_edgeCount() == 0);
+
+    // Task 3 leaves with its edge, and the edge goes once its record falls out of the history
+    TEST_CHECK(deps_addEdge(list_findTask(test_head, 3), list_findTask(test_head, 2)) == DEPS_OK);
+    TEST_CHECK(list_removeTask(&test_head, 3, test_stack, test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(deps_edgeCount() == 1);
+    for (int i = 0; i < TEST_UNDO_DEPTH; i++)
+        list_setTaskFields(test_head, 2, i % 2 ? PRIORITY_LOW : PRIORITY_HIGH, STATUS_NOT_STARTED, test_stack,
+                           test_trees[1], test_trees[2]);
+    TEST_CHECK(deps_edgeCount() == 0);
+    deps_reset();
+}
+
+/**
+ * @brief A task added under a removed task's ID starts without its tags; evicting the
+ * removed task from the undo history takes its tags off.
+ */
+static void test_reusedIdDropsTags() {
+    const char *names[2];
+    int ids[4], count = 0, error_at = 0;
+    test_reset(3);
+    TEST_CHECK(tags_add(list_findTask(test_head, 1), "infra") == TAGS_OK);
+    TEST_CHECK(list_removeTask(&test_head, 1, test_stack, test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    Task *fresh = test_makeTask(1, PRIORITY_LOW, STATUS_NOT_STARTED);
+    TEST_CHECK(fresh && list_insertTask(&test_head, fresh, POS_END, 0, test_stack,
+                                        test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(tags_ofTask(1, names, 2) == 0);
+    TEST_CHECK(tags_select("tag:infra", ids, 4, &count, &error_at) == TAGS_OK && count == 0);
+
+    // Task 3 leaves with its tag, and the tag goes once its record falls out of the history
+    TEST_CHECK(tags_add(list_findTask(test_head, 3), "infra") == TAGS_OK);
+    TEST_CHECK(list_removeTask(&test_head, 3, test_stack, test_trees[0], test_trees[1], test_trees[2]) == LIST_OK);
+    TEST_CHECK(tags_ofTask(3, names, 2) == 1);
+    for (int i = 0; i < TEST_UNDO_DEPTH; i++)
+        list_setTaskFields(test_head, 2, i % 2 ? PRIORITY_LOW : PRIORITY_HIGH, STATUS_NOT_STARTED, test_stack,
+                           test_trees[1], test_trees[2]);
+    TEST_CHECK(tags_ofTask(3, names, 2) == 0);
+    tags_reset();
+}
+
+/**
+ * @brief Returns the next value of a fixed linear congruential sequence.
+ *
+ * The tests draw their "random" inputs from it so every run checks the same cases.
+ */
+static unsigned int test_random(unsigned int *state) {
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 8;
+}
+
+/**
+ * @brief Edge visitor: counts the edges whose blocker is ordered after the blocked task.
+ */
+static void test_checkEdgeOrder(int blocker_id, int blocked_id, void *context) {
+    int *position = context;
+    if (position[blocker_id] == 0 || position[blocker_id] >= position[blocked_id]) position[0]++;
+}
+
+/**
+ * @brief Edges that would close a cycle are rejected and leave the graph as it was.
+ *
+ * Tasks 1 to 200 form a chain, with random forward edges on top; every backward
+ * edge then closes a cycle.
+ */
+static void test_cycleRejected() {
+    enum { COUNT = 200 };
+    static int ids[COUNT], position[COUNT + 1];
+    unsigned int seed = 40;
+    test_reset(COUNT);
+    for (int id = 1; id < COUNT; id++)
+        TEST_CHECK(deps_addEdge(list_findTask(test_head, id), list_findTask(test_head, id + 1)) == DEPS_OK);
+    for (int i = 0; i < 2000; i++) {
+        int a = 1 + (int)(test_random(&seed) % COUNT), b = 1 + (int)(test_random(&seed) % COUNT);
+        if (a == b) continue;
+        DepsStatus status = deps_addEdge(list_findTask(test_head, a < b ? a : b),
+                                         list_findTask(test_head, a < b ? b : a));
+        TEST_CHECK(status == DEPS_OK || status == DEPS_EXISTS);
+    }
+    long edges = deps_edgeCount();
+
+    TEST_CHECK(deps_addEdge(list_findTask(test_head, 7), list_findTask(test_head, 7)) == DEPS_SELF);
+    TEST_CHECK(deps_addEdge(list_findTask(test_head, COUNT), list_findTask(test_head, 1)) == DEPS_CYCLE);
+    for (int i = 0; i < 500; i++) {
+        int a = 1 + (int)(test_random(&seed) % COUNT), b = 1 + (int)(test_random(&seed) % COUNT);
+        if (a == b) continue;
+        TEST_CHECK(deps_addEdge(list_findTask(test_head, a > b ? a : b),
+                                list_findTask(test_head, a > b ? b : a)) == DEPS_CYCLE);
+    }
+    TEST_CHECK(deps_edgeCount() == edges);
+
+    // The order still puts every blocker before the tasks it blocks
+    TEST_CHECK(deps_order(ids, COUNT) == COUNT);
+    memset(position, 0, sizeof(position));
+    for (int i = 0; i < COUNT; i++)
+        if (ids[i] >= 1 && ids[i] <= COUNT) position[ids[i]] = i + 1;
+    deps_forEachEdge(test_checkEdgeOrder, position);
+    TEST_CHECK(position[0] == 0);
+    deps_reset();
+}
+
+/**
+ * @brief Clock state for test_checkFired(): the previous and the new time of a step.
+ */
+typedef struct {
+    unsigned int before;
+    unsigned int now;
+    int bad;
+} TestStep;
+
+/**
+ * @brief Expiry visitor: counts the deadlines fired outside the step that passed them.
+ */
+static void test_checkFired(int id, unsigned int due, void *context) {
+    TestStep *step = context;
+    const Task *task = list_findTask(test_head, id);
+    if (!task || task->due != due || due <= step->before || due > step->now) step->bad++;
+}
+
+/**
+ * @brief The timing wheel agrees with a scan of the list at every step of the clock.
+ *
+ * Due dates drawn from a fixed sequence spread over every level of the wheel, and
+ * tasks are rescheduled or finished as the clock moves, so deadlines cascade down
+ * the levels and leave them early.
+ */
+static void test_wheelMatchesScan() {
+    enum { COUNT = 3000 };
+    const unsigned int base = 1000000000u;
+    static const unsigned int spans[] = {300, 70000, 20000000, 3000000000u};
+    unsigned int seed = 41;
+    TestStep step = {base, base, 0};
+    test_reset(0);
+    deadline_reset();
+    deadline_advance(base, NULL, NULL);
+    for (int id = 1; id <= COUNT; id++) {
+        Task *task = test_makeTask(id, PRIORITY_LOW, STATUS_NOT_STARTED);
+        if (task && id % 10) task->due = base + 1 + test_random(&seed) % spans[id % 4];
+        if (!task || list_insertTask(&test_head, task, POS_END, 0, NULL,
+                                     test_trees[0], test_trees[1], test_trees[2]) != LIST_OK) {
+            printf("Cannot build the test list.\n");
+            exit(2);
+        }
+    }
+
+    for (int i = 0; i < 4000 && step.now < 4000000000u; i++) {
+        step.before = step.now;
+        step.now += 1 + test_random(&seed) % (i < 2000 ? 600 : 2000000);
+        long fired = deadline_advance(step.now, test_checkFired, &step);
+        if (i % 16 == 0) {
+            int id = 1 + (int)(test_random(&seed) % COUNT);
+            unsigned int due = step.now + 1 + test_random(&seed) % 100000;
+            TEST_CHECK(list_setTaskFieldsDue(test_head, id, PRIORITY_LOW, i % 32 ? STATUS_NOT_STARTED : STATUS_FINISHED,
+                                             due, NULL, test_trees[1], test_trees[2]) == LIST_OK);
+        }
+
+        int overdue = 0, pending = 0;
+        for (List *node = test_head; node != NULL; node = node->next) {
+            const Task *task = node->task;
+            if (task->status == STATUS_FINISHED || task->due == 0) continue;
+            if (task->due <= step.now) overdue++;
+            else pending++;
+        }
+        TEST_CHECK(fired >= 0 && deadline_now() == step.now);
+        TEST_CHECK(deadline_overdueCount() == overdue);
+        TEST_CHECK(deadline_pendingCount() == pending);
+        if (deadline_overdueCount() != overdue || deadline_pendingCount() != pending) break;
+    }
+    TEST_CHECK(step.bad == 0);
+    TEST_CHECK(deadline_overdueCount() > 0);
+    test_reset(0);
+    deadline_reset();
+}
+
+/**
+ * @brief Fills a bitmap and its model with count distinct values in each of two containers.
+ */
+static void test_fillBitmap(Bitmap *bitmap, unsigned char *model, int count, unsigned int *seed) {
+    for (uint32_t key = 0; key < 2; key++) {
+        for (int added = 0; added < count; ) {
+            uint32_t value = key << 16 | test_random(seed) % 65536;
+            if (model[value]) continue;
+            model[value] = 1;
+            if (!bitmap_add(bitmap, value)) {
+                printf("Out of memory.\n");
+                exit(2);
+            }
+            added++;
+        }
+    }
+}
+
+/**
+ * @brief Checks a bitmap against its model; returns 1 if they hold the same values.
+ */
+static int test_sameBitmap(const Bitmap *bitmap, const unsigned char *model, uint32_t *values) {
+    long count = bitmap_values(bitmap, values, 2 * 65536), expected = 0;
+    for (uint32_t value = 0; value < 2 * 65536; value++) {
+        if (!model[value]) continue;
+        if (expected >= count || values[expected] != value) return 0;
+        expected++;
+    }
+    return count == expected && bitmap_cardinality(bitmap) == expected;
+}
+
+/**
+ * @brief AND and AND NOT give the same values as a plain model on both sides of the
+ * array/bitset switch at BITMAP_ARRAY_MAX values per container.
+ *
+ * Each pair of sizes is run with full containers, then again after removals take
+ * the first operand back below the switch.
+ */
+static void test_bitmapAcrossSwitch() {
+    static const int sizes[] = {BITMAP_ARRAY_MAX / 2, BITMAP_ARRAY_MAX - 1, BITMAP_ARRAY_MAX,
+                                BITMAP_ARRAY_MAX + 1, 3 * BITMAP_ARRAY_MAX};
+    enum { SIZES = sizeof(sizes) / sizeof(sizes[0]), RANGE = 2 * 65536 };
+    unsigned char *model_a = mem_alloc(MEM_SCRATCH, RANGE), *model_b = mem_alloc(MEM_SCRATCH, RANGE);
+    unsigned char *model_out = mem_alloc(MEM_SCRATCH, RANGE);
+    uint32_t *values = mem_alloc(MEM_SCRATCH, RANGE * sizeof(uint32_t));
+    unsigned int seed = 42;
+    if (!model_a || !model_b || !model_out || !values) {
+        printf("Out of memory.\n");
+        exit(2);
+    }
+
+    for (int i = 0; i < SIZES; i++) {
+        for (int j = 0; j < SIZES; j++) {
+            Bitmap a, b, out;
+            bitmap_init(&a);
+            bitmap_init(&b);
+            bitmap_init(&out);
+            memset(model_a, 0, RANGE);
+            memset(model_b, 0, RANGE);
+            test_fillBitmap(&a, model_a, sizes[i], &seed);
+            test_fillBitmap(&b, model_b, sizes[j], &seed);
+            TEST_CHECK(test_sameBitmap(&a, model_a, values) && test_sameBitmap(&b, model_b, values));
+
+            for (int pass = 0; pass < 2; pass++) {
+                TEST_CHECK(bitmap_and(&out, &a, &b));
+                for (int v = 0; v < RANGE; v++) model_out[v] = model_a[v] && model_b[v];
+                TEST_CHECK(test_sameBitmap(&out, model_out, values));
+                TEST_CHECK(bitmap_andNot(&out, &a, &b));
+                for (int v = 0; v < RANGE; v++) model_out[v] = model_a[v] && !model_b[v];
+                TEST_CHECK(test_sameBitmap(&out, model_out, values));
+
+                // Take a back below the switch (and below half of it, where bitsets shrink)
+                for (int v = 0, kept = 0; v < RANGE; v++) {
+                    if (v % 65536 == 0) kept = 0;
+                    if (model_a[v] && ++kept > BITMAP_ARRAY_MAX / 3) {
+                        model_a[v] = 0;
+                        bitmap_remove(&a, (uint32_t)v);
+                    }
+                }
+            }
+            bitmap_free(&a);
+            bitmap_free(&b);
+            bitmap_free(&out);
+        }
+    }
+    mem_free(MEM_SCRATCH, model_a, RANGE);
+    mem_free(MEM_SCRATCH, model_b, RANGE);
+    mem_free(MEM_SCRATCH, model_out, RANGE);
+    mem_free(MEM_SCRATCH, values, RANGE * sizeof(uint32_t));
+}
+
+int main() {
+    progress_setEnabled(0);
+    test_stack = stack_create(TEST_UNDO_DEPTH);
+    if (test_stack) stack_setEvictHandler(test_stack, list_evictTask);
+    test_trees[0] = tree_create(KEY_ID);
+    test_trees[1] = tree_create(KEY_PRIORITY);
+    test_trees[2] = tree_create(KEY_STATUS);
+    if (!test_stack || !test_trees[0] || !test_trees[1] || !test_trees[2]) {
+        printf("Out of memory.\n");
+        return 2;
+    }
+
+    test_removeWhereUndo();
+    test_updateWhereUndo();
+    test_clearUndo();
+    test_rollbackPastDepth();
+    test_emptyRollbackKeepsRedo();
+    test_smallTransactionPatches();
+    test_loadClearsHistory();
+    test_isolatedTaskReady();
+    test_reusedIdDropsEdges();
+    test_reusedIdDropsTags();
+    test_cycleRejected();
+    test_wheelMatchesScan();
+    test_bitmapAcrossSwitch();
+
+    list_destroy(test_head);
+    stack_free(test_stack);
+    for (int i = 0; i < 3; i++) tree_free(test_trees[i]);
+    desc_reset();
+    if (test_failures) {
+        printf("%d checks failed.\n", test_failures);
+        return 1;
+    }
+    printf("All tests passed.\n");
+    return 0;
+}